@@ -0,0 +1,73 @@
+/*!
+ @header MDLAlignedAllocator.hpp
+ @framework ModelIO
+ @abstract Standard allocator for SIMD-aligned native storage
+ @copyright Treata Norouzi on 10/19/26.
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include "MDLDefines.hpp"
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace MDL
+{
+namespace Private
+{
+    // Allocates on `_Alignment` bytes, a cache line by default, so SIMD
+    // loops over the storage start on an aligned element
+    template <typename _Type, std::size_t _Alignment = 64>
+    class AlignedAllocator
+    {
+    public:
+        using value_type = _Type;
+
+        template <typename _Other>
+        struct rebind
+        {
+            using other = AlignedAllocator<_Other, _Alignment>;
+        };
+
+                                    AlignedAllocator() noexcept = default;
+        template <typename _Other>
+                                    AlignedAllocator(const AlignedAllocator<_Other, _Alignment>&) noexcept {}
+
+        _Type*                      allocate(std::size_t count);
+        void                        deallocate(_Type* pointer, std::size_t count) noexcept;
+
+        template <typename _Other>
+        bool                        operator==(const AlignedAllocator<_Other, _Alignment>&) const noexcept { return true; }
+        template <typename _Other>
+        bool                        operator!=(const AlignedAllocator<_Other, _Alignment>&) const noexcept { return false; }
+    };
+
+    template <typename _Type, std::size_t _Alignment = 64>
+    using AlignedVector = std::vector<_Type, AlignedAllocator<_Type, _Alignment>>;
+
+} // Private
+} // MDL
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// MARK: - Private Sector
+
+template <typename _Type, std::size_t _Alignment>
+_MDL_INLINE _Type* MDL::Private::AlignedAllocator<_Type, _Alignment>::allocate(std::size_t count)
+{
+    return static_cast<_Type*>(::operator new(count * sizeof(_Type), std::align_val_t(_Alignment)));
+}
+
+template <typename _Type, std::size_t _Alignment>
+_MDL_INLINE void MDL::Private::AlignedAllocator<_Type, _Alignment>::deallocate(_Type* pointer, std::size_t) noexcept
+{
+    ::operator delete(pointer, std::align_val_t(_Alignment));
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
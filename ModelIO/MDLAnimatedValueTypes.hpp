@@ -8,6 +8,10 @@
 
 #include "Foundation/Foundation.hpp"
 #include "MDLTypes.hpp"
+#include "MDLCurveCompression.hpp"
+#include "MDLKeyframeSampling.hpp"
+#include "MDLTransformProgram.hpp"
+#include "MDLTransform.hpp"
 
 namespace MDL
 {
@@ -45,6 +49,20 @@ public:
     
     // getTimes:maxCount:
     NS::UInteger                    getTimes(const NS::TimeInterval* timesArray, NS::UInteger maxCount);
+    
+    // - Native
+    
+    // Native copy of the keys of a scalar, vector3, quaternion or matrix
+    // value, imported on first use; nullptr for the other value types.
+    // timeSampleCount, minimumTime, maximumTime and getTimes read it. The
+    // snapshot returned is unaffected by later edits.
+    std::shared_ptr<const Private::KeyframeCurve>   keyframeCurve();
+    
+    // keyTimes without boxing each time
+    KeyTimeSpan                     keyTimeSpan();
+    
+    // Drops the native keys, for values edited outside the bridge
+    void                            invalidateKeyframes();
 };
 
 class AnimatedScalarArray : public NS::Referencing<AnimatedValue>
@@ -84,6 +102,16 @@ public:
     
     // getDoubleArray:maxCount:
     NS::UInteger                getDoubleArray(const double* valuesArray, NS::UInteger maxCount);
+    
+    // - Native
+    
+    // Compresses the current keys into a lossy copy kept next to them; the
+    // value's getters keep answering with the exact keys from ModelIO. The
+    // copy is dropped by the value's next edit through the bridge
+    std::shared_ptr<const CompressedCurve>  compress(const CurveCompressionSettings& settings = CurveCompressionSettings());
+    
+    // nullptr unless compressed
+    std::shared_ptr<const CompressedCurve>  compressedCurve() const;
 };
 
 class AnimatedVector3Array : public NS::Referencing<AnimatedValue>
@@ -121,6 +149,16 @@ public:
     
     // getDouble3Array:maxCount:
     NS::UInteger        getDouble3Array(const vector_double3* valuesArray, NS::UInteger maxCount);
+    
+    // - Native
+    
+    // Compresses the current keys into a lossy copy kept next to them; the
+    // value's getters keep answering with the exact keys from ModelIO. The
+    // copy is dropped by the value's next edit through the bridge
+    std::shared_ptr<const CompressedCurve>  compress(const CurveCompressionSettings& settings = CurveCompressionSettings());
+    
+    // nullptr unless compressed
+    std::shared_ptr<const CompressedCurve>  compressedCurve() const;
 };
 
 class AnimatedQuaternionArray : public NS::Referencing<AnimatedValue>
@@ -158,10 +196,21 @@ public:
     
     // getDoubleQuaternionArray:maxCount:
     NS::UInteger            getDoubleQuaternionArray(const simd_quatd* valuesArray, NS::UInteger maxCount);
+    
+    // - Native
+    
+    // Compresses the current keys into a lossy copy kept next to them; the
+    // value's getters keep answering with the exact keys from ModelIO. The
+    // copy is dropped by the value's next edit through the bridge
+    std::shared_ptr<const CompressedCurve>  compress(const CurveCompressionSettings& settings = CurveCompressionSettings());
+    
+    // nullptr unless compressed
+    std::shared_ptr<const CompressedCurve>  compressedCurve() const;
 };
 
 class AnimatedScalar : public NS::Referencing<AnimatedValue>
 {
+public:
     static class AnimatedScalar*    alloc();
     
     class AnimatedScalar*           init();
@@ -183,10 +232,24 @@ class AnimatedScalar : public NS::Referencing<AnimatedValue>
     
     // resetWithDoubleArray:atTimes:count:
     void                            resetWithDoubleArray(const double* valuesArray, const NS::TimeInterval* timesArray, NS::UInteger count);
+    
+    // - Native
+    
+    // Samples at each of `times`; one sweep over the keys while the times
+    // ascend
+    void                            floatsAtTimes(const NS::TimeInterval* times, NS::UInteger count, float* values);
+    
+    // Samples at start + i * frameInterval, the spacing of Asset::frameInterval
+    void                            floatsAtTimes(NS::TimeInterval start, NS::TimeInterval frameInterval,
+                                                  NS::UInteger count, float* values);
+    
+    // Sequential sampling; `cursor` keeps the key of the previous call
+    float                           floatAtTime(NS::TimeInterval time, KeyframeCursor& cursor);
 };
     
 class AnimatedVector2 : public NS::Referencing<AnimatedValue>
 {
+public:
     static class AnimatedVector2*   alloc();
     
     class AnimatedVector2*          init();
@@ -218,6 +281,7 @@ class AnimatedVector2 : public NS::Referencing<AnimatedValue>
 
 class AnimatedVector3 : public NS::Referencing<AnimatedValue>
 {
+public:
     static class AnimatedVector3*   alloc();
     
     class AnimatedVector3*          init();
@@ -245,10 +309,24 @@ class AnimatedVector3 : public NS::Referencing<AnimatedValue>
     
     // getDouble3Array:maxCount:
     NS::UInteger            getDouble3Array(const vector_double3* valuesArray, NS::UInteger maxCount);
+    
+    // - Native
+    
+    // Samples at each of `times`; one sweep over the keys while the times
+    // ascend
+    void                    float3sAtTimes(const NS::TimeInterval* times, NS::UInteger count, vector_float3* values);
+    
+    // Samples at start + i * frameInterval, the spacing of Asset::frameInterval
+    void                    float3sAtTimes(NS::TimeInterval start, NS::TimeInterval frameInterval,
+                                           NS::UInteger count, vector_float3* values);
+    
+    // Sequential sampling; `cursor` keeps the key of the previous call
+    vector_float3           float3AtTime(NS::TimeInterval time, KeyframeCursor& cursor);
 };
 
 class AnimatedVector4 : public NS::Referencing<AnimatedValue>
 {
+public:
     static class AnimatedVector4*   alloc();
     
     class AnimatedVector4*          init();
@@ -280,6 +358,7 @@ class AnimatedVector4 : public NS::Referencing<AnimatedValue>
 
 class AnimatedQuaternion : public NS::Referencing<AnimatedValue>
 {
+public:
     static class AnimatedQuaternion*    alloc();
     
     class AnimatedQuaternion*           init();
@@ -307,10 +386,24 @@ class AnimatedQuaternion : public NS::Referencing<AnimatedValue>
     
     // getDoubleQuaternionArray:maxCount:
     NS::UInteger        getDoubleQuaternionArray(const simd_quatd* valuesArray, NS::UInteger maxCount);
+    
+    // - Native
+    
+    // Samples at each of `times`, spherically between keys; one sweep over
+    // the keys while the times ascend
+    void                floatQuaternionsAtTimes(const NS::TimeInterval* times, NS::UInteger count, simd_quatf* values);
+    
+    // Samples at start + i * frameInterval, the spacing of Asset::frameInterval
+    void                floatQuaternionsAtTimes(NS::TimeInterval start, NS::TimeInterval frameInterval,
+                                                NS::UInteger count, simd_quatf* values);
+    
+    // Sequential sampling; `cursor` keeps the key of the previous call
+    simd_quatf          floatQuaternionAtTime(NS::TimeInterval time, KeyframeCursor& cursor);
 };
 
 class AnimatedMatrix4x4 : public NS::Referencing<AnimatedValue>
 {
+public:
     static class AnimatedMatrix4x4*     alloc();
     
     class AnimatedMatrix4x4*            init();
@@ -338,8 +431,41 @@ class AnimatedMatrix4x4 : public NS::Referencing<AnimatedValue>
     
     // getDouble4x4Array:maxCount:
     NS::UInteger            getDouble4x4Array(const matrix_double4x4* valuesArray, NS::UInteger maxCount);
+    
+    // - Native
+    
+    // Samples at each of `times`, element-wise between keys; one sweep over
+    // the keys while the times ascend
+    void                    float4x4sAtTimes(const NS::TimeInterval* times, NS::UInteger count, matrix_float4x4* values);
+    
+    // Samples at start + i * frameInterval, the spacing of Asset::frameInterval
+    void                    float4x4sAtTimes(NS::TimeInterval start, NS::TimeInterval frameInterval,
+                                             NS::UInteger count, matrix_float4x4* values);
+    
+    // Sequential sampling; `cursor` keeps the key of the previous call
+    matrix_float4x4         float4x4AtTime(NS::TimeInterval time, KeyframeCursor& cursor);
 };
 
+namespace Private
+{
+    // Drops what was derived from `value` through the transform stacks
+    // sampling it -- compiled programs, bounds, mirrored scene transforms --
+    // as a transform setter does for its own component
+    void                                    animatedValueEdited(const void* value);
+    
+    // How the keys of values of class `cls` are mirrored natively; a zero
+    // stride for classes that are not. Answered from a per-thread table after
+    // the first call for a class.
+    struct KeyframeLayout
+    {
+        NS::UInteger                        stride;
+        SEL                                 getValues;
+        bool                                spherical;
+    };
+    KeyframeLayout                          keyframeLayout(::Class cls);
+    
+} // Private
+
 }
 
 // MARK: - Private Sector
@@ -371,18 +497,32 @@ _MDL_INLINE MDL::DataPrecision MDL::AnimatedValue::precision() const
 // property: timeSampleCount
 _MDL_INLINE NS::UInteger MDL::AnimatedValue::timeSampleCount() const
 {
+    if (const auto curve = const_cast<AnimatedValue*>(this)->keyframeCurve())
+    {
+        return curve->keyCount();
+    }
     return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(timeSampleCount));
 }
 
 // property: minimumTime
 _MDL_INLINE NS::TimeInterval MDL::AnimatedValue::minimumTime() const
 {
+    const auto curve = const_cast<AnimatedValue*>(this)->keyframeCurve();
+    if (curve && curve->keyCount())
+    {
+        return curve->times()[0];
+    }
     return Object::sendMessage<NS::TimeInterval>(this, _MDL_PRIVATE_SEL(minimumTime));
 }
 
 // property: maximumTime
 _MDL_INLINE NS::TimeInterval MDL::AnimatedValue::maximumTime() const
 {
+    const auto curve = const_cast<AnimatedValue*>(this)->keyframeCurve();
+    if (curve && curve->keyCount())
+    {
+        return curve->times()[curve->keyCount() - 1];
+    }
     return Object::sendMessage<NS::TimeInterval>(this, _MDL_PRIVATE_SEL(maximumTime));
 }
 
@@ -394,7 +534,9 @@ _MDL_INLINE MDL::AnimatedValueInterpolation MDL::AnimatedValue::interpolation()
 // write method: setInterpolation:
 _MDL_INLINE void MDL::AnimatedValue::setInterpolation(AnimatedValueInterpolation interpolation)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setInterpolation_), interpolation);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setInterpolation_), interpolation);
+    Private::KeyframeStore::shared().remove(this);
+    Private::CompressedCurveStore::shared().remove(this);
 }
 
 // property: keyTimes
@@ -406,12 +548,21 @@ _MDL_INLINE NS::Array* MDL::AnimatedValue::keyTimes() const
 // method: clear
 _MDL_INLINE void MDL::AnimatedValue::clear()
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(clear));
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(clear));
+    Private::KeyframeStore::shared().edit(this, [](Private::KeyframeCurve& curve) { curve.clear(); });
+    Private::CompressedCurveStore::shared().remove(this);
+    Private::animatedValueEdited(this);
 }
 
 // method: getTimes:maxCount:
 _MDL_INLINE NS::UInteger MDL::AnimatedValue::getTimes(const NS::TimeInterval* timesArray, NS::UInteger maxCount)
 {
+    if (const auto curve = keyframeCurve())
+    {
+        const NS::UInteger count = std::min(maxCount, curve->keyCount());
+        std::copy(curve->times(), curve->times() + count, const_cast<NS::TimeInterval*>(timesArray));
+        return count;
+    }
     return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getTimes_maxCount_), timesArray, maxCount);
 }
 
@@ -444,51 +595,55 @@ _MDL_INLINE MDL::AnimatedScalarArray* MDL::AnimatedScalarArray::init(NS::UIntege
 // method: setFloatArray:count:atTime:
 _MDL_INLINE void MDL::AnimatedScalarArray::setFloatArray(const float* array, NS::UInteger count, NS::TimeInterval time)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setFloatArray_count_atTime_), array, count, time);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setFloatArray_count_atTime_), array, count, time);
+    Private::CompressedCurveStore::shared().remove(this);
 }
 
 // method: setDoubleArray:count:atTime:
 _MDL_INLINE void MDL::AnimatedScalarArray::setDoubleArray(const double* array, NS::UInteger count, NS::TimeInterval time)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setDoubleArray_count_atTime_), array, count, time);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setDoubleArray_count_atTime_), array, count, time);
+    Private::CompressedCurveStore::shared().remove(this);
 }
 
-// method: getFloatArray:count:atTime:
+// method: getFloatArray:maxCount:atTime:
 _MDL_INLINE NS::UInteger MDL::AnimatedScalarArray::getFloatArray(const float* array, NS::UInteger maxCount, NS::TimeInterval time)
 {
-    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getFloatArray_count_atTime_), array, maxCount, time);
+    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getFloatArray_maxCount_atTime_), array, maxCount, time);
 }
 
-// method: getDoubleArray:count:atTime:
+// method: getDoubleArray:maxCount:atTime:
 _MDL_INLINE NS::UInteger MDL::AnimatedScalarArray::getDoubleArray(const double* array, NS::UInteger maxCount, NS::TimeInterval time)
 {
-    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getDoubleArray_count_atTime_), array, maxCount, time);
+    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getDoubleArray_maxCount_atTime_), array, maxCount, time);
 }
 
 // method: resetWithFloatArray:count:atTimes:count:
 _MDL_INLINE void MDL::AnimatedScalarArray::resetWithFloatArray(const float* valuesArray, NS::UInteger valuesCount,
                                                                const NS::TimeInterval* timesArray, NS::UInteger timesCount)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithFloatArray_count_atTime_count_), valuesArray, valuesCount, timesArray, timesCount);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithFloatArray_count_atTimes_count_), valuesArray, valuesCount, timesArray, timesCount);
+    Private::CompressedCurveStore::shared().remove(this);
 }
 
 // method: resetWithDoubleArray:count:atTimes:count:
 _MDL_INLINE void MDL::AnimatedScalarArray::resetWithDoubleArray(const double* valuesArray, NS::UInteger valuesCount,
                                                                const NS::TimeInterval* timesArray, NS::UInteger timesCount)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithDoubleArray_count_atTime_count_), valuesArray, valuesCount, timesArray, timesCount);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithDoubleArray_count_atTimes_count_), valuesArray, valuesCount, timesArray, timesCount);
+    Private::CompressedCurveStore::shared().remove(this);
 }
 
 // method: getFloatArray:maxCount:
 _MDL_INLINE NS::UInteger MDL::AnimatedScalarArray::getFloatArray(const float* array, NS::UInteger maxCount)
 {
-    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getFloatArray_count_), array, maxCount);
+    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getFloatArray_maxCount_), array, maxCount);
 }
 
 // method: getDoubleArray:maxCount:
 _MDL_INLINE NS::UInteger MDL::AnimatedScalarArray::getDoubleArray(const double* array, NS::UInteger maxCount)
 {
-    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getDoubleArray_count_), array, maxCount);
+    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getDoubleArray_maxCount_), array, maxCount);
 }
 
 // MARK: Class AnimatedVector3Array
@@ -514,51 +669,55 @@ _MDL_INLINE MDL::AnimatedVector3Array* MDL::AnimatedVector3Array::init(NS::UInte
 // method: setFloat3Array:count:atTime:
 _MDL_INLINE void MDL::AnimatedVector3Array::setFloat3Array(const vector_float3* array, NS::UInteger count, NS::TimeInterval time)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setFloat3Array_count_atTime_), array, count, time);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setFloat3Array_count_atTime_), array, count, time);
+    Private::CompressedCurveStore::shared().remove(this);
 }
 
 // method: setDouble3Array:count:atTime:
 _MDL_INLINE void MDL::AnimatedVector3Array::setDouble3Array(const vector_double3* array, NS::UInteger count, NS::TimeInterval time)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setDouble3Array_count_atTime_), array, count, time);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setDouble3Array_count_atTime_), array, count, time);
+    Private::CompressedCurveStore::shared().remove(this);
 }
 
-// method: getFloat3Array:count:atTime:
+// method: getFloat3Array:maxCount:atTime:
 _MDL_INLINE NS::UInteger MDL::AnimatedVector3Array::getFloat3Array(const vector_float3* array, NS::UInteger maxCount, NS::TimeInterval time)
 {
-    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getFloat3Array_count_atTime_), array, maxCount, time);
+    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getFloat3Array_maxCount_atTime_), array, maxCount, time);
 }
 
-// method: getDouble3Array:count:atTime:
+// method: getDouble3Array:maxCount:atTime:
 _MDL_INLINE NS::UInteger MDL::AnimatedVector3Array::getDouble3Array(const vector_double3* array, NS::UInteger maxCount, NS::TimeInterval time)
 {
-    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getDouble3Array_count_atTime_), array, maxCount, time);
+    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getDouble3Array_maxCount_atTime_), array, maxCount, time);
 }
 
 // method: resetWithFloat3Array:count:atTimes:count:
 _MDL_INLINE void MDL::AnimatedVector3Array::resetWithFloat3Array(const vector_float3* valuesArray, NS::UInteger valuesCount,
                                                                  const NS::TimeInterval* timesArray, NS::UInteger timesCount)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithFloat3Array_count_atTime_count_), valuesArray, valuesCount, timesArray, timesCount);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithFloat3Array_count_atTimes_count_), valuesArray, valuesCount, timesArray, timesCount);
+    Private::CompressedCurveStore::shared().remove(this);
 }
 
 // method: resetWithDouble3Array:count:atTimes:count:
 _MDL_INLINE void MDL::AnimatedVector3Array::resetWithDouble3Array(const vector_double3* valuesArray, NS::UInteger valuesCount,
                                                                   const NS::TimeInterval* timesArray, NS::UInteger timesCount)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithDouble3Array_count_atTime_count_), valuesArray, valuesCount, timesArray, timesCount);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithDouble3Array_count_atTimes_count_), valuesArray, valuesCount, timesArray, timesCount);
+    Private::CompressedCurveStore::shared().remove(this);
 }
 
 
 _MDL_INLINE NS::UInteger MDL::AnimatedVector3Array::getFloat3Array(const vector_float3* array, NS::UInteger maxCount)
 {
-    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getFloat3Array_count_), array, maxCount);
+    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getFloat3Array_maxCount_), array, maxCount);
 }
 
 // method: getDouble3Array:maxCount:
 _MDL_INLINE NS::UInteger MDL::AnimatedVector3Array::getDouble3Array(const vector_double3* array, NS::UInteger maxCount)
 {
-    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getDouble3Array_count_), array, maxCount);
+    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getDouble3Array_maxCount_), array, maxCount);
 }
 
 // MARK: Class AnimatedQuaternionArray
@@ -584,51 +743,55 @@ _MDL_INLINE MDL::AnimatedQuaternionArray* MDL::AnimatedQuaternionArray::init(NS:
 // method: setFloatQuaternionArray:count:atTime:
 _MDL_INLINE void MDL::AnimatedQuaternionArray::setFloatQuaternionArray(const simd_quatf* array, NS::UInteger count, NS::TimeInterval time)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setFloatQuaternionArray_count_atTime_), array, count, time);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setFloatQuaternionArray_count_atTime_), array, count, time);
+    Private::CompressedCurveStore::shared().remove(this);
 }
 
 // method: setDoubleQuaternionArray:count:atTime:
 _MDL_INLINE void MDL::AnimatedQuaternionArray::setDoubleQuaternionArray(const simd_quatd* array, NS::UInteger count, NS::TimeInterval time)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setDoubleQuaternionArray_count_atTime_), array, count, time);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setDoubleQuaternionArray_count_atTime_), array, count, time);
+    Private::CompressedCurveStore::shared().remove(this);
 }
 
-// method: getFloatQuaternionArray:count:atTime:
+// method: getFloatQuaternionArray:maxCount:atTime:
 _MDL_INLINE NS::UInteger MDL::AnimatedQuaternionArray::getFloatQuaternionArray(const simd_quatf* array, NS::UInteger maxCount, NS::TimeInterval time)
 {
-    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getFloatQuaternionArray_count_atTime_), array, maxCount, time);
+    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getFloatQuaternionArray_maxCount_atTime_), array, maxCount, time);
 }
 
-// method: getDoubleQuaternionArray:count:atTime:
+// method: getDoubleQuaternionArray:maxCount:atTime:
 _MDL_INLINE NS::UInteger MDL::AnimatedQuaternionArray::getDoubleQuaternionArray(const simd_quatd* array, NS::UInteger maxCount, NS::TimeInterval time)
 {
-    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getDoubleQuaternionArray_count_atTime_), array, maxCount, time);
+    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getDoubleQuaternionArray_maxCount_atTime_), array, maxCount, time);
 }
 
 // method: resetWithFloatQuaternionArray:count:atTimes:count:
 _MDL_INLINE void MDL::AnimatedQuaternionArray::resetWithFloatQuaternionArray(const simd_quatf* valuesArray, NS::UInteger valuesCount,
                                                                              const NS::TimeInterval* timesArray, NS::UInteger timesCount)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithFloatQuaternionArray_count_atTime_count_), valuesArray, valuesCount, timesArray, timesCount);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithFloatQuaternionArray_count_atTimes_count_), valuesArray, valuesCount, timesArray, timesCount);
+    Private::CompressedCurveStore::shared().remove(this);
 }
 
 // method: resetWithDoubleQuaternionArray:count:atTimes:count:
 _MDL_INLINE void MDL::AnimatedQuaternionArray::resetWithDoubleQuaternionArray(const simd_quatd* valuesArray, NS::UInteger valuesCount,
                                                                               const NS::TimeInterval* timesArray, NS::UInteger timesCount)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithDoubleQuaternionArray_count_atTime_count_), valuesArray, valuesCount, timesArray, timesCount);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithDoubleQuaternionArray_count_atTimes_count_), valuesArray, valuesCount, timesArray, timesCount);
+    Private::CompressedCurveStore::shared().remove(this);
 }
 
 
 _MDL_INLINE NS::UInteger MDL::AnimatedQuaternionArray::getFloatQuaternionArray(const simd_quatf* array, NS::UInteger maxCount)
 {
-    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getFloatQuaternionArray_count_), array, maxCount);
+    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getFloatQuaternionArray_maxCount_), array, maxCount);
 }
 
 // method: getDoubleQuaternionArray:maxCount:
 _MDL_INLINE NS::UInteger MDL::AnimatedQuaternionArray::getDoubleQuaternionArray(const simd_quatd* array, NS::UInteger maxCount)
 {
-    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getDoubleQuaternionArray_count_), array, maxCount);
+    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getDoubleQuaternionArray_maxCount_), array, maxCount);
 }
 
 // MARK: Class AnimatedScalar
@@ -648,13 +811,25 @@ _MDL_INLINE MDL::AnimatedScalar* MDL::AnimatedScalar::init()
 // method: setFloat:atTime:
 _MDL_INLINE void MDL::AnimatedScalar::setFloat(float value, NS::TimeInterval time)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setFloat_atTime_), value, time);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setFloat_atTime_), value, time);
+    Private::KeyframeStore::shared().edit(this, [&](Private::KeyframeCurve& curve)
+    {
+        const float key[1] = { value };
+        curve.insert(time, key);
+    });
+    Private::animatedValueEdited(this);
 }
 
 // method: setDouble:atTime:
 _MDL_INLINE void MDL::AnimatedScalar::setDouble(double value, NS::TimeInterval time)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setDouble_atTime_), value, time);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setDouble_atTime_), value, time);
+    Private::KeyframeStore::shared().edit(this, [&](Private::KeyframeCurve& curve)
+    {
+        const float key[1] = { float(value) };
+        curve.insert(time, key);
+    });
+    Private::animatedValueEdited(this);
 }
 
 // method: floatAtTime:
@@ -672,13 +847,17 @@ _MDL_INLINE double MDL::AnimatedScalar::doubleAtTime(NS::TimeInterval time)
 // method: resetWithFloatArray:atTimes:count:
 _MDL_INLINE void MDL::AnimatedScalar::resetWithFloatArray(const float* valuesArray, const NS::TimeInterval* timesArray, NS::UInteger count)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithFloatArray_atTime_count_), valuesArray, timesArray, count);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithFloatArray_atTime_count_), valuesArray, timesArray, count);
+    Private::KeyframeStore::shared().remove(this);
+    Private::animatedValueEdited(this);
 }
 
 // method: resetWithDoubleArray:atTimes:count:
 _MDL_INLINE void MDL::AnimatedScalar::resetWithDoubleArray(const double* valuesArray, const NS::TimeInterval* timesArray, NS::UInteger count)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithDoubleArray_atTime_count_), valuesArray, timesArray, count);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithDoubleArray_atTime_count_), valuesArray, timesArray, count);
+    Private::KeyframeStore::shared().remove(this);
+    Private::animatedValueEdited(this);
 }
 
 // MARK: Class AnimatedVector2
@@ -748,13 +927,25 @@ _MDL_INLINE MDL::AnimatedVector3* MDL::AnimatedVector3::init()
 // method: setFloat3:atTime:
 _MDL_INLINE void MDL::AnimatedVector3::setFloat3(vector_float3 value, NS::TimeInterval time)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setFloat3_atTime_), value, time);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setFloat3_atTime_), value, time);
+    Private::KeyframeStore::shared().edit(this, [&](Private::KeyframeCurve& curve)
+    {
+        const float key[4] = { value.x, value.y, value.z, 0.0f };
+        curve.insert(time, key);
+    });
+    Private::animatedValueEdited(this);
 }
 
 // method: setDouble3:atTime:
 _MDL_INLINE void MDL::AnimatedVector3::setDouble3(vector_double3 value, NS::TimeInterval time)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setDouble3_atTime_), value, time);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setDouble3_atTime_), value, time);
+    Private::KeyframeStore::shared().edit(this, [&](Private::KeyframeCurve& curve)
+    {
+        const float key[4] = { float(value.x), float(value.y), float(value.z), 0.0f };
+        curve.insert(time, key);
+    });
+    Private::animatedValueEdited(this);
 }
 
 // method: float3AtTime:
@@ -772,13 +963,17 @@ _MDL_INLINE vector_double3 MDL::AnimatedVector3::double3AtTime(NS::TimeInterval
 // method: resetWithFloat3Array:atTimes:count:
 _MDL_INLINE void MDL::AnimatedVector3::resetWithFloat3Array(const vector_float3* valuesArray, const NS::TimeInterval* timesArray, NS::UInteger count)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithFloat3Array_atTime_count_), valuesArray, timesArray, count);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithFloat3Array_atTime_count_), valuesArray, timesArray, count);
+    Private::KeyframeStore::shared().remove(this);
+    Private::animatedValueEdited(this);
 }
 
 // method: resetWithDouble3Array:atTimes:count:
 _MDL_INLINE void MDL::AnimatedVector3::resetWithDouble3Array(const vector_double3* valuesArray, const NS::TimeInterval* timesArray, NS::UInteger count)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithDouble3Array_atTime_count_), valuesArray, timesArray, count);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithDouble3Array_atTime_count_), valuesArray, timesArray, count);
+    Private::KeyframeStore::shared().remove(this);
+    Private::animatedValueEdited(this);
 }
 
 // MARK: Class AnimatedVector4
@@ -848,13 +1043,25 @@ _MDL_INLINE MDL::AnimatedQuaternion* MDL::AnimatedQuaternion::init()
 // method: setFloatQuaternion:atTime:
 _MDL_INLINE void MDL::AnimatedQuaternion::setFloatQuaternion(simd_quatf value, NS::TimeInterval time)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setFloatQuaternion_atTime_), value, time);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setFloatQuaternion_atTime_), value, time);
+    Private::KeyframeStore::shared().edit(this, [&](Private::KeyframeCurve& curve)
+    {
+        const float key[4] = { value.vector.x, value.vector.y, value.vector.z, value.vector.w };
+        curve.insert(time, key);
+    });
+    Private::animatedValueEdited(this);
 }
 
 // method: setDoubleQuaternion:atTime:
 _MDL_INLINE void MDL::AnimatedQuaternion::setDoubleQuaternion(simd_quatd value, NS::TimeInterval time)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setDoubleQuaternion_atTime_), value, time);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setDoubleQuaternion_atTime_), value, time);
+    Private::KeyframeStore::shared().edit(this, [&](Private::KeyframeCurve& curve)
+    {
+        const float key[4] = { float(value.vector.x), float(value.vector.y), float(value.vector.z), float(value.vector.w) };
+        curve.insert(time, key);
+    });
+    Private::animatedValueEdited(this);
 }
 
 // method: floatQuaternionAtTime:
@@ -872,13 +1079,17 @@ _MDL_INLINE simd_quatd MDL::AnimatedQuaternion::doubleQuaternionAtTime(NS::TimeI
 // method: resetWithFloatQuaternionArray:atTimes:count:
 _MDL_INLINE void MDL::AnimatedQuaternion::resetWithFloatQuaternionArray(const simd_quatf* valuesArray, const NS::TimeInterval* timesArray, NS::UInteger count)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithFloatQuaternionArray_atTime_count_), valuesArray, timesArray, count);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithFloatQuaternionArray_atTime_count_), valuesArray, timesArray, count);
+    Private::KeyframeStore::shared().remove(this);
+    Private::animatedValueEdited(this);
 }
 
 // method: resetWithDoubleQuaternionArray:atTimes:count:
 _MDL_INLINE void MDL::AnimatedQuaternion::resetWithDoubleQuaternionArray(const simd_quatd* valuesArray, const NS::TimeInterval* timesArray, NS::UInteger count)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithDoubleQuaternionArray_atTime_count_), valuesArray, timesArray, count);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithDoubleQuaternionArray_atTime_count_), valuesArray, timesArray, count);
+    Private::KeyframeStore::shared().remove(this);
+    Private::animatedValueEdited(this);
 }
 
 // MARK: Class AnimatedMatrix4x4
@@ -898,13 +1109,21 @@ _MDL_INLINE MDL::AnimatedMatrix4x4* MDL::AnimatedMatrix4x4::init()
 // method: setFloat4x4:atTime:
 _MDL_INLINE void MDL::AnimatedMatrix4x4::setFloat4x4(matrix_float4x4 value, NS::TimeInterval time)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setFloat4x4_atTime_), value, time);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setFloat4x4_atTime_), value, time);
+    Private::KeyframeStore::shared().edit(this, [&](Private::KeyframeCurve& curve)
+    {
+        const float* key = reinterpret_cast<const float*>(&value.columns[0]);
+        curve.insert(time, key);
+    });
+    Private::animatedValueEdited(this);
 }
 
 // method: setDouble4x4:atTime:
 _MDL_INLINE void MDL::AnimatedMatrix4x4::setDouble4x4(matrix_double4x4 value, NS::TimeInterval time)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setDouble4x4_atTime_), value, time);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setDouble4x4_atTime_), value, time);
+    Private::KeyframeStore::shared().remove(this);
+    Private::animatedValueEdited(this);
 }
 
 // method: float4x4AtTime:
@@ -922,13 +1141,392 @@ _MDL_INLINE matrix_double4x4 MDL::AnimatedMatrix4x4::double4x4AtTime(NS::TimeInt
 // method: resetWithFloat4x4Array:atTimes:count:
 _MDL_INLINE void MDL::AnimatedMatrix4x4::resetWithFloat4x4Array(const matrix_float4x4* valuesArray, const NS::TimeInterval* timesArray, NS::UInteger count)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithFloat4x4Array_atTime_count_), valuesArray, timesArray, count);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithFloat4x4Array_atTime_count_), valuesArray, timesArray, count);
+    Private::KeyframeStore::shared().remove(this);
+    Private::animatedValueEdited(this);
 }
 
 // method: resetWithDouble4x4Array:atTimes:count:
 _MDL_INLINE void MDL::AnimatedMatrix4x4::resetWithDouble4x4Array(const matrix_double4x4* valuesArray, const NS::TimeInterval* timesArray, NS::UInteger count)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithDouble4x4Array_atTime_count_), valuesArray, timesArray, count);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(resetWithDouble4x4Array_atTime_count_), valuesArray, timesArray, count);
+    Private::KeyframeStore::shared().remove(this);
+    Private::animatedValueEdited(this);
+}
+
+// MARK: - Native
+
+// native: keyframeCurve
+_MDL_INLINE std::shared_ptr<const MDL::Private::KeyframeCurve> MDL::AnimatedValue::keyframeCurve()
+{
+    const Private::KeyframeLayout layout = Private::keyframeLayout(object_getClass(reinterpret_cast<id>(this)));
+    if (!layout.stride)
+    {
+        return nullptr;
+    }
+    
+    Private::KeyframeStore& store = Private::KeyframeStore::shared();
+    if (auto curve = store.find(this))
+    {
+        return curve;
+    }
+    
+    Private::KeyframeCurve::Interpolation interpolation = Private::KeyframeCurve::InterpolationConstant;
+    if (Object::sendMessage<AnimatedValueInterpolation>(this, _MDL_PRIVATE_SEL(interpolation)) == AnimatedValueInterpolationLinear)
+    {
+        interpolation = layout.spherical ? Private::KeyframeCurve::InterpolationSpherical : Private::KeyframeCurve::InterpolationLinear;
+    }
+    
+    // Filled before it is shared, so readers never see a partial import
+    const NS::UInteger     keyCount = Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(timeSampleCount));
+    Private::KeyframeCurve curve;
+    curve.reset(keyCount, layout.stride, interpolation);
+    if (keyCount)
+    {
+        Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getTimes_maxCount_), curve.times(), keyCount);
+        Object::sendMessage<NS::UInteger>(this, layout.getValues, curve.values(), keyCount);
+    }
+    return store.insert(this, std::move(curve));
+}
+
+// native: keyTimeSpan
+_MDL_INLINE MDL::KeyTimeSpan MDL::AnimatedValue::keyTimeSpan()
+{
+    KeyTimeSpan span;
+    if (const auto curve = keyframeCurve())
+    {
+        span.data = curve->times();
+        span.count = curve->keyCount();
+        span.keys = curve;
+    }
+    return span;
+}
+
+// native: invalidateKeyframes
+_MDL_INLINE void MDL::AnimatedValue::invalidateKeyframes()
+{
+    Private::KeyframeStore::shared().remove(this);
+    Private::animatedValueEdited(this);
+}
+
+// native: floatsAtTimes
+_MDL_INLINE void MDL::AnimatedScalar::floatsAtTimes(const NS::TimeInterval* times, NS::UInteger count, float* values)
+{
+    const auto curve = reinterpret_cast<AnimatedValue*>(this)->keyframeCurve();
+    if (!curve || !curve->keyCount())
+    {
+        for (NS::UInteger i = 0; i < count; ++i)
+        {
+            values[i] = floatAtTime(times[i]);
+        }
+        return;
+    }
+    curve->sample(times, count, values);
+}
+
+// native: floatsAtTimes
+_MDL_INLINE void MDL::AnimatedScalar::floatsAtTimes(NS::TimeInterval start, NS::TimeInterval frameInterval,
+                                                    NS::UInteger count, float* values)
+{
+    const auto curve = reinterpret_cast<AnimatedValue*>(this)->keyframeCurve();
+    if (!curve || !curve->keyCount())
+    {
+        for (NS::UInteger i = 0; i < count; ++i)
+        {
+            values[i] = floatAtTime(start + double(i) * frameInterval);
+        }
+        return;
+    }
+    curve->sample(start, frameInterval, count, values);
+}
+
+// native: floatAtTime:cursor:
+_MDL_INLINE float MDL::AnimatedScalar::floatAtTime(NS::TimeInterval time, KeyframeCursor& cursor)
+{
+    const Private::KeyframeCurve* curve = Private::KeyframeStore::shared().find(this, cursor);
+    if (!curve || !curve->keyCount())
+    {
+        if (!curve)
+        {
+            // Imported for the next call
+            reinterpret_cast<AnimatedValue*>(this)->keyframeCurve();
+        }
+        return floatAtTime(time);
+    }
+    
+    float value;
+    curve->sample(time, cursor.key, reinterpret_cast<float*>(&value));
+    return value;
+}
+
+// native: float3sAtTimes
+_MDL_INLINE void MDL::AnimatedVector3::float3sAtTimes(const NS::TimeInterval* times, NS::UInteger count, vector_float3* values)
+{
+    const auto curve = reinterpret_cast<AnimatedValue*>(this)->keyframeCurve();
+    if (!curve || !curve->keyCount())
+    {
+        for (NS::UInteger i = 0; i < count; ++i)
+        {
+            values[i] = float3AtTime(times[i]);
+        }
+        return;
+    }
+    curve->sample(times, count, reinterpret_cast<float*>(values));
+}
+
+// native: float3sAtTimes
+_MDL_INLINE void MDL::AnimatedVector3::float3sAtTimes(NS::TimeInterval start, NS::TimeInterval frameInterval,
+                                                      NS::UInteger count, vector_float3* values)
+{
+    const auto curve = reinterpret_cast<AnimatedValue*>(this)->keyframeCurve();
+    if (!curve || !curve->keyCount())
+    {
+        for (NS::UInteger i = 0; i < count; ++i)
+        {
+            values[i] = float3AtTime(start + double(i) * frameInterval);
+        }
+        return;
+    }
+    curve->sample(start, frameInterval, count, reinterpret_cast<float*>(values));
+}
+
+// native: float3AtTime:cursor:
+_MDL_INLINE vector_float3 MDL::AnimatedVector3::float3AtTime(NS::TimeInterval time, KeyframeCursor& cursor)
+{
+    const Private::KeyframeCurve* curve = Private::KeyframeStore::shared().find(this, cursor);
+    if (!curve || !curve->keyCount())
+    {
+        if (!curve)
+        {
+            // Imported for the next call
+            reinterpret_cast<AnimatedValue*>(this)->keyframeCurve();
+        }
+        return float3AtTime(time);
+    }
+    
+    vector_float3 value;
+    curve->sample(time, cursor.key, reinterpret_cast<float*>(&value));
+    return value;
+}
+
+// native: floatQuaternionsAtTimes
+_MDL_INLINE void MDL::AnimatedQuaternion::floatQuaternionsAtTimes(const NS::TimeInterval* times, NS::UInteger count, simd_quatf* values)
+{
+    const auto curve = reinterpret_cast<AnimatedValue*>(this)->keyframeCurve();
+    if (!curve || !curve->keyCount())
+    {
+        for (NS::UInteger i = 0; i < count; ++i)
+        {
+            values[i] = floatQuaternionAtTime(times[i]);
+        }
+        return;
+    }
+    curve->sample(times, count, reinterpret_cast<float*>(values));
+}
+
+// native: floatQuaternionsAtTimes
+_MDL_INLINE void MDL::AnimatedQuaternion::floatQuaternionsAtTimes(NS::TimeInterval start, NS::TimeInterval frameInterval,
+                                                                  NS::UInteger count, simd_quatf* values)
+{
+    const auto curve = reinterpret_cast<AnimatedValue*>(this)->keyframeCurve();
+    if (!curve || !curve->keyCount())
+    {
+        for (NS::UInteger i = 0; i < count; ++i)
+        {
+            values[i] = floatQuaternionAtTime(start + double(i) * frameInterval);
+        }
+        return;
+    }
+    curve->sample(start, frameInterval, count, reinterpret_cast<float*>(values));
+}
+
+// native: floatQuaternionAtTime:cursor:
+_MDL_INLINE simd_quatf MDL::AnimatedQuaternion::floatQuaternionAtTime(NS::TimeInterval time, KeyframeCursor& cursor)
+{
+    const Private::KeyframeCurve* curve = Private::KeyframeStore::shared().find(this, cursor);
+    if (!curve || !curve->keyCount())
+    {
+        if (!curve)
+        {
+            // Imported for the next call
+            reinterpret_cast<AnimatedValue*>(this)->keyframeCurve();
+        }
+        return floatQuaternionAtTime(time);
+    }
+    
+    simd_quatf value;
+    curve->sample(time, cursor.key, reinterpret_cast<float*>(&value));
+    return value;
+}
+
+// native: float4x4sAtTimes
+_MDL_INLINE void MDL::AnimatedMatrix4x4::float4x4sAtTimes(const NS::TimeInterval* times, NS::UInteger count, matrix_float4x4* values)
+{
+    const auto curve = reinterpret_cast<AnimatedValue*>(this)->keyframeCurve();
+    if (!curve || !curve->keyCount())
+    {
+        for (NS::UInteger i = 0; i < count; ++i)
+        {
+            values[i] = float4x4AtTime(times[i]);
+        }
+        return;
+    }
+    curve->sample(times, count, reinterpret_cast<float*>(values));
+}
+
+// native: float4x4sAtTimes
+_MDL_INLINE void MDL::AnimatedMatrix4x4::float4x4sAtTimes(NS::TimeInterval start, NS::TimeInterval frameInterval,
+                                                          NS::UInteger count, matrix_float4x4* values)
+{
+    const auto curve = reinterpret_cast<AnimatedValue*>(this)->keyframeCurve();
+    if (!curve || !curve->keyCount())
+    {
+        for (NS::UInteger i = 0; i < count; ++i)
+        {
+            values[i] = float4x4AtTime(start + double(i) * frameInterval);
+        }
+        return;
+    }
+    curve->sample(start, frameInterval, count, reinterpret_cast<float*>(values));
+}
+
+// native: float4x4AtTime:cursor:
+_MDL_INLINE matrix_float4x4 MDL::AnimatedMatrix4x4::float4x4AtTime(NS::TimeInterval time, KeyframeCursor& cursor)
+{
+    const Private::KeyframeCurve* curve = Private::KeyframeStore::shared().find(this, cursor);
+    if (!curve || !curve->keyCount())
+    {
+        if (!curve)
+        {
+            // Imported for the next call
+            reinterpret_cast<AnimatedValue*>(this)->keyframeCurve();
+        }
+        return float4x4AtTime(time);
+    }
+    
+    matrix_float4x4 value;
+    curve->sample(time, cursor.key, reinterpret_cast<float*>(&value));
+    return value;
+}
+
+// native: compress
+_MDL_INLINE std::shared_ptr<const MDL::CompressedCurve> MDL::AnimatedScalarArray::compress(const CurveCompressionSettings& settings)
+{
+    const NS::UInteger elementCount = this->elementCount();
+    const NS::UInteger keyCount = Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(timeSampleCount));
+    const bool         linear = Object::sendMessage<AnimatedValueInterpolation>(this, _MDL_PRIVATE_SEL(interpolation)) == AnimatedValueInterpolationLinear;
+    
+    std::vector<NS::TimeInterval> times(keyCount);
+    std::vector<float>            values(keyCount * elementCount);
+    Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getTimes_maxCount_), times.data(), keyCount);
+    Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getFloatArray_maxCount_), values.data(), values.size());
+    
+    std::shared_ptr<const CompressedCurve> curve = CompressedCurve::compress(CompressedCurve::KindScalar, values.data(),
+                                                                             1, elementCount, times.data(), keyCount, linear, settings);
+    Private::CompressedCurveStore::shared().insert(this, curve);
+    return curve;
+}
+
+// native: compressedCurve
+_MDL_INLINE std::shared_ptr<const MDL::CompressedCurve> MDL::AnimatedScalarArray::compressedCurve() const
+{
+    return Private::CompressedCurveStore::shared().find(this);
+}
+
+// native: compress
+_MDL_INLINE std::shared_ptr<const MDL::CompressedCurve> MDL::AnimatedVector3Array::compress(const CurveCompressionSettings& settings)
+{
+    const NS::UInteger elementCount = this->elementCount();
+    const NS::UInteger keyCount = Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(timeSampleCount));
+    const bool         linear = Object::sendMessage<AnimatedValueInterpolation>(this, _MDL_PRIVATE_SEL(interpolation)) == AnimatedValueInterpolationLinear;
+    
+    std::vector<NS::TimeInterval> times(keyCount);
+    std::vector<vector_float3>    values(keyCount * elementCount);
+    Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getTimes_maxCount_), times.data(), keyCount);
+    Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getFloat3Array_maxCount_), values.data(), values.size());
+    
+    std::shared_ptr<const CompressedCurve> curve = CompressedCurve::compress(CompressedCurve::KindVector3, reinterpret_cast<const float*>(values.data()),
+                                                                             4, elementCount, times.data(), keyCount, linear, settings);
+    Private::CompressedCurveStore::shared().insert(this, curve);
+    return curve;
+}
+
+// native: compressedCurve
+_MDL_INLINE std::shared_ptr<const MDL::CompressedCurve> MDL::AnimatedVector3Array::compressedCurve() const
+{
+    return Private::CompressedCurveStore::shared().find(this);
+}
+
+// native: compress
+_MDL_INLINE std::shared_ptr<const MDL::CompressedCurve> MDL::AnimatedQuaternionArray::compress(const CurveCompressionSettings& settings)
+{
+    const NS::UInteger elementCount = this->elementCount();
+    const NS::UInteger keyCount = Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(timeSampleCount));
+    const bool         linear = Object::sendMessage<AnimatedValueInterpolation>(this, _MDL_PRIVATE_SEL(interpolation)) == AnimatedValueInterpolationLinear;
+    
+    std::vector<NS::TimeInterval> times(keyCount);
+    std::vector<simd_quatf>       values(keyCount * elementCount);
+    Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getTimes_maxCount_), times.data(), keyCount);
+    Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getFloatQuaternionArray_maxCount_), values.data(), values.size());
+    
+    std::shared_ptr<const CompressedCurve> curve = CompressedCurve::compress(CompressedCurve::KindQuaternion, reinterpret_cast<const float*>(values.data()),
+                                                                             4, elementCount, times.data(), keyCount, linear, settings);
+    Private::CompressedCurveStore::shared().insert(this, curve);
+    return curve;
+}
+
+// native: compressedCurve
+_MDL_INLINE std::shared_ptr<const MDL::CompressedCurve> MDL::AnimatedQuaternionArray::compressedCurve() const
+{
+    return Private::CompressedCurveStore::shared().find(this);
+}
+
+// native: animatedValueEdited
+_MDL_INLINE void MDL::Private::animatedValueEdited(const void* value)
+{
+    TransformProgramCache& cache = TransformProgramCache::shared();
+    for (const void* stack : cache.owners(value))
+    {
+        cache.invalidate(stack);
+        BoundsCache::shared().markDirty(stack);
+        syncSceneTransform(SceneGraph::shared().findTransform(stack), static_cast<const TransformComponent*>(stack));
+    }
+    cache.touch();
+}
+
+_MDL_INLINE MDL::Private::KeyframeLayout MDL::Private::keyframeLayout(::Class cls)
+{
+    // Classes outlive every instance, so they can key the table for good
+    thread_local std::unordered_map<const void*, KeyframeLayout> layouts;
+    
+    auto it = layouts.find(cls);
+    if (it != layouts.end())
+    {
+        return it->second;
+    }
+    
+    KeyframeLayout layout = { 0, nullptr, false };
+    for (::Class c = cls; c && !layout.stride; c = class_getSuperclass(c))
+    {
+        if (c == _MDL_PRIVATE_CLS(MDLAnimatedScalar))
+        {
+            layout = { 1, _MDL_PRIVATE_SEL(getFloatArray_maxCount_), false };
+        }
+        else if (c == _MDL_PRIVATE_CLS(MDLAnimatedVector3))
+        {
+            layout = { 4, _MDL_PRIVATE_SEL(getFloat3Array_maxCount_), false };
+        }
+        else if (c == _MDL_PRIVATE_CLS(MDLAnimatedQuaternion))
+        {
+            layout = { 4, _MDL_PRIVATE_SEL(getFloatQuaternionArray_maxCount_), true };
+        }
+        else if (c == _MDL_PRIVATE_CLS(MDLAnimatedMatrix4x4))
+        {
+            layout = { 16, _MDL_PRIVATE_SEL(getFloat4x4Array_maxCount_), false };
+        }
+    }
+    layouts.emplace(cls, layout);
+    return layout;
 }
 
 // MARK: - Original Header
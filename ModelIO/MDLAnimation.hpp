@@ -10,6 +10,17 @@
 #include "MDLValueTypes.hpp"
 #include "MDLAnimatedValueTypes.hpp"
 #include "MDLObject.hpp"
+#include "MDLMesh.hpp"
+#include "MDLJointHierarchy.hpp"
+#include "MDLPoseBlending.hpp"
+#include "MDLRetargeting.hpp"
+#include "MDLSkinning.hpp"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <string>
+#include <vector>
 
 namespace MDL
 {
@@ -27,6 +38,27 @@ public:
     
     // initWithName:jointPaths:
     class Skeleton*             init(const NS::String* name, const NS::Array* jointPaths);
+    
+    // - Native
+    
+    // Joint parents as flat arrays in evaluation order, compiled from the
+    // joint paths on init, or on first use for skeletons read from an asset
+    std::shared_ptr<const Private::JointHierarchy> jointHierarchy() const;
+    
+    // Parent index of each joint, -1 for roots; returns how many were written
+    NS::UInteger                jointParentIndices(std::int32_t* parentIndices, NS::UInteger maxCount) const;
+    
+    // Model-space transforms of every joint posed by `animation` at `time`,
+    // in one forward pass over the hierarchy; joints the animation lacks
+    // keep their rest transforms. Returns how many were written.
+    NS::UInteger                pose(class PackedJointAnimation* animation, NS::TimeInterval time,
+                                     matrix_float4x4* modelTransforms, NS::UInteger maxCount) const;
+    void                        pose(class PackedJointAnimation* animation, NS::TimeInterval time,
+                                     Matrix4x4Array* modelTransforms) const;
+    
+private:
+    const float*                poseModelSpace(class PackedJointAnimation* animation, NS::TimeInterval time,
+                                               const Private::JointHierarchy& hierarchy) const;
 };
 
 // Protocol
@@ -47,6 +79,14 @@ public:
     
     // initWithName:jointPaths:
     class PackedJointAnimation*             init(const NS::String* name, const NS::Array* jointPaths);
+    
+    // - Native
+    
+    // Local translations, rotations and scales of the first `jointCount`
+    // joints at `time`, four floats per joint; channels without values leave
+    // the identity
+    void                                    jointTransforms(NS::TimeInterval time, NS::UInteger jointCount,
+                                                            float* translations, float* rotations, float* scales);
 };
 
                                 // !!!: Uncertain
@@ -69,8 +109,187 @@ public:
     
     matrix_double4x4                        geometryBindTransform() const;
     void                                    setGeometryBindTransform(matrix_double4x4 geometryBindTransform);
+    
+    // - Native
+    
+    // Skin matrices of the skeleton posed by the packed joint animation at
+    // `time`, one per joint index of the bound mesh, geometry bind included;
+    // returns how many were written
+    NS::UInteger                            jointPalette(NS::TimeInterval time, matrix_float4x4* palette, NS::UInteger maxCount);
+    
+    // Deforms the positions, and the normals if `layout` places them, of
+    // `mesh` posed at `time` into `target`, spread over the worker pool.
+    // False if the mesh lacks positions, joint indices or joint weights,
+    // nothing is bound, or `target` is too small for `layout`.
+    bool                                    skin(class Mesh* mesh, NS::TimeInterval time, SkinningMode mode,
+                                                 class MeshBuffer* target, const SkinningLayout& layout = SkinningLayout());
+    
+    // Drops the compiled joint mapping, for bindings edited outside the bridge
+    void                                    invalidateRig();
+    
+private:
+    std::shared_ptr<const Private::SkinningRig> rig();
+    // Skin matrices at `time` into the calling thread's scratch palette
+    const float*                            posePalette(const Private::SkinningRig& rig, NS::TimeInterval time, bool withGeometryBind);
+};
+
+// Moves animation authored for a source skeleton onto a target skeleton.
+// Joints are matched and the rest-pose corrections compiled once, on make;
+// each animation then compiles to a per-frame program on first use.
+// Holds both skeletons for its lifetime.
+class AnimationRetargeter
+{
+public:
+    static std::shared_ptr<AnimationRetargeter> make(Skeleton* source, Skeleton* target,
+                                                     const RetargetSettings& settings = RetargetSettings());
+    
+                                            ~AnimationRetargeter();
+    
+    NS::UInteger                            targetJointCount() const;
+    NS::UInteger                            matchedJointCount() const;
+    // Source joint index of each target joint, -1 where the target keeps its
+    // rest pose
+    const std::int32_t*                     sourceJoints() const;
+    
+    // Local translations, rotations and scales of every target joint for
+    // `animation` at `time`, four floats per joint
+    void                                    retarget(PackedJointAnimation* animation, NS::TimeInterval time,
+                                                     float* translations, float* rotations, float* scales);
+    
+    // Model-space transforms of the target posed by `animation` at `time`;
+    // returns how many were written
+    NS::UInteger                            pose(PackedJointAnimation* animation, NS::TimeInterval time,
+                                                 matrix_float4x4* modelTransforms, NS::UInteger maxCount);
+    
+    // A new animation over the target's joints, keyed at every key time of
+    // `animation`; the caller owns it
+    PackedJointAnimation*                   newRetargetedAnimation(PackedJointAnimation* animation, const NS::String* name);
+    
+                                            AnimationRetargeter(const AnimationRetargeter&) = delete;
+    AnimationRetargeter&                    operator=(const AnimationRetargeter&) = delete;
+    
+private:
+    // Only make() builds retargeters, with a map to apply
+                                            AnimationRetargeter() = default;
+    
+    struct ProgramEntry
+    {
+        // Joint paths the program was compiled from
+        const NS::Array*                    jointPaths;
+        std::shared_ptr<const Private::RetargetProgram> program;
+    };
+    
+    std::shared_ptr<const Private::RetargetProgram> program(PackedJointAnimation* animation);
+    
+    Skeleton*                               _source = nullptr;
+    Skeleton*                               _target = nullptr;
+    std::shared_ptr<const Private::JointHierarchy> _sourceHierarchy;
+    std::shared_ptr<const Private::JointHierarchy> _targetHierarchy;
+    std::shared_ptr<const Private::RetargetMap> _map;
+    // Target joints read in place, for posing retargeted transforms
+    Private::JointMap                       _targetJoints;
+    std::mutex                              _mutex;
+    // Programs by animation; each animation is retained until the
+    // retargeter goes away, so its address cannot pass to another one
+    std::unordered_map<const void*, ProgramEntry> _programs;
 };
 
+// Combines clips of one skeleton: clips sample their animations at their own
+// times, blend nodes cross-fade two inputs and additive nodes layer the
+// difference of two inputs onto a third, each under an optional per-joint
+// mask. Inputs are added before the nodes that read them. Every node owns
+// its pose buffers from the moment it is added, so evaluating allocates
+// nothing; a tree is evaluated from one thread at a time.
+class AnimationBlendTree
+{
+public:
+    using Node = NS::UInteger;
+    
+    // Returned by addBlend and addAdditive when an input is not a node
+    // added earlier; calls on it are ignored, and evaluating it writes
+    // nothing
+    static constexpr Node                   NoNode = ~Node(0);
+    
+    static std::shared_ptr<AnimationBlendTree> make(Skeleton* skeleton);
+    
+                                            ~AnimationBlendTree();
+    
+    NS::UInteger                            jointCount() const;
+    
+    // Joints `animation` lacks hold the skeleton's rest pose
+    Node                                    addClip(PackedJointAnimation* animation, NS::TimeInterval time = 0.0);
+    // `a` at weight 0, `b` at weight 1
+    Node                                    addBlend(Node a, Node b, float weight = 0.5f,
+                                                     PoseBlendRotation rotation = PoseBlendRotationNlerp);
+    // `base` plus the change from `reference` to `layer`, at full weight
+    Node                                    addAdditive(Node base, Node layer, Node reference, float weight = 1.0f);
+    
+    void                                    setTime(Node clip, NS::TimeInterval time);
+    void                                    setWeight(Node node, float weight);
+    // Scales the weight of a blend or additive node per joint; nullptr
+    // applies it to every joint
+    void                                    setMask(Node node, const float* jointWeights);
+    // `insideWeight` for the joint at `jointPath` and its descendants,
+    // `outsideWeight` for the rest
+    void                                    setMask(Node node, const NS::String* jointPath, float insideWeight = 1.0f, float outsideWeight = 0.0f);
+    
+    // Local translations, rotations and scales of every joint, four floats each
+    void                                    evaluateLocal(Node root, float* translations, float* rotations, float* scales);
+    // Model-space transforms of every joint; returns how many were written
+    NS::UInteger                            evaluate(Node root, matrix_float4x4* modelTransforms, NS::UInteger maxCount);
+    void                                    evaluate(Node root, Matrix4x4Array* modelTransforms);
+    
+                                            AnimationBlendTree(const AnimationBlendTree&) = delete;
+    AnimationBlendTree&                     operator=(const AnimationBlendTree&) = delete;
+    
+private:
+    // Only make() builds trees, with a skeleton's hierarchy
+                                            AnimationBlendTree() = default;
+    
+    enum class NodeKind
+    {
+        Clip,
+        Blend,
+        Additive,
+    };
+    
+    struct NodeState
+    {
+        NodeKind                            kind;
+        PackedJointAnimation*               animation = nullptr;
+        std::shared_ptr<const Private::JointMap> joints;
+        NS::TimeInterval                    time = 0.0;
+        Node                                inputs[3] = {};
+        float                               weight = 1.0f;
+        PoseBlendRotation                   rotation = PoseBlendRotationNlerp;
+        Private::AlignedVector<float>       mask;
+        // Translations, rotations and scales, four floats per joint each
+        Private::AlignedVector<float>       pose;
+    };
+    
+    Node                                    addNode(NodeState node);
+    // nullptr when `root` is not a node
+    const float*                            evaluatePose(Node root);
+    Private::PoseBlending::Pose             pose(Node node);
+    
+    std::shared_ptr<const Private::JointHierarchy> _hierarchy;
+    std::vector<NodeState>                  _nodes;
+    std::vector<char>                       _reachable;
+    Private::AlignedVector<float>           _rest;
+    Private::AlignedVector<float>           _sample;
+    Private::AlignedVector<float>           _local;
+    Private::AlignedVector<float>           _model;
+    // Joints read in place, for posing the blended transforms
+    Private::JointMap                       _joints;
+};
+
+namespace Private
+{
+    std::vector<std::string>                jointPathStrings(const NS::Array* jointPaths);
+    // Rest transforms of every joint, the identity past those the skeleton has
+    void                                    restTransforms(Matrix4x4Array* transforms, NS::UInteger jointCount, float* out);
+}
+
 }
 
 // MARK: - Private Sector
@@ -102,7 +321,15 @@ _MDL_INLINE MDL::Matrix4x4Array* MDL::Skeleton::jointRestTransforms() const
 // method: initWithName:jointPaths:
 _MDL_INLINE MDL::Skeleton* MDL::Skeleton::init(const NS::String* name, const NS::Array* jointPaths)
 {
-    return Object::sendMessage<MDL::Skeleton*>(this, _MDL_PRIVATE_SEL(initWithName_jointPaths_), name, jointPaths);
+    Private::JointHierarchyStore::shared().remove(this);
+    Skeleton* skeleton = Object::sendMessage<MDL::Skeleton*>(this, _MDL_PRIVATE_SEL(initWithName_jointPaths_), name, jointPaths);
+    if (skeleton)
+    {
+        // Recorded against the array the skeleton keeps, which lookups see
+        Private::JointHierarchyStore::shared().insert(skeleton, skeleton->jointPaths(),
+                                                      Private::JointHierarchy::build(Private::jointPathStrings(jointPaths)));
+    }
+    return skeleton;
 }
 
 // MARK: Class PackedJointAnimation
@@ -140,6 +367,7 @@ _MDL_INLINE MDL::AnimatedVector3Array* MDL::PackedJointAnimation::scales() const
 // method: initWithName:jointPaths:
 _MDL_INLINE MDL::PackedJointAnimation* MDL::PackedJointAnimation::init(const NS::String* name, const NS::Array* jointPaths)
 {
+    Private::JointHierarchyStore::shared().remove(this);
     return Object::sendMessage<MDL::PackedJointAnimation*>(this, _MDL_PRIVATE_SEL(initWithName_jointPaths_), name, jointPaths);
 }
 
@@ -164,7 +392,8 @@ _MDL_INLINE MDL::Skeleton* MDL::AnimationBindComponent::skeleton() const
 // write method: setSkeleton:
 _MDL_INLINE void MDL::AnimationBindComponent::setSkeleton(const Skeleton* skeleton)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setSkeleton_), skeleton);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setSkeleton_), skeleton);
+    Private::SkinningRigCache::shared().remove(this);
 }
 
 // property: jointAnimation
@@ -175,7 +404,8 @@ _MDL_INLINE MDL::JointAnimation* MDL::AnimationBindComponent::jointAnimation() c
 // write method: setJointAnimation:
 _MDL_INLINE void MDL::AnimationBindComponent::setJointAnimation(const JointAnimation* jointAnimation)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setJointAnimation_), jointAnimation);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setJointAnimation_), jointAnimation);
+    Private::SkinningRigCache::shared().remove(this);
 }
 
 // property: jointPaths
@@ -186,7 +416,8 @@ _MDL_INLINE NS::Array* MDL::AnimationBindComponent::jointPaths() const
 // write method: setJointPaths:
 _MDL_INLINE void MDL::AnimationBindComponent::setJointPaths(const NS::Array* jointPaths)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setJointPaths_), jointPaths);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setJointPaths_), jointPaths);
+    Private::SkinningRigCache::shared().remove(this);
 }
 
 // property: geometryBindTransform
@@ -197,9 +428,773 @@ _MDL_INLINE matrix_double4x4 MDL::AnimationBindComponent::geometryBindTransform(
 // write method: setGeometryBindTransform:
 _MDL_INLINE void MDL::AnimationBindComponent::setGeometryBindTransform(matrix_double4x4 geometryBindTransform)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setGeometryBindTransform_), geometryBindTransform);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setGeometryBindTransform_), geometryBindTransform);
+    Private::SkinningRigCache::shared().remove(this);
+}
+
+// MARK: - Native Skeleton
+
+// native: jointHierarchy
+_MDL_INLINE std::shared_ptr<const MDL::Private::JointHierarchy> MDL::Skeleton::jointHierarchy() const
+{
+    const NS::Array* jointPaths = this->jointPaths();
+    if (std::shared_ptr<const Private::JointHierarchy> hierarchy = Private::JointHierarchyStore::shared().find(this, jointPaths))
+    {
+        return hierarchy;
+    }
+    std::shared_ptr<const Private::JointHierarchy> hierarchy = Private::JointHierarchy::build(Private::jointPathStrings(jointPaths));
+    Private::JointHierarchyStore::shared().insert(this, jointPaths, hierarchy);
+    return hierarchy;
+}
+
+// native: jointParentIndices
+_MDL_INLINE NS::UInteger MDL::Skeleton::jointParentIndices(std::int32_t* parentIndices, NS::UInteger maxCount) const
+{
+    std::shared_ptr<const Private::JointHierarchy> hierarchy = jointHierarchy();
+    const NS::UInteger                             count = std::min(maxCount, hierarchy->jointCount());
+    std::copy(hierarchy->parents(), hierarchy->parents() + count, parentIndices);
+    return count;
+}
+
+// native: pose
+_MDL_INLINE NS::UInteger MDL::Skeleton::pose(PackedJointAnimation* animation, NS::TimeInterval time,
+                                             matrix_float4x4* modelTransforms, NS::UInteger maxCount) const
+{
+    std::shared_ptr<const Private::JointHierarchy> hierarchy = jointHierarchy();
+    const NS::UInteger                             count = std::min(maxCount, hierarchy->jointCount());
+    const float*                                   model = poseModelSpace(animation, time, *hierarchy);
+    std::copy(model, model + count * 16, reinterpret_cast<float*>(modelTransforms));
+    return count;
+}
+
+// native: pose
+_MDL_INLINE void MDL::Skeleton::pose(PackedJointAnimation* animation, NS::TimeInterval time, Matrix4x4Array* modelTransforms) const
+{
+    std::shared_ptr<const Private::JointHierarchy> hierarchy = jointHierarchy();
+    const float*                                   model = poseModelSpace(animation, time, *hierarchy);
+    modelTransforms->setFloat4x4Array(reinterpret_cast<const matrix_float4x4*>(model), hierarchy->jointCount());
+}
+
+// native: poseModelSpace
+_MDL_INLINE const float* MDL::Skeleton::poseModelSpace(PackedJointAnimation* animation, NS::TimeInterval time,
+                                                       const Private::JointHierarchy& hierarchy) const
+{
+    const NS::Array*                         animationJointPaths = animation ? animation->jointPaths() : nullptr;
+    std::shared_ptr<const Private::JointMap> map = Private::JointHierarchyStore::shared().findJointMap(this, animation, animationJointPaths);
+    // Also rebuilt when the caller's hierarchy is not the one the map was built for
+    if (!map || map->sources.size() != hierarchy.jointCount())
+    {
+        map = std::make_shared<const Private::JointMap>(hierarchy.mapJoints(Private::jointPathStrings(animationJointPaths)));
+        Private::JointHierarchyStore::shared().insertJointMap(this, animation, animationJointPaths, map);
+    }
+    
+    Private::PoseScratch& scratch = Private::PoseScratch::local();
+    const NS::UInteger    jointCount = hierarchy.jointCount();
+    scratch.translations.resize(map->sourceCount * 4);
+    scratch.rotations.resize(map->sourceCount * 4);
+    scratch.scales.resize(map->sourceCount * 4);
+    if (map->sourceCount)
+    {
+        animation->jointTransforms(time, map->sourceCount, scratch.translations.data(), scratch.rotations.data(), scratch.scales.data());
+    }
+    
+    // Rest transforms are only read for joints the animation leaves out
+    const float* restTransforms = nullptr;
+    if (!map->complete)
+    {
+        scratch.restTransforms.resize(jointCount * 16);
+        Private::restTransforms(jointRestTransforms(), jointCount, scratch.restTransforms.data());
+        restTransforms = scratch.restTransforms.data();
+    }
+    
+    scratch.model.resize(jointCount * 16);
+    hierarchy.pose(scratch.translations.data(), scratch.rotations.data(), scratch.scales.data(), *map, restTransforms, scratch.model.data());
+    return scratch.model.data();
+}
+
+// MARK: - Native PackedJointAnimation
+
+// native: jointTransforms
+_MDL_INLINE void MDL::PackedJointAnimation::jointTransforms(NS::TimeInterval time, NS::UInteger jointCount,
+                                                            float* translations, float* rotations, float* scales)
+{
+    for (NS::UInteger i = 0; i < jointCount * 4; ++i)
+    {
+        translations[i] = 0.0f;
+        rotations[i] = float(i % 4 == 3);
+        scales[i] = 1.0f;
+    }
+    if (AnimatedVector3Array* values = this->translations())
+    {
+        values->getFloat3Array(reinterpret_cast<vector_float3*>(translations), jointCount, time);
+    }
+    if (AnimatedQuaternionArray* values = this->rotations())
+    {
+        values->getFloatQuaternionArray(reinterpret_cast<simd_quatf*>(rotations), jointCount, time);
+    }
+    if (AnimatedVector3Array* values = this->scales())
+    {
+        values->getFloat3Array(reinterpret_cast<vector_float3*>(scales), jointCount, time);
+    }
+}
+
+// MARK: - Native AnimationBindComponent
+
+// native: jointPalette
+_MDL_INLINE NS::UInteger MDL::AnimationBindComponent::jointPalette(NS::TimeInterval time, matrix_float4x4* palette, NS::UInteger maxCount)
+{
+    std::shared_ptr<const Private::SkinningRig> rig = this->rig();
+    if (!rig)
+    {
+        return 0;
+    }
+    const NS::UInteger count = std::min(maxCount, rig->paletteCount());
+    const float*       matrices = posePalette(*rig, time, true);
+    std::copy(matrices, matrices + count * 16, reinterpret_cast<float*>(palette));
+    return count;
+}
+
+// native: skin
+_MDL_INLINE bool MDL::AnimationBindComponent::skin(Mesh* mesh, NS::TimeInterval time, SkinningMode mode,
+                                                   MeshBuffer* target, const SkinningLayout& layout)
+{
+    std::shared_ptr<const Private::SkinningRig> rig = this->rig();
+    if (!rig || !mesh || !target)
+    {
+        return false;
+    }
+    
+    VertexAttributeData* positions = mesh->vertexAttributeDataForAttributeNamed(VertexAttributePosition, VertexFormatFloat3);
+    VertexAttributeData* joints = mesh->vertexAttributeDataForAttributeNamed(VertexAttributeJointIndices, VertexFormatUShort4);
+    VertexAttributeData* weights = mesh->vertexAttributeDataForAttributeNamed(VertexAttributeJointWeights, VertexFormatFloat4);
+    if (!positions || !joints || !weights)
+    {
+        return false;
+    }
+    const bool           writeNormals = layout.normalOffset != SkinningLayout::NotWritten;
+    VertexAttributeData* normals = writeNormals ? mesh->vertexAttributeDataForAttributeNamed(VertexAttributeNormal, VertexFormatFloat3) : nullptr;
+    
+    const NS::UInteger vertexCount = mesh->vertexCount();
+    if (!vertexCount)
+    {
+        return true;
+    }
+    NS::UInteger required = layout.positionOffset + (vertexCount - 1) * layout.positionStride + 3 * sizeof(float);
+    if (writeNormals)
+    {
+        required = std::max(required, layout.normalOffset + (vertexCount - 1) * layout.normalStride + 3 * sizeof(float));
+    }
+    MeshBufferMap* map = target->length() >= required ? target->map() : nullptr;
+    char*          bytes = map ? static_cast<char*>(map->bytes()) : nullptr;
+    if (!bytes)
+    {
+        return false;
+    }
+    
+    Private::Skinning::Input input;
+    input.positions = static_cast<const float*>(positions->dataStart());
+    input.positionStride = positions->stride();
+    input.normals = normals ? static_cast<const float*>(normals->dataStart()) : nullptr;
+    input.normalStride = normals ? normals->stride() : 0;
+    input.joints = static_cast<const std::uint16_t*>(joints->dataStart());
+    input.jointStride = joints->stride();
+    input.weights = static_cast<const float*>(weights->dataStart());
+    input.weightStride = weights->stride();
+    input.vertexCount = vertexCount;
+    
+    Private::Skinning::Output output;
+    output.positions = reinterpret_cast<float*>(bytes + layout.positionOffset);
+    output.positionStride = layout.positionStride;
+    output.normals = writeNormals ? reinterpret_cast<float*>(bytes + layout.normalOffset) : nullptr;
+    output.normalStride = layout.normalStride;
+    
+    if (mode == SkinningModeDualQuaternion)
+    {
+        static thread_local std::vector<float> dualQuaternions;
+        const float* matrices = posePalette(*rig, time, false);
+        dualQuaternions.resize(rig->paletteCount() * 8);
+        for (NS::UInteger i = 0; i < rig->paletteCount(); ++i)
+        {
+            Private::Skinning::toDualQuaternion(matrices + i * 16, dualQuaternions.data() + i * 8);
+        }
+        Private::Skinning::dualQuaternion(input, dualQuaternions.data(), rig->paletteCount(), rig->geometryBindTransform(), output);
+    }
+    else
+    {
+        Private::Skinning::linearBlend(input, posePalette(*rig, time, true), rig->paletteCount(), output);
+    }
+    
+    Private::MeshBufferGeneration::shared().bump(target);
+    Private::BoundsCache::shared().markDirty(target);
+    return true;
+}
+
+// native: invalidateRig
+_MDL_INLINE void MDL::AnimationBindComponent::invalidateRig()
+{
+    Private::SkinningRigCache::shared().remove(this);
+}
+
+// native: rig
+_MDL_INLINE std::shared_ptr<const MDL::Private::SkinningRig> MDL::AnimationBindComponent::rig()
+{
+    if (std::shared_ptr<const Private::SkinningRig> cached = Private::SkinningRigCache::shared().find(this))
+    {
+        return cached;
+    }
+    
+    Skeleton* skeleton = this->skeleton();
+    if (!skeleton)
+    {
+        return nullptr;
+    }
+    std::shared_ptr<const Private::JointHierarchy> hierarchy = skeleton->jointHierarchy();
+    const NS::UInteger                             jointCount = hierarchy->jointCount();
+    
+    std::vector<float> restTransforms(jointCount * 16);
+    std::vector<float> bindTransforms(jointCount * 16);
+    Private::restTransforms(skeleton->jointRestTransforms(), jointCount, restTransforms.data());
+    Private::restTransforms(skeleton->jointBindTransforms(), jointCount, bindTransforms.data());
+    
+    JointAnimation*          animation = jointAnimation();
+    std::vector<std::string> animationJointPaths;
+    if (animation && Object::sendMessage<BOOL>(animation, _MDL_PRIVATE_SEL(isKindOfClass_), _MDL_PRIVATE_CLS(MDLPackedJointAnimation)))
+    {
+        animationJointPaths = Private::jointPathStrings(reinterpret_cast<PackedJointAnimation*>(animation)->jointPaths());
+    }
+    
+    const matrix_double4x4 geometryBind = geometryBindTransform();
+    const double*          geometryBindValues = reinterpret_cast<const double*>(&geometryBind);
+    const bool             unset = std::all_of(geometryBindValues, geometryBindValues + 16, [](double value) { return value == 0.0; });
+    
+    std::shared_ptr<const Private::SkinningRig> rig = Private::SkinningRig::build(std::move(hierarchy), restTransforms.data(), bindTransforms.data(),
+                                                                                  animationJointPaths, Private::jointPathStrings(jointPaths()),
+                                                                                  unset ? nullptr : geometryBindValues);
+    Private::SkinningRigCache::shared().store(this, rig);
+    return rig;
+}
+
+// native: posePalette
+_MDL_INLINE const float* MDL::AnimationBindComponent::posePalette(const Private::SkinningRig& rig, NS::TimeInterval time, bool withGeometryBind)
+{
+    static thread_local std::vector<float> palette;
+    Private::PoseScratch& scratch = Private::PoseScratch::local();
+    
+    const NS::UInteger animationJointCount = rig.animationJointCount();
+    scratch.translations.resize(animationJointCount * 4);
+    scratch.rotations.resize(animationJointCount * 4);
+    scratch.scales.resize(animationJointCount * 4);
+    if (animationJointCount)
+    {
+        reinterpret_cast<PackedJointAnimation*>(jointAnimation())->jointTransforms(time, animationJointCount, scratch.translations.data(),
+                                                                                  scratch.rotations.data(), scratch.scales.data());
+    }
+    
+    scratch.model.resize(rig.jointCount() * 16);
+    palette.resize(rig.paletteCount() * 16);
+    rig.pose(scratch.translations.data(), scratch.rotations.data(), scratch.scales.data(), scratch.model.data());
+    rig.palette(scratch.model.data(), withGeometryBind, palette.data());
+    return palette.data();
 }
 
+// MARK: - Native AnimationRetargeter
+
+_MDL_INLINE std::shared_ptr<MDL::AnimationRetargeter> MDL::AnimationRetargeter::make(Skeleton* source, Skeleton* target,
+                                                                                   const RetargetSettings& settings)
+{
+    if (!source || !target)
+    {
+        return nullptr;
+    }
+    std::shared_ptr<AnimationRetargeter> retargeter(new AnimationRetargeter());
+    source->retain();
+    target->retain();
+    retargeter->_source = source;
+    retargeter->_target = target;
+    retargeter->_sourceHierarchy = source->jointHierarchy();
+    retargeter->_targetHierarchy = target->jointHierarchy();
+    
+    const NS::UInteger sourceCount = retargeter->_sourceHierarchy->jointCount();
+    const NS::UInteger targetCount = retargeter->_targetHierarchy->jointCount();
+    std::vector<float> sourceRest(sourceCount * 16);
+    std::vector<float> targetRest(targetCount * 16);
+    Private::restTransforms(source->jointRestTransforms(), sourceCount, sourceRest.data());
+    Private::restTransforms(target->jointRestTransforms(), targetCount, targetRest.data());
+    
+    retargeter->_map = Private::RetargetMap::build(*retargeter->_sourceHierarchy, Private::jointPathStrings(source->jointPaths()), sourceRest.data(),
+                                                   *retargeter->_targetHierarchy, Private::jointPathStrings(target->jointPaths()), targetRest.data(),
+                                                   settings);
+    
+    retargeter->_targetJoints.sources.resize(targetCount);
+    for (NS::UInteger j = 0; j < targetCount; ++j)
+    {
+        retargeter->_targetJoints.sources[j] = std::int32_t(j);
+    }
+    retargeter->_targetJoints.sourceCount = targetCount;
+    retargeter->_targetJoints.complete = true;
+    return retargeter;
+}
+
+_MDL_INLINE MDL::AnimationRetargeter::~AnimationRetargeter()
+{
+    if (_source)
+    {
+        _source->release();
+    }
+    if (_target)
+    {
+        _target->release();
+    }
+    for (const auto& entry : _programs)
+    {
+        if (entry.first)
+        {
+            reinterpret_cast<PackedJointAnimation*>(const_cast<void*>(entry.first))->release();
+        }
+    }
+}
+
+_MDL_INLINE NS::UInteger MDL::AnimationRetargeter::targetJointCount() const
+{
+    return _map->targetJointCount();
+}
+
+_MDL_INLINE NS::UInteger MDL::AnimationRetargeter::matchedJointCount() const
+{
+    return _map->matchedJointCount();
+}
+
+_MDL_INLINE const std::int32_t* MDL::AnimationRetargeter::sourceJoints() const
+{
+    return _map->sourceJoints();
+}
+
+_MDL_INLINE void MDL::AnimationRetargeter::retarget(PackedJointAnimation* animation, NS::TimeInterval time,
+                                                    float* translations, float* rotations, float* scales)
+{
+    std::shared_ptr<const Private::RetargetProgram> program = this->program(animation);
+    Private::PoseScratch&                           scratch = Private::PoseScratch::local();
+    const NS::UInteger                              sourceCount = program->sourceCount();
+    scratch.translations.resize(sourceCount * 4);
+    scratch.rotations.resize(sourceCount * 4);
+    scratch.scales.resize(sourceCount * 4);
+    if (sourceCount)
+    {
+        animation->jointTransforms(time, sourceCount, scratch.translations.data(), scratch.rotations.data(), scratch.scales.data());
+    }
+    program->apply(scratch.translations.data(), scratch.rotations.data(), scratch.scales.data(), translations, rotations, scales);
+}
+
+_MDL_INLINE NS::UInteger MDL::AnimationRetargeter::pose(PackedJointAnimation* animation, NS::TimeInterval time,
+                                                        matrix_float4x4* modelTransforms, NS::UInteger maxCount)
+{
+    static thread_local Private::AlignedVector<float> translations, rotations, scales;
+    const NS::UInteger    jointCount = _targetHierarchy->jointCount();
+    Private::PoseScratch& scratch = Private::PoseScratch::local();
+    translations.resize(jointCount * 4);
+    rotations.resize(jointCount * 4);
+    scales.resize(jointCount * 4);
+    retarget(animation, time, translations.data(), rotations.data(), scales.data());
+    
+    // Every target joint comes out of the program, rest poses included
+    scratch.model.resize(jointCount * 16);
+    _targetHierarchy->pose(translations.data(), rotations.data(), scales.data(), _targetJoints, nullptr, scratch.model.data());
+    const float* model = scratch.model.data();
+    
+    const NS::UInteger count = std::min(maxCount, jointCount);
+    std::copy(model, model + count * 16, reinterpret_cast<float*>(modelTransforms));
+    return count;
+}
+
+_MDL_INLINE MDL::PackedJointAnimation* MDL::AnimationRetargeter::newRetargetedAnimation(PackedJointAnimation* animation,
+                                                                                         const NS::String* name)
+{
+    // Keys wherever any channel of the source has one
+    std::vector<NS::TimeInterval> times;
+    AnimatedValue* channels[3] =
+    {
+        reinterpret_cast<AnimatedValue*>(animation->translations()),
+        reinterpret_cast<AnimatedValue*>(animation->rotations()),
+        reinterpret_cast<AnimatedValue*>(animation->scales()),
+    };
+    for (AnimatedValue* channel : channels)
+    {
+        const NS::UInteger count = channel ? channel->timeSampleCount() : 0;
+        const NS::UInteger first = times.size();
+        times.resize(first + count);
+        if (count)
+        {
+            channel->getTimes(times.data() + first, count);
+        }
+    }
+    std::sort(times.begin(), times.end());
+    times.erase(std::unique(times.begin(), times.end()), times.end());
+    
+    const NS::UInteger jointCount = _targetHierarchy->jointCount();
+    Private::AlignedVector<float> translations(times.size() * jointCount * 4);
+    Private::AlignedVector<float> rotations(times.size() * jointCount * 4);
+    Private::AlignedVector<float> scales(times.size() * jointCount * 4);
+    for (NS::UInteger k = 0; k < times.size(); ++k)
+    {
+        const NS::UInteger offset = k * jointCount * 4;
+        retarget(animation, times[k], translations.data() + offset, rotations.data() + offset, scales.data() + offset);
+    }
+    
+    PackedJointAnimation* retargeted = PackedJointAnimation::alloc()->init(name, _target->jointPaths());
+    if (!retargeted || times.empty())
+    {
+        return retargeted;
+    }
+    const NS::UInteger valueCount = times.size() * jointCount;
+    retargeted->translations()->resetWithFloat3Array(reinterpret_cast<const vector_float3*>(translations.data()), valueCount,
+                                                     times.data(), times.size());
+    retargeted->rotations()->resetWithFloatQuaternionArray(reinterpret_cast<const simd_quatf*>(rotations.data()), valueCount,
+                                                           times.data(), times.size());
+    retargeted->scales()->resetWithFloat3Array(reinterpret_cast<const vector_float3*>(scales.data()), valueCount,
+                                               times.data(), times.size());
+    return retargeted;
+}
+
+_MDL_INLINE std::shared_ptr<const MDL::Private::RetargetProgram> MDL::AnimationRetargeter::program(PackedJointAnimation* animation)
+{
+    const NS::Array* jointPaths = animation ? animation->jointPaths() : nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _programs.find(animation);
+        if (it != _programs.end() && it->second.jointPaths == jointPaths)
+        {
+            return it->second.program;
+        }
+    }
+    
+    std::shared_ptr<const Private::RetargetProgram> program =
+        _map->compile(_sourceHierarchy->mapJoints(Private::jointPathStrings(jointPaths)));
+    
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto inserted = _programs.emplace(animation, ProgramEntry { jointPaths, program });
+    if (!inserted.second)
+    {
+        inserted.first->second = { jointPaths, program };
+    }
+    else if (animation)
+    {
+        animation->retain();
+    }
+    return program;
+}
+
+// MARK: - Native AnimationBlendTree
+
+_MDL_INLINE std::shared_ptr<MDL::AnimationBlendTree> MDL::AnimationBlendTree::make(Skeleton* skeleton)
+{
+    if (!skeleton)
+    {
+        return nullptr;
+    }
+    std::shared_ptr<AnimationBlendTree> tree(new AnimationBlendTree());
+    tree->_hierarchy = skeleton->jointHierarchy();
+    
+    // Rest transforms as local poses, for joints clips leave out
+    const NS::UInteger jointCount = tree->_hierarchy->jointCount();
+    std::vector<float> restTransforms(jointCount * 16);
+    Private::restTransforms(skeleton->jointRestTransforms(), jointCount, restTransforms.data());
+    tree->_rest.assign(jointCount * 12, 0.0f);
+    for (NS::UInteger j = 0; j < jointCount; ++j)
+    {
+        const float* m = restTransforms.data() + j * 16;
+        float*       translation = tree->_rest.data() + j * 4;
+        float*       scale = tree->_rest.data() + jointCount * 8 + j * 4;
+        float        dualQuaternion[8];
+        for (int c = 0; c < 3; ++c)
+        {
+            translation[c] = m[12 + c];
+            scale[c] = std::sqrt(m[c * 4] * m[c * 4] + m[c * 4 + 1] * m[c * 4 + 1] + m[c * 4 + 2] * m[c * 4 + 2]);
+        }
+        Private::Skinning::toDualQuaternion(m, dualQuaternion);
+        std::copy(dualQuaternion, dualQuaternion + 4, tree->_rest.data() + jointCount * 4 + j * 4);
+    }
+    
+    tree->_local.resize(jointCount * 12);
+    tree->_model.resize(jointCount * 16);
+    tree->_joints.sources.resize(jointCount);
+    for (NS::UInteger j = 0; j < jointCount; ++j)
+    {
+        tree->_joints.sources[j] = std::int32_t(j);
+    }
+    tree->_joints.sourceCount = jointCount;
+    tree->_joints.complete = true;
+    return tree;
+}
+
+_MDL_INLINE MDL::AnimationBlendTree::~AnimationBlendTree()
+{
+    for (NodeState& node : _nodes)
+    {
+        if (node.animation)
+        {
+            node.animation->release();
+        }
+    }
+}
+
+_MDL_INLINE NS::UInteger MDL::AnimationBlendTree::jointCount() const
+{
+    return _hierarchy->jointCount();
+}
+
+_MDL_INLINE MDL::AnimationBlendTree::Node MDL::AnimationBlendTree::addClip(PackedJointAnimation* animation, NS::TimeInterval time)
+{
+    NodeState node;
+    node.kind = NodeKind::Clip;
+    node.time = time;
+    std::vector<std::string> animationJointPaths;
+    if (animation)
+    {
+        animation->retain();
+        node.animation = animation;
+        animationJointPaths = Private::jointPathStrings(animation->jointPaths());
+    }
+    node.joints = std::make_shared<const Private::JointMap>(_hierarchy->mapJoints(animationJointPaths));
+    _sample.resize(std::max<NS::UInteger>(_sample.size(), node.joints->sourceCount * 12));
+    return addNode(std::move(node));
+}
+
+_MDL_INLINE MDL::AnimationBlendTree::Node MDL::AnimationBlendTree::addBlend(Node a, Node b, float weight, PoseBlendRotation rotation)
+{
+    if (a >= _nodes.size() || b >= _nodes.size())
+    {
+        return NoNode;
+    }
+    NodeState node;
+    node.kind = NodeKind::Blend;
+    node.inputs[0] = a;
+    node.inputs[1] = b;
+    node.weight = weight;
+    node.rotation = rotation;
+    return addNode(std::move(node));
+}
+
+_MDL_INLINE MDL::AnimationBlendTree::Node MDL::AnimationBlendTree::addAdditive(Node base, Node layer, Node reference, float weight)
+{
+    if (base >= _nodes.size() || layer >= _nodes.size() || reference >= _nodes.size())
+    {
+        return NoNode;
+    }
+    NodeState node;
+    node.kind = NodeKind::Additive;
+    node.inputs[0] = base;
+    node.inputs[1] = layer;
+    node.inputs[2] = reference;
+    node.weight = weight;
+    return addNode(std::move(node));
+}
+
+_MDL_INLINE MDL::AnimationBlendTree::Node MDL::AnimationBlendTree::addNode(NodeState node)
+{
+    node.pose.resize(jointCount() * 12);
+    _nodes.push_back(std::move(node));
+    _reachable.resize(_nodes.size());
+    return _nodes.size() - 1;
+}
+
+_MDL_INLINE void MDL::AnimationBlendTree::setTime(Node clip, NS::TimeInterval time)
+{
+    if (clip < _nodes.size())
+    {
+        _nodes[clip].time = time;
+    }
+}
+
+_MDL_INLINE void MDL::AnimationBlendTree::setWeight(Node node, float weight)
+{
+    if (node < _nodes.size())
+    {
+        _nodes[node].weight = weight;
+    }
+}
+
+_MDL_INLINE void MDL::AnimationBlendTree::setMask(Node node, const float* jointWeights)
+{
+    if (node >= _nodes.size())
+    {
+        return;
+    }
+    if (!jointWeights)
+    {
+        _nodes[node].mask.clear();
+        return;
+    }
+    _nodes[node].mask.assign(jointWeights, jointWeights + jointCount());
+}
+
+_MDL_INLINE void MDL::AnimationBlendTree::setMask(Node node, const NS::String* jointPath, float insideWeight, float outsideWeight)
+{
+    if (node >= _nodes.size())
+    {
+        return;
+    }
+    const char*        path = jointPath ? jointPath->utf8String() : nullptr;
+    const std::int32_t root = _hierarchy->jointIndex(path ? path : "");
+    const NS::UInteger count = jointCount();
+    
+    // Parents come first in evaluation order, so one pass settles each joint
+    std::vector<char> inside(count, 0);
+    for (NS::UInteger i = 0; i < count; ++i)
+    {
+        const std::uint32_t joint = _hierarchy->order()[i];
+        const std::int32_t  parent = _hierarchy->orderedParents()[i];
+        inside[joint] = std::int32_t(joint) == root || (parent != Private::JointHierarchy::NoJoint && inside[parent]);
+    }
+    Private::AlignedVector<float>& mask = _nodes[node].mask;
+    mask.resize(count);
+    for (NS::UInteger j = 0; j < count; ++j)
+    {
+        mask[j] = inside[j] ? insideWeight : outsideWeight;
+    }
+}
+
+_MDL_INLINE MDL::Private::PoseBlending::Pose MDL::AnimationBlendTree::pose(Node node)
+{
+    float* values = _nodes[node].pose.data();
+    const NS::UInteger count = jointCount();
+    return { values, values + count * 4, values + count * 8 };
+}
+
+_MDL_INLINE const float* MDL::AnimationBlendTree::evaluatePose(Node root)
+{
+    if (root >= _nodes.size())
+    {
+        return nullptr;
+    }
+    
+    // Inputs always precede their readers, so a backward sweep marks what
+    // the root needs and a forward one evaluates it
+    std::fill(_reachable.begin(), _reachable.end(), 0);
+    _reachable[root] = 1;
+    for (Node i = root + 1; i-- > 0;)
+    {
+        if (_reachable[i] && _nodes[i].kind != NodeKind::Clip)
+        {
+            _reachable[_nodes[i].inputs[0]] = 1;
+            _reachable[_nodes[i].inputs[1]] = 1;
+            _reachable[_nodes[i].inputs[2]] |= _nodes[i].kind == NodeKind::Additive;
+        }
+    }
+    
+    const NS::UInteger count = jointCount();
+    for (Node i = 0; i <= root; ++i)
+    {
+        if (!_reachable[i])
+        {
+            continue;
+        }
+        NodeState&                  node = _nodes[i];
+        Private::PoseBlending::Pose out = pose(i);
+        const float*                mask = node.mask.empty() ? nullptr : node.mask.data();
+        
+        if (node.kind == NodeKind::Clip)
+        {
+            const NS::UInteger sourceCount = node.joints->sourceCount;
+            float*             sample = _sample.data();
+            if (sourceCount)
+            {
+                node.animation->jointTransforms(node.time, sourceCount, sample, sample + sourceCount * 4, sample + sourceCount * 8);
+            }
+            for (NS::UInteger j = 0; j < count; ++j)
+            {
+                const std::int32_t source = node.joints->sources[j];
+                const float*       from = source == Private::JointHierarchy::NoJoint ? _rest.data() + j * 4 : sample + NS::UInteger(source) * 4;
+                const NS::UInteger stride = source == Private::JointHierarchy::NoJoint ? count * 4 : sourceCount * 4;
+                std::copy(from, from + 4, out.translations + j * 4);
+                std::copy(from + stride, from + stride + 4, out.rotations + j * 4);
+                std::copy(from + stride * 2, from + stride * 2 + 4, out.scales + j * 4);
+            }
+            continue;
+        }
+        
+        const Private::PoseBlending::Pose a = pose(node.inputs[0]);
+        const Private::PoseBlending::Pose b = pose(node.inputs[1]);
+        if (node.kind == NodeKind::Blend)
+        {
+            Private::PoseBlending::blend({ a.translations, a.rotations, a.scales }, { b.translations, b.rotations, b.scales },
+                                         node.weight, mask, count, node.rotation, out);
+        }
+        else
+        {
+            const Private::PoseBlending::Pose reference = pose(node.inputs[2]);
+            Private::PoseBlending::add({ a.translations, a.rotations, a.scales }, { b.translations, b.rotations, b.scales },
+                                       { reference.translations, reference.rotations, reference.scales }, node.weight, mask, count, out);
+        }
+    }
+    
+    std::copy(_nodes[root].pose.begin(), _nodes[root].pose.end(), _local.begin());
+    Private::PoseBlending::normalizeRotations(_local.data() + count * 4, count);
+    return _local.data();
+}
+
+_MDL_INLINE void MDL::AnimationBlendTree::evaluateLocal(Node root, float* translations, float* rotations, float* scales)
+{
+    const float*       local = evaluatePose(root);
+    const NS::UInteger count = jointCount();
+    if (!local)
+    {
+        return;
+    }
+    std::copy(local, local + count * 4, translations);
+    std::copy(local + count * 4, local + count * 8, rotations);
+    std::copy(local + count * 8, local + count * 12, scales);
+}
+
+_MDL_INLINE NS::UInteger MDL::AnimationBlendTree::evaluate(Node root, matrix_float4x4* modelTransforms, NS::UInteger maxCount)
+{
+    const float*       local = evaluatePose(root);
+    const NS::UInteger count = jointCount();
+    if (!local)
+    {
+        return 0;
+    }
+    _hierarchy->pose(local, local + count * 4, local + count * 8, _joints, nullptr, _model.data());
+    
+    const NS::UInteger written = std::min(maxCount, count);
+    std::copy(_model.data(), _model.data() + written * 16, reinterpret_cast<float*>(modelTransforms));
+    return written;
+}
+
+_MDL_INLINE void MDL::AnimationBlendTree::evaluate(Node root, Matrix4x4Array* modelTransforms)
+{
+    const float*       local = evaluatePose(root);
+    const NS::UInteger count = jointCount();
+    if (!local)
+    {
+        return;
+    }
+    _hierarchy->pose(local, local + count * 4, local + count * 8, _joints, nullptr, _model.data());
+    modelTransforms->setFloat4x4Array(reinterpret_cast<const matrix_float4x4*>(_model.data()), count);
+}
+
+_MDL_INLINE void MDL::Private::restTransforms(Matrix4x4Array* transforms, NS::UInteger jointCount, float* out)
+{
+    const NS::UInteger count = transforms ? std::min(jointCount, transforms->elementCount()) : 0;
+    for (NS::UInteger i = count * 16; i < jointCount * 16; ++i)
+    {
+        out[i] = float(i % 16 % 5 == 0);
+    }
+    if (count)
+    {
+        transforms->getFloat4x4Array(reinterpret_cast<matrix_float4x4*>(out), count);
+    }
+}
+
+_MDL_INLINE std::vector<std::string> MDL::Private::jointPathStrings(const NS::Array* jointPaths)
+{
+    std::vector<std::string> strings(jointPaths ? jointPaths->count() : 0);
+    for (NS::UInteger i = 0; i < strings.size(); ++i)
+    {
+        const char* path = jointPaths->object<NS::String>(i)->utf8String();
+        strings[i] = path ? path : "";
+    }
+    return strings;
+}
 
 // MARK: - Original Header
 
@@ -11,6 +11,8 @@
 #include "MDLObject.hpp"
 #include "MDLVertexDescriptor.hpp"
 #include "MDLMeshBuffer.hpp"
+#include "MDLMesh.hpp"
+#include "MDLInstancing.hpp"
 #include "MDLAnimation.hpp"
 #import "Foundation/NSURL.hpp"
 #import <simd/simd.h>
@@ -111,6 +113,51 @@ public:
     class ObjectContainerComponent* animations() const;
     void                            setAnimations(const class ObjectContainerComponent* animations);
     
+    // MARK: - Native
+    
+    // Hierarchy over the world-space triangles of every mesh in the asset at
+    // `time`; its ranges follow the order of childObjectsOfClass(MDLMesh).
+    // Rebuilt when a mesh's buffers change or a transform is set through the
+    // bridge; invalidate after moving objects any other way.
+    std::shared_ptr<BoundingVolumeHierarchy>    boundingVolumeHierarchyAtTime(NS::TimeInterval time);
+    
+    void                                        invalidateBoundingVolumeHierarchy() const;
+    
+    // Scene graph node standing for the asset, with the top level objects as
+    // its children; imported on first use
+    Private::SceneGraph::NodeId                 sceneNode() const;
+    
+    void                                        invalidateSceneGraph() const;
+    
+    // World matrices of every object in the asset at `time`, evaluated in one
+    // pass and cached per time until a transform or the hierarchy changes;
+    // `parallel` spreads independent subtrees over the worker pool
+    std::shared_ptr<const WorldTransformTable>  worldTransformsAtTime(NS::TimeInterval time, bool parallel = false) const;
+    
+    // Folds meshes with identical vertex, index and layout content into one
+    // master each, for imports that repeat the same part many times. Every
+    // copy is replaced in its parent by a plain object that keeps its name,
+    // transform, visibility and children and instances the master, which
+    // moves to masters(); top-level copies keep their index in the asset.
+    // Meshes carrying components besides a transform (skinned ones, for
+    // instance) are left alone. Returns the number of meshes released.
+    NS::UInteger                                deduplicateMeshes(const InstancingSettings& settings = InstancingSettings());
+    
+    // Every visible mesh at `time`, drawn directly or through an instance,
+    // with its world matrix and grouped by master. An instance draws every
+    // visible mesh in its prototype's subtree, under the transforms between
+    // them. Built from worldTransformsAtTime on every call
+    std::shared_ptr<const InstanceTable>        instanceTableAtTime(NS::TimeInterval time, bool parallel = false) const;
+    
+    // Calls `fn(Object*)` for each object in the asset that is kind of
+    // `objectClass` (every object for nullptr), in pre-order, until `fn`
+    // returns false
+    template <typename _Fn>
+    void                                        forEachObjectOfClass(Class objectClass, _Fn&& fn) const;
+    
+    // Same, over the worker pool; `fn` must be thread-safe
+    template <typename _Fn>
+    void                                        forEachObjectOfClassParallel(Class objectClass, _Fn&& fn) const;
 };
 
 // Protocol
@@ -191,8 +238,24 @@ _MDL_INLINE BOOL MDL::Asset::exportAssetToURL(const NS::URL* URL, NS::Error** er
 }
 
 // method: objectAtPath:
+// Looked up in the scene graph's path index, where the first component names
+// a top level object, and confirmed against ModelIO; misses and stale hits
+// are left to ModelIO
 _MDL_INLINE MDL::Object* MDL::Asset::objectAtPath(const NS::String* path)
 {
+    const char*                       utf8 = path ? path->utf8String() : "";
+    const Private::SceneGraph::NodeId scope = sceneNode();
+    const Private::SceneGraph&        graph = Private::SceneGraph::shared();
+    const Private::SceneGraph::NodeId node = graph.findPath(scope, utf8);
+    if (node != Private::SceneGraph::InvalidNode)
+    {
+        MDL::Object* hit = static_cast<MDL::Object*>(const_cast<void*>(graph.object(node)));
+        if (Private::confirmPath(nullptr, hit, utf8))
+        {
+            return hit;
+        }
+    }
+    
     return Object::sendMessage<MDL::Object*>(this, _MDL_PRIVATE_SEL(objectAtPath_), path);
 }
 
@@ -209,9 +272,16 @@ _MDL_INLINE BOOL MDL::Asset::canExportFileExtension(const NS::String* extention)
 }
 
 // method: childObjectsOfClass:
+// Collected from the scene graph, in pre-order
 _MDL_INLINE NS::Array* MDL::Asset::childObjectsOfClass(Class objectClass)
 {
-    return Object::sendMessage<NS::Array*>(this, _MDL_PRIVATE_SEL(childObjectsOfClass_), objectClass);
+    std::vector<const NS::Object*> objects;
+    forEachObjectOfClass(objectClass, [&](MDL::Object* object)
+    {
+        objects.push_back(object);
+        return true;
+    });
+    return NS::Array::array(objects.data(), objects.size());
 }
 
 // method: loadTextures
@@ -221,9 +291,44 @@ _MDL_INLINE void MDL::Asset::loadTextures()
 }
 
 // method: boundingBoxAtTime:
+// Served natively from the bounds cache; only the top-level objects are
+// visited when nothing changed since the last call
 _MDL_INLINE MDL::AxisAlignedBoundingBox MDL::Asset::boundingBoxAtTime(NS::TimeInterval time)
 {
-    return Object::sendMessage<AxisAlignedBoundingBox>(this, _MDL_PRIVATE_SEL(boundingBoxAtTime_), time);
+    Private::BoundsCache&     cache = Private::BoundsCache::shared();
+    Private::BoundsCache::Box box;
+    if (cache.find(this, time, box))
+    {
+        return Private::axisAlignedBoundingBox(box);
+    }
+    
+    box = Private::BoundsCache::emptyBox();
+    bool animated = false;
+    for (NS::UInteger i = 0, n = count(); i < n; ++i)
+    {
+        MDL::Object*              object = objectAtIndex(i);
+        Private::BoundsCache::Box local = Private::boundsCacheBox(object->localBoundingBoxAtTime(time));
+        bool                      objectAnimated = false;
+        cache.find(object, time, local, &objectAnimated);
+        cache.addDependency(object, this);
+        
+        if (TransformComponent* component = object->transform())
+        {
+            const matrix_float4x4 matrix = component->localTransformAtTime(time);
+            local = Private::BoundsCache::transform(local, reinterpret_cast<const float*>(&matrix.columns[0]),
+                                                    sizeof(matrix.columns[0]) / sizeof(float));
+            cache.addDependency(component, this);
+            
+            NS::Array* keyTimes = component->keyTimes();
+            objectAnimated = objectAnimated || (keyTimes && keyTimes->count() > 1);
+        }
+        
+        Private::BoundsCache::merge(box, local);
+        animated = animated || objectAnimated;
+    }
+    
+    cache.store(this, time, animated, box);
+    return Private::axisAlignedBoundingBox(box);
 }
 
 // property: boundingBox
@@ -308,13 +413,30 @@ _MDL_INLINE MDL::VertexDescriptor* MDL::Asset::vertexDescriptor() const
 // method: addObject:
 _MDL_INLINE void MDL::Asset::addObject(const MDL::Object* object)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(addObject_), object);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(addObject_), object);
+    Private::BoundsCache::shared().markDirty(this);
+    
+    Private::SceneGraph&              graph = Private::SceneGraph::shared();
+    const Private::SceneGraph::NodeId node = graph.findContainer(this);
+    if (node != Private::SceneGraph::InvalidNode && object)
+    {
+        graph.attach(object->sceneNode(), node);
+    }
 }
 
 // method: removeObject:
 _MDL_INLINE void MDL::Asset::removeObject(const MDL::Object* object)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(removeObject_), object);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(removeObject_), object);
+    Private::BoundsCache::shared().markDirty(this);
+    
+    Private::SceneGraph&              graph = Private::SceneGraph::shared();
+    const Private::SceneGraph::NodeId owner = graph.findContainer(this);
+    const Private::SceneGraph::NodeId node = graph.find(object);
+    if (owner != Private::SceneGraph::InvalidNode && node != Private::SceneGraph::InvalidNode && graph.parent(node) == owner)
+    {
+        graph.detach(node);
+    }
 }
 
 // property: count
@@ -408,6 +530,469 @@ _MDL_INLINE NS::Array* MDL::LightProbeIrradianceDataSource::placeLightProbesWith
 }
 
 
+// MARK: Asset-Native
+
+// native: boundingVolumeHierarchyAtTime
+_MDL_INLINE std::shared_ptr<MDL::BoundingVolumeHierarchy> MDL::Asset::boundingVolumeHierarchyAtTime(NS::TimeInterval time)
+{
+    NS::Array*         meshes = childObjectsOfClass(static_cast<Class>(_MDL_PRIVATE_CLS(MDLMesh)));
+    const NS::UInteger meshCount = meshes ? meshes->count() : 0;
+    
+    Private::BoundingVolumeHierarchyCache::Key key = { 0, 0, time };
+    for (NS::UInteger m = 0; m < meshCount; ++m)
+    {
+        Mesh* mesh = meshes->object<Mesh>(m);
+        const Private::BoundingVolumeHierarchyCache::Key meshKey = Private::meshHierarchyKey(mesh);
+        key.topology = Private::hashCombine(key.topology, reinterpret_cast<std::uintptr_t>(mesh));
+        key.topology = Private::hashCombine(key.topology, meshKey.topology);
+        key.vertices = Private::hashCombine(key.vertices, meshKey.vertices);
+    }
+    key.vertices = Private::hashCombine(key.vertices, Private::SceneGraph::shared().transformGeneration());
+    
+    if (std::shared_ptr<BoundingVolumeHierarchy> cached = Private::BoundingVolumeHierarchyCache::shared().find(this, key))
+    {
+        return cached;
+    }
+    
+    std::vector<float>         positions;
+    std::vector<std::uint32_t> triangles, rangeOffsets(meshCount);
+    std::vector<std::uint32_t> meshTriangles, submeshOffsets;
+    
+    for (NS::UInteger m = 0; m < meshCount; ++m)
+    {
+        rangeOffsets[m] = std::uint32_t(triangles.size() / 3);
+        
+        Mesh*                mesh = meshes->object<Mesh>(m);
+        VertexAttributeData* positionData = mesh->vertexAttributeDataForAttributeNamed(VertexAttributePosition, VertexFormatFloat3);
+        if (!positionData)
+        {
+            continue;
+        }
+        
+        const matrix_float4x4 world = Private::worldTransformAtTime(mesh, time);
+        const unsigned char*  bytes = static_cast<const unsigned char*>(positionData->dataStart());
+        const NS::UInteger    stride = positionData->stride();
+        const NS::UInteger    count = mesh->vertexCount();
+        const std::uint32_t   base = std::uint32_t(positions.size() / 3);
+        
+        positions.resize(positions.size() + count * 3);
+        float* out = &positions[base * 3];
+        for (NS::UInteger v = 0; v < count; ++v)
+        {
+            const float* p = reinterpret_cast<const float*>(bytes + v * stride);
+            for (int row = 0; row < 3; ++row)
+            {
+                out[v * 3 + row] = world.columns[0][row] * p[0] + world.columns[1][row] * p[1] +
+                                   world.columns[2][row] * p[2] + world.columns[3][row];
+            }
+        }
+        
+        meshTriangles.clear();
+        Private::meshTriangles(mesh, meshTriangles, submeshOffsets);
+        for (std::uint32_t index : meshTriangles)
+        {
+            triangles.push_back(index + base);
+        }
+    }
+    
+    std::shared_ptr<BoundingVolumeHierarchy> hierarchy = BoundingVolumeHierarchy::build(positions.data(), sizeof(float) * 3,
+                                                                                        positions.size() / 3,
+                                                                                        triangles.data(), triangles.size(),
+                                                                                        std::move(rangeOffsets));
+    Private::BoundingVolumeHierarchyCache::shared().store(this, key, hierarchy);
+    return hierarchy;
+}
+
+// native: invalidateBoundingVolumeHierarchy
+_MDL_INLINE void MDL::Asset::invalidateBoundingVolumeHierarchy() const
+{
+    Private::BoundingVolumeHierarchyCache::shared().invalidate(this);
+}
+
+// native: sceneNode
+_MDL_INLINE MDL::Private::SceneGraph::NodeId MDL::Asset::sceneNode() const
+{
+    Private::SceneGraph& graph = Private::SceneGraph::shared();
+    
+    Private::SceneGraph::NodeId node = graph.findContainer(this);
+    if (node != Private::SceneGraph::InvalidNode)
+    {
+        return node;
+    }
+    
+    node = graph.insert(this, Private::SceneGraph::FlagContainer);
+    graph.setContainer(node, this);
+    for (NS::UInteger i = 0, n = Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(count)); i < n; ++i)
+    {
+        MDL::Object* object = Object::sendMessage<MDL::Object*>(this, _MDL_PRIVATE_SEL(objectAtIndex_), i);
+        graph.attach(object->sceneNode(), node);
+    }
+    return node;
+}
+
+// native: forEachObjectOfClass
+template <typename _Fn>
+_MDL_INLINE void MDL::Asset::forEachObjectOfClass(Class objectClass, _Fn&& fn) const
+{
+    // Importing the asset may meet new classes, so the filter is built after it
+    const Private::SceneGraph::NodeId root = sceneNode();
+    const Private::SceneGraph&        graph = Private::SceneGraph::shared();
+    graph.traverse(root, Private::sceneClassFilter(objectClass), [&](Private::SceneGraph::NodeId node)
+    {
+        return fn(static_cast<MDL::Object*>(const_cast<void*>(graph.object(node))));
+    });
+}
+
+// native: forEachObjectOfClassParallel
+template <typename _Fn>
+_MDL_INLINE void MDL::Asset::forEachObjectOfClassParallel(Class objectClass, _Fn&& fn) const
+{
+    // Importing the asset may meet new classes, so the filter is built after it
+    const Private::SceneGraph::NodeId root = sceneNode();
+    const Private::SceneGraph&        graph = Private::SceneGraph::shared();
+    graph.traverseParallel(root, Private::sceneClassFilter(objectClass), [&](Private::SceneGraph::NodeId node)
+    {
+        return fn(static_cast<MDL::Object*>(const_cast<void*>(graph.object(node))));
+    });
+}
+
+// native: worldTransformsAtTime
+_MDL_INLINE std::shared_ptr<const MDL::WorldTransformTable> MDL::Asset::worldTransformsAtTime(NS::TimeInterval time, bool parallel) const
+{
+    return Private::worldTransformTable(sceneNode(), time, parallel);
+}
+
+// native: deduplicateMeshes
+_MDL_INLINE NS::UInteger MDL::Asset::deduplicateMeshes(const InstancingSettings& settings)
+{
+    using NodeId = Private::SceneGraph::NodeId;
+    Private::SceneGraph& graph = Private::SceneGraph::shared();
+    
+    std::vector<MDL::Object*> meshes;
+    forEachObjectOfClass(static_cast<Class>(_MDL_PRIVATE_CLS(MDLMesh)), [&](MDL::Object* object)
+    {
+        TransformComponent* transform = object->transform();
+        NS::Array*          components = object->components();
+        bool                plain = !object->instance();
+        for (NS::UInteger c = 0, n = components ? components->count() : 0; plain && c < n; ++c)
+        {
+            plain = components->object(c) == reinterpret_cast<NS::Object*>(transform);
+        }
+        if (plain)
+        {
+            meshes.push_back(object);
+        }
+        return true;
+    });
+    
+    // Buffers are mapped here, on the calling thread, and hashed on the pool
+    std::vector<Private::MeshContent> contents(meshes.size());
+    for (NS::UInteger m = 0; m < meshes.size(); ++m)
+    {
+        Private::meshContent(reinterpret_cast<Mesh*>(meshes[m]), settings.matchMaterials, contents[m]);
+    }
+    Private::parallelFor(contents.size(), 64, [&](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger m = begin; m < end; ++m)
+        {
+            contents[m].computeHash();
+        }
+    });
+    
+    std::vector<std::vector<std::uint32_t>>                         groups;
+    std::unordered_map<std::uint64_t, std::vector<std::uint32_t>>   groupsByHash;
+    for (std::uint32_t m = 0; m < meshes.size(); ++m)
+    {
+        std::vector<std::uint32_t>& candidates = groupsByHash[contents[m].hash];
+        auto found = std::find_if(candidates.begin(), candidates.end(), [&](std::uint32_t group)
+        {
+            return contents[groups[group].front()].equals(contents[m]);
+        });
+        if (found != candidates.end())
+        {
+            groups[*found].push_back(m);
+            continue;
+        }
+        candidates.push_back(std::uint32_t(groups.size()));
+        groups.push_back({ m });
+    }
+    
+    // Replacements by parent, so that each child container is rebuilt once
+    std::unordered_map<MDL::Object*, std::unordered_map<MDL::Object*, MDL::Object*>> replacements;
+    std::unordered_map<MDL::Object*, MDL::Object*>                                   topLevel;
+    std::unordered_map<MDL::Object*, MDL::Object*>                                   substitutes;
+    std::vector<MDL::Object*>                                                        released;
+    NS::UInteger                                                                     folded = 0;
+    
+    for (const std::vector<std::uint32_t>& group : groups)
+    {
+        if (group.size() < std::max<NS::UInteger>(settings.minimumCopies, 2))
+        {
+            continue;
+        }
+        
+        ++folded;
+        ObjectContainerComponent* masters = this->masters();
+        if (!masters)
+        {
+            ObjectContainer* container = ObjectContainer::alloc()->init();
+            setMasters(reinterpret_cast<ObjectContainerComponent*>(container));
+            container->release();
+            masters = this->masters();
+        }
+        MDL::Object* master = meshes[group.front()];
+        for (std::uint32_t m : group)
+        {
+            MDL::Object* mesh = meshes[m];
+            const NodeId node = graph.find(mesh);
+            const NodeId parentNode = graph.parent(node);
+            mesh->retain();
+            
+            MDL::Object* instance = MDL::Object::alloc()->init();
+            reinterpret_cast<Named*>(instance)->setName(reinterpret_cast<Named*>(mesh)->name());
+            instance->setHidden(mesh->hidden());
+            instance->setTransform(mesh->transform());
+            mesh->setTransform(nullptr);
+            if (ObjectContainerComponent* children = mesh->children())
+            {
+                children->retain();
+                mesh->setChildren(nullptr);
+                instance->setChildren(children);
+                children->release();
+            }
+            instance->setInstance(master);
+            
+            if (graph.flags(parentNode) & Private::SceneGraph::FlagContainer)
+            {
+                topLevel[mesh] = instance;
+            }
+            else
+            {
+                replacements[static_cast<MDL::Object*>(const_cast<void*>(graph.object(parentNode)))][mesh] = instance;
+            }
+            substitutes[mesh] = instance;
+            released.push_back(mesh);
+        }
+        masters->addObject(master);
+    }
+    
+    for (auto& [parent, replaced] : replacements)
+    {
+        // A replaced parent handed its children to its instance
+        auto             substitute = substitutes.find(parent);
+        MDL::Object*     owner = substitute == substitutes.end() ? parent : substitute->second;
+        NS::Array*       objects = owner->children()->objects();
+        ObjectContainer* container = ObjectContainer::alloc()->init();
+        for (NS::UInteger i = 0, n = objects->count(); i < n; ++i)
+        {
+            MDL::Object* child = objects->object<MDL::Object>(i);
+            auto         it = replaced.find(child);
+            reinterpret_cast<ObjectContainerComponent*>(container)->addObject(it == replaced.end() ? child : it->second);
+        }
+        owner->setChildren(reinterpret_cast<ObjectContainerComponent*>(container));
+        container->release();
+    }
+    
+    // The asset only appends, so everything from the first replaced object
+    // on is taken out and added back in its original order
+    if (!topLevel.empty())
+    {
+        const NS::UInteger        count = this->count();
+        std::vector<MDL::Object*> tail;
+        for (NS::UInteger i = 0; i < count; ++i)
+        {
+            MDL::Object* object = objectAtIndex(i);
+            if (tail.empty() && !topLevel.count(object))
+            {
+                continue;
+            }
+            object->retain();
+            tail.push_back(object);
+        }
+        for (MDL::Object* object : tail)
+        {
+            removeObject(object);
+        }
+        for (MDL::Object* object : tail)
+        {
+            auto it = topLevel.find(object);
+            addObject(it == topLevel.end() ? object : it->second);
+            object->release();
+        }
+    }
+    
+    // The masters leave the hierarchy and the copies are gone; drop what the
+    // native caches still hold for either
+    for (MDL::Object* mesh : released)
+    {
+        graph.remove(graph.find(mesh));
+        Private::BoundsCache::shared().markDirty(mesh);
+        Private::BoundingVolumeHierarchyCache::shared().invalidate(mesh);
+        mesh->release();
+    }
+    for (auto& [mesh, instance] : substitutes)
+    {
+        instance->release();
+    }
+    invalidateBoundingVolumeHierarchy();
+    
+    return released.size() - folded;
+}
+
+// native: instanceTableAtTime
+_MDL_INLINE std::shared_ptr<const MDL::InstanceTable> MDL::Asset::instanceTableAtTime(NS::TimeInterval time, bool parallel) const
+{
+    using NodeId = Private::SceneGraph::NodeId;
+    using Matrix = Private::SceneGraph::Matrix;
+    const Private::SceneGraph& graph = Private::SceneGraph::shared();
+    
+    std::shared_ptr<const WorldTransformTable> world = worldTransformsAtTime(time, parallel);
+    const Private::SceneGraph::ClassFilter     meshes = Private::sceneClassFilter(static_cast<Class>(_MDL_PRIVATE_CLS(MDLMesh)));
+    
+    std::shared_ptr<InstanceTable>               table = std::make_shared<InstanceTable>();
+    // By master address, tagged in the low bit when reached through an instance
+    std::unordered_map<std::uintptr_t, std::uint32_t> masterIds;
+    // Meshes each instanced prototype draws, with their transforms relative
+    // to the instance placing it
+    std::unordered_map<MDL::Object*, std::vector<std::pair<MDL::Object*, Matrix>>> prototypes;
+    std::vector<std::uint32_t>                   ids;
+    std::vector<Matrix>                          matrices;
+    std::vector<NodeId>                          nodes;
+    std::vector<char>                            hidden(graph.capacity(), 0);
+    table->_time = time;
+    
+    const auto masterId = [&](MDL::Object* master, bool instanced)
+    {
+        auto [it, inserted] = masterIds.emplace(reinterpret_cast<std::uintptr_t>(master) | std::uintptr_t(instanced),
+                                                std::uint32_t(table->_masters.size()));
+        if (inserted)
+        {
+            table->_masters.push_back(reinterpret_cast<Mesh*>(master));
+        }
+        return it->second;
+    };
+    
+    // The prototype and its subtree, under the prototype's own transform;
+    // instances inside it are followed as well, up to a depth that also
+    // stops instance cycles
+    const auto expand = [&](MDL::Object* prototype) -> const std::vector<std::pair<MDL::Object*, Matrix>>&
+    {
+        auto [it, inserted] = prototypes.emplace(prototype, std::vector<std::pair<MDL::Object*, Matrix>>());
+        if (!inserted)
+        {
+            return it->second;
+        }
+        
+        constexpr NS::UInteger MaxInstanceDepth = 16;
+        Matrix                 identity = {};
+        identity.columns[0] = identity.columns[5] = identity.columns[10] = identity.columns[15] = 1.0f;
+        
+        struct Visit
+        {
+            MDL::Object*       object;
+            Matrix             parentMatrix;
+            NS::UInteger       depth;
+        };
+        std::vector<Visit> pending = { { prototype, identity, 0 } };
+        while (!pending.empty())
+        {
+            const auto [object, parentMatrix, depth] = pending.back();
+            pending.pop_back();
+            if (object->hidden())
+            {
+                continue;
+            }
+            
+            Matrix matrix = parentMatrix;
+            if (TransformComponent* transform = object->transform())
+            {
+                Matrix                local;
+                const matrix_float4x4 value = transform->localTransformAtTime(time);
+                std::memcpy(local.columns, &value, sizeof(local.columns));
+                Private::WorldTransformCache::multiply(parentMatrix, local, matrix);
+            }
+            if (Object::sendMessage<BOOL>(object, _MDL_PRIVATE_SEL(isKindOfClass_), _MDL_PRIVATE_CLS(MDLMesh)))
+            {
+                it->second.push_back({ object, matrix });
+            }
+            if (MDL::Object* original = object->instance(); original && depth < MaxInstanceDepth)
+            {
+                pending.push_back({ original, matrix, depth + 1 });
+            }
+            ObjectContainerComponent* children = object->children();
+            NS::Array*                objects = children ? children->objects() : nullptr;
+            // Pushed last first, so meshes come out in child order
+            for (NS::UInteger c = objects ? objects->count() : 0; c-- > 0;)
+            {
+                pending.push_back({ objects->object<MDL::Object>(c), matrix, depth });
+            }
+        }
+        return it->second;
+    };
+    
+    for (NS::UInteger i = 0; i < world->count(); ++i)
+    {
+        const NodeId node = world->nodes()[i];
+        const NodeId parent = graph.parent(node);
+        hidden[node] = (graph.flags(node) & Private::SceneGraph::FlagHidden) || (parent != Private::SceneGraph::InvalidNode && hidden[parent]);
+        if (hidden[node] || (graph.flags(node) & Private::SceneGraph::FlagContainer))
+        {
+            continue;
+        }
+        
+        MDL::Object*                        object = static_cast<MDL::Object*>(const_cast<void*>(graph.object(node)));
+        const Private::SceneGraph::ClassId  classId = graph.classId(node);
+        if (classId < meshes.accepted.size() && meshes.accepted[classId])
+        {
+            ids.push_back(masterId(object, false));
+            nodes.push_back(node);
+            matrices.push_back(world->matrices()[i]);
+        }
+        if (MDL::Object* prototype = object->instance())
+        {
+            for (const auto& [mesh, relative] : expand(prototype))
+            {
+                ids.push_back(masterId(mesh, true));
+                nodes.push_back(node);
+                matrices.emplace_back();
+                Private::WorldTransformCache::multiply(world->matrices()[i], relative, matrices.back());
+            }
+        }
+    }
+    
+    // Counting sort by master, stable within each
+    table->_offsets.assign(table->_masters.size() + 1, 0);
+    for (std::uint32_t id : ids)
+    {
+        ++table->_offsets[id + 1];
+    }
+    for (NS::UInteger m = 0; m < table->_masters.size(); ++m)
+    {
+        table->_offsets[m + 1] += table->_offsets[m];
+    }
+    
+    std::vector<std::uint32_t> cursor(table->_offsets.begin(), table->_offsets.end() - 1);
+    table->_masterIds.resize(ids.size());
+    table->_matrices.resize(ids.size());
+    table->_nodes.resize(ids.size());
+    for (NS::UInteger i = 0; i < ids.size(); ++i)
+    {
+        const std::uint32_t slot = cursor[ids[i]]++;
+        table->_masterIds[slot] = ids[i];
+        table->_matrices[slot] = matrices[i];
+        table->_nodes[slot] = nodes[i];
+    }
+    return table;
+}
+
+// native: invalidateSceneGraph
+_MDL_INLINE void MDL::Asset::invalidateSceneGraph() const
+{
+    Private::SceneGraph& graph = Private::SceneGraph::shared();
+    graph.remove(graph.findContainer(this));
+}
+
+
 // MARK: - Original Header
 
 ////////#import <ModelIO/ModelIOExports.h>
@@ -0,0 +1,1311 @@
+/*!
+ @header MDLBoundingVolumeHierarchy.hpp
+ @framework ModelIO
+ @abstract Four-wide bounding volume hierarchy over triangle lists
+ @copyright Treata Norouzi on 10/19/26.
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include "MDLDefines.hpp"
+#include "MDLObjectLifetime.hpp"
+#include "MDLParallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define _MDL_BVH_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define _MDL_BVH_NEON 1
+#endif
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace MDL
+{
+// Built with binned SAH; every node holds the bounds of up to four children
+// side by side so a ray or box is tested against all of them at once. Leaves
+// hold at most `MaxLeafSize` triangles. Triangle ids reported by queries are
+// positions in the source triangle list.
+class BoundingVolumeHierarchy
+{
+public:
+    struct Bounds
+    {
+        float                               min[3];
+        float                               max[3];
+    };
+
+    struct Ray
+    {
+        float                               origin[3];
+        float                               direction[3];
+        float                               tMin;
+        float                               tMax;
+    };
+
+    struct Hit
+    {
+        // InvalidTriangle when nothing was hit
+        std::uint32_t                       triangle;
+        float                               t;
+        // Barycentrics of the second and third corner
+        float                               u;
+        float                               v;
+    };
+
+    struct Closest
+    {
+        // InvalidTriangle when no triangle lies within the search distance
+        std::uint32_t                       triangle;
+        float                               point[3];
+        float                               distanceSquared;
+    };
+
+    static constexpr std::uint32_t          InvalidTriangle = std::numeric_limits<std::uint32_t>::max();
+    static constexpr NS::UInteger           MaxLeafSize = 4;
+
+    // positions are three floats per vertex, `positionStride` bytes apart;
+    // `indices` is a triangle list. `rangeOffsets` optionally lists the first
+    // triangle of each submesh or mesh that was concatenated into the list.
+    static std::shared_ptr<BoundingVolumeHierarchy> build(const float* positions,
+                                                          NS::UInteger positionStride,
+                                                          NS::UInteger vertexCount,
+                                                          const std::uint32_t* indices,
+                                                          NS::UInteger indexCount,
+                                                          std::vector<std::uint32_t> rangeOffsets = {});
+
+    NS::UInteger                            vertexCount() const;
+    NS::UInteger                            triangleCount() const;
+    NS::UInteger                            nodeCount() const;
+    Bounds                                  bounds() const;
+
+    NS::UInteger                            rangeCount() const;
+    // Range a triangle came from and its index within that range
+    NS::UInteger                            rangeOfTriangle(std::uint32_t triangle, std::uint32_t* localTriangle = nullptr) const;
+
+    // Closest hit within [tMin, tMax]
+    bool                                    intersect(const Ray& ray, Hit& hit) const;
+    // Any hit within [tMin, tMax]
+    bool                                    occluded(const Ray& ray) const;
+    // Closest hits for a batch of rays, spread over the worker pool
+    void                                    intersect(const Ray* rays, NS::UInteger count, Hit* hits) const;
+
+    // Nearest point on any triangle to `point`, no further than `maxDistance`
+    bool                                    closestPoint(const float* point, float maxDistance, Closest& closest) const;
+
+    // fn(triangle) for every triangle whose bounds overlap `box`
+    template <typename _Fn>
+    void                                    overlap(const Bounds& box, _Fn&& fn) const;
+    void                                    overlap(const Bounds& box, std::vector<std::uint32_t>& triangles) const;
+
+    // Recomputes every bound for moved vertices; the tree shape is kept, so
+    // quality degrades with large deformations and a rebuild is preferable.
+    // Not safe to call while other threads query the hierarchy.
+    void                                    refit(const float* positions, NS::UInteger positionStride);
+
+private:
+    struct alignas(16) Node
+    {
+        float                               minX[4];
+        float                               minY[4];
+        float                               minZ[4];
+        float                               maxX[4];
+        float                               maxY[4];
+        float                               maxZ[4];
+        // Child node, or first triangle of a leaf when `count` is non-zero
+        std::uint32_t                       child[4];
+        std::uint32_t                       count[4];
+    };
+
+    struct BuildRange
+    {
+        std::uint32_t                       begin;
+        std::uint32_t                       end;
+        std::uint32_t                       mid;
+        Bounds                              bounds;
+    };
+
+    struct Deferred
+    {
+        std::uint32_t                       node;
+        std::uint32_t                       lane;
+        BuildRange                          range;
+    };
+
+    struct BuildState
+    {
+        std::vector<Bounds>                 triangleBounds;
+        std::vector<float>                  centroids;
+        std::vector<std::uint32_t>          order;
+    };
+
+    static constexpr std::uint32_t          EmptyLane = std::numeric_limits<std::uint32_t>::max();
+    static constexpr NS::UInteger           BinCount = 16;
+    static constexpr NS::UInteger           MaxSahDepth = 48;
+    static constexpr NS::UInteger           StackSize = 256;
+
+    NS::UInteger                            _vertexCount = 0;
+    std::vector<float>                      _positions;
+    std::vector<std::uint32_t>              _triangles;
+    std::vector<std::uint32_t>              _triangleIds;
+    std::vector<Node>                       _nodes;
+    std::vector<std::uint32_t>              _rangeOffsets;
+
+    void                                    evaluate(BuildState& state, BuildRange& range, NS::UInteger depth) const;
+    void                                    buildTree(BuildState& state, std::vector<Node>& nodes, const BuildRange& root,
+                                                      std::vector<Deferred>* deferred, NS::UInteger deferBelow) const;
+
+    Bounds                                  triangleBounds(std::uint32_t slot) const;
+    bool                                    intersectTriangle(std::uint32_t slot, const Ray& ray, float tMax,
+                                                              float& t, float& u, float& v) const;
+
+    void                                    closestPointOnTriangle(std::uint32_t slot, const float* point, float* closest) const;
+
+    template <bool _AnyHit>
+    bool                                    traverse(const Ray& ray, Hit& hit) const;
+};
+
+namespace Private
+{
+    // Caches hierarchies per owning object (a Mesh or an Asset). The topology
+    // part of the key decides between refitting and rebuilding. Entries are
+    // evicted when their owner is deallocated.
+    class BoundingVolumeHierarchyCache
+    {
+    public:
+        struct Key
+        {
+            std::uint64_t                   topology;
+            std::uint64_t                   vertices;
+            double                          time;
+        };
+
+        static BoundingVolumeHierarchyCache&            shared();
+
+        std::shared_ptr<BoundingVolumeHierarchy>        find(const void* owner, const Key& key);
+        // Entry whose topology still matches, whatever its vertex state
+        std::shared_ptr<BoundingVolumeHierarchy>        findTopology(const void* owner, const Key& key);
+        void                                            store(const void* owner, const Key& key,
+                                                              std::shared_ptr<BoundingVolumeHierarchy> hierarchy);
+        void                                            invalidate(const void* owner);
+
+    private:
+        struct Entry
+        {
+            Key                                         key;
+            std::shared_ptr<BoundingVolumeHierarchy>    hierarchy;
+        };
+
+        std::mutex                                      _mutex;
+        std::unordered_map<const void*, Entry>          _entries;
+    };
+
+    // Folds a buffer identity and its fill generation into a cache key
+    std::uint64_t                           hashCombine(std::uint64_t seed, std::uint64_t value);
+
+} // Private
+} // MDL
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// MARK: - Private Sector
+
+namespace MDL
+{
+namespace Private
+{
+    _MDL_INLINE void                        growBounds(BoundingVolumeHierarchy::Bounds& bounds, const float* p)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            bounds.min[axis] = std::min(bounds.min[axis], p[axis]);
+            bounds.max[axis] = std::max(bounds.max[axis], p[axis]);
+        }
+    }
+
+    _MDL_INLINE void                        growBounds(BoundingVolumeHierarchy::Bounds& bounds, const BoundingVolumeHierarchy::Bounds& other)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            bounds.min[axis] = std::min(bounds.min[axis], other.min[axis]);
+            bounds.max[axis] = std::max(bounds.max[axis], other.max[axis]);
+        }
+    }
+
+    _MDL_INLINE BoundingVolumeHierarchy::Bounds emptyBounds()
+    {
+        constexpr float inf = std::numeric_limits<float>::infinity();
+        return { { inf, inf, inf }, { -inf, -inf, -inf } };
+    }
+
+    _MDL_INLINE float                       halfArea(const BoundingVolumeHierarchy::Bounds& bounds)
+    {
+        const float dx = bounds.max[0] - bounds.min[0];
+        const float dy = bounds.max[1] - bounds.min[1];
+        const float dz = bounds.max[2] - bounds.min[2];
+        return (dx < 0.0f) ? 0.0f : dx * dy + dy * dz + dz * dx;
+    }
+
+    // Squared distance from `point` to each child box, zero inside
+    template <typename _Node>
+    _MDL_INLINE void                        distanceLanes(const _Node& node, const float* point, float* distanceSquared)
+    {
+#if defined(_MDL_BVH_SSE)
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 px = _mm_set1_ps(point[0]), py = _mm_set1_ps(point[1]), pz = _mm_set1_ps(point[2]);
+        const __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(node.minX), px), _mm_sub_ps(px, _mm_load_ps(node.maxX))), zero);
+        const __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(node.minY), py), _mm_sub_ps(py, _mm_load_ps(node.maxY))), zero);
+        const __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(node.minZ), pz), _mm_sub_ps(pz, _mm_load_ps(node.maxZ))), zero);
+        _mm_storeu_ps(distanceSquared, _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+#elif defined(_MDL_BVH_NEON)
+        const float32x4_t zero = vdupq_n_f32(0.0f);
+        const float32x4_t px = vdupq_n_f32(point[0]), py = vdupq_n_f32(point[1]), pz = vdupq_n_f32(point[2]);
+        const float32x4_t dx = vmaxq_f32(vmaxq_f32(vsubq_f32(vld1q_f32(node.minX), px), vsubq_f32(px, vld1q_f32(node.maxX))), zero);
+        const float32x4_t dy = vmaxq_f32(vmaxq_f32(vsubq_f32(vld1q_f32(node.minY), py), vsubq_f32(py, vld1q_f32(node.maxY))), zero);
+        const float32x4_t dz = vmaxq_f32(vmaxq_f32(vsubq_f32(vld1q_f32(node.minZ), pz), vsubq_f32(pz, vld1q_f32(node.maxZ))), zero);
+        vst1q_f32(distanceSquared, vfmaq_f32(vfmaq_f32(vmulq_f32(dx, dx), dy, dy), dz, dz));
+#else
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            const float dx = std::max(std::max(node.minX[lane] - point[0], point[0] - node.maxX[lane]), 0.0f);
+            const float dy = std::max(std::max(node.minY[lane] - point[1], point[1] - node.maxY[lane]), 0.0f);
+            const float dz = std::max(std::max(node.minZ[lane] - point[2], point[2] - node.maxZ[lane]), 0.0f);
+            distanceSquared[lane] = dx * dx + dy * dy + dz * dz;
+        }
+#endif
+    }
+
+    // Slab test of one ray against the four lanes of a node; returns a lane
+    // mask and writes the entry distances
+    template <typename _Node>
+    _MDL_INLINE unsigned                    intersectLanes(const _Node& node, const float* origin, const float* inverse,
+                                                           float tMin, float tMax, float* entry)
+    {
+#if defined(_MDL_BVH_SSE)
+        const __m128 ox = _mm_set1_ps(origin[0]), oy = _mm_set1_ps(origin[1]), oz = _mm_set1_ps(origin[2]);
+        const __m128 ix = _mm_set1_ps(inverse[0]), iy = _mm_set1_ps(inverse[1]), iz = _mm_set1_ps(inverse[2]);
+
+        const __m128 x0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minX), ox), ix);
+        const __m128 x1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxX), ox), ix);
+        const __m128 y0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minY), oy), iy);
+        const __m128 y1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxY), oy), iy);
+        const __m128 z0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minZ), oz), iz);
+        const __m128 z1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxZ), oz), iz);
+
+        const __m128 nearT = _mm_max_ps(_mm_max_ps(_mm_min_ps(x0, x1), _mm_min_ps(y0, y1)),
+                                        _mm_max_ps(_mm_min_ps(z0, z1), _mm_set1_ps(tMin)));
+        const __m128 farT  = _mm_min_ps(_mm_min_ps(_mm_max_ps(x0, x1), _mm_max_ps(y0, y1)),
+                                        _mm_min_ps(_mm_max_ps(z0, z1), _mm_set1_ps(tMax)));
+        _mm_storeu_ps(entry, nearT);
+        return unsigned(_mm_movemask_ps(_mm_cmple_ps(nearT, farT)));
+#elif defined(_MDL_BVH_NEON)
+        const float32x4_t ox = vdupq_n_f32(origin[0]), oy = vdupq_n_f32(origin[1]), oz = vdupq_n_f32(origin[2]);
+        const float32x4_t ix = vdupq_n_f32(inverse[0]), iy = vdupq_n_f32(inverse[1]), iz = vdupq_n_f32(inverse[2]);
+
+        const float32x4_t x0 = vmulq_f32(vsubq_f32(vld1q_f32(node.minX), ox), ix);
+        const float32x4_t x1 = vmulq_f32(vsubq_f32(vld1q_f32(node.maxX), ox), ix);
+        const float32x4_t y0 = vmulq_f32(vsubq_f32(vld1q_f32(node.minY), oy), iy);
+        const float32x4_t y1 = vmulq_f32(vsubq_f32(vld1q_f32(node.maxY), oy), iy);
+        const float32x4_t z0 = vmulq_f32(vsubq_f32(vld1q_f32(node.minZ), oz), iz);
+        const float32x4_t z1 = vmulq_f32(vsubq_f32(vld1q_f32(node.maxZ), oz), iz);
+
+        const float32x4_t nearT = vmaxq_f32(vmaxq_f32(vminq_f32(x0, x1), vminq_f32(y0, y1)),
+                                            vmaxq_f32(vminq_f32(z0, z1), vdupq_n_f32(tMin)));
+        const float32x4_t farT  = vminq_f32(vminq_f32(vmaxq_f32(x0, x1), vmaxq_f32(y0, y1)),
+                                            vminq_f32(vmaxq_f32(z0, z1), vdupq_n_f32(tMax)));
+        vst1q_f32(entry, nearT);
+
+        const uint32x4_t hit = vcleq_f32(nearT, farT);
+        return (vgetq_lane_u32(hit, 0) & 1) | (vgetq_lane_u32(hit, 1) & 2) |
+               (vgetq_lane_u32(hit, 2) & 4) | (vgetq_lane_u32(hit, 3) & 8);
+#else
+        unsigned mask = 0;
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            const float x0 = (node.minX[lane] - origin[0]) * inverse[0], x1 = (node.maxX[lane] - origin[0]) * inverse[0];
+            const float y0 = (node.minY[lane] - origin[1]) * inverse[1], y1 = (node.maxY[lane] - origin[1]) * inverse[1];
+            const float z0 = (node.minZ[lane] - origin[2]) * inverse[2], z1 = (node.maxZ[lane] - origin[2]) * inverse[2];
+
+            const float nearT = std::max(std::max(std::min(x0, x1), std::min(y0, y1)), std::max(std::min(z0, z1), tMin));
+            const float farT  = std::min(std::min(std::max(x0, x1), std::max(y0, y1)), std::min(std::max(z0, z1), tMax));
+            entry[lane] = nearT;
+            mask |= unsigned(nearT <= farT) << lane;
+        }
+        return mask;
+#endif
+    }
+
+    template <typename _Node>
+    _MDL_INLINE unsigned                    overlapLanes(const _Node& node, const BoundingVolumeHierarchy::Bounds& box)
+    {
+#if defined(_MDL_BVH_SSE)
+        __m128 inside = _mm_and_ps(_mm_cmple_ps(_mm_load_ps(node.minX), _mm_set1_ps(box.max[0])),
+                                   _mm_cmpge_ps(_mm_load_ps(node.maxX), _mm_set1_ps(box.min[0])));
+        inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmple_ps(_mm_load_ps(node.minY), _mm_set1_ps(box.max[1])),
+                                               _mm_cmpge_ps(_mm_load_ps(node.maxY), _mm_set1_ps(box.min[1]))));
+        inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmple_ps(_mm_load_ps(node.minZ), _mm_set1_ps(box.max[2])),
+                                               _mm_cmpge_ps(_mm_load_ps(node.maxZ), _mm_set1_ps(box.min[2]))));
+        return unsigned(_mm_movemask_ps(inside));
+#else
+        unsigned mask = 0;
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            const bool inside = node.minX[lane] <= box.max[0] && node.maxX[lane] >= box.min[0] &&
+                                node.minY[lane] <= box.max[1] && node.maxY[lane] >= box.min[1] &&
+                                node.minZ[lane] <= box.max[2] && node.maxZ[lane] >= box.min[2];
+            mask |= unsigned(inside) << lane;
+        }
+        return mask;
+#endif
+    }
+
+} // Private
+} // MDL
+
+// MARK: BoundingVolumeHierarchy
+
+// static native: build
+_MDL_INLINE std::shared_ptr<MDL::BoundingVolumeHierarchy> MDL::BoundingVolumeHierarchy::build(const float* positions,
+                                                                                              NS::UInteger positionStride,
+                                                                                              NS::UInteger vertexCount,
+                                                                                              const std::uint32_t* indices,
+                                                                                              NS::UInteger indexCount,
+                                                                                              std::vector<std::uint32_t> rangeOffsets)
+{
+    std::shared_ptr<BoundingVolumeHierarchy> bvh = std::make_shared<BoundingVolumeHierarchy>();
+    bvh->_vertexCount = vertexCount;
+    bvh->_rangeOffsets = std::move(rangeOffsets);
+    bvh->_positions.resize(vertexCount * 3);
+
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(positions);
+    for (NS::UInteger i = 0; i < vertexCount; ++i)
+    {
+        std::memcpy(&bvh->_positions[i * 3], bytes + i * positionStride, sizeof(float) * 3);
+    }
+
+    // Triangles referencing vertices out of range are dropped from the tree
+    const NS::UInteger sourceCount = indexCount / 3;
+    std::vector<std::uint32_t> valid;
+    valid.reserve(sourceCount);
+    for (NS::UInteger t = 0; t < sourceCount; ++t)
+    {
+        if (indices[t * 3] < vertexCount && indices[t * 3 + 1] < vertexCount && indices[t * 3 + 2] < vertexCount)
+        {
+            valid.push_back(std::uint32_t(t));
+        }
+    }
+
+    const NS::UInteger triangleCount = valid.size();
+    BuildState state;
+    state.triangleBounds.resize(triangleCount);
+    state.centroids.resize(triangleCount * 3);
+    state.order.resize(triangleCount);
+
+    Private::parallelFor(triangleCount, 4096, [&](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger i = begin; i < end; ++i)
+        {
+            Bounds bounds = Private::emptyBounds();
+            for (NS::UInteger corner = 0; corner < 3; ++corner)
+            {
+                Private::growBounds(bounds, &bvh->_positions[indices[valid[i] * 3 + corner] * 3]);
+            }
+            state.triangleBounds[i] = bounds;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                state.centroids[i * 3 + axis] = 0.5f * (bounds.min[axis] + bounds.max[axis]);
+            }
+            state.order[i] = std::uint32_t(i);
+        }
+    });
+
+    BuildRange root = { 0, std::uint32_t(triangleCount), 0, Private::emptyBounds() };
+    bvh->evaluate(state, root, 0);
+
+    // The top of the tree is built with parallel binning; subtrees below
+    // `deferBelow` triangles are then built independently and spliced in
+    const NS::UInteger threads = Private::ThreadPool::shared().threadCount();
+    const NS::UInteger deferBelow = (threads > 1) ? std::max<NS::UInteger>(triangleCount / (threads * 8), 4096) : 0;
+
+    std::vector<Deferred> deferred;
+    bvh->buildTree(state, bvh->_nodes, root, (threads > 1) ? &deferred : nullptr, deferBelow);
+
+    std::vector<std::vector<Node>> subtrees(deferred.size());
+    Private::parallelFor(deferred.size(), 1, [&](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger i = begin; i < end; ++i)
+        {
+            bvh->buildTree(state, subtrees[i], deferred[i].range, nullptr, 0);
+        }
+    });
+
+    for (NS::UInteger i = 0; i < deferred.size(); ++i)
+    {
+        const std::uint32_t base = std::uint32_t(bvh->_nodes.size());
+        for (Node& node : subtrees[i])
+        {
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                if (node.count[lane] == 0 && node.child[lane] != EmptyLane)
+                {
+                    node.child[lane] += base;
+                }
+            }
+            bvh->_nodes.push_back(node);
+        }
+        bvh->_nodes[deferred[i].node].child[deferred[i].lane] = base;
+    }
+
+    // Lay the triangles out in leaf order so leaves read them contiguously
+    bvh->_triangles.resize(triangleCount * 3);
+    bvh->_triangleIds.resize(triangleCount);
+    for (NS::UInteger slot = 0; slot < triangleCount; ++slot)
+    {
+        const std::uint32_t source = valid[state.order[slot]];
+        bvh->_triangleIds[slot] = source;
+        std::memcpy(&bvh->_triangles[slot * 3], indices + source * 3, sizeof(std::uint32_t) * 3);
+    }
+
+    return bvh;
+}
+
+_MDL_INLINE void MDL::BoundingVolumeHierarchy::evaluate(BuildState& state, BuildRange& range, NS::UInteger depth) const
+{
+    struct Bin
+    {
+        Bounds          bounds;
+        std::uint32_t   count;
+    };
+
+    struct Partial
+    {
+        Bounds          bounds;
+        Bounds          centroidBounds;
+        Bin             bins[3][BinCount];
+    };
+
+    const NS::UInteger count = range.end - range.begin;
+    // Small ranges get fewer bins; there is nothing to gain from empty ones
+    const NS::UInteger binCount = std::min<NS::UInteger>(BinCount, std::max<NS::UInteger>(count, 4));
+
+    constexpr NS::UInteger kGrain = 1 << 14;
+    const NS::UInteger     chunkCount = std::max<NS::UInteger>((count + kGrain - 1) / kGrain, 1);
+
+    // Ranges that fit one chunk, which is nearly all of them, stay off the heap
+    Partial              local;
+    std::vector<Partial> shared((chunkCount > 1) ? chunkCount : 0);
+    Partial*             partials = (chunkCount > 1) ? shared.data() : &local;
+
+    auto forChunks = [&](auto&& fn)
+    {
+        if (chunkCount == 1)
+        {
+            fn(local, range.begin, range.end);
+            return;
+        }
+        Private::parallelFor(count, kGrain, [&](NS::UInteger begin, NS::UInteger end)
+        {
+            fn(partials[begin / kGrain], range.begin + begin, range.begin + end);
+        });
+    };
+
+    // Pass one: range and centroid bounds
+    forChunks([&](Partial& partial, NS::UInteger begin, NS::UInteger end)
+    {
+        partial.bounds = Private::emptyBounds();
+        partial.centroidBounds = Private::emptyBounds();
+        for (NS::UInteger i = begin; i < end; ++i)
+        {
+            const std::uint32_t triangle = state.order[i];
+            Private::growBounds(partial.bounds, state.triangleBounds[triangle]);
+            Private::growBounds(partial.centroidBounds, &state.centroids[triangle * 3]);
+        }
+    });
+
+    Bounds centroidBounds = Private::emptyBounds();
+    range.bounds = Private::emptyBounds();
+    for (NS::UInteger chunk = 0; chunk < chunkCount; ++chunk)
+    {
+        Private::growBounds(range.bounds, partials[chunk].bounds);
+        Private::growBounds(centroidBounds, partials[chunk].centroidBounds);
+    }
+
+    range.mid = range.end;
+    if (count <= 1)
+    {
+        return;
+    }
+
+    float extent[3], scale[3];
+    bool  degenerate = true;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        extent[axis] = centroidBounds.max[axis] - centroidBounds.min[axis];
+        scale[axis] = (extent[axis] > 0.0f) ? float(binCount) / extent[axis] : 0.0f;
+        degenerate = degenerate && !(extent[axis] > 0.0f);
+    }
+
+    // Identical centroids, or a runaway branch: halve the range and move on
+    if (degenerate || depth >= MaxSahDepth)
+    {
+        if (count > MaxLeafSize)
+        {
+            range.mid = range.begin + std::uint32_t(count / 2);
+        }
+        return;
+    }
+
+    auto binOf = [&](std::uint32_t triangle, int axis)
+    {
+        const float offset = (state.centroids[triangle * 3 + axis] - centroidBounds.min[axis]) * scale[axis];
+        return std::min<NS::UInteger>(NS::UInteger(std::max(offset, 0.0f)), binCount - 1);
+    };
+
+    // Pass two: per-axis bins
+    forChunks([&](Partial& partial, NS::UInteger begin, NS::UInteger end)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            for (NS::UInteger b = 0; b < binCount; ++b)
+            {
+                partial.bins[axis][b] = { Private::emptyBounds(), 0 };
+            }
+        }
+        for (NS::UInteger i = begin; i < end; ++i)
+        {
+            const std::uint32_t triangle = state.order[i];
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                if (scale[axis] > 0.0f)
+                {
+                    Bin& bin = partial.bins[axis][binOf(triangle, axis)];
+                    Private::growBounds(bin.bounds, state.triangleBounds[triangle]);
+                    ++bin.count;
+                }
+            }
+        }
+    });
+
+    float        bestCost = std::numeric_limits<float>::infinity();
+    int          bestAxis = -1;
+    NS::UInteger bestSplit = 0;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (!(scale[axis] > 0.0f))
+        {
+            continue;
+        }
+
+        Bin bins[BinCount];
+        for (NS::UInteger b = 0; b < binCount; ++b)
+        {
+            bins[b] = partials[0].bins[axis][b];
+            for (NS::UInteger chunk = 1; chunk < chunkCount; ++chunk)
+            {
+                Private::growBounds(bins[b].bounds, partials[chunk].bins[axis][b].bounds);
+                bins[b].count += partials[chunk].bins[axis][b].count;
+            }
+        }
+
+        // Sweep from the right, then evaluate each plane from the left
+        float        rightCost[BinCount];
+        Bounds       accumulated = Private::emptyBounds();
+        NS::UInteger accumulatedCount = 0;
+        for (NS::UInteger b = binCount - 1; b > 0; --b)
+        {
+            Private::growBounds(accumulated, bins[b].bounds);
+            accumulatedCount += bins[b].count;
+            rightCost[b] = Private::halfArea(accumulated) * float(accumulatedCount);
+        }
+
+        accumulated = Private::emptyBounds();
+        accumulatedCount = 0;
+        for (NS::UInteger b = 1; b < binCount; ++b)
+        {
+            Private::growBounds(accumulated, bins[b - 1].bounds);
+            accumulatedCount += bins[b - 1].count;
+            if (accumulatedCount == 0 || accumulatedCount == count)
+            {
+                continue;
+            }
+            const float cost = Private::halfArea(accumulated) * float(accumulatedCount) + rightCost[b];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = b;
+            }
+        }
+    }
+
+    // A leaf costs one triangle test per triangle; a split adds a node visit
+    const float leafCost = Private::halfArea(range.bounds) * float(count);
+    const float splitCost = Private::halfArea(range.bounds) * 0.5f + bestCost;
+    if (bestAxis < 0 || (count <= MaxLeafSize && leafCost <= splitCost))
+    {
+        if (count > MaxLeafSize)
+        {
+            range.mid = range.begin + std::uint32_t(count / 2);
+        }
+        return;
+    }
+
+    std::uint32_t* middle = std::partition(state.order.data() + range.begin, state.order.data() + range.end,
+                                           [&](std::uint32_t triangle) { return binOf(triangle, bestAxis) < bestSplit; });
+    range.mid = std::uint32_t(middle - state.order.data());
+}
+
+_MDL_INLINE void MDL::BoundingVolumeHierarchy::buildTree(BuildState& state,
+                                                         std::vector<Node>& nodes,
+                                                         const BuildRange& root,
+                                                         std::vector<Deferred>* deferred,
+                                                         NS::UInteger deferBelow) const
+{
+    struct Pending
+    {
+        BuildRange      range;
+        NS::UInteger    depth;
+        std::uint32_t   parent;
+        std::uint32_t   lane;
+    };
+
+    // Depth-first, so every child is stored after its parent
+    std::vector<Pending> stack = { { root, 0, EmptyLane, 0 } };
+    while (!stack.empty())
+    {
+        const Pending pending = stack.back();
+        stack.pop_back();
+
+        const std::uint32_t index = std::uint32_t(nodes.size());
+        if (pending.parent != EmptyLane)
+        {
+            nodes[pending.parent].child[pending.lane] = index;
+        }
+
+        // Open the range into up to four children, always splitting the largest
+        BuildRange children[4] = { pending.range };
+        NS::UInteger childCount = 1;
+        while (childCount < 4)
+        {
+            int   widest = -1;
+            float widestArea = -1.0f;
+            for (NS::UInteger c = 0; c < childCount; ++c)
+            {
+                const float area = Private::halfArea(children[c].bounds);
+                if (children[c].mid != children[c].end && area > widestArea)
+                {
+                    widest = int(c);
+                    widestArea = area;
+                }
+            }
+            if (widest < 0)
+            {
+                break;
+            }
+
+            BuildRange& parent = children[widest];
+            BuildRange  left = { parent.begin, parent.mid, 0, Private::emptyBounds() };
+            BuildRange  right = { parent.mid, parent.end, 0, Private::emptyBounds() };
+            evaluate(state, left, pending.depth + 1);
+            evaluate(state, right, pending.depth + 1);
+            parent = left;
+            children[childCount++] = right;
+        }
+
+        Node node;
+        for (NS::UInteger lane = 0; lane < 4; ++lane)
+        {
+            const BuildRange& child = children[lane];
+            const Bounds      bounds = (lane < childCount) ? child.bounds : Private::emptyBounds();
+            node.minX[lane] = bounds.min[0];
+            node.minY[lane] = bounds.min[1];
+            node.minZ[lane] = bounds.min[2];
+            node.maxX[lane] = bounds.max[0];
+            node.maxY[lane] = bounds.max[1];
+            node.maxZ[lane] = bounds.max[2];
+            node.child[lane] = EmptyLane;
+            node.count[lane] = 0;
+
+            if (lane >= childCount || child.end == child.begin)
+            {
+                continue;
+            }
+
+            if (child.mid == child.end)
+            {
+                node.child[lane] = child.begin;
+                node.count[lane] = child.end - child.begin;
+            }
+            else if (deferred && child.end - child.begin < deferBelow)
+            {
+                deferred->push_back({ index, std::uint32_t(lane), child });
+            }
+            else
+            {
+                stack.push_back({ child, pending.depth + 2, index, std::uint32_t(lane) });
+            }
+        }
+        nodes.push_back(node);
+    }
+}
+
+// native: vertexCount
+_MDL_INLINE NS::UInteger MDL::BoundingVolumeHierarchy::vertexCount() const
+{
+    return _vertexCount;
+}
+
+// native: triangleCount
+_MDL_INLINE NS::UInteger MDL::BoundingVolumeHierarchy::triangleCount() const
+{
+    return _triangleIds.size();
+}
+
+// native: nodeCount
+_MDL_INLINE NS::UInteger MDL::BoundingVolumeHierarchy::nodeCount() const
+{
+    return _nodes.size();
+}
+
+// native: bounds
+_MDL_INLINE MDL::BoundingVolumeHierarchy::Bounds MDL::BoundingVolumeHierarchy::bounds() const
+{
+    Bounds bounds = Private::emptyBounds();
+    if (_nodes.empty())
+    {
+        return bounds;
+    }
+
+    const Node& root = _nodes.front();
+    for (int lane = 0; lane < 4; ++lane)
+    {
+        if (root.child[lane] != EmptyLane)
+        {
+            const float lo[3] = { root.minX[lane], root.minY[lane], root.minZ[lane] };
+            const float hi[3] = { root.maxX[lane], root.maxY[lane], root.maxZ[lane] };
+            Private::growBounds(bounds, lo);
+            Private::growBounds(bounds, hi);
+        }
+    }
+    return bounds;
+}
+
+// native: rangeCount
+_MDL_INLINE NS::UInteger MDL::BoundingVolumeHierarchy::rangeCount() const
+{
+    return std::max<NS::UInteger>(_rangeOffsets.size(), 1);
+}
+
+// native: rangeOfTriangle
+_MDL_INLINE NS::UInteger MDL::BoundingVolumeHierarchy::rangeOfTriangle(std::uint32_t triangle, std::uint32_t* localTriangle) const
+{
+    auto it = std::upper_bound(_rangeOffsets.begin(), _rangeOffsets.end(), triangle);
+    const NS::UInteger range = (it == _rangeOffsets.begin()) ? 0 : NS::UInteger(it - _rangeOffsets.begin()) - 1;
+    if (localTriangle)
+    {
+        *localTriangle = triangle - (_rangeOffsets.empty() ? 0 : _rangeOffsets[range]);
+    }
+    return range;
+}
+
+_MDL_INLINE MDL::BoundingVolumeHierarchy::Bounds MDL::BoundingVolumeHierarchy::triangleBounds(std::uint32_t slot) const
+{
+    Bounds bounds = Private::emptyBounds();
+    for (NS::UInteger corner = 0; corner < 3; ++corner)
+    {
+        Private::growBounds(bounds, &_positions[_triangles[slot * 3 + corner] * 3]);
+    }
+    return bounds;
+}
+
+// Möller–Trumbore, two-sided
+_MDL_INLINE bool MDL::BoundingVolumeHierarchy::intersectTriangle(std::uint32_t slot, const Ray& ray, float tMax,
+                                                                 float& t, float& u, float& v) const
+{
+    const float* p0 = &_positions[_triangles[slot * 3] * 3];
+    const float* p1 = &_positions[_triangles[slot * 3 + 1] * 3];
+    const float* p2 = &_positions[_triangles[slot * 3 + 2] * 3];
+    const float* d = ray.direction;
+
+    const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+    const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+    const float pv[3] = { d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0] };
+
+    const float det = e1[0] * pv[0] + e1[1] * pv[1] + e1[2] * pv[2];
+    if (det == 0.0f)
+    {
+        return false;
+    }
+
+    const float inv = 1.0f / det;
+    const float tv[3] = { ray.origin[0] - p0[0], ray.origin[1] - p0[1], ray.origin[2] - p0[2] };
+    u = (tv[0] * pv[0] + tv[1] * pv[1] + tv[2] * pv[2]) * inv;
+    if (u < 0.0f || u > 1.0f)
+    {
+        return false;
+    }
+
+    const float qv[3] = { tv[1] * e1[2] - tv[2] * e1[1], tv[2] * e1[0] - tv[0] * e1[2], tv[0] * e1[1] - tv[1] * e1[0] };
+    v = (d[0] * qv[0] + d[1] * qv[1] + d[2] * qv[2]) * inv;
+    if (v < 0.0f || u + v > 1.0f)
+    {
+        return false;
+    }
+
+    t = (e2[0] * qv[0] + e2[1] * qv[1] + e2[2] * qv[2]) * inv;
+    return t >= ray.tMin && t <= tMax;
+}
+
+template <bool _AnyHit>
+_MDL_INLINE bool MDL::BoundingVolumeHierarchy::traverse(const Ray& ray, Hit& hit) const
+{
+    hit.triangle = InvalidTriangle;
+    hit.t = ray.tMax;
+    if (_nodes.empty())
+    {
+        return false;
+    }
+
+    // Keep reciprocals finite so axis-parallel rays never produce 0 * inf
+    float inverse[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float d = ray.direction[axis];
+        inverse[axis] = 1.0f / ((std::fabs(d) > 1e-30f) ? d : std::copysign(1e-30f, d));
+    }
+
+    std::uint32_t stackNode[StackSize];
+    float         stackNear[StackSize];
+    NS::UInteger  top = 0;
+    stackNode[top] = 0;
+    stackNear[top++] = ray.tMin;
+
+    while (top > 0)
+    {
+        --top;
+        if (stackNear[top] > hit.t)
+        {
+            continue;
+        }
+
+        const Node& node = _nodes[stackNode[top]];
+        alignas(16) float entry[4];
+        unsigned mask = Private::intersectLanes(node, ray.origin, inverse, ray.tMin, hit.t, entry);
+
+        std::uint32_t innerNode[4];
+        float         innerNear[4];
+        NS::UInteger  innerCount = 0;
+
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            if (!(mask & (1u << lane)) || node.child[lane] == EmptyLane)
+            {
+                continue;
+            }
+
+            if (node.count[lane] == 0)
+            {
+                innerNode[innerCount] = node.child[lane];
+                innerNear[innerCount++] = entry[lane];
+                continue;
+            }
+
+            for (std::uint32_t slot = node.child[lane], end = slot + node.count[lane]; slot < end; ++slot)
+            {
+                float t, u, v;
+                if (intersectTriangle(slot, ray, hit.t, t, u, v))
+                {
+                    hit = { _triangleIds[slot], t, u, v };
+                    if (_AnyHit)
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+
+        // Push far to near so the nearest child is visited first
+        for (NS::UInteger i = 1; i < innerCount; ++i)
+        {
+            for (NS::UInteger j = i; j > 0 && innerNear[j] > innerNear[j - 1]; --j)
+            {
+                std::swap(innerNear[j], innerNear[j - 1]);
+                std::swap(innerNode[j], innerNode[j - 1]);
+            }
+        }
+        for (NS::UInteger i = 0; i < innerCount && top < StackSize; ++i)
+        {
+            stackNode[top] = innerNode[i];
+            stackNear[top++] = innerNear[i];
+        }
+    }
+
+    return hit.triangle != InvalidTriangle;
+}
+
+// native: intersect
+_MDL_INLINE bool MDL::BoundingVolumeHierarchy::intersect(const Ray& ray, Hit& hit) const
+{
+    return traverse<false>(ray, hit);
+}
+
+// native: occluded
+_MDL_INLINE bool MDL::BoundingVolumeHierarchy::occluded(const Ray& ray) const
+{
+    Hit hit;
+    return traverse<true>(ray, hit);
+}
+
+// native: intersect (batch)
+_MDL_INLINE void MDL::BoundingVolumeHierarchy::intersect(const Ray* rays, NS::UInteger count, Hit* hits) const
+{
+    Private::parallelFor(count, 256, [&](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger i = begin; i < end; ++i)
+        {
+            traverse<false>(rays[i], hits[i]);
+        }
+    });
+}
+
+// native: closestPoint
+_MDL_INLINE bool MDL::BoundingVolumeHierarchy::closestPoint(const float* point, float maxDistance, Closest& closest) const
+{
+    closest.triangle = InvalidTriangle;
+    closest.distanceSquared = maxDistance * maxDistance;
+    if (_nodes.empty())
+    {
+        return false;
+    }
+
+    std::uint32_t stackNode[StackSize];
+    float         stackNear[StackSize];
+    NS::UInteger  top = 0;
+    stackNode[top] = 0;
+    stackNear[top++] = 0.0f;
+
+    while (top > 0)
+    {
+        --top;
+        if (stackNear[top] > closest.distanceSquared)
+        {
+            continue;
+        }
+
+        const Node& node = _nodes[stackNode[top]];
+        alignas(16) float boxDistance[4];
+        Private::distanceLanes(node, point, boxDistance);
+
+        std::uint32_t innerNode[4];
+        float         innerNear[4];
+        NS::UInteger  innerCount = 0;
+
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            if (node.child[lane] == EmptyLane || boxDistance[lane] > closest.distanceSquared)
+            {
+                continue;
+            }
+
+            if (node.count[lane] == 0)
+            {
+                innerNode[innerCount] = node.child[lane];
+                innerNear[innerCount++] = boxDistance[lane];
+                continue;
+            }
+
+            for (std::uint32_t slot = node.child[lane], end = slot + node.count[lane]; slot < end; ++slot)
+            {
+                float       candidate[3];
+                closestPointOnTriangle(slot, point, candidate);
+                const float d[3] = { candidate[0] - point[0], candidate[1] - point[1], candidate[2] - point[2] };
+                const float distanceSquared = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+                if (distanceSquared <= closest.distanceSquared)
+                {
+                    closest.triangle = _triangleIds[slot];
+                    closest.distanceSquared = distanceSquared;
+                    std::memcpy(closest.point, candidate, sizeof(candidate));
+                }
+            }
+        }
+
+        // Push far to near so the nearest child is visited first
+        for (NS::UInteger i = 1; i < innerCount; ++i)
+        {
+            for (NS::UInteger j = i; j > 0 && innerNear[j] > innerNear[j - 1]; --j)
+            {
+                std::swap(innerNear[j], innerNear[j - 1]);
+                std::swap(innerNode[j], innerNode[j - 1]);
+            }
+        }
+        for (NS::UInteger i = 0; i < innerCount && top < StackSize; ++i)
+        {
+            stackNode[top] = innerNode[i];
+            stackNear[top++] = innerNear[i];
+        }
+    }
+
+    return closest.triangle != InvalidTriangle;
+}
+
+// Region by region, as in Ericson's Real-Time Collision Detection 5.1.5
+_MDL_INLINE void MDL::BoundingVolumeHierarchy::closestPointOnTriangle(std::uint32_t slot, const float* point, float* closest) const
+{
+    const float* a = &_positions[_triangles[slot * 3] * 3];
+    const float* b = &_positions[_triangles[slot * 3 + 1] * 3];
+    const float* c = &_positions[_triangles[slot * 3 + 2] * 3];
+
+    auto dot = [](const float* u, const float* v) { return u[0] * v[0] + u[1] * v[1] + u[2] * v[2]; };
+    auto blend = [&](float v, float w)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            closest[axis] = a[axis] + (b[axis] - a[axis]) * v + (c[axis] - a[axis]) * w;
+        }
+    };
+
+    const float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+    const float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+    const float ap[3] = { point[0] - a[0], point[1] - a[1], point[2] - a[2] };
+    const float d1 = dot(ab, ap), d2 = dot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f)
+    {
+        return blend(0.0f, 0.0f);
+    }
+
+    const float bp[3] = { point[0] - b[0], point[1] - b[1], point[2] - b[2] };
+    const float d3 = dot(ab, bp), d4 = dot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3)
+    {
+        return blend(1.0f, 0.0f);
+    }
+
+    const float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+    {
+        return blend(d1 / (d1 - d3), 0.0f);
+    }
+
+    const float cp[3] = { point[0] - c[0], point[1] - c[1], point[2] - c[2] };
+    const float d5 = dot(ab, cp), d6 = dot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6)
+    {
+        return blend(0.0f, 1.0f);
+    }
+
+    const float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+    {
+        return blend(0.0f, d2 / (d2 - d6));
+    }
+
+    const float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f)
+    {
+        const float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        return blend(1.0f - w, w);
+    }
+
+    const float denominator = 1.0f / (va + vb + vc);
+    return blend(vb * denominator, vc * denominator);
+}
+
+template <typename _Fn>
+_MDL_INLINE void MDL::BoundingVolumeHierarchy::overlap(const Bounds& box, _Fn&& fn) const
+{
+    if (_nodes.empty())
+    {
+        return;
+    }
+
+    std::uint32_t stack[StackSize];
+    NS::UInteger  top = 0;
+    stack[top++] = 0;
+
+    while (top > 0)
+    {
+        const Node& node = _nodes[stack[--top]];
+        const unsigned mask = Private::overlapLanes(node, box);
+
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            if (!(mask & (1u << lane)) || node.child[lane] == EmptyLane)
+            {
+                continue;
+            }
+
+            if (node.count[lane] == 0)
+            {
+                if (top < StackSize)
+                {
+                    stack[top++] = node.child[lane];
+                }
+                continue;
+            }
+
+            for (std::uint32_t slot = node.child[lane], end = slot + node.count[lane]; slot < end; ++slot)
+            {
+                const Bounds bounds = triangleBounds(slot);
+                if (bounds.min[0] <= box.max[0] && bounds.max[0] >= box.min[0] &&
+                    bounds.min[1] <= box.max[1] && bounds.max[1] >= box.min[1] &&
+                    bounds.min[2] <= box.max[2] && bounds.max[2] >= box.min[2])
+                {
+                    fn(_triangleIds[slot]);
+                }
+            }
+        }
+    }
+}
+
+// native: overlap
+_MDL_INLINE void MDL::BoundingVolumeHierarchy::overlap(const Bounds& box, std::vector<std::uint32_t>& triangles) const
+{
+    overlap(box, [&](std::uint32_t triangle) { triangles.push_back(triangle); });
+}
+
+// native: refit
+_MDL_INLINE void MDL::BoundingVolumeHierarchy::refit(const float* positions, NS::UInteger positionStride)
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(positions);
+    Private::parallelFor(_vertexCount, 1 << 14, [&](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger i = begin; i < end; ++i)
+        {
+            std::memcpy(&_positions[i * 3], bytes + i * positionStride, sizeof(float) * 3);
+        }
+    });
+
+    auto store = [](Node& node, int lane, const Bounds& bounds)
+    {
+        node.minX[lane] = bounds.min[0];
+        node.minY[lane] = bounds.min[1];
+        node.minZ[lane] = bounds.min[2];
+        node.maxX[lane] = bounds.max[0];
+        node.maxY[lane] = bounds.max[1];
+        node.maxZ[lane] = bounds.max[2];
+    };
+
+    // Leaf lanes are independent; inner lanes follow bottom-up since every
+    // child is stored after its parent
+    Private::parallelFor(_nodes.size(), 256, [&](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger n = begin; n < end; ++n)
+        {
+            Node& node = _nodes[n];
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                if (node.count[lane] == 0)
+                {
+                    continue;
+                }
+                Bounds bounds = Private::emptyBounds();
+                for (std::uint32_t slot = node.child[lane], last = slot + node.count[lane]; slot < last; ++slot)
+                {
+                    Private::growBounds(bounds, triangleBounds(slot));
+                }
+                store(node, lane, bounds);
+            }
+        }
+    });
+
+    for (NS::UInteger n = _nodes.size(); n-- > 0;)
+    {
+        Node& node = _nodes[n];
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            if (node.count[lane] != 0 || node.child[lane] == EmptyLane)
+            {
+                continue;
+            }
+
+            const Node& child = _nodes[node.child[lane]];
+            Bounds bounds = Private::emptyBounds();
+            for (int c = 0; c < 4; ++c)
+            {
+                if (child.child[c] != EmptyLane)
+                {
+                    const float lo[3] = { child.minX[c], child.minY[c], child.minZ[c] };
+                    const float hi[3] = { child.maxX[c], child.maxY[c], child.maxZ[c] };
+                    Private::growBounds(bounds, lo);
+                    Private::growBounds(bounds, hi);
+                }
+            }
+            store(node, lane, bounds);
+        }
+    }
+}
+
+// MARK: BoundingVolumeHierarchyCache
+
+_MDL_INLINE std::uint64_t MDL::Private::hashCombine(std::uint64_t seed, std::uint64_t value)
+{
+    return seed ^ (value + 0x9E3779B97F4A7C15ull + (seed << 6) + (seed >> 2));
+}
+
+_MDL_INLINE MDL::Private::BoundingVolumeHierarchyCache& MDL::Private::BoundingVolumeHierarchyCache::shared()
+{
+    static BoundingVolumeHierarchyCache cache;
+    return cache;
+}
+
+_MDL_INLINE std::shared_ptr<MDL::BoundingVolumeHierarchy> MDL::Private::BoundingVolumeHierarchyCache::find(const void* owner, const Key& key)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _entries.find(owner);
+    if (it == _entries.end())
+    {
+        return nullptr;
+    }
+
+    const Key& cached = it->second.key;
+    if (cached.topology != key.topology || cached.vertices != key.vertices || cached.time != key.time)
+    {
+        return nullptr;
+    }
+    return it->second.hierarchy;
+}
+
+_MDL_INLINE std::shared_ptr<MDL::BoundingVolumeHierarchy> MDL::Private::BoundingVolumeHierarchyCache::findTopology(const void* owner, const Key& key)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _entries.find(owner);
+    if (it == _entries.end() || it->second.key.topology != key.topology)
+    {
+        return nullptr;
+    }
+    return it->second.hierarchy;
+}
+
+_MDL_INLINE void MDL::Private::BoundingVolumeHierarchyCache::store(const void* owner, const Key& key,
+                                                                   std::shared_ptr<BoundingVolumeHierarchy> hierarchy)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries[owner] = Entry { key, std::move(hierarchy) };
+    }
+    ObjectLifetime::watch(owner, this, [](const void* object) { shared().invalidate(object); });
+}
+
+_MDL_INLINE void MDL::Private::BoundingVolumeHierarchyCache::invalidate(const void* owner)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.erase(owner);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,313 @@
+/*!
+ @header MDLBoundsCache.hpp
+ @framework ModelIO
+ @abstract Incrementally invalidated bounding boxes for objects and assets
+ @copyright Treata Norouzi on 10/19/26.
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include "MDLDefines.hpp"
+#include "MDLObjectLifetime.hpp"
+#include "Foundation/NSTypes.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace MDL
+{
+namespace Private
+{
+    // Local bounds per object (or asset), keyed by its address. Every entry
+    // records what it was computed from -- transforms, child containers, vertex
+    // buffers, children -- so a change to any of those drops the entry and
+    // everything that was built on top of it, up to the asset. Entries whose
+    // subtree is animated hold one sample per time asked for; static ones hold
+    // a single sample valid at every time. Cached objects and both ends of every
+    // dependency are watched, and their entries and edges go away with them.
+    class BoundsCache
+    {
+    public:
+        struct Box
+        {
+            float                                   min[3];
+            float                                   max[3];
+        };
+
+        // Samples kept per animated entry; storing one more starts the entry
+        // over from that sample
+        static constexpr NS::UInteger               MaxSamples = 1024;
+
+        static BoundsCache&                         shared();
+
+        static Box                                  emptyBox();
+        static void                                 merge(Box& box, const Box& other);
+        // Box around `box` after an affine transform given as four columns
+        static Box                                  transform(const Box& box, const float* columns, NS::UInteger columnStride);
+
+        bool                                        find(const void* object, double time, Box& box, bool* animated = nullptr);
+        void                                        store(const void* object, double time, bool animated, const Box& box);
+
+        // A change to `source` invalidates `object`; sources are objects,
+        // transform components, child containers and mesh buffers
+        void                                        addDependency(const void* source, const void* object);
+
+        // Drops the entry of `source`, if any, and of everything depending on it
+        void                                        markDirty(const void* source);
+        void                                        clear();
+
+    private:
+        struct Entry
+        {
+            bool                                    animated;
+            // Sorted by time; a single sample when not animated
+            std::vector<std::pair<double, Box>>     samples;
+        };
+
+        std::mutex                                                      _mutex;
+        std::unordered_map<const void*, Entry>                          _entries;
+        std::unordered_map<const void*, std::vector<const void*>>       _dependents;
+        // Reverse edges, so that a deallocated object can be unlinked
+        std::unordered_map<const void*, std::vector<const void*>>       _sources;
+
+        void                                        drop(const void* source);
+        static void                                 evict(const void* object);
+    };
+
+} // Private
+} // MDL
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// MARK: - Private Sector
+
+_MDL_INLINE MDL::Private::BoundsCache& MDL::Private::BoundsCache::shared()
+{
+    static BoundsCache cache;
+    return cache;
+}
+
+_MDL_INLINE MDL::Private::BoundsCache::Box MDL::Private::BoundsCache::emptyBox()
+{
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    return { { inf, inf, inf }, { -inf, -inf, -inf } };
+}
+
+_MDL_INLINE void MDL::Private::BoundsCache::merge(Box& box, const Box& other)
+{
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        box.min[axis] = std::min(box.min[axis], other.min[axis]);
+        box.max[axis] = std::max(box.max[axis], other.max[axis]);
+    }
+}
+
+_MDL_INLINE MDL::Private::BoundsCache::Box MDL::Private::BoundsCache::transform(const Box& box, const float* columns, NS::UInteger columnStride)
+{
+    if (box.min[0] > box.max[0])
+    {
+        return box;
+    }
+
+    // Arvo: each output axis takes the smaller and larger product per input axis
+    Box result;
+    for (int row = 0; row < 3; ++row)
+    {
+        result.min[row] = result.max[row] = columns[3 * columnStride + row];
+        for (int column = 0; column < 3; ++column)
+        {
+            const float m = columns[column * columnStride + row];
+            const float a = m * box.min[column];
+            const float b = m * box.max[column];
+            result.min[row] += std::min(a, b);
+            result.max[row] += std::max(a, b);
+        }
+    }
+    return result;
+}
+
+_MDL_INLINE bool MDL::Private::BoundsCache::find(const void* object, double time, Box& box, bool* animated)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _entries.find(object);
+    if (it == _entries.end() || it->second.samples.empty())
+    {
+        return false;
+    }
+
+    const Entry& entry = it->second;
+    if (animated)
+    {
+        *animated = entry.animated;
+    }
+    if (!entry.animated)
+    {
+        box = entry.samples.front().second;
+        return true;
+    }
+
+    auto sample = std::lower_bound(entry.samples.begin(), entry.samples.end(), time,
+                                   [](const std::pair<double, Box>& s, double t) { return s.first < t; });
+    if (sample == entry.samples.end() || sample->first != time)
+    {
+        return false;
+    }
+    box = sample->second;
+    return true;
+}
+
+_MDL_INLINE void MDL::Private::BoundsCache::store(const void* object, double time, bool animated, const Box& box)
+{
+    ObjectLifetime::watch(object, this, &BoundsCache::evict);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Entry& entry = _entries[object];
+    if (!animated || entry.animated != animated)
+    {
+        entry.samples.clear();
+    }
+    entry.animated = animated;
+
+    auto sample = std::lower_bound(entry.samples.begin(), entry.samples.end(), time,
+                                   [](const std::pair<double, Box>& s, double t) { return s.first < t; });
+    if (sample != entry.samples.end() && sample->first == time)
+    {
+        sample->second = box;
+        return;
+    }
+
+    if (entry.samples.size() >= MaxSamples)
+    {
+        entry.samples.clear();
+        sample = entry.samples.end();
+    }
+    entry.samples.insert(sample, { time, box });
+}
+
+_MDL_INLINE void MDL::Private::BoundsCache::addDependency(const void* source, const void* object)
+{
+    if (!source || !object)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        std::vector<const void*>& dependents = _dependents[source];
+        if (std::find(dependents.begin(), dependents.end(), object) != dependents.end())
+        {
+            return;
+        }
+        dependents.push_back(object);
+        _sources[object].push_back(source);
+    }
+    ObjectLifetime::watch(source, this, &BoundsCache::evict);
+    ObjectLifetime::watch(object, this, &BoundsCache::evict);
+}
+
+_MDL_INLINE void MDL::Private::BoundsCache::markDirty(const void* source)
+{
+    if (!source)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    drop(source);
+}
+
+_MDL_INLINE void MDL::Private::BoundsCache::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.clear();
+    _dependents.clear();
+    _sources.clear();
+}
+
+_MDL_INLINE void MDL::Private::BoundsCache::drop(const void* source)
+{
+    // Dependencies are kept: the graph only changes shape through the same
+    // calls that end up here, and a stale edge merely costs an extra drop
+    // until one of its ends is deallocated
+    std::vector<const void*>        pending = { source };
+    std::unordered_set<const void*> visited = { source };
+    while (!pending.empty())
+    {
+        const void* current = pending.back();
+        pending.pop_back();
+        _entries.erase(current);
+
+        auto it = _dependents.find(current);
+        if (it == _dependents.end())
+        {
+            continue;
+        }
+        for (const void* dependent : it->second)
+        {
+            if (visited.insert(dependent).second)
+            {
+                pending.push_back(dependent);
+            }
+        }
+    }
+}
+
+_MDL_INLINE void MDL::Private::BoundsCache::evict(const void* object)
+{
+    BoundsCache&                cache = shared();
+    std::lock_guard<std::mutex> lock(cache._mutex);
+
+    // What was built on `object` is dropped as well, then both directions of
+    // its edges are unlinked
+    cache.drop(object);
+
+    const auto unlink = [](std::unordered_map<const void*, std::vector<const void*>>& edges,
+                           const void* from, const void* to)
+    {
+        auto it = edges.find(from);
+        if (it == edges.end())
+        {
+            return;
+        }
+        it->second.erase(std::remove(it->second.begin(), it->second.end(), to), it->second.end());
+        if (it->second.empty())
+        {
+            edges.erase(it);
+        }
+    };
+
+    auto dependents = cache._dependents.find(object);
+    if (dependents != cache._dependents.end())
+    {
+        for (const void* dependent : dependents->second)
+        {
+            unlink(cache._sources, dependent, object);
+        }
+        cache._dependents.erase(dependents);
+    }
+
+    auto sources = cache._sources.find(object);
+    if (sources != cache._sources.end())
+    {
+        for (const void* source : sources->second)
+        {
+            unlink(cache._dependents, source, object);
+        }
+        cache._sources.erase(sources);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
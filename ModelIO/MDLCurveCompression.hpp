@@ -0,0 +1,732 @@
+/*!
+ @header MDLCurveCompression.hpp
+ @framework ModelIO
+ @abstract Error-bounded, quantized storage for animated array values
+ @copyright Treata Norouzi on 10/19/26.
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include "MDLDefines.hpp"
+#include "MDLObjectLifetime.hpp"
+#include "Foundation/NSTypes.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define _MDL_CURVE_COMPRESSION_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define _MDL_CURVE_COMPRESSION_NEON 1
+#endif
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace MDL
+{
+struct CurveCompressionSettings
+{
+    // Largest distance between a source value and its decompressed
+    // counterpart, for scalar and vector tracks
+    float                               tolerance = 1.0e-4f;
+    // Largest rotation between a source quaternion and its decompressed
+    // counterpart, in radians
+    float                               angularTolerance = 1.0e-3f;
+};
+
+// The keys of an animated array value in compressed form. Every element is a
+// track of its own: keys that interpolating their kept neighbours reproduces
+// within tolerance are dropped, and the kept values are quantized to 16 bits,
+// against the track's own range for scalars and vectors and as their smallest
+// three components for quaternions. A track that stays within tolerance of
+// one value keeps a single key. Tolerances are met as long as they exceed the
+// quantization step, 1/65535 of a track's range or 4.3e-5 per quaternion
+// component; wider tracks keep every key at that step's precision.
+class CompressedCurve
+{
+public:
+    enum Kind : std::uint8_t
+    {
+        KindScalar,
+        KindVector3,
+        KindQuaternion,
+    };
+
+    // Most source keys one pair of kept keys may span, which bounds the
+    // time compression takes
+    static constexpr NS::UInteger       MaxKeySpan = 64;
+
+    // `values` holds `keyCount` keys of `elementCount` elements, element e
+    // of key k at values + (k * elementCount + e) * stride; quaternions are
+    // x, y, z, w. `linear` is false for values with constant interpolation.
+    static std::shared_ptr<CompressedCurve> compress(Kind kind,
+                                                     const float* values,
+                                                     NS::UInteger stride,
+                                                     NS::UInteger elementCount,
+                                                     const double* times,
+                                                     NS::UInteger keyCount,
+                                                     bool linear,
+                                                     const CurveCompressionSettings& settings);
+
+    Kind                                kind() const;
+    NS::UInteger                        elementCount() const;
+    // Keys of the source
+    NS::UInteger                        keyCount() const;
+    // Keys kept, over all tracks
+    NS::UInteger                        storedKeyCount() const;
+    NS::UInteger                        sizeInBytes() const;
+
+    double                              minimumTime() const;
+    double                              maximumTime() const;
+
+    // Writes up to `maxCount` elements at `time`, `stride` floats apart,
+    // and returns how many were written
+    NS::UInteger                        sample(double time, float* out, NS::UInteger stride, NS::UInteger maxCount) const;
+    // Writes up to `maxCount` elements of the source keys, in the layout
+    // compress() takes, and returns how many were written
+    NS::UInteger                        decompress(float* out, NS::UInteger stride, NS::UInteger maxCount) const;
+
+private:
+    struct Track
+    {
+        // First kept key in _frames, and in _values times three
+        std::uint32_t                   first;
+        std::uint32_t                   count;
+        // value = minimum + quantized * scale, for scalars and vectors
+        float                           minimum[3];
+        float                           scale[3];
+    };
+
+    // Half the range of a smallest-three component, 1 / sqrt(2)
+    static constexpr float              SmallestThreeRange = 0.70710678f;
+
+    static void                         encodeQuaternion(const float* value, std::uint16_t* out);
+    static void                         decodeQuaternion(const std::uint16_t* value, float* out);
+
+    std::uint32_t                       frameAt(std::uint32_t index) const;
+    // Last kept key of `track` at or before `frame`
+    std::uint32_t                       findKey(const Track& track, std::uint32_t frame) const;
+    void                                locate(double time, std::uint32_t& frame, float& fraction) const;
+    void                                decode(const Track& track, std::uint32_t key, float* out) const;
+    void                                evaluate(const Track& track, std::uint32_t key, std::uint32_t frame, float fraction,
+                                                 float* out, NS::UInteger stride) const;
+    void                                blend(const float* a, const float* b, float weight, float* out, NS::UInteger stride) const;
+
+    Kind                                _kind = KindScalar;
+    bool                                _linear = true;
+    NS::UInteger                        _elementCount = 0;
+    NS::UInteger                        _keyCount = 0;
+    // Key k is at _start + k * _interval unless the times are stored
+    double                              _start = 0.0;
+    double                              _interval = 0.0;
+    std::vector<double>                 _times;
+    std::vector<Track>                  _tracks;
+    // Source key index of every kept key, 16 bits wide while they fit
+    std::vector<std::uint16_t>          _frames16;
+    std::vector<std::uint32_t>          _frames32;
+    // Three quantized components per kept key, one for scalars
+    std::vector<std::uint16_t>          _values;
+};
+
+namespace Private
+{
+    // Compressed curves attached to animated array values, by value, until
+    // the value's next edit through the bridge or its deallocation drops
+    // them. The value's own keys stay as they were.
+    class CompressedCurveStore
+    {
+    public:
+        static CompressedCurveStore&                shared();
+
+        std::shared_ptr<const CompressedCurve>      find(const void* value) const;
+        void                                        insert(const void* value, std::shared_ptr<const CompressedCurve> curve);
+        void                                        remove(const void* value);
+        void                                        clear();
+
+    private:
+        static void                                 evict(const void* value);
+
+        mutable std::mutex                          _mutex;
+        std::unordered_map<const void*, std::shared_ptr<const CompressedCurve>> _curves;
+        // Lets lookups skip the lock while nothing is compressed
+        std::atomic<NS::UInteger>                   _count { 0 };
+    };
+
+} // Private
+} // MDL
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// MARK: - Private Sector
+
+_MDL_INLINE std::shared_ptr<MDL::CompressedCurve> MDL::CompressedCurve::compress(Kind kind,
+                                                                                 const float* values,
+                                                                                 NS::UInteger stride,
+                                                                                 NS::UInteger elementCount,
+                                                                                 const double* times,
+                                                                                 NS::UInteger keyCount,
+                                                                                 bool linear,
+                                                                                 const CurveCompressionSettings& settings)
+{
+    auto curve = std::make_shared<CompressedCurve>();
+    curve->_kind = kind;
+    curve->_linear = linear;
+    curve->_elementCount = elementCount;
+    curve->_keyCount = keyCount;
+    if (!keyCount || !elementCount)
+    {
+        return curve;
+    }
+
+    curve->_start = times[0];
+    curve->_interval = keyCount > 1 ? (times[keyCount - 1] - times[0]) / double(keyCount - 1) : 0.0;
+    for (NS::UInteger k = 1; k + 1 < keyCount; ++k)
+    {
+        if (std::abs(times[k] - (curve->_start + double(k) * curve->_interval)) > 1.0e-4 * curve->_interval)
+        {
+            curve->_times.assign(times, times + keyCount);
+            break;
+        }
+    }
+
+    const bool           wideFrames = keyCount > 0x10000;
+    const NS::UInteger   components = kind == KindScalar ? 1 : 3;
+    const float          tolerance2 = settings.tolerance * settings.tolerance;
+    const float          maxChord = 2.0f * std::sin(0.25f * settings.angularTolerance);
+    const float          maxChord2 = maxChord * maxChord;
+    std::vector<float>          source(keyCount * 4);
+    std::vector<std::uint16_t>  quantized(keyCount * 3);
+    std::vector<float>          decoded(keyCount * 4);
+    std::vector<std::uint32_t>  kept;
+    kept.reserve(keyCount);
+
+    // Distance from source key `j` to the curve through kept keys a and b
+    auto withinTolerance = [&](NS::UInteger a, NS::UInteger b, NS::UInteger j)
+    {
+        const float* s = &source[j * 4];
+        const float* da = &decoded[a * 4];
+        const float* db = &decoded[b * 4];
+        const float  u = linear && b != a ? float(j - a) / float(b - a) : 0.0f;
+        if (kind == KindQuaternion)
+        {
+            const float sign = da[0] * db[0] + da[1] * db[1] + da[2] * db[2] + da[3] * db[3] < 0.0f ? -1.0f : 1.0f;
+            float r[4];
+            float length2 = 0.0f;
+            for (int c = 0; c < 4; ++c)
+            {
+                r[c] = da[c] + (sign * db[c] - da[c]) * u;
+                length2 += r[c] * r[c];
+            }
+            // Chord between the unit quaternions; unlike the cosine of the
+            // angle, it keeps its precision for small rotations
+            const float scale = (s[0] * r[0] + s[1] * r[1] + s[2] * r[2] + s[3] * r[3] < 0.0f ? -1.0f : 1.0f) / std::sqrt(length2);
+            float chord2 = 0.0f;
+            for (int c = 0; c < 4; ++c)
+            {
+                const float d = r[c] * scale - s[c];
+                chord2 += d * d;
+            }
+            return chord2 <= maxChord2;
+        }
+        float distance2 = 0.0f;
+        for (NS::UInteger c = 0; c < components; ++c)
+        {
+            const float d = da[c] + (db[c] - da[c]) * u - s[c];
+            distance2 += d * d;
+        }
+        return distance2 <= tolerance2;
+    };
+
+    curve->_tracks.resize(elementCount);
+    for (NS::UInteger e = 0; e < elementCount; ++e)
+    {
+        Track& track = curve->_tracks[e];
+        track = Track {};
+        for (NS::UInteger k = 0; k < keyCount; ++k)
+        {
+            const float* value = values + (k * elementCount + e) * stride;
+            float*       s = &source[k * 4];
+            if (kind == KindQuaternion)
+            {
+                const float length = std::sqrt(value[0] * value[0] + value[1] * value[1] + value[2] * value[2] + value[3] * value[3]);
+                const float inverseLength = length > 0.0f ? 1.0f / length : 0.0f;
+                for (int c = 0; c < 4; ++c)
+                {
+                    s[c] = value[c] * inverseLength;
+                }
+                if (length == 0.0f)
+                {
+                    s[3] = 1.0f;
+                }
+            }
+            else
+            {
+                std::copy(value, value + components, s);
+            }
+        }
+
+        // Range quantization, or smallest three for rotations
+        bool constant = true;
+        if (kind == KindQuaternion)
+        {
+            for (NS::UInteger k = 0; k < keyCount; ++k)
+            {
+                encodeQuaternion(&source[k * 4], &quantized[k * 3]);
+                decodeQuaternion(&quantized[k * 3], &decoded[k * 4]);
+            }
+            for (NS::UInteger k = 1; k < keyCount && constant; ++k)
+            {
+                constant = withinTolerance(0, 0, k);
+            }
+        }
+        else
+        {
+            float lower[3];
+            float upper[3];
+            for (NS::UInteger c = 0; c < components; ++c)
+            {
+                lower[c] = upper[c] = source[c];
+                for (NS::UInteger k = 1; k < keyCount; ++k)
+                {
+                    lower[c] = std::min(lower[c], source[k * 4 + c]);
+                    upper[c] = std::max(upper[c], source[k * 4 + c]);
+                }
+            }
+            float halfExtent2 = 0.0f;
+            for (NS::UInteger c = 0; c < components; ++c)
+            {
+                halfExtent2 += 0.25f * (upper[c] - lower[c]) * (upper[c] - lower[c]);
+            }
+            constant = halfExtent2 <= tolerance2;
+            for (NS::UInteger c = 0; c < components; ++c)
+            {
+                track.minimum[c] = constant ? 0.5f * (lower[c] + upper[c]) : lower[c];
+                track.scale[c] = constant ? 0.0f : (upper[c] - lower[c]) / 65535.0f;
+            }
+            for (NS::UInteger k = 0; k < keyCount; ++k)
+            {
+                for (NS::UInteger c = 0; c < components; ++c)
+                {
+                    const float step = track.scale[c];
+                    const float q = step > 0.0f ? std::round((source[k * 4 + c] - track.minimum[c]) / step) : 0.0f;
+                    quantized[k * 3 + c] = std::uint16_t(std::min(std::max(q, 0.0f), 65535.0f));
+                    decoded[k * 4 + c] = track.minimum[c] + float(quantized[k * 3 + c]) * step;
+                }
+            }
+        }
+
+        // Key reduction: from each kept key, reach as far as the keys in
+        // between stay within tolerance
+        kept.clear();
+        kept.push_back(0);
+        if (!constant)
+        {
+            NS::UInteger anchor = 0;
+            while (anchor + 1 < keyCount)
+            {
+                NS::UInteger reach = anchor + 1;
+                const NS::UInteger limit = std::min(keyCount - 1, anchor + NS::UInteger(MaxKeySpan));
+                for (NS::UInteger candidate = anchor + 2; candidate <= limit; ++candidate)
+                {
+                    bool fits = true;
+                    for (NS::UInteger j = anchor + 1; j < candidate && fits; ++j)
+                    {
+                        fits = withinTolerance(anchor, candidate, j);
+                    }
+                    if (!fits)
+                    {
+                        break;
+                    }
+                    reach = candidate;
+                }
+                kept.push_back(std::uint32_t(reach));
+                anchor = reach;
+            }
+        }
+
+        track.first = std::uint32_t(wideFrames ? curve->_frames32.size() : curve->_frames16.size());
+        track.count = std::uint32_t(kept.size());
+        for (std::uint32_t key : kept)
+        {
+            if (wideFrames)
+            {
+                curve->_frames32.push_back(key);
+            }
+            else
+            {
+                curve->_frames16.push_back(std::uint16_t(key));
+            }
+            for (NS::UInteger c = 0; c < 3; ++c)
+            {
+                curve->_values.push_back(c < components || kind == KindQuaternion ? quantized[key * 3 + c] : 0);
+            }
+        }
+    }
+
+    curve->_frames16.shrink_to_fit();
+    curve->_frames32.shrink_to_fit();
+    curve->_values.shrink_to_fit();
+    return curve;
+}
+
+_MDL_INLINE MDL::CompressedCurve::Kind MDL::CompressedCurve::kind() const
+{
+    return _kind;
+}
+
+_MDL_INLINE NS::UInteger MDL::CompressedCurve::elementCount() const
+{
+    return _elementCount;
+}
+
+_MDL_INLINE NS::UInteger MDL::CompressedCurve::keyCount() const
+{
+    return _keyCount;
+}
+
+_MDL_INLINE NS::UInteger MDL::CompressedCurve::storedKeyCount() const
+{
+    return _frames16.size() + _frames32.size();
+}
+
+_MDL_INLINE NS::UInteger MDL::CompressedCurve::sizeInBytes() const
+{
+    return sizeof(CompressedCurve) + _times.size() * sizeof(double) + _tracks.size() * sizeof(Track) +
+           _frames16.size() * sizeof(std::uint16_t) + _frames32.size() * sizeof(std::uint32_t) +
+           _values.size() * sizeof(std::uint16_t);
+}
+
+_MDL_INLINE double MDL::CompressedCurve::minimumTime() const
+{
+    return _times.empty() ? _start : _times.front();
+}
+
+_MDL_INLINE double MDL::CompressedCurve::maximumTime() const
+{
+    return _times.empty() ? _start + double(_keyCount ? _keyCount - 1 : 0) * _interval : _times.back();
+}
+
+_MDL_INLINE NS::UInteger MDL::CompressedCurve::sample(double time, float* out, NS::UInteger stride, NS::UInteger maxCount) const
+{
+    if (!_keyCount)
+    {
+        return 0;
+    }
+
+    std::uint32_t frame;
+    float         fraction;
+    locate(time, frame, fraction);
+
+    const NS::UInteger count = std::min(maxCount, _elementCount);
+    for (NS::UInteger e = 0; e < count; ++e)
+    {
+        const Track& track = _tracks[e];
+        evaluate(track, findKey(track, frame), frame, fraction, out + e * stride, stride);
+    }
+    return count;
+}
+
+_MDL_INLINE NS::UInteger MDL::CompressedCurve::decompress(float* out, NS::UInteger stride, NS::UInteger maxCount) const
+{
+    const NS::UInteger count = std::min(maxCount, _keyCount * _elementCount);
+
+    // Every track moves forward one source key at a time
+    std::vector<std::uint32_t> keys(_elementCount, 0);
+    NS::UInteger written = 0;
+    for (std::uint32_t frame = 0; written < count; ++frame)
+    {
+        for (NS::UInteger e = 0; e < _elementCount && written < count; ++e, ++written)
+        {
+            const Track&   track = _tracks[e];
+            std::uint32_t& key = keys[e];
+            while (key + 1 < track.count && frameAt(track.first + key + 1) <= frame)
+            {
+                ++key;
+            }
+            evaluate(track, key, frame, 0.0f, out + written * stride, stride);
+        }
+    }
+    return count;
+}
+
+_MDL_INLINE void MDL::CompressedCurve::encodeQuaternion(const float* value, std::uint16_t* out)
+{
+    int largest = 0;
+    for (int c = 1; c < 4; ++c)
+    {
+        if (std::abs(value[c]) > std::abs(value[largest]))
+        {
+            largest = c;
+        }
+    }
+    // q and -q are the same rotation; keeping the dropped component positive
+    // lets it be rebuilt from the other three
+    const float sign = value[largest] < 0.0f ? -1.0f : 1.0f;
+    for (int c = 0, slot = 0; c < 4; ++c)
+    {
+        if (c == largest)
+        {
+            continue;
+        }
+        const float q = std::round((sign * value[c] + SmallestThreeRange) * (32767.0f / (2.0f * SmallestThreeRange)));
+        out[slot++] = std::uint16_t(std::min(std::max(q, 0.0f), 32767.0f));
+    }
+    out[0] |= std::uint16_t((largest & 1) << 15);
+    out[1] |= std::uint16_t((largest >> 1) << 15);
+}
+
+_MDL_INLINE void MDL::CompressedCurve::decodeQuaternion(const std::uint16_t* value, float* out)
+{
+    const int largest = (value[0] >> 15) | ((value[1] >> 15) << 1);
+    float     sum = 0.0f;
+    for (int c = 0, slot = 0; c < 4; ++c)
+    {
+        if (c == largest)
+        {
+            continue;
+        }
+        out[c] = float(value[slot++] & 0x7fff) * (2.0f * SmallestThreeRange / 32767.0f) - SmallestThreeRange;
+        sum += out[c] * out[c];
+    }
+    out[largest] = std::sqrt(std::max(0.0f, 1.0f - sum));
+}
+
+_MDL_INLINE std::uint32_t MDL::CompressedCurve::frameAt(std::uint32_t index) const
+{
+    return _frames32.empty() ? _frames16[index] : _frames32[index];
+}
+
+_MDL_INLINE std::uint32_t MDL::CompressedCurve::findKey(const Track& track, std::uint32_t frame) const
+{
+    // The first kept key is always the first source key
+    if (_frames32.empty())
+    {
+        const std::uint16_t* frames = _frames16.data() + track.first;
+        return std::uint32_t(std::upper_bound(frames + 1, frames + track.count, frame) - frames - 1);
+    }
+    const std::uint32_t* frames = _frames32.data() + track.first;
+    return std::uint32_t(std::upper_bound(frames + 1, frames + track.count, frame) - frames - 1);
+}
+
+_MDL_INLINE void MDL::CompressedCurve::locate(double time, std::uint32_t& frame, float& fraction) const
+{
+    frame = 0;
+    fraction = 0.0f;
+    if (_keyCount < 2 || time <= minimumTime())
+    {
+        return;
+    }
+    if (time >= maximumTime())
+    {
+        frame = std::uint32_t(_keyCount - 1);
+        return;
+    }
+
+    double position;
+    if (_times.empty())
+    {
+        position = (time - _start) / _interval;
+    }
+    else
+    {
+        const NS::UInteger key = std::upper_bound(_times.begin(), _times.end(), time) - _times.begin() - 1;
+        position = double(key) + (time - _times[key]) / (_times[key + 1] - _times[key]);
+    }
+    frame = std::min(std::uint32_t(position), std::uint32_t(_keyCount - 1));
+    fraction = float(position - double(frame));
+    // Times computed as start + k * interval may land just short of key k
+    if (fraction > 1.0f - 1.0e-5f)
+    {
+        frame = std::min(frame + 1, std::uint32_t(_keyCount - 1));
+        fraction = 0.0f;
+    }
+    if (!_linear)
+    {
+        fraction = 0.0f;
+    }
+}
+
+_MDL_INLINE void MDL::CompressedCurve::decode(const Track& track, std::uint32_t key, float* out) const
+{
+    const std::uint16_t* value = _values.data() + (NS::UInteger(track.first) + key) * 3;
+    if (_kind == KindQuaternion)
+    {
+        decodeQuaternion(value, out);
+        return;
+    }
+#if defined(_MDL_CURVE_COMPRESSION_SSE)
+    const __m128i quantized = _mm_setr_epi32(value[0], value[1], value[2], 0);
+    const __m128  minimum = _mm_setr_ps(track.minimum[0], track.minimum[1], track.minimum[2], 0.0f);
+    const __m128  scale = _mm_setr_ps(track.scale[0], track.scale[1], track.scale[2], 0.0f);
+    _mm_storeu_ps(out, _mm_add_ps(minimum, _mm_mul_ps(_mm_cvtepi32_ps(quantized), scale)));
+#elif defined(_MDL_CURVE_COMPRESSION_NEON)
+    const uint16x4_t  quantized = { value[0], value[1], value[2], 0 };
+    const float32x4_t minimum = { track.minimum[0], track.minimum[1], track.minimum[2], 0.0f };
+    const float32x4_t scale = { track.scale[0], track.scale[1], track.scale[2], 0.0f };
+    vst1q_f32(out, vmlaq_f32(minimum, vcvtq_f32_u32(vmovl_u16(quantized)), scale));
+#else
+    for (int c = 0; c < 3; ++c)
+    {
+        out[c] = track.minimum[c] + float(value[c]) * track.scale[c];
+    }
+    out[3] = 0.0f;
+#endif
+}
+
+_MDL_INLINE void MDL::CompressedCurve::evaluate(const Track& track, std::uint32_t key, std::uint32_t frame, float fraction,
+                                                float* out, NS::UInteger stride) const
+{
+    float a[4];
+    decode(track, key, a);
+
+    const float from = float(frameAt(track.first + key));
+    if (!_linear || key + 1 >= track.count || (float(frame) == from && fraction == 0.0f))
+    {
+        blend(a, a, 0.0f, out, stride);
+        return;
+    }
+
+    float b[4];
+    decode(track, key + 1, b);
+    const float to = float(frameAt(track.first + key + 1));
+    blend(a, b, (float(frame) - from + fraction) / (to - from), out, stride);
+}
+
+_MDL_INLINE void MDL::CompressedCurve::blend(const float* a, const float* b, float weight, float* out, NS::UInteger stride) const
+{
+    if (_kind == KindScalar)
+    {
+        out[0] = a[0] + (b[0] - a[0]) * weight;
+        return;
+    }
+
+#if defined(_MDL_CURVE_COMPRESSION_SSE)
+    const __m128 va = _mm_loadu_ps(a);
+    __m128       vb = _mm_loadu_ps(b);
+    if (_kind == KindQuaternion)
+    {
+        // Along the shorter arc, then back onto the unit sphere
+        __m128 dot = _mm_mul_ps(va, vb);
+        dot = _mm_add_ps(dot, _mm_shuffle_ps(dot, dot, _MM_SHUFFLE(2, 3, 0, 1)));
+        dot = _mm_add_ps(dot, _mm_shuffle_ps(dot, dot, _MM_SHUFFLE(1, 0, 3, 2)));
+        vb = _mm_xor_ps(vb, _mm_and_ps(_mm_cmplt_ps(dot, _mm_setzero_ps()), _mm_set1_ps(-0.0f)));
+    }
+    __m128 r = _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), _mm_set1_ps(weight)));
+    if (_kind == KindQuaternion)
+    {
+        __m128 length2 = _mm_mul_ps(r, r);
+        length2 = _mm_add_ps(length2, _mm_shuffle_ps(length2, length2, _MM_SHUFFLE(2, 3, 0, 1)));
+        length2 = _mm_add_ps(length2, _mm_shuffle_ps(length2, length2, _MM_SHUFFLE(1, 0, 3, 2)));
+        r = _mm_div_ps(r, _mm_sqrt_ps(length2));
+    }
+    if (stride >= 4)
+    {
+        _mm_storeu_ps(out, r);
+        return;
+    }
+    float result[4];
+    _mm_storeu_ps(result, r);
+#elif defined(_MDL_CURVE_COMPRESSION_NEON)
+    const float32x4_t va = vld1q_f32(a);
+    float32x4_t       vb = vld1q_f32(b);
+    if (_kind == KindQuaternion)
+    {
+        if (vaddvq_f32(vmulq_f32(va, vb)) < 0.0f)
+        {
+            vb = vnegq_f32(vb);
+        }
+    }
+    float32x4_t r = vmlaq_n_f32(va, vsubq_f32(vb, va), weight);
+    if (_kind == KindQuaternion)
+    {
+        r = vmulq_n_f32(r, 1.0f / std::sqrt(vaddvq_f32(vmulq_f32(r, r))));
+    }
+    if (stride >= 4)
+    {
+        vst1q_f32(out, r);
+        return;
+    }
+    float result[4];
+    vst1q_f32(result, r);
+#else
+    float result[4];
+    const float sign = _kind == KindQuaternion && a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3] < 0.0f ? -1.0f : 1.0f;
+    float length2 = 0.0f;
+    for (int c = 0; c < 4; ++c)
+    {
+        result[c] = a[c] + (sign * b[c] - a[c]) * weight;
+        length2 += result[c] * result[c];
+    }
+    if (_kind == KindQuaternion)
+    {
+        const float inverseLength = 1.0f / std::sqrt(length2);
+        for (int c = 0; c < 4; ++c)
+        {
+            result[c] *= inverseLength;
+        }
+    }
+#endif
+    std::copy(result, result + std::min<NS::UInteger>(stride, _kind == KindQuaternion ? 4 : 3), out);
+}
+
+_MDL_INLINE MDL::Private::CompressedCurveStore& MDL::Private::CompressedCurveStore::shared()
+{
+    static CompressedCurveStore store;
+    return store;
+}
+
+_MDL_INLINE std::shared_ptr<const MDL::CompressedCurve> MDL::Private::CompressedCurveStore::find(const void* value) const
+{
+    if (!_count.load(std::memory_order_acquire))
+    {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _curves.find(value);
+    return it == _curves.end() ? nullptr : it->second;
+}
+
+_MDL_INLINE void MDL::Private::CompressedCurveStore::insert(const void* value, std::shared_ptr<const CompressedCurve> curve)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _curves[value] = std::move(curve);
+        _count.store(_curves.size(), std::memory_order_release);
+    }
+    ObjectLifetime::watch(value, this, &CompressedCurveStore::evict);
+}
+
+_MDL_INLINE void MDL::Private::CompressedCurveStore::remove(const void* value)
+{
+    if (!_count.load(std::memory_order_acquire))
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    _curves.erase(value);
+    _count.store(_curves.size(), std::memory_order_release);
+}
+
+_MDL_INLINE void MDL::Private::CompressedCurveStore::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _curves.clear();
+    _count.store(0, std::memory_order_release);
+}
+
+_MDL_INLINE void MDL::Private::CompressedCurveStore::evict(const void* value)
+{
+    shared().remove(value);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -12,7 +12,7 @@
 namespace MDL::Private::Class
 {
 // MDLValueTypes.hpp
-    _MDL_PRIVATE_DEF_CLS( MTLMatrix4x4Array );
+    _MDL_PRIVATE_DEF_CLS( MDLMatrix4x4Array );
 
 // MDLVertexDescriptor.hpp
     _MDL_PRIVATE_DEF_CLS( MDLVertexBufferLayout );
@@ -39,6 +39,7 @@ namespace MDL::Private::Class
 
 // MDLVoxelArray.hpp
     _MDL_PRIVATE_DEF_CLS( MDLVoxelArray );
+    _MDL_PRIVATE_DEF_CLS( NSData );
 
 // MDLAnimatedValueTypes.hpp
     _MDL_PRIVATE_DEF_CLS( MDLAnimatedValue );
@@ -164,6 +165,8 @@ namespace MDL::Private::Selector
     _MDL_PRIVATE_DEF_SEL( setFormat_, "setFormat:" );
     _MDL_PRIVATE_DEF_SEL( offset, "offset" );
     _MDL_PRIVATE_DEF_SEL( setOffset_, "setOffset:" );
+    _MDL_PRIVATE_DEF_SEL( bufferIndex, "bufferIndex" );
+    _MDL_PRIVATE_DEF_SEL( setBufferIndex_, "setBufferIndex:" );
     _MDL_PRIVATE_DEF_SEL( time, "time" );
     _MDL_PRIVATE_DEF_SEL( setTime_, "setTime:" );
     _MDL_PRIVATE_DEF_SEL( initializationValue, "initializationValue" );
@@ -173,9 +176,11 @@ namespace MDL::Private::Selector
     _MDL_PRIVATE_DEF_SEL( attributeNamed_, "attributeNamed:" );
     _MDL_PRIVATE_DEF_SEL( addOrReplaceAttribute_, "addOrReplaceAttribute:" );
     _MDL_PRIVATE_DEF_SEL( removeAttributeNamed_, "removeAttributeNamed:" );
+    _MDL_PRIVATE_DEF_SEL( attributes, "attributes" );
+    _MDL_PRIVATE_DEF_SEL( layouts, "layouts" );
     _MDL_PRIVATE_DEF_SEL( reset_, "reset:" );
-    _MDL_PRIVATE_DEF_SEL( setPackedStrides_, "setPackedStrides:" );
-    _MDL_PRIVATE_DEF_SEL( setPackedOffsets_, "setPackedOffsets:" );
+    _MDL_PRIVATE_DEF_SEL( setPackedStrides, "setPackedStrides" );
+    _MDL_PRIVATE_DEF_SEL( setPackedOffsets, "setPackedOffsets" );
 
 // MDLObject.hpp
     _MDL_PRIVATE_DEF_SEL( components, "components" );
@@ -185,6 +190,7 @@ namespace MDL::Private::Selector
     _MDL_PRIVATE_DEF_SEL( setObject_forKeyedSubscript_, "setObject:forKeyedSubscript:" );
     _MDL_PRIVATE_DEF_SEL( parent, "parent" );
     _MDL_PRIVATE_DEF_SEL( instance, "instance" );
+    _MDL_PRIVATE_DEF_SEL( setInstance_, "setInstance:" );
     _MDL_PRIVATE_DEF_SEL( path, "path" );
     _MDL_PRIVATE_DEF_SEL( objectAtPath_, "objectAtPath:" );
     _MDL_PRIVATE_DEF_SEL( enumerateChildObjectsOfClass_root_usingBlock_stopPointer_, "enumerateChildObjectsOfClass:root:usingBlock:stopPointer:" );
@@ -196,6 +202,7 @@ namespace MDL::Private::Selector
     _MDL_PRIVATE_DEF_SEL( setHidden_, "setHidden:" );
     _MDL_PRIVATE_DEF_SEL( addChild_, "addChild:" );
     _MDL_PRIVATE_DEF_SEL( boundingBoxAtTime_, "boundingBoxAtTime:" );
+    _MDL_PRIVATE_DEF_SEL( isKindOfClass_, "isKindOfClass:" );
 
 // MDLTransform.hpp
     _MDL_PRIVATE_DEF_SEL( matrix, "matrix" );
@@ -282,6 +289,7 @@ namespace MDL::Private::Selector
     _MDL_PRIVATE_DEF_SEL( voxelsWithinExtent_, "voxelsWithinExtent:" );
     _MDL_PRIVATE_DEF_SEL( voxelIndices, "voxelIndices" );
     _MDL_PRIVATE_DEF_SEL( setVoxelAtIndex_, "setVoxelAtIndex:" );
+    _MDL_PRIVATE_DEF_SEL( dataWithBytes_length_, "dataWithBytes:length:" );
     _MDL_PRIVATE_DEF_SEL( setVoxelsForMesh_divisions_patchRadius_, "setVoxelsForMesh:divisions:patchRadius:" );
     _MDL_PRIVATE_DEF_SEL( setVoxelsForMesh_divisions_interiorShells_exteriorShells_patchRadius_,
                          "setVoxelsForMesh:divisions:interiorShells:exteriorShells:patchRadius:" );
@@ -294,7 +302,7 @@ namespace MDL::Private::Selector
     _MDL_PRIVATE_DEF_SEL( indexOfSpatialLocation_, "indexOfSpatialLocation:" );
     _MDL_PRIVATE_DEF_SEL( spatialLocationOfIndex_, "spatialLocationOfIndex:" );
     _MDL_PRIVATE_DEF_SEL( voxelBoundingBoxAtIndex_, "voxelBoundingBoxAtIndex:" );
-    _MDL_PRIVATE_DEF_SEL( convertToSignedShellField_, "convertToSignedShellField:" );
+    _MDL_PRIVATE_DEF_SEL( convertToSignedShellField, "convertToSignedShellField" );
     _MDL_PRIVATE_DEF_SEL( isValidSignedShellField, "isValidSignedShellField" );
     _MDL_PRIVATE_DEF_SEL( shellFieldInteriorThickness, "shellFieldInteriorThickness" );
     _MDL_PRIVATE_DEF_SEL( setShellFieldInteriorThickness_, "setShellFieldInteriorThickness:" );
@@ -320,34 +328,31 @@ namespace MDL::Private::Selector
     //_MDL_PRIVATE_DEF_SEL( initWithElementCount_, "initWithElementCount:" );
     _MDL_PRIVATE_DEF_SEL( setFloatArray_count_atTime_, "setFloatArray:count:atTime:" );
     _MDL_PRIVATE_DEF_SEL( setDoubleArray_count_atTime_, "setDoubleArray:count:atTime:" );
-    _MDL_PRIVATE_DEF_SEL( getFloatArray_count_atTime_, "getFloatArray:count:atTime:" );
-    _MDL_PRIVATE_DEF_SEL( getDoubleArray_count_atTime_, "getDoubleArray:count:atTime:" );
-    _MDL_PRIVATE_DEF_SEL( resetWithFloatArray_count_atTime_count_, "resetWithFloatArray:count:atTime_count:" );
-    _MDL_PRIVATE_DEF_SEL( resetWithDoubleArray_count_atTime_count_, "resetWithDoubleArray:count:atTime:count:" );
-    _MDL_PRIVATE_DEF_SEL( getFloatArray_count_, "getFloatArray:count:" );
-    _MDL_PRIVATE_DEF_SEL( getDoubleArray_count_, "getDoubleArray:count:" );
+    _MDL_PRIVATE_DEF_SEL( getFloatArray_maxCount_atTime_, "getFloatArray:maxCount:atTime:" );
+    _MDL_PRIVATE_DEF_SEL( getDoubleArray_maxCount_atTime_, "getDoubleArray:maxCount:atTime:" );
+    _MDL_PRIVATE_DEF_SEL( resetWithFloatArray_count_atTimes_count_, "resetWithFloatArray:count:atTimes:count:" );
+    _MDL_PRIVATE_DEF_SEL( resetWithDoubleArray_count_atTimes_count_, "resetWithDoubleArray:count:atTimes:count:" );
+    _MDL_PRIVATE_DEF_SEL( getDoubleArray_maxCount_, "getDoubleArray:maxCount:" );
 
     //_MDL_PRIVATE_DEF_SEL( elementCount, "elementCount" );
     //_MDL_PRIVATE_DEF_SEL( initWithElementCount_, "initWithElementCount:" );
     _MDL_PRIVATE_DEF_SEL( setFloat3Array_count_atTime_, "setFloat3Array:count:atTime:" );
     _MDL_PRIVATE_DEF_SEL( setDouble3Array_count_atTime_, "setDouble3Array:count:atTime:" );
-    _MDL_PRIVATE_DEF_SEL( getFloat3Array_count_atTime_, "getFloat3Array:count:atTime:" );
-    _MDL_PRIVATE_DEF_SEL( getDouble3Array_count_atTime_, "getDouble3Array:count:atTime:" );
-    _MDL_PRIVATE_DEF_SEL( resetWithFloat3Array_count_atTime_count_, "resetWithFloat3Array:count:atTime_count:" );
-    _MDL_PRIVATE_DEF_SEL( resetWithDouble3Array_count_atTime_count_, "resetWithDouble3Array:count:atTime:count:" );
-    _MDL_PRIVATE_DEF_SEL( getFloat3Array_count_, "getFloat3Array:count:" );
-    _MDL_PRIVATE_DEF_SEL( getDouble3Array_count_, "getDouble3Array:count:" );
+    _MDL_PRIVATE_DEF_SEL( getFloat3Array_maxCount_atTime_, "getFloat3Array:maxCount:atTime:" );
+    _MDL_PRIVATE_DEF_SEL( getDouble3Array_maxCount_atTime_, "getDouble3Array:maxCount:atTime:" );
+    _MDL_PRIVATE_DEF_SEL( resetWithFloat3Array_count_atTimes_count_, "resetWithFloat3Array:count:atTimes:count:" );
+    _MDL_PRIVATE_DEF_SEL( resetWithDouble3Array_count_atTimes_count_, "resetWithDouble3Array:count:atTimes:count:" );
+    _MDL_PRIVATE_DEF_SEL( getDouble3Array_maxCount_, "getDouble3Array:maxCount:" );
 
     //_MDL_PRIVATE_DEF_SEL( elementCount, "elementCount" );
     //_MDL_PRIVATE_DEF_SEL( initWithElementCount_, "initWithElementCount:" );
     _MDL_PRIVATE_DEF_SEL( setFloatQuaternionArray_count_atTime_, "setFloatQuaternionArray:count:atTime:" );
     _MDL_PRIVATE_DEF_SEL( setDoubleQuaternionArray_count_atTime_, "setDoubleQuaternionArray:count:atTime:" );
-    _MDL_PRIVATE_DEF_SEL( getFloatQuaternionArray_count_atTime_, "getFloatQuaternionArray:count:atTime:" );
-    _MDL_PRIVATE_DEF_SEL( getDoubleQuaternionArray_count_atTime_, "getDoubleQuaternionArray:count:atTime:" );
-    _MDL_PRIVATE_DEF_SEL( resetWithFloatQuaternionArray_count_atTime_count_, "resetWithFloatQuaternionArray:count:atTime_count:" );
-    _MDL_PRIVATE_DEF_SEL( resetWithDoubleQuaternionArray_count_atTime_count_, "resetWithDoubleQuaternionArray:count:atTime:count:" );
-    _MDL_PRIVATE_DEF_SEL( getFloatQuaternionArray_count_, "getFloatQuaternionArray:count:" );
-    _MDL_PRIVATE_DEF_SEL( getDoubleQuaternionArray_count_, "getDoubleQuaternionArray:count:" );
+    _MDL_PRIVATE_DEF_SEL( getFloatQuaternionArray_maxCount_atTime_, "getFloatQuaternionArray:maxCount:atTime:" );
+    _MDL_PRIVATE_DEF_SEL( getDoubleQuaternionArray_maxCount_atTime_, "getDoubleQuaternionArray:maxCount:atTime:" );
+    _MDL_PRIVATE_DEF_SEL( resetWithFloatQuaternionArray_count_atTimes_count_, "resetWithFloatQuaternionArray:count:atTimes:count:" );
+    _MDL_PRIVATE_DEF_SEL( resetWithDoubleQuaternionArray_count_atTimes_count_, "resetWithDoubleQuaternionArray:count:atTimes:count:" );
+    _MDL_PRIVATE_DEF_SEL( getDoubleQuaternionArray_maxCount_, "getDoubleQuaternionArray:maxCount:" );
 
     _MDL_PRIVATE_DEF_SEL( setFloat_atTime_, "setFloat:atTime:" );
     _MDL_PRIVATE_DEF_SEL( setDouble_atTime_, "setDouble:atTime:" );
@@ -390,6 +395,9 @@ namespace MDL::Private::Selector
     _MDL_PRIVATE_DEF_SEL( double4x4AtTime_, "double4x4AtTime:" );
     _MDL_PRIVATE_DEF_SEL( resetWithFloat4x4Array_atTime_count_, "resetWithFloat4x4Array:atTime:count:" );
     _MDL_PRIVATE_DEF_SEL( resetWithDouble4x4Array_atTime_count_, "resetWithDouble4x4Array:atTime:count:" );
+    _MDL_PRIVATE_DEF_SEL( getFloatArray_maxCount_, "getFloatArray:maxCount:" );
+    _MDL_PRIVATE_DEF_SEL( getFloat3Array_maxCount_, "getFloat3Array:maxCount:" );
+    _MDL_PRIVATE_DEF_SEL( getFloatQuaternionArray_maxCount_, "getFloatQuaternionArray:maxCount:" );
 
 // MDLAnimation.hpp
     _MDL_PRIVATE_DEF_SEL( jointPaths, "jointPaths" );
@@ -629,6 +637,12 @@ namespace MDL::Private::Selector
     _MDL_PRIVATE_DEF_SEL( setVertexCreases_, "setVertexCreases:" );
     _MDL_PRIVATE_DEF_SEL( vertexCreaseCount, "vertexCreaseCount" );
     _MDL_PRIVATE_DEF_SEL( setVertexCreaseCount_, "setVertexCreaseCount:" );
+    _MDL_PRIVATE_DEF_SEL( edgeCreaseIndices, "edgeCreaseIndices" );
+    _MDL_PRIVATE_DEF_SEL( setEdgeCreaseIndices_, "setEdgeCreaseIndices:" );
+    _MDL_PRIVATE_DEF_SEL( edgeCreases, "edgeCreases" );
+    _MDL_PRIVATE_DEF_SEL( setEdgeCreases_, "setEdgeCreases:" );
+    _MDL_PRIVATE_DEF_SEL( edgeCreaseCount, "edgeCreaseCount" );
+    _MDL_PRIVATE_DEF_SEL( setEdgeCreaseCount_, "setEdgeCreaseCount:" );
     _MDL_PRIVATE_DEF_SEL( holes, "holes" );
     _MDL_PRIVATE_DEF_SEL( setHoles_, "setHoles:" );
     _MDL_PRIVATE_DEF_SEL( holeCount, "holeCount" );
@@ -770,6 +784,7 @@ namespace MDL::Private::Selector
     _MDL_PRIVATE_DEF_SEL( setVertexCount_, "setVertexCount:" );
     _MDL_PRIVATE_DEF_SEL( vertexBuffers, "vertexBuffers" );
     _MDL_PRIVATE_DEF_SEL( setVertexBuffers_, "setVertexBuffers:" );
+    _MDL_PRIVATE_DEF_SEL( submeshes, "submeshes" );
     //_MDL_PRIVATE_DEF_SEL( allocator, "allocator" );
 
     _MDL_PRIVATE_DEF_SEL( addAttributeWithName_format_, "addAttributeWithName:format:" );
@@ -877,7 +892,7 @@ namespace MDL::Private::Selector
     _MDL_PRIVATE_DEF_SEL( addRotateXOp_inverse_, "addRotateXOp:inverse:" );
     _MDL_PRIVATE_DEF_SEL( addRotateYOp_inverse_, "addRotateYOp:inverse:" );
     _MDL_PRIVATE_DEF_SEL( addRotateZOp_inverse_, "addRotateZOp:inverse:" );
-    _MDL_PRIVATE_DEF_SEL( addRotateOp_inverse_, "addRotateOp:inverse:" );
+    _MDL_PRIVATE_DEF_SEL( addRotateOp_order_inverse_, "addRotateOp:order:inverse:" );
     _MDL_PRIVATE_DEF_SEL( addScaleOp_inverse_, "addScaleOp:inverse:" );
     _MDL_PRIVATE_DEF_SEL( addMatrixOp_inverse_, "addMatrixOp:inverse:" );
     _MDL_PRIVATE_DEF_SEL( addOrientOp_inverse_, "addOrientOp:inverse:" );
@@ -0,0 +1,353 @@
+/*!
+ @header MDLInstancing.hpp
+ @framework ModelIO
+ @abstract Content hashing for mesh deduplication and flat instance tables for renderers
+ @copyright Treata Norouzi on 10/19/26.
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include "MDLDefines.hpp"
+#include "MDLSceneGraph.hpp"
+#include "Foundation/NSTypes.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define _MDL_INSTANCING_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define _MDL_INSTANCING_NEON 1
+#endif
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace MDL
+{
+class Asset;
+class Mesh;
+
+struct InstancingSettings
+{
+    // Identical meshes needed before they are folded into a master; at least two
+    NS::UInteger                    minimumCopies = 2;
+    // Copies must also agree on the names of their submesh materials;
+    // otherwise every instance draws with the materials of the master
+    bool                            matchMaterials = true;
+};
+
+// Every mesh drawn at one time, directly or through an instance, as one entry
+// per placement; entries of the same master are contiguous so a renderer can
+// issue one instanced draw per master
+class InstanceTable
+{
+public:
+    using NodeId = Private::SceneGraph::NodeId;
+    using Matrix = Private::SceneGraph::Matrix;
+
+    double                          time() const;
+
+    // Meshes drawn, in order of first appearance
+    NS::UInteger                    masterCount() const;
+    Mesh*                           master(NS::UInteger masterId) const;
+    // Entries of `masterId` are [firstInstance, firstInstance + instanceCount)
+    NS::UInteger                    firstInstance(NS::UInteger masterId) const;
+    NS::UInteger                    instanceCount(NS::UInteger masterId) const;
+
+    NS::UInteger                    count() const;
+    // One per entry: the master drawn, its world matrix and the scene graph
+    // node placing it
+    const std::uint32_t*            masterIds() const;
+    const Matrix*                   matrices() const;
+    const NodeId*                   nodes() const;
+
+private:
+    friend class Asset;
+
+    double                          _time = 0.0;
+    std::vector<Mesh*>              _masters;
+    // masterCount() + 1 entries
+    std::vector<std::uint32_t>      _offsets;
+    std::vector<std::uint32_t>      _masterIds;
+    std::vector<Matrix>             _matrices;
+    std::vector<NodeId>             _nodes;
+};
+
+namespace Private
+{
+    // 64-bit hash of a byte range over the xxh3 long-input loop: eight 64-bit
+    // lanes fed 64-byte stripes with a 32x32->64 multiply per lane, scrambled
+    // every 1 KiB. The secret is expanded from the seed instead of taken from
+    // the reference implementation, so values are only meaningful within a
+    // process; chain ranges by passing the previous hash as the seed.
+    struct ContentHash
+    {
+        static std::uint64_t            hash(const void* bytes, NS::UInteger length, std::uint64_t seed = 0);
+
+    private:
+        static constexpr std::uint64_t  Prime32_1 = 0x9E3779B1u;
+        static constexpr std::uint64_t  Prime64_1 = 0x9E3779B185EBCA87ull;
+        static constexpr NS::UInteger   StripeLength = 64;
+        static constexpr NS::UInteger   StripesPerBlock = 16;
+        // Stripe s of a block reads keys [s, s + 8); the scramble reads the
+        // last eight
+        static constexpr NS::UInteger   SecretLength = 32;
+
+        static void                     accumulate(std::uint64_t* lanes, const unsigned char* stripe, const std::uint64_t* keys);
+        static void                     scramble(std::uint64_t* lanes, const std::uint64_t* keys);
+        // Low and high halves of the 128-bit product a * b, xored
+        static std::uint64_t            foldedMultiply(std::uint64_t a, std::uint64_t b);
+    };
+
+    // What makes two meshes interchangeable: the vertex count, vertex
+    // descriptor and submesh layout as words, submesh material names, and the
+    // vertex then index buffer bytes. Spans point into mapped mesh buffers
+    // and stay valid until the autorelease pool of the caller drains.
+    struct MeshContent
+    {
+        std::vector<std::uint64_t>                          layout;
+        std::vector<std::string>                            materials;
+        std::vector<std::pair<const void*, NS::UInteger>>   spans;
+        std::uint64_t                                       hash = 0;
+
+        void                                                computeHash();
+        bool                                                equals(const MeshContent& other) const;
+    };
+
+} // Private
+} // MDL
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// MARK: - Private Sector
+
+_MDL_INLINE double MDL::InstanceTable::time() const
+{
+    return _time;
+}
+
+_MDL_INLINE NS::UInteger MDL::InstanceTable::masterCount() const
+{
+    return _masters.size();
+}
+
+_MDL_INLINE MDL::Mesh* MDL::InstanceTable::master(NS::UInteger masterId) const
+{
+    return masterId < _masters.size() ? _masters[masterId] : nullptr;
+}
+
+_MDL_INLINE NS::UInteger MDL::InstanceTable::firstInstance(NS::UInteger masterId) const
+{
+    return masterId < _masters.size() ? _offsets[masterId] : _masterIds.size();
+}
+
+_MDL_INLINE NS::UInteger MDL::InstanceTable::instanceCount(NS::UInteger masterId) const
+{
+    return masterId < _masters.size() ? _offsets[masterId + 1] - _offsets[masterId] : 0;
+}
+
+_MDL_INLINE NS::UInteger MDL::InstanceTable::count() const
+{
+    return _masterIds.size();
+}
+
+_MDL_INLINE const std::uint32_t* MDL::InstanceTable::masterIds() const
+{
+    return _masterIds.data();
+}
+
+_MDL_INLINE const MDL::InstanceTable::Matrix* MDL::InstanceTable::matrices() const
+{
+    return _matrices.data();
+}
+
+_MDL_INLINE const MDL::InstanceTable::NodeId* MDL::InstanceTable::nodes() const
+{
+    return _nodes.data();
+}
+
+_MDL_INLINE std::uint64_t MDL::Private::ContentHash::hash(const void* bytes, NS::UInteger length, std::uint64_t seed)
+{
+    // splitmix64 of the seed
+    alignas(16) std::uint64_t secret[SecretLength];
+    std::uint64_t             state = seed;
+    for (NS::UInteger k = 0; k < SecretLength; ++k)
+    {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        secret[k] = z ^ (z >> 31);
+    }
+
+    alignas(16) std::uint64_t lanes[8] = { Prime32_1, Prime64_1, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull,
+                                           0x85EBCA77C2B2AE63ull, 0x85EBCA77u, 0x27D4EB2F165667C5ull, 0xC2B2AE3Du };
+
+    const unsigned char* data = static_cast<const unsigned char*>(bytes);
+    const NS::UInteger   stripes = length / StripeLength;
+    NS::UInteger         s = 0;
+    for (; s + StripesPerBlock <= stripes; s += StripesPerBlock)
+    {
+        for (NS::UInteger i = 0; i < StripesPerBlock; ++i)
+        {
+            accumulate(lanes, data + (s + i) * StripeLength, secret + i);
+        }
+        scramble(lanes, secret + SecretLength - 8);
+    }
+    for (NS::UInteger i = 0; s < stripes; ++s, ++i)
+    {
+        accumulate(lanes, data + s * StripeLength, secret + i);
+    }
+
+    // The tail, zero padded; the length folded in below tells paddings apart
+    if (const NS::UInteger tail = length - stripes * StripeLength)
+    {
+        alignas(16) unsigned char last[StripeLength] = {};
+        std::memcpy(last, data + stripes * StripeLength, tail);
+        accumulate(lanes, last, secret + StripesPerBlock);
+    }
+
+    std::uint64_t result = std::uint64_t(length) * Prime64_1;
+    for (int pair = 0; pair < 4; ++pair)
+    {
+        result += foldedMultiply(lanes[pair * 2] ^ secret[8 + pair * 2], lanes[pair * 2 + 1] ^ secret[9 + pair * 2]);
+    }
+    result ^= result >> 37;
+    result *= 0x165667919E3779F9ull;
+    return result ^ (result >> 32);
+}
+
+// lanes[i ^ 1] += word[i]; lanes[i] += lo32(key) * hi32(key), key = word[i] ^ keys[i]
+_MDL_INLINE void MDL::Private::ContentHash::accumulate(std::uint64_t* lanes, const unsigned char* stripe, const std::uint64_t* keys)
+{
+#if defined(_MDL_INSTANCING_SSE)
+    for (int i = 0; i < 4; ++i)
+    {
+        const __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(stripe) + i);
+        const __m128i key = _mm_xor_si128(words, _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i * 2)));
+        const __m128i product = _mm_mul_epu32(key, _mm_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)));
+        const __m128i swapped = _mm_shuffle_epi32(words, _MM_SHUFFLE(1, 0, 3, 2));
+        __m128i*      lane = reinterpret_cast<__m128i*>(lanes) + i;
+        _mm_store_si128(lane, _mm_add_epi64(_mm_load_si128(lane), _mm_add_epi64(product, swapped)));
+    }
+#elif defined(_MDL_INSTANCING_NEON)
+    for (int i = 0; i < 4; ++i)
+    {
+        const uint64x2_t words = vreinterpretq_u64_u8(vld1q_u8(stripe + i * 16));
+        const uint64x2_t key = veorq_u64(words, vld1q_u64(keys + i * 2));
+        uint64x2_t       lane = vaddq_u64(vld1q_u64(lanes + i * 2), vextq_u64(words, words, 1));
+        lane = vmlal_u32(lane, vmovn_u64(key), vshrn_n_u64(key, 32));
+        vst1q_u64(lanes + i * 2, lane);
+    }
+#else
+    for (int i = 0; i < 8; ++i)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, stripe + i * 8, sizeof(word));
+        const std::uint64_t key = word ^ keys[i];
+        lanes[i ^ 1] += word;
+        lanes[i] += (key & 0xFFFFFFFFull) * (key >> 32);
+    }
+#endif
+}
+
+_MDL_INLINE void MDL::Private::ContentHash::scramble(std::uint64_t* lanes, const std::uint64_t* keys)
+{
+#if defined(_MDL_INSTANCING_SSE)
+    const __m128i prime = _mm_set1_epi32(int(Prime32_1));
+    for (int i = 0; i < 4; ++i)
+    {
+        __m128i* lane = reinterpret_cast<__m128i*>(lanes) + i;
+        __m128i  value = _mm_load_si128(lane);
+        value = _mm_xor_si128(value, _mm_srli_epi64(value, 47));
+        value = _mm_xor_si128(value, _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i * 2)));
+        const __m128i low = _mm_mul_epu32(value, prime);
+        const __m128i high = _mm_mul_epu32(_mm_srli_epi64(value, 32), prime);
+        _mm_store_si128(lane, _mm_add_epi64(low, _mm_slli_epi64(high, 32)));
+    }
+#elif defined(_MDL_INSTANCING_NEON)
+    for (int i = 0; i < 4; ++i)
+    {
+        uint64x2_t value = vld1q_u64(lanes + i * 2);
+        value = veorq_u64(value, vshrq_n_u64(value, 47));
+        value = veorq_u64(value, vld1q_u64(keys + i * 2));
+        const uint64x2_t high = vshlq_n_u64(vmull_n_u32(vshrn_n_u64(value, 32), std::uint32_t(Prime32_1)), 32);
+        vst1q_u64(lanes + i * 2, vmlal_n_u32(high, vmovn_u64(value), std::uint32_t(Prime32_1)));
+    }
+#else
+    for (int i = 0; i < 8; ++i)
+    {
+        std::uint64_t value = lanes[i];
+        value ^= value >> 47;
+        value ^= keys[i];
+        lanes[i] = value * Prime32_1;
+    }
+#endif
+}
+
+_MDL_INLINE std::uint64_t MDL::Private::ContentHash::foldedMultiply(std::uint64_t a, std::uint64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+    const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    return std::uint64_t(product) ^ std::uint64_t(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    std::uint64_t high;
+    const std::uint64_t low = _umul128(a, b, &high);
+    return low ^ high;
+#else
+    // Schoolbook on 32-bit halves
+    const std::uint64_t aLow = a & 0xFFFFFFFFull, aHigh = a >> 32;
+    const std::uint64_t bLow = b & 0xFFFFFFFFull, bHigh = b >> 32;
+    const std::uint64_t lowLow = aLow * bLow;
+    const std::uint64_t highLow = aHigh * bLow;
+    const std::uint64_t lowHigh = aLow * bHigh;
+    const std::uint64_t cross = (lowLow >> 32) + (highLow & 0xFFFFFFFFull) + lowHigh;
+    const std::uint64_t high = aHigh * bHigh + (highLow >> 32) + (cross >> 32);
+    const std::uint64_t low = (cross << 32) | (lowLow & 0xFFFFFFFFull);
+    return low ^ high;
+#endif
+}
+
+_MDL_INLINE void MDL::Private::MeshContent::computeHash()
+{
+    hash = ContentHash::hash(layout.data(), layout.size() * sizeof(std::uint64_t));
+    for (const std::string& material : materials)
+    {
+        hash = ContentHash::hash(material.data(), material.size(), hash);
+    }
+    for (const std::pair<const void*, NS::UInteger>& span : spans)
+    {
+        hash = ContentHash::hash(span.first, span.second, hash);
+    }
+}
+
+// Byte for byte; the hash only picks the candidates
+_MDL_INLINE bool MDL::Private::MeshContent::equals(const MeshContent& other) const
+{
+    if (hash != other.hash || layout != other.layout || materials != other.materials || spans.size() != other.spans.size())
+    {
+        return false;
+    }
+    for (NS::UInteger s = 0; s < spans.size(); ++s)
+    {
+        if (spans[s].second != other.spans[s].second ||
+            (spans[s].second && spans[s].first != other.spans[s].first &&
+             std::memcmp(spans[s].first, other.spans[s].first, spans[s].second) != 0))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
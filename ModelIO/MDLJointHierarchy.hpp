@@ -0,0 +1,473 @@
+/*!
+ @header MDLJointHierarchy.hpp
+ @framework ModelIO
+ @abstract Flat joint hierarchies and model-space pose evaluation for skeletons
+ @copyright Treata Norouzi on 10/19/26.
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include "MDLDefines.hpp"
+#include "MDLAlignedAllocator.hpp"
+#include "MDLObjectLifetime.hpp"
+#include "Foundation/NSTypes.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define _MDL_JOINT_HIERARCHY_SSE 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define _MDL_JOINT_HIERARCHY_NEON 1
+#endif
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace MDL
+{
+namespace Private
+{
+    // Skeleton joints fed by the joints of an animation
+    struct JointMap
+    {
+        // Animation joint of each skeleton joint, JointHierarchy::NoJoint
+        // where the skeleton joint keeps its rest transform
+        std::vector<std::int32_t>       sources;
+        NS::UInteger                    sourceCount = 0;
+        // Every skeleton joint is animated, so rest transforms go unread
+        bool                            complete = false;
+    };
+
+    // Joints of a skeleton as flat arrays, parents before children, so a pose
+    // is one forward pass with each parent already in model space. Parents
+    // are found from the joint paths: "root/hip/knee" is the child of
+    // "root/hip", or of "root" when the skeleton has no "root/hip".
+    class JointHierarchy
+    {
+    public:
+        static constexpr std::int32_t   NoJoint = -1;
+
+        static std::shared_ptr<JointHierarchy> build(const std::vector<std::string>& jointPaths);
+
+        NS::UInteger                    jointCount() const;
+        // NoJoint when the skeleton has no joint at `path`
+        std::int32_t                    jointIndex(const std::string& path) const;
+        // Parent of each joint, by joint index
+        const std::int32_t*             parents() const;
+        // Joint indices in evaluation order, and the parent of each entry
+        const std::uint32_t*            order() const;
+        const std::int32_t*             orderedParents() const;
+
+        JointMap                        mapJoints(const std::vector<std::string>& animationJointPaths) const;
+
+        // Model-space transforms from local ones, 16 floats per joint in
+        // joint order, column-major; `model` must not alias `locals`
+        void                            toModelSpace(const float* locals, float* model) const;
+        // Model-space transforms from the translations, rotations and scales
+        // of the animation joints, four floats apart, picked through `map`;
+        // unmapped joints use `restTransforms`, or the identity when null
+        void                            pose(const float* translations, const float* rotations, const float* scales,
+                                             const JointMap& map, const float* restTransforms, float* model) const;
+
+    private:
+        template <typename _Local>
+        void                            forward(const _Local& local, float* model) const;
+
+        std::vector<std::int32_t>       _parents;
+        std::vector<std::uint32_t>      _order;
+        std::vector<std::int32_t>       _orderedParents;
+        std::unordered_map<std::string, std::int32_t> _indices;
+        // The joint paths already list parents first, so evaluation walks
+        // joint order directly
+        bool                            _inJointOrder = true;
+    };
+
+    // Per-thread buffers for sampled joint transforms, reused across poses so
+    // steady-state evaluation does not allocate
+    struct PoseScratch
+    {
+        AlignedVector<float>            translations;
+        AlignedVector<float>            rotations;
+        AlignedVector<float>            scales;
+        AlignedVector<float>            restTransforms;
+        AlignedVector<float>            model;
+
+        static PoseScratch&             local();
+    };
+
+    // Hierarchies by skeleton, and joint maps by skeleton and animation.
+    // Every entry records the joint path arrays it was built from, by
+    // address and count, and a lookup that passes other arrays misses; an
+    // entry also goes away when an object it was built for is initialized
+    // or deallocated.
+    class JointHierarchyStore
+    {
+    public:
+        static JointHierarchyStore&                     shared();
+
+        // nullptr unless stored from `jointPaths`, the skeleton's current
+        // joint paths
+        std::shared_ptr<const JointHierarchy>           find(const void* skeleton, const NS::Array* jointPaths);
+        // Replaces the skeleton's hierarchy and drops its joint maps
+        void                                            insert(const void* skeleton, const NS::Array* jointPaths,
+                                                               std::shared_ptr<const JointHierarchy> hierarchy);
+        // nullptr unless stored from `animationJointPaths`, the animation's
+        // current joint paths
+        std::shared_ptr<const JointMap>                 findJointMap(const void* skeleton, const void* animation,
+                                                                     const NS::Array* animationJointPaths);
+        void                                            insertJointMap(const void* skeleton, const void* animation,
+                                                                       const NS::Array* animationJointPaths,
+                                                                       std::shared_ptr<const JointMap> map);
+        // Drops everything built for `object`, as a skeleton or an animation
+        void                                            remove(const void* object);
+        void                                            clear();
+
+    private:
+        // Joint paths an entry was built from
+        struct Source
+        {
+            const void*                                 jointPaths;
+            NS::UInteger                                count;
+
+            static Source                               of(const NS::Array* jointPaths);
+            bool                                        operator==(const Source& other) const;
+        };
+
+        template <typename _Value>
+        struct Entry
+        {
+            Source                                      source;
+            std::shared_ptr<const _Value>               value;
+        };
+
+        struct PairHash
+        {
+            std::size_t operator()(const std::pair<const void*, const void*>& key) const
+            {
+                return std::hash<const void*>()(key.first) * 31 + std::hash<const void*>()(key.second);
+            }
+        };
+
+        static void                                     evict(const void* object);
+
+        std::mutex                                      _mutex;
+        std::unordered_map<const void*, Entry<JointHierarchy>> _hierarchies;
+        std::unordered_map<std::pair<const void*, const void*>, Entry<JointMap>, PairHash> _jointMaps;
+    };
+
+} // Private
+} // MDL
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// MARK: - Private Sector
+
+_MDL_INLINE std::shared_ptr<MDL::Private::JointHierarchy> MDL::Private::JointHierarchy::build(const std::vector<std::string>& jointPaths)
+{
+    auto hierarchy = std::make_shared<JointHierarchy>();
+    const NS::UInteger jointCount = jointPaths.size();
+
+    hierarchy->_indices.reserve(jointCount);
+    for (NS::UInteger i = 0; i < jointCount; ++i)
+    {
+        hierarchy->_indices.emplace(jointPaths[i], std::int32_t(i));
+    }
+
+    hierarchy->_parents.assign(jointCount, NoJoint);
+    std::vector<std::uint32_t> depths(jointCount, 0);
+    for (NS::UInteger i = 0; i < jointCount; ++i)
+    {
+        const std::string& path = jointPaths[i];
+        for (std::size_t slash = path.rfind('/'); slash != std::string::npos && slash > 0; slash = path.rfind('/', slash - 1))
+        {
+            auto parent = hierarchy->_indices.find(path.substr(0, slash));
+            if (parent != hierarchy->_indices.end())
+            {
+                hierarchy->_parents[i] = parent->second;
+                break;
+            }
+        }
+        depths[i] = std::uint32_t(std::count(path.begin(), path.end(), '/'));
+        hierarchy->_inJointOrder &= hierarchy->_parents[i] < std::int32_t(i);
+    }
+
+    hierarchy->_order.resize(jointCount);
+    for (NS::UInteger i = 0; i < jointCount; ++i)
+    {
+        hierarchy->_order[i] = std::uint32_t(i);
+    }
+    if (!hierarchy->_inJointOrder)
+    {
+        std::stable_sort(hierarchy->_order.begin(), hierarchy->_order.end(),
+                         [&](std::uint32_t a, std::uint32_t b) { return depths[a] < depths[b]; });
+    }
+    hierarchy->_orderedParents.resize(jointCount);
+    for (NS::UInteger i = 0; i < jointCount; ++i)
+    {
+        hierarchy->_orderedParents[i] = hierarchy->_parents[hierarchy->_order[i]];
+    }
+    return hierarchy;
+}
+
+_MDL_INLINE NS::UInteger MDL::Private::JointHierarchy::jointCount() const
+{
+    return _parents.size();
+}
+
+_MDL_INLINE std::int32_t MDL::Private::JointHierarchy::jointIndex(const std::string& path) const
+{
+    auto joint = _indices.find(path);
+    return joint == _indices.end() ? NoJoint : joint->second;
+}
+
+_MDL_INLINE const std::int32_t* MDL::Private::JointHierarchy::parents() const
+{
+    return _parents.data();
+}
+
+_MDL_INLINE const std::uint32_t* MDL::Private::JointHierarchy::order() const
+{
+    return _order.data();
+}
+
+_MDL_INLINE const std::int32_t* MDL::Private::JointHierarchy::orderedParents() const
+{
+    return _orderedParents.data();
+}
+
+_MDL_INLINE MDL::Private::JointMap MDL::Private::JointHierarchy::mapJoints(const std::vector<std::string>& animationJointPaths) const
+{
+    JointMap map;
+    map.sources.assign(jointCount(), NoJoint);
+    map.sourceCount = animationJointPaths.size();
+    for (NS::UInteger i = 0; i < animationJointPaths.size(); ++i)
+    {
+        const std::int32_t joint = jointIndex(animationJointPaths[i]);
+        if (joint != NoJoint)
+        {
+            map.sources[joint] = std::int32_t(i);
+        }
+    }
+    map.complete = std::find(map.sources.begin(), map.sources.end(), NoJoint) == map.sources.end();
+    return map;
+}
+
+// Walks the joints parents first; `local(joint, columns)` fills the 16 local
+// floats of a joint and says whether its last row is (0, 0, 0, 1), which
+// saves the fourth column of products.
+template <typename _Local>
+_MDL_INLINE void MDL::Private::JointHierarchy::forward(const _Local& local, float* model) const
+{
+    const NS::UInteger count = jointCount();
+    for (NS::UInteger i = 0; i < count; ++i)
+    {
+        const NS::UInteger joint = _inJointOrder ? i : _order[i];
+        const std::int32_t parent = _orderedParents[i];
+        float*             out = model + joint * 16;
+        if (parent == NoJoint)
+        {
+            local(joint, out);
+            continue;
+        }
+
+        alignas(16) float l[16];
+        const bool        affine = local(joint, l);
+        const float*      p = model + NS::UInteger(parent) * 16;
+#if defined(_MDL_JOINT_HIERARCHY_SSE)
+        const __m128 p0 = _mm_loadu_ps(p), p1 = _mm_loadu_ps(p + 4), p2 = _mm_loadu_ps(p + 8), p3 = _mm_loadu_ps(p + 12);
+        for (int c = 0; c < 4; ++c)
+        {
+            const float* lc = l + c * 4;
+            __m128 column = _mm_add_ps(_mm_add_ps(_mm_mul_ps(p0, _mm_set1_ps(lc[0])), _mm_mul_ps(p1, _mm_set1_ps(lc[1]))),
+                                       _mm_mul_ps(p2, _mm_set1_ps(lc[2])));
+            if (!affine || c == 3)
+            {
+                column = _mm_add_ps(column, affine ? p3 : _mm_mul_ps(p3, _mm_set1_ps(lc[3])));
+            }
+            _mm_storeu_ps(out + c * 4, column);
+        }
+#elif defined(_MDL_JOINT_HIERARCHY_NEON)
+        const float32x4_t p0 = vld1q_f32(p), p1 = vld1q_f32(p + 4), p2 = vld1q_f32(p + 8), p3 = vld1q_f32(p + 12);
+        for (int c = 0; c < 4; ++c)
+        {
+            const float32x4_t lc = vld1q_f32(l + c * 4);
+            float32x4_t column = vmulq_laneq_f32(p0, lc, 0);
+            column = vfmaq_laneq_f32(column, p1, lc, 1);
+            column = vfmaq_laneq_f32(column, p2, lc, 2);
+            if (!affine || c == 3)
+            {
+                column = vfmaq_laneq_f32(column, p3, lc, 3);
+            }
+            vst1q_f32(out + c * 4, column);
+        }
+#else
+        for (int c = 0; c < 4; ++c)
+        {
+            const float* lc = l + c * 4;
+            for (int r = 0; r < 4; ++r)
+            {
+                out[c * 4 + r] = p[r] * lc[0] + p[4 + r] * lc[1] + p[8 + r] * lc[2] + ((affine && c < 3) ? 0.0f : p[12 + r] * lc[3]);
+            }
+        }
+#endif
+    }
+}
+
+_MDL_INLINE void MDL::Private::JointHierarchy::toModelSpace(const float* locals, float* model) const
+{
+    forward([locals](NS::UInteger joint, float* out)
+    {
+        const float* l = locals + joint * 16;
+        std::copy(l, l + 16, out);
+        return l[3] == 0.0f && l[7] == 0.0f && l[11] == 0.0f && l[15] == 1.0f;
+    }, model);
+}
+
+_MDL_INLINE void MDL::Private::JointHierarchy::pose(const float* translations, const float* rotations, const float* scales,
+                                                    const JointMap& map, const float* restTransforms, float* model) const
+{
+    const std::int32_t* sources = map.sources.data();
+    forward([=](NS::UInteger joint, float* out)
+    {
+        const std::int32_t source = sources[joint];
+        if (source == NoJoint)
+        {
+            if (!restTransforms)
+            {
+                for (int i = 0; i < 16; ++i)
+                {
+                    out[i] = float(i % 5 == 0);
+                }
+                return true;
+            }
+            const float* rest = restTransforms + joint * 16;
+            std::copy(rest, rest + 16, out);
+            return rest[3] == 0.0f && rest[7] == 0.0f && rest[11] == 0.0f && rest[15] == 1.0f;
+        }
+
+        const float* t = translations + NS::UInteger(source) * 4;
+        const float* q = rotations + NS::UInteger(source) * 4;
+        const float* s = scales + NS::UInteger(source) * 4;
+        const float  x = q[0], y = q[1], z = q[2], w = q[3];
+        out[0] = (1.0f - 2.0f * (y * y + z * z)) * s[0];
+        out[1] = (2.0f * (x * y + z * w)) * s[0];
+        out[2] = (2.0f * (x * z - y * w)) * s[0];
+        out[3] = 0.0f;
+        out[4] = (2.0f * (x * y - z * w)) * s[1];
+        out[5] = (1.0f - 2.0f * (x * x + z * z)) * s[1];
+        out[6] = (2.0f * (y * z + x * w)) * s[1];
+        out[7] = 0.0f;
+        out[8] = (2.0f * (x * z + y * w)) * s[2];
+        out[9] = (2.0f * (y * z - x * w)) * s[2];
+        out[10] = (1.0f - 2.0f * (x * x + y * y)) * s[2];
+        out[11] = 0.0f;
+        out[12] = t[0];
+        out[13] = t[1];
+        out[14] = t[2];
+        out[15] = 1.0f;
+        return true;
+    }, model);
+}
+
+_MDL_INLINE MDL::Private::PoseScratch& MDL::Private::PoseScratch::local()
+{
+    static thread_local PoseScratch scratch;
+    return scratch;
+}
+
+_MDL_INLINE MDL::Private::JointHierarchyStore& MDL::Private::JointHierarchyStore::shared()
+{
+    static JointHierarchyStore store;
+    return store;
+}
+
+_MDL_INLINE MDL::Private::JointHierarchyStore::Source MDL::Private::JointHierarchyStore::Source::of(const NS::Array* jointPaths)
+{
+    return { jointPaths, jointPaths ? jointPaths->count() : 0 };
+}
+
+_MDL_INLINE bool MDL::Private::JointHierarchyStore::Source::operator==(const Source& other) const
+{
+    return jointPaths == other.jointPaths && count == other.count;
+}
+
+_MDL_INLINE std::shared_ptr<const MDL::Private::JointHierarchy> MDL::Private::JointHierarchyStore::find(const void* skeleton,
+                                                                                                        const NS::Array* jointPaths)
+{
+    const Source                source = Source::of(jointPaths);
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _hierarchies.find(skeleton);
+    return it == _hierarchies.end() || !(it->second.source == source) ? nullptr : it->second.value;
+}
+
+_MDL_INLINE void MDL::Private::JointHierarchyStore::insert(const void* skeleton, const NS::Array* jointPaths,
+                                                          std::shared_ptr<const JointHierarchy> hierarchy)
+{
+    const Source source = Source::of(jointPaths);
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _hierarchies[skeleton] = { source, std::move(hierarchy) };
+        for (auto it = _jointMaps.begin(); it != _jointMaps.end();)
+        {
+            it = it->first.first == skeleton ? _jointMaps.erase(it) : std::next(it);
+        }
+    }
+    ObjectLifetime::watch(skeleton, this, &JointHierarchyStore::evict);
+}
+
+_MDL_INLINE std::shared_ptr<const MDL::Private::JointMap> MDL::Private::JointHierarchyStore::findJointMap(const void* skeleton, const void* animation,
+                                                                                                          const NS::Array* animationJointPaths)
+{
+    const Source                source = Source::of(animationJointPaths);
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _jointMaps.find(std::make_pair(skeleton, animation));
+    return it == _jointMaps.end() || !(it->second.source == source) ? nullptr : it->second.value;
+}
+
+_MDL_INLINE void MDL::Private::JointHierarchyStore::insertJointMap(const void* skeleton, const void* animation,
+                                                                  const NS::Array* animationJointPaths,
+                                                                  std::shared_ptr<const JointMap> map)
+{
+    const Source source = Source::of(animationJointPaths);
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _jointMaps[std::make_pair(skeleton, animation)] = { source, std::move(map) };
+    }
+    ObjectLifetime::watch(skeleton, this, &JointHierarchyStore::evict);
+    ObjectLifetime::watch(animation, this, &JointHierarchyStore::evict);
+}
+
+_MDL_INLINE void MDL::Private::JointHierarchyStore::remove(const void* object)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _hierarchies.erase(object);
+    for (auto it = _jointMaps.begin(); it != _jointMaps.end();)
+    {
+        it = it->first.first == object || it->first.second == object ? _jointMaps.erase(it) : std::next(it);
+    }
+}
+
+_MDL_INLINE void MDL::Private::JointHierarchyStore::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _hierarchies.clear();
+    _jointMaps.clear();
+}
+
+_MDL_INLINE void MDL::Private::JointHierarchyStore::evict(const void* object)
+{
+    shared().remove(object);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,515 @@
+/*!
+ @header MDLKeyframeSampling.hpp
+ @framework ModelIO
+ @abstract Native keyframe storage, cursor-based and batched sampling
+ @copyright Treata Norouzi on 10/19/26.
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include "MDLDefines.hpp"
+#include "MDLAlignedAllocator.hpp"
+#include "MDLObjectLifetime.hpp"
+#include "Foundation/NSTypes.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define _MDL_KEYFRAME_SAMPLING_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define _MDL_KEYFRAME_SAMPLING_NEON 1
+#endif
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace MDL
+{
+namespace Private
+{
+    class KeyframeCurve;
+}
+
+// Key times of an animated value, without boxing them in an NS::Array. The
+// span holds the keys it was taken from, so it stays valid, and unchanged,
+// after the value's keys next change.
+struct KeyTimeSpan
+{
+    const NS::TimeInterval*             data = nullptr;
+    NS::UInteger                        count = 0;
+    std::shared_ptr<const void>         keys;
+
+    const NS::TimeInterval*             begin() const;
+    const NS::TimeInterval*             end() const;
+};
+
+// Where a sequential reader is in an animated value's keys, kept between
+// calls so playback that moves forward finds its key in O(1). Keep one per
+// value being played; a cursor moved to another value starts over.
+struct KeyframeCursor
+{
+    const void*                                     value = nullptr;
+    std::shared_ptr<const Private::KeyframeCurve>   curve;
+    std::uint64_t                                   generation = 0;
+    std::uint32_t                                   key = 0;
+};
+
+namespace Private
+{
+    // Key times and values of one animated value, as two aligned arrays.
+    // Times are kept in double precision, as ModelIO keeps them. Values are
+    // stored `stride` floats apart, the layout of the simd type the native
+    // readers return (4 for vector_float3 and simd_quatf, 16 for
+    // matrix_float4x4); double getters are answered by ModelIO. Times before
+    // the first key and after the last clamp to them.
+    class KeyframeCurve
+    {
+    public:
+        enum Interpolation : std::uint8_t
+        {
+            InterpolationConstant,
+            InterpolationLinear,
+            // Linear along the shorter arc, for quaternions
+            InterpolationSpherical,
+        };
+
+        // Samples located per pass before they are interpolated
+        static constexpr NS::UInteger   BlockSize = 256;
+
+        // Sizes the curve for `keyCount` keys, to be filled through times()
+        // and values()
+        void                            reset(NS::UInteger keyCount, NS::UInteger stride, Interpolation interpolation);
+        void                            clear();
+        // Adds a key, or replaces the value of the key at `time`; O(1) when
+        // keys arrive in time order
+        void                            insert(double time, const float* value);
+
+        NS::UInteger                    keyCount() const;
+        NS::UInteger                    stride() const;
+
+        Interpolation                   interpolation() const;
+        void                            setInterpolation(Interpolation interpolation);
+
+        double*                         times();
+        const double*                   times() const;
+        float*                          values();
+        const float*                    values() const;
+
+        // One sample, starting the key search from `key` and leaving it at
+        // the key found
+        void                            sample(double time, std::uint32_t& key, float* out) const;
+        // Writes the curve at each of `times` to `out`, `stride` floats per
+        // sample, moving one cursor through the keys
+        void                            sample(const double* times, NS::UInteger count, float* out) const;
+        // At start + i * interval
+        void                            sample(double start, double interval, NS::UInteger count, float* out) const;
+
+    private:
+        // Steps taken from the previous key before searching by bisection
+        static constexpr int            SeekSteps = 4;
+
+        template <typename _Time>
+        void                            sampleBlocks(_Time&& timeAt, NS::UInteger count, float* out) const;
+        // Moves `key` to the last key at or before `time` and returns the
+        // weight of the key after it
+        float                           seek(double time, std::uint32_t& key) const;
+        void                            interpolate(const std::uint32_t* keys, const float* weights, NS::UInteger count,
+                                                    float* out) const;
+
+        AlignedVector<double>           _times;
+        AlignedVector<float>            _values;
+        NS::UInteger                    _stride = 1;
+        Interpolation                   _interpolation = InterpolationLinear;
+    };
+
+    // Native copies of the keys of animated values, by value. The ModelIO
+    // objects stay authoritative: the bridge imports their keys on first use
+    // and writes every later edit it makes through to both. Readers get a
+    // shared snapshot that no later edit changes: an edit works on the stored
+    // curve only when nobody else holds it, and on a copy otherwise. Entries
+    // go away with their values.
+    class KeyframeStore
+    {
+    public:
+        using Curve = std::shared_ptr<const KeyframeCurve>;
+
+        static KeyframeStore&           shared();
+
+        // nullptr until `value` is imported
+        Curve                           find(const void* value);
+        // Stores the imported keys of `value`, replacing any earlier ones
+        Curve                           insert(const void* value, KeyframeCurve&& curve);
+        void                            remove(const void* value);
+        void                            clear();
+
+        // Curve of `value` through `cursor`, which holds it; looked up again
+        // only when the cursor was last used on another value or curves
+        // changed since
+        const KeyframeCurve*            find(const void* value, KeyframeCursor& cursor);
+
+        // Runs `edit(KeyframeCurve&)` under the store's lock if `value` has
+        // been imported
+        template <typename _Edit>
+        void                            edit(const void* value, _Edit&& edit);
+
+    private:
+        static void                     evict(const void* value);
+
+        std::mutex                                                          _mutex;
+        std::unordered_map<const void*, std::shared_ptr<KeyframeCurve>>     _curves;
+        // Bumped whenever a curve is created, edited or removed, so cursors
+        // drop the snapshot they hold
+        std::atomic<std::uint64_t>                                          _generation { 1 };
+    };
+
+} // Private
+} // MDL
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// MARK: - Private Sector
+
+_MDL_INLINE const NS::TimeInterval* MDL::KeyTimeSpan::begin() const
+{
+    return data;
+}
+
+_MDL_INLINE const NS::TimeInterval* MDL::KeyTimeSpan::end() const
+{
+    return data + count;
+}
+
+_MDL_INLINE void MDL::Private::KeyframeCurve::reset(NS::UInteger keyCount, NS::UInteger stride, Interpolation interpolation)
+{
+    _times.resize(keyCount);
+    _values.resize(keyCount * stride);
+    _stride = stride;
+    _interpolation = interpolation;
+}
+
+_MDL_INLINE void MDL::Private::KeyframeCurve::clear()
+{
+    _times.clear();
+    _values.clear();
+}
+
+_MDL_INLINE void MDL::Private::KeyframeCurve::insert(double time, const float* value)
+{
+    NS::UInteger index = _times.size();
+    if (!_times.empty() && time <= _times.back())
+    {
+        index = std::lower_bound(_times.begin(), _times.end(), time) - _times.begin();
+        if (_times[index] == time)
+        {
+            std::copy(value, value + _stride, _values.begin() + index * _stride);
+            return;
+        }
+    }
+    _times.insert(_times.begin() + index, time);
+    _values.insert(_values.begin() + index * _stride, value, value + _stride);
+}
+
+_MDL_INLINE NS::UInteger MDL::Private::KeyframeCurve::keyCount() const
+{
+    return _times.size();
+}
+
+_MDL_INLINE NS::UInteger MDL::Private::KeyframeCurve::stride() const
+{
+    return _stride;
+}
+
+_MDL_INLINE MDL::Private::KeyframeCurve::Interpolation MDL::Private::KeyframeCurve::interpolation() const
+{
+    return _interpolation;
+}
+
+_MDL_INLINE void MDL::Private::KeyframeCurve::setInterpolation(Interpolation interpolation)
+{
+    _interpolation = interpolation;
+}
+
+_MDL_INLINE double* MDL::Private::KeyframeCurve::times()
+{
+    return _times.data();
+}
+
+_MDL_INLINE const double* MDL::Private::KeyframeCurve::times() const
+{
+    return _times.data();
+}
+
+_MDL_INLINE float* MDL::Private::KeyframeCurve::values()
+{
+    return _values.data();
+}
+
+_MDL_INLINE const float* MDL::Private::KeyframeCurve::values() const
+{
+    return _values.data();
+}
+
+_MDL_INLINE void MDL::Private::KeyframeCurve::sample(double time, std::uint32_t& key, float* out) const
+{
+    if (_times.empty())
+    {
+        std::fill(out, out + _stride, 0.0f);
+        return;
+    }
+
+    const float weight = seek(time, key);
+    interpolate(&key, &weight, 1, out);
+}
+
+_MDL_INLINE void MDL::Private::KeyframeCurve::sample(const double* times, NS::UInteger count, float* out) const
+{
+    sampleBlocks([times](NS::UInteger i) { return times[i]; }, count, out);
+}
+
+_MDL_INLINE void MDL::Private::KeyframeCurve::sample(double start, double interval, NS::UInteger count, float* out) const
+{
+    sampleBlocks([start, interval](NS::UInteger i) { return start + double(i) * interval; }, count, out);
+}
+
+template <typename _Time>
+_MDL_INLINE void MDL::Private::KeyframeCurve::sampleBlocks(_Time&& timeAt, NS::UInteger count, float* out) const
+{
+    if (_times.empty())
+    {
+        std::fill(out, out + count * _stride, 0.0f);
+        return;
+    }
+
+    std::uint32_t keys[BlockSize];
+    float         weights[BlockSize];
+    std::uint32_t key = 0;
+    for (NS::UInteger begin = 0; begin < count; begin += BlockSize)
+    {
+        const NS::UInteger size = std::min<NS::UInteger>(BlockSize, count - begin);
+        for (NS::UInteger i = 0; i < size; ++i)
+        {
+            weights[i] = seek(timeAt(begin + i), key);
+            keys[i] = key;
+        }
+        interpolate(keys, weights, size, out + begin * _stride);
+    }
+}
+
+_MDL_INLINE float MDL::Private::KeyframeCurve::seek(double time, std::uint32_t& key) const
+{
+    const std::uint32_t last = std::uint32_t(_times.size() - 1);
+    key = std::min(key, last);
+
+    if (time < _times[key])
+    {
+        if (key > 0 && time >= _times[key - 1])
+        {
+            --key;
+        }
+        else
+        {
+            key = std::uint32_t(std::max<std::ptrdiff_t>(std::upper_bound(_times.begin(), _times.begin() + key, time) - _times.begin() - 1, 0));
+        }
+    }
+    else
+    {
+        for (int step = 0; key < last && _times[key + 1] <= time; ++step)
+        {
+            if (step == SeekSteps)
+            {
+                key = std::uint32_t(std::upper_bound(_times.begin() + key + 1, _times.end(), time) - _times.begin() - 1);
+                break;
+            }
+            ++key;
+        }
+    }
+
+    if (key < last && time > _times[key] && _interpolation != InterpolationConstant)
+    {
+        return float((time - _times[key]) / (_times[key + 1] - _times[key]));
+    }
+    return 0.0f;
+}
+
+_MDL_INLINE void MDL::Private::KeyframeCurve::interpolate(const std::uint32_t* keys, const float* weights, NS::UInteger count,
+                                                          float* out) const
+{
+    const float*        values = _values.data();
+    const std::uint32_t last = std::uint32_t(_times.size() - 1);
+    const NS::UInteger  stride = _stride;
+
+    if (_interpolation == InterpolationSpherical)
+    {
+        for (NS::UInteger i = 0; i < count; ++i)
+        {
+            const float* a = values + keys[i] * stride;
+            const float* b = values + std::min(keys[i] + 1, last) * stride;
+            const float  t = weights[i];
+            float        cosine = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+            const float  sign = cosine < 0.0f ? -1.0f : 1.0f;
+            cosine *= sign;
+
+            // Close keys interpolate linearly, where the sine would lose
+            // precision
+            float wa = 1.0f - t;
+            float wb = t * sign;
+            if (cosine < 0.9995f)
+            {
+                const float angle = std::acos(cosine);
+                const float inverseSine = 1.0f / std::sin(angle);
+                wa = std::sin((1.0f - t) * angle) * inverseSine;
+                wb = std::sin(t * angle) * inverseSine * sign;
+            }
+            float* o = out + i * stride;
+            float  length = 0.0f;
+            for (int c = 0; c < 4; ++c)
+            {
+                o[c] = wa * a[c] + wb * b[c];
+                length += o[c] * o[c];
+            }
+            const float inverseLength = length > 0.0f ? 1.0f / std::sqrt(length) : 0.0f;
+            for (int c = 0; c < 4; ++c)
+            {
+                o[c] *= inverseLength;
+            }
+        }
+        return;
+    }
+
+    if (stride == 1)
+    {
+        float a[BlockSize];
+        float b[BlockSize];
+        for (NS::UInteger i = 0; i < count; ++i)
+        {
+            a[i] = values[keys[i]];
+            b[i] = values[std::min(keys[i] + 1, last)];
+        }
+        for (NS::UInteger i = 0; i < count; ++i)
+        {
+            out[i] = a[i] + (b[i] - a[i]) * weights[i];
+        }
+        return;
+    }
+
+    for (NS::UInteger i = 0; i < count; ++i)
+    {
+        const float* a = values + keys[i] * stride;
+        const float* b = values + std::min(keys[i] + 1, last) * stride;
+        float*       o = out + i * stride;
+        NS::UInteger c = 0;
+#if defined(_MDL_KEYFRAME_SAMPLING_SSE)
+        const __m128 t = _mm_set1_ps(weights[i]);
+        for (; c + 4 <= stride; c += 4)
+        {
+            const __m128 va = _mm_loadu_ps(a + c);
+            _mm_storeu_ps(o + c, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b + c), va), t)));
+        }
+#elif defined(_MDL_KEYFRAME_SAMPLING_NEON)
+        for (; c + 4 <= stride; c += 4)
+        {
+            const float32x4_t va = vld1q_f32(a + c);
+            vst1q_f32(o + c, vmlaq_n_f32(va, vsubq_f32(vld1q_f32(b + c), va), weights[i]));
+        }
+#endif
+        for (; c < stride; ++c)
+        {
+            o[c] = a[c] + (b[c] - a[c]) * weights[i];
+        }
+    }
+}
+
+_MDL_INLINE MDL::Private::KeyframeStore& MDL::Private::KeyframeStore::shared()
+{
+    static KeyframeStore store;
+    return store;
+}
+
+_MDL_INLINE MDL::Private::KeyframeStore::Curve MDL::Private::KeyframeStore::find(const void* value)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _curves.find(value);
+    return it == _curves.end() ? nullptr : it->second;
+}
+
+_MDL_INLINE MDL::Private::KeyframeStore::Curve MDL::Private::KeyframeStore::insert(const void* value, KeyframeCurve&& curve)
+{
+    std::shared_ptr<KeyframeCurve> stored = std::make_shared<KeyframeCurve>(std::move(curve));
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _curves[value] = stored;
+        _generation.fetch_add(1, std::memory_order_acq_rel);
+    }
+    ObjectLifetime::watch(value, this, &KeyframeStore::evict);
+    return stored;
+}
+
+_MDL_INLINE void MDL::Private::KeyframeStore::remove(const void* value)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_curves.erase(value))
+    {
+        _generation.fetch_add(1, std::memory_order_acq_rel);
+    }
+}
+
+_MDL_INLINE void MDL::Private::KeyframeStore::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _curves.clear();
+    _generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+_MDL_INLINE const MDL::Private::KeyframeCurve* MDL::Private::KeyframeStore::find(const void* value, KeyframeCursor& cursor)
+{
+    const std::uint64_t generation = _generation.load(std::memory_order_acquire);
+    if (cursor.value != value || cursor.generation != generation)
+    {
+        cursor.value = value;
+        cursor.curve = find(value);
+        cursor.generation = generation;
+        cursor.key = 0;
+    }
+    return cursor.curve.get();
+}
+
+template <typename _Edit>
+_MDL_INLINE void MDL::Private::KeyframeStore::edit(const void* value, _Edit&& edit)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _curves.find(value);
+    if (it == _curves.end())
+    {
+        return;
+    }
+
+    // Snapshots are only handed out under the lock, so a curve nobody else
+    // holds can be changed in place
+    if (it->second.use_count() != 1)
+    {
+        it->second = std::make_shared<KeyframeCurve>(*it->second);
+    }
+    edit(*it->second);
+    _generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+_MDL_INLINE void MDL::Private::KeyframeStore::evict(const void* value)
+{
+    KeyframeStore&              store = shared();
+    std::lock_guard<std::mutex> lock(store._mutex);
+    if (store._curves.erase(value))
+    {
+        store._generation.fetch_add(1, std::memory_order_acq_rel);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
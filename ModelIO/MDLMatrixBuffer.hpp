@@ -0,0 +1,480 @@
+/*!
+ @header MDLMatrixBuffer.hpp
+ @framework ModelIO
+ @abstract Aligned native storage and bulk kernels for arrays of 4x4 matrices
+ @copyright Treata Norouzi on 10/19/26.
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include "MDLDefines.hpp"
+#include "MDLTypes.hpp"
+#include "MDLAlignedAllocator.hpp"
+#include "MDLObjectLifetime.hpp"
+#include "MDLParallel.hpp"
+#include "MDLTransformProgram.hpp"
+#include "Foundation/NSTypes.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define _MDL_MATRIX_BUFFER_SSE 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define _MDL_MATRIX_BUFFER_NEON 1
+#endif
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace MDL
+{
+// Column-major 4x4 matrices in one 64-byte-aligned allocation, each matrix
+// on its own cache line in float precision. The storage is sized for double
+// precision, so converting between the two happens in place.
+class Matrix4x4Buffer
+{
+public:
+                                    Matrix4x4Buffer() = default;
+    explicit                        Matrix4x4Buffer(NS::UInteger count, DataPrecision precision = DataPrecisionFloat);
+
+    NS::UInteger                    count() const;
+    DataPrecision                   precision() const;
+    // Identity matrices past the current count
+    void                            resize(NS::UInteger count);
+
+    // Spans over the matrices, 16 values each; nullptr unless the buffer
+    // holds that precision
+    float*                          floats();
+    const float*                    floats() const;
+    double*                         doubles();
+    const double*                   doubles() const;
+
+    void                            convert(DataPrecision precision);
+
+    // Bulk kernels, in place: matrix i times `other` matrix i, every matrix
+    // times `matrix` or `matrix` times every matrix, and inverses and
+    // transposes. The other operands are in this buffer's precision.
+    void                            multiply(const Matrix4x4Buffer& other);
+    void                            multiply(const void* matrix);
+    void                            premultiply(const void* matrix);
+    void                            invert();
+    void                            transpose();
+
+private:
+    Private::AlignedVector<double>  _storage;
+    NS::UInteger                    _count = 0;
+    DataPrecision                   _precision = DataPrecisionFloat;
+};
+
+namespace Private
+{
+    // Kernels over `count` column-major 4x4 matrices; outputs may alias
+    // inputs matrix for matrix, and large counts spread over the worker pool
+    struct MatrixKernels
+    {
+        static constexpr NS::UInteger   Grain = 4096;
+
+        // out[i] = a[i] * b[i * bStride], so a zero stride applies one matrix
+        template <typename _Scalar>
+        static void                     multiply(const _Scalar* a, const _Scalar* b, NS::UInteger bStride, _Scalar* out, NS::UInteger count);
+        // out[i] = m * b[i]
+        template <typename _Scalar>
+        static void                     premultiply(const _Scalar* m, const _Scalar* b, _Scalar* out, NS::UInteger count);
+        template <typename _Scalar>
+        static void                     invert(const _Scalar* in, _Scalar* out, NS::UInteger count);
+        template <typename _Scalar>
+        static void                     transpose(const _Scalar* in, _Scalar* out, NS::UInteger count);
+
+        // Widening runs back to front and narrowing front to back, so both
+        // work in place over storage sized for doubles
+        static void                     widen(const float* in, double* out, NS::UInteger valueCount);
+        static void                     narrow(const double* in, float* out, NS::UInteger valueCount);
+
+    private:
+        static void                     multiplyOne(const float* a, const float* b, float* out);
+        static void                     multiplyOne(const double* a, const double* b, double* out);
+        static void                     transposeOne(const float* in, float* out);
+        static void                     transposeOne(const double* in, double* out);
+    };
+
+    // Native mirrors of Matrix4x4Array contents, by array; written through
+    // by the bridge setters so reads skip the Objective-C copy, and dropped
+    // when the array is initialized or deallocated
+    class MatrixBufferStore
+    {
+    public:
+        static MatrixBufferStore&                       shared();
+
+        std::shared_ptr<const Matrix4x4Buffer>          find(const void* array);
+        void                                            insert(const void* array, std::shared_ptr<const Matrix4x4Buffer> buffer);
+        void                                            remove(const void* array);
+        void                                            clear();
+
+    private:
+        static void                                     evict(const void* array);
+
+        std::mutex                                      _mutex;
+        std::unordered_map<const void*, std::shared_ptr<const Matrix4x4Buffer>> _buffers;
+    };
+
+} // Private
+} // MDL
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// MARK: - Private Sector
+
+_MDL_INLINE MDL::Matrix4x4Buffer::Matrix4x4Buffer(NS::UInteger count, DataPrecision precision)
+    : _precision(precision == DataPrecisionDouble ? DataPrecisionDouble : DataPrecisionFloat)
+{
+    resize(count);
+}
+
+_MDL_INLINE NS::UInteger MDL::Matrix4x4Buffer::count() const
+{
+    return _count;
+}
+
+_MDL_INLINE MDL::DataPrecision MDL::Matrix4x4Buffer::precision() const
+{
+    return _precision;
+}
+
+_MDL_INLINE void MDL::Matrix4x4Buffer::resize(NS::UInteger count)
+{
+    const NS::UInteger previous = _count;
+    _storage.resize(count * 16);
+    _count = count;
+    for (NS::UInteger i = previous * 16; i < count * 16; ++i)
+    {
+        if (_precision == DataPrecisionDouble)
+        {
+            _storage[i] = double(i % 16 % 5 == 0);
+        }
+        else
+        {
+            reinterpret_cast<float*>(_storage.data())[i] = float(i % 16 % 5 == 0);
+        }
+    }
+}
+
+_MDL_INLINE float* MDL::Matrix4x4Buffer::floats()
+{
+    return _precision == DataPrecisionFloat ? reinterpret_cast<float*>(_storage.data()) : nullptr;
+}
+
+_MDL_INLINE const float* MDL::Matrix4x4Buffer::floats() const
+{
+    return _precision == DataPrecisionFloat ? reinterpret_cast<const float*>(_storage.data()) : nullptr;
+}
+
+_MDL_INLINE double* MDL::Matrix4x4Buffer::doubles()
+{
+    return _precision == DataPrecisionDouble ? _storage.data() : nullptr;
+}
+
+_MDL_INLINE const double* MDL::Matrix4x4Buffer::doubles() const
+{
+    return _precision == DataPrecisionDouble ? _storage.data() : nullptr;
+}
+
+_MDL_INLINE void MDL::Matrix4x4Buffer::convert(DataPrecision precision)
+{
+    precision = precision == DataPrecisionDouble ? DataPrecisionDouble : DataPrecisionFloat;
+    if (precision == _precision)
+    {
+        return;
+    }
+    float* narrow = reinterpret_cast<float*>(_storage.data());
+    if (precision == DataPrecisionDouble)
+    {
+        Private::MatrixKernels::widen(narrow, _storage.data(), _count * 16);
+    }
+    else
+    {
+        Private::MatrixKernels::narrow(_storage.data(), narrow, _count * 16);
+    }
+    _precision = precision;
+}
+
+_MDL_INLINE void MDL::Matrix4x4Buffer::multiply(const Matrix4x4Buffer& other)
+{
+    const NS::UInteger count = std::min(_count, other._count);
+    if (_precision == DataPrecisionDouble)
+    {
+        Private::MatrixKernels::multiply(doubles(), other.doubles(), 16, doubles(), count);
+    }
+    else
+    {
+        Private::MatrixKernels::multiply(floats(), other.floats(), 16, floats(), count);
+    }
+}
+
+_MDL_INLINE void MDL::Matrix4x4Buffer::multiply(const void* matrix)
+{
+    if (_precision == DataPrecisionDouble)
+    {
+        Private::MatrixKernels::multiply(doubles(), static_cast<const double*>(matrix), 0, doubles(), _count);
+    }
+    else
+    {
+        Private::MatrixKernels::multiply(floats(), static_cast<const float*>(matrix), 0, floats(), _count);
+    }
+}
+
+_MDL_INLINE void MDL::Matrix4x4Buffer::premultiply(const void* matrix)
+{
+    if (_precision == DataPrecisionDouble)
+    {
+        Private::MatrixKernels::premultiply(static_cast<const double*>(matrix), doubles(), doubles(), _count);
+    }
+    else
+    {
+        Private::MatrixKernels::premultiply(static_cast<const float*>(matrix), floats(), floats(), _count);
+    }
+}
+
+_MDL_INLINE void MDL::Matrix4x4Buffer::invert()
+{
+    if (_precision == DataPrecisionDouble)
+    {
+        Private::MatrixKernels::invert(doubles(), doubles(), _count);
+    }
+    else
+    {
+        Private::MatrixKernels::invert(floats(), floats(), _count);
+    }
+}
+
+_MDL_INLINE void MDL::Matrix4x4Buffer::transpose()
+{
+    if (_precision == DataPrecisionDouble)
+    {
+        Private::MatrixKernels::transpose(doubles(), doubles(), _count);
+    }
+    else
+    {
+        Private::MatrixKernels::transpose(floats(), floats(), _count);
+    }
+}
+
+template <typename _Scalar>
+_MDL_INLINE void MDL::Private::MatrixKernels::multiply(const _Scalar* a, const _Scalar* b, NS::UInteger bStride, _Scalar* out,
+                                                      NS::UInteger count)
+{
+    parallelFor(count, Grain, [=](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger i = begin; i < end; ++i)
+        {
+            multiplyOne(a + i * 16, b + i * bStride, out + i * 16);
+        }
+    });
+}
+
+template <typename _Scalar>
+_MDL_INLINE void MDL::Private::MatrixKernels::premultiply(const _Scalar* m, const _Scalar* b, _Scalar* out, NS::UInteger count)
+{
+    parallelFor(count, Grain, [=](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger i = begin; i < end; ++i)
+        {
+            multiplyOne(m, b + i * 16, out + i * 16);
+        }
+    });
+}
+
+template <typename _Scalar>
+_MDL_INLINE void MDL::Private::MatrixKernels::invert(const _Scalar* in, _Scalar* out, NS::UInteger count)
+{
+    parallelFor(count, Grain / 4, [=](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger i = begin; i < end; ++i)
+        {
+            TransformProgram::invert(in + i * 16, out + i * 16);
+        }
+    });
+}
+
+template <typename _Scalar>
+_MDL_INLINE void MDL::Private::MatrixKernels::transpose(const _Scalar* in, _Scalar* out, NS::UInteger count)
+{
+    parallelFor(count, Grain, [=](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger i = begin; i < end; ++i)
+        {
+            transposeOne(in + i * 16, out + i * 16);
+        }
+    });
+}
+
+_MDL_INLINE void MDL::Private::MatrixKernels::widen(const float* in, double* out, NS::UInteger valueCount)
+{
+    NS::UInteger i = valueCount;
+#if defined(_MDL_MATRIX_BUFFER_SSE)
+    for (; i >= 4; i -= 4)
+    {
+        const __m128 values = _mm_loadu_ps(in + i - 4);
+        _mm_storeu_pd(out + i - 2, _mm_cvtps_pd(_mm_movehl_ps(values, values)));
+        _mm_storeu_pd(out + i - 4, _mm_cvtps_pd(values));
+    }
+#elif defined(_MDL_MATRIX_BUFFER_NEON)
+    for (; i >= 4; i -= 4)
+    {
+        const float32x4_t values = vld1q_f32(in + i - 4);
+        vst1q_f64(out + i - 2, vcvt_high_f64_f32(values));
+        vst1q_f64(out + i - 4, vcvt_f64_f32(vget_low_f32(values)));
+    }
+#endif
+    for (; i > 0; --i)
+    {
+        out[i - 1] = double(in[i - 1]);
+    }
+}
+
+_MDL_INLINE void MDL::Private::MatrixKernels::narrow(const double* in, float* out, NS::UInteger valueCount)
+{
+    NS::UInteger i = 0;
+#if defined(_MDL_MATRIX_BUFFER_SSE)
+    for (; i + 4 <= valueCount; i += 4)
+    {
+        const __m128 low = _mm_cvtpd_ps(_mm_loadu_pd(in + i));
+        const __m128 high = _mm_cvtpd_ps(_mm_loadu_pd(in + i + 2));
+        _mm_storeu_ps(out + i, _mm_movelh_ps(low, high));
+    }
+#elif defined(_MDL_MATRIX_BUFFER_NEON)
+    for (; i + 4 <= valueCount; i += 4)
+    {
+        vst1q_f32(out + i, vcvt_high_f32_f64(vcvt_f32_f64(vld1q_f64(in + i)), vld1q_f64(in + i + 2)));
+    }
+#endif
+    for (; i < valueCount; ++i)
+    {
+        out[i] = float(in[i]);
+    }
+}
+
+_MDL_INLINE void MDL::Private::MatrixKernels::multiplyOne(const float* a, const float* b, float* out)
+{
+#if defined(_MDL_MATRIX_BUFFER_SSE)
+    const __m128 a0 = _mm_loadu_ps(a), a1 = _mm_loadu_ps(a + 4), a2 = _mm_loadu_ps(a + 8), a3 = _mm_loadu_ps(a + 12);
+    __m128 columns[4];
+    for (int c = 0; c < 4; ++c)
+    {
+        const float* bc = b + c * 4;
+        columns[c] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(bc[0])), _mm_mul_ps(a1, _mm_set1_ps(bc[1]))),
+                                _mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(bc[2])), _mm_mul_ps(a3, _mm_set1_ps(bc[3]))));
+    }
+    for (int c = 0; c < 4; ++c)
+    {
+        _mm_storeu_ps(out + c * 4, columns[c]);
+    }
+#elif defined(_MDL_MATRIX_BUFFER_NEON)
+    const float32x4_t a0 = vld1q_f32(a), a1 = vld1q_f32(a + 4), a2 = vld1q_f32(a + 8), a3 = vld1q_f32(a + 12);
+    float32x4_t columns[4];
+    for (int c = 0; c < 4; ++c)
+    {
+        const float32x4_t bc = vld1q_f32(b + c * 4);
+        columns[c] = vfmaq_laneq_f32(vfmaq_laneq_f32(vfmaq_laneq_f32(vmulq_laneq_f32(a0, bc, 0), a1, bc, 1), a2, bc, 2), a3, bc, 3);
+    }
+    for (int c = 0; c < 4; ++c)
+    {
+        vst1q_f32(out + c * 4, columns[c]);
+    }
+#else
+    TransformProgram::multiply(a, b, out);
+#endif
+}
+
+_MDL_INLINE void MDL::Private::MatrixKernels::multiplyOne(const double* a, const double* b, double* out)
+{
+    TransformProgram::multiply(a, b, out);
+}
+
+_MDL_INLINE void MDL::Private::MatrixKernels::transposeOne(const float* in, float* out)
+{
+#if defined(_MDL_MATRIX_BUFFER_SSE)
+    __m128 c0 = _mm_loadu_ps(in), c1 = _mm_loadu_ps(in + 4), c2 = _mm_loadu_ps(in + 8), c3 = _mm_loadu_ps(in + 12);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    _mm_storeu_ps(out, c0);
+    _mm_storeu_ps(out + 4, c1);
+    _mm_storeu_ps(out + 8, c2);
+    _mm_storeu_ps(out + 12, c3);
+#elif defined(_MDL_MATRIX_BUFFER_NEON)
+    // De-interleaving loads transpose on the way in
+    const float32x4x4_t rows = vld4q_f32(in);
+    vst1q_f32(out, rows.val[0]);
+    vst1q_f32(out + 4, rows.val[1]);
+    vst1q_f32(out + 8, rows.val[2]);
+    vst1q_f32(out + 12, rows.val[3]);
+#else
+    float result[16];
+    for (int c = 0; c < 4; ++c)
+    {
+        for (int r = 0; r < 4; ++r)
+        {
+            result[r * 4 + c] = in[c * 4 + r];
+        }
+    }
+    std::copy(result, result + 16, out);
+#endif
+}
+
+_MDL_INLINE void MDL::Private::MatrixKernels::transposeOne(const double* in, double* out)
+{
+    double result[16];
+    for (int c = 0; c < 4; ++c)
+    {
+        for (int r = 0; r < 4; ++r)
+        {
+            result[r * 4 + c] = in[c * 4 + r];
+        }
+    }
+    std::copy(result, result + 16, out);
+}
+
+_MDL_INLINE MDL::Private::MatrixBufferStore& MDL::Private::MatrixBufferStore::shared()
+{
+    static MatrixBufferStore store;
+    return store;
+}
+
+_MDL_INLINE std::shared_ptr<const MDL::Matrix4x4Buffer> MDL::Private::MatrixBufferStore::find(const void* array)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _buffers.find(array);
+    return it == _buffers.end() ? nullptr : it->second;
+}
+
+_MDL_INLINE void MDL::Private::MatrixBufferStore::insert(const void* array, std::shared_ptr<const Matrix4x4Buffer> buffer)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _buffers[array] = std::move(buffer);
+    }
+    ObjectLifetime::watch(array, this, &MatrixBufferStore::evict);
+}
+
+_MDL_INLINE void MDL::Private::MatrixBufferStore::remove(const void* array)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _buffers.erase(array);
+}
+
+_MDL_INLINE void MDL::Private::MatrixBufferStore::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _buffers.clear();
+}
+
+_MDL_INLINE void MDL::Private::MatrixBufferStore::evict(const void* array)
+{
+    shared().remove(array);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
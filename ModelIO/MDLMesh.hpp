@@ -12,6 +12,10 @@
 #include "MDLSubmesh.hpp"
 #include "MDLMeshBuffer.hpp"
 #include "MDLVertexDescriptor.hpp"
+#include "MDLMeshSimplifier.hpp"
+#include "MDLBoundingVolumeHierarchy.hpp"
+#include "MDLInstancing.hpp"
+#include "MDLVertexBounds.hpp"
 
 namespace MDL
 {
@@ -78,8 +82,8 @@ public:
     void                setVertexBuffers(const NS::Array* vertexBuffers);
     
     // !!!: NSMutableArray is not ported to Cpp!
-    // copy
-//    NS::MutableArray*   submeshes() const;
+    // copy; read back through its NSArray interface
+    NS::Array*          submeshes() const;
 //    void                setsubmeshes(const NS::MutableArray* submeshes);
     
     class MeshBufferAllocator*  allocator() const;
@@ -327,8 +331,60 @@ public:
     BOOL                generateLightMapVertexColorsWithLightsToConsider(const NS::Array* lightsToConsider,
                                                                          const NS::Array* objectsToConsider,
                                                                          const NS::String* vertexAttributeName);
+    
+    // MARK: - Native
+    
+    // Copy of the mesh with every triangle submesh reduced to about
+    // `targetRatio` of its triangles. The copy shares the vertex buffers;
+    // vertices used by several submeshes, crease vertices and the corners of
+    // hole faces stay where they are, and creased edges stay sharp. `maxError`
+    // is relative to the diagonal of the bounds.
+    class Mesh*         newSimplifiedMesh(float targetRatio,
+                                          float maxError,
+                                          class MeshBufferAllocator* allocator);
+    
+    // One mesh per entry of `ratios` (largest first), all produced by a single
+    // collapse sequence and sharing the source vertex buffers
+    NS::Array*          newLevelsOfDetail(const float* ratios,
+                                          NS::UInteger levelCount,
+                                          float maxError,
+                                          class MeshBufferAllocator* allocator);
+    
+    // Hierarchy over the triangles of every triangle and strip submesh; its
+    // ranges are submesh indices. Built on first use and cached until an index
+    // or vertex buffer is replaced or refilled.
+    std::shared_ptr<BoundingVolumeHierarchy>    boundingVolumeHierarchy();
+    
+    // Refits a copy of the cached hierarchy to the current positions instead
+    // of rebuilding it, as long as only vertex data changed; hierarchies
+    // handed out earlier are left untouched
+    std::shared_ptr<BoundingVolumeHierarchy>    refitBoundingVolumeHierarchy();
+    
+    void                                        invalidateBoundingVolumeHierarchy() const;
 };
 
+namespace Private
+{
+    // Triangle list over every triangle and strip submesh of `mesh`, plus the
+    // first triangle of each submesh
+    void                                        meshTriangles(Mesh* mesh,
+                                                              std::vector<std::uint32_t>& triangles,
+                                                              std::vector<std::uint32_t>& rangeOffsets);
+    
+    BoundingVolumeHierarchyCache::Key           meshHierarchyKey(Mesh* mesh);
+    
+    // Layout, material names and buffer spans of `mesh` for deduplication;
+    // the hash is left to the caller so that it can run off the main thread
+    void                                        meshContent(Mesh* mesh, bool materials, MeshContent& content);
+    
+    // Component type and count of `format` as read by vertexBounds; false for
+    // packed and 32-bit integer formats
+    bool                                        vertexComponent(VertexFormat format,
+                                                                VertexComponent& component,
+                                                                NS::UInteger& componentCount);
+    
+} // Private
+
 }
 
 // MARK: - Private Sector 
@@ -452,8 +508,25 @@ _MDL_INLINE MDL::VertexAttributeData* MDL::Mesh::vertexAttributeDataForAttribute
 }
 
 // property: boundingBox
+// Reduced over the position attribute in its stored format; formats the
+// kernel does not read are left to ModelIO
 _MDL_INLINE MDL::AxisAlignedBoundingBox MDL::Mesh::boundingBox() const
 {
+    VertexAttributeData* positionData = Object::sendMessage<VertexAttributeData*>(this,
+                                                                                  _MDL_PRIVATE_SEL(vertexAttributeDataForAttributeNamed_),
+                                                                                  VertexAttributePosition);
+    
+    Private::VertexComponent component;
+    NS::UInteger componentCount;
+    Private::BoundsCache::Box box;
+    if (positionData
+        && Private::vertexComponent(positionData->format(), component, componentCount)
+        && Private::vertexBounds(positionData->dataStart(), positionData->stride(), vertexCount(),
+                                 component, componentCount, box.min, box.max))
+    {
+        return Private::axisAlignedBoundingBox(box);
+    }
+    
     return Object::sendMessage<AxisAlignedBoundingBox>(this, _MDL_PRIVATE_SEL(boundingBox));
 }
 
@@ -465,7 +538,8 @@ _MDL_INLINE MDL::VertexDescriptor* MDL::Mesh::vertexDescriptor() const
 // write method: setVertexDescriptor:
 _MDL_INLINE void MDL::Mesh::setVertexDescriptor(const VertexDescriptor* vertexDescriptor)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setVertexDescriptor_), vertexDescriptor);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setVertexDescriptor_), vertexDescriptor);
+    Private::BoundsCache::shared().markDirty(this);
 }
 
 // property: vertexCount
@@ -476,7 +550,8 @@ _MDL_INLINE NS::UInteger MDL::Mesh::vertexCount() const
 // write method: setVertexCount:
 _MDL_INLINE void MDL::Mesh::setVertexCount(NS::UInteger vertexCount)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setVertexCount_), vertexCount);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setVertexCount_), vertexCount);
+    Private::BoundsCache::shared().markDirty(this);
 }
 
 // property: vertexBuffers
@@ -487,7 +562,14 @@ _MDL_INLINE NS::Array* MDL::Mesh::vertexBuffers() const
 // write method: setVertexBuffers:
 _MDL_INLINE void MDL::Mesh::setVertexBuffers(const NS::Array* vertexBuffers)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setVertexBuffers_), vertexBuffers);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setVertexBuffers_), vertexBuffers);
+    Private::BoundsCache::shared().markDirty(this);
+}
+
+// property: submeshes
+_MDL_INLINE NS::Array* MDL::Mesh::submeshes() const
+{
+    return Object::sendMessage<NS::Array*>(this, _MDL_PRIVATE_SEL(submeshes));
 }
 
 // property: allocator
@@ -502,7 +584,8 @@ _MDL_INLINE MDL::MeshBufferAllocator* MDL::Mesh::allocator() const
 _MDL_INLINE void MDL::Mesh::addAttributeWithName(const NS::String* name,
                                                  VertexFormat format)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(addAttributeWithName_format_), name, format);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(addAttributeWithName_format_), name, format);
+    Private::BoundsCache::shared().markDirty(this);
 }
 
 // method: addAttributeWithName:format:type:data:stride:
@@ -512,9 +595,10 @@ _MDL_INLINE void MDL::Mesh::addAttributeWithName(const NS::String* name,
                                                  const NS::Data* data,
                                                  NS::Integer stride)
 {
-    return Object::sendMessage<void>(this, 
-                                     _MDL_PRIVATE_SEL(addAttributeWithName_format_type_data_stride_),
-                                     name, format, type, data, stride);
+    Object::sendMessage<void>(this, 
+                              _MDL_PRIVATE_SEL(addAttributeWithName_format_type_data_stride_),
+                              name, format, type, data, stride);
+    Private::BoundsCache::shared().markDirty(this);
 }
 
 // method: addAttributeWithName:format:type:data:stride:time:
@@ -525,9 +609,10 @@ _MDL_INLINE void MDL::Mesh::addAttributeWithName(const NS::String* name,
                                                  NS::Integer stride,
                                                  NS::TimeInterval time)
 {
-    return Object::sendMessage<void>(this,
-                                     _MDL_PRIVATE_SEL(addAttributeWithName_format_type_data_stride_time_),
-                                     name, format, type, data, stride, time);
+    Object::sendMessage<void>(this,
+                              _MDL_PRIVATE_SEL(addAttributeWithName_format_type_data_stride_time_),
+                              name, format, type, data, stride, time);
+    Private::BoundsCache::shared().markDirty(this);
 }
 
 
@@ -535,7 +620,8 @@ _MDL_INLINE void MDL::Mesh::addAttributeWithName(const NS::String* name,
 _MDL_INLINE void MDL::Mesh::addNormalsWithAttributeNamed(const NS::String* attributeName,
                                                          float creaseThreshold)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(addNormalsWithAttributeNamed_creaseThreshold_), attributeName, creaseThreshold);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(addNormalsWithAttributeNamed_creaseThreshold_), attributeName, creaseThreshold);
+    Private::BoundsCache::shared().markDirty(this);
 }
 
 // method: addTangentBasisForTextureCoordinateAttributeNamed:tangentAttributeNamed:bitangentAttributeNamed:
@@ -543,9 +629,10 @@ _MDL_INLINE void MDL::Mesh::addTangentBasisForTextureCoordinateAttributeNamed1(c
                                                                               const NS::String* tangentAttributeName,
                                                                               const NS::String* bitangentAttributeName)
 {
-    return Object::sendMessage<void>(this, 
-                                     _MDL_PRIVATE_SEL(addTangentBasisForTextureCoordinateAttributeNamed_tangentAttributeNamed_bitangentAttributeNamed_),
-                                     textureCoordinateAttributeName, tangentAttributeName, bitangentAttributeName);
+    Object::sendMessage<void>(this, 
+                              _MDL_PRIVATE_SEL(addTangentBasisForTextureCoordinateAttributeNamed_tangentAttributeNamed_bitangentAttributeNamed_),
+                              textureCoordinateAttributeName, tangentAttributeName, bitangentAttributeName);
+    Private::BoundsCache::shared().markDirty(this);
 }
 
 // method: addTangentBasisForTextureCoordinateAttributeNamed:normalAttributeNamed:tangentAttributeNamed:
@@ -553,9 +640,10 @@ _MDL_INLINE void MDL::Mesh::addTangentBasisForTextureCoordinateAttributeNamed2(c
                                                                               const NS::String* normalAttributeName,
                                                                               const NS::String* tangentAttributeName)
 {
-    return Object::sendMessage<void>(this,
-                                     _MDL_PRIVATE_SEL(addTangentBasisForTextureCoordinateAttributeNamed_normalAttributeNamed_tangentAttributeNamed_),
-                                     textureCoordinateAttributeName, normalAttributeName, tangentAttributeName);
+    Object::sendMessage<void>(this,
+                              _MDL_PRIVATE_SEL(addTangentBasisForTextureCoordinateAttributeNamed_normalAttributeNamed_tangentAttributeNamed_),
+                              textureCoordinateAttributeName, normalAttributeName, tangentAttributeName);
+    Private::BoundsCache::shared().markDirty(this);
 }
 
 // method: addOrthTanBasisForTextureCoordinateAttributeNamed:normalAttributeNamed:tangentAttributeNamed:
@@ -563,53 +651,62 @@ _MDL_INLINE void MDL::Mesh::addOrthTanBasisForTextureCoordinateAttributeNamed(co
                                                                               const NS::String* normalAttributeName,
                                                                               const NS::String* tangentAttributeName)
 {
-    return Object::sendMessage<void>(this,
-                                     _MDL_PRIVATE_SEL(addOrthTanBasisForTextureCoordinateAttributeNamed_normalAttributeNamed_tangentAttributeNamed_),
-                                     textureCoordinateAttributeName, normalAttributeName, tangentAttributeName);
+    Object::sendMessage<void>(this,
+                              _MDL_PRIVATE_SEL(addOrthTanBasisForTextureCoordinateAttributeNamed_normalAttributeNamed_tangentAttributeNamed_),
+                              textureCoordinateAttributeName, normalAttributeName, tangentAttributeName);
+    Private::BoundsCache::shared().markDirty(this);
 }
 
 // method: addUnwrappedTextureCoordinatesForAttributeNamed:
 _MDL_INLINE void MDL::Mesh::addUnwrappedTextureCoordinatesForAttributeNamed(const NS::String* textureCoordinateAttributeName)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(addUnwrappedTextureCoordinatesForAttributeNamed_), textureCoordinateAttributeName);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(addUnwrappedTextureCoordinatesForAttributeNamed_), textureCoordinateAttributeName);
+    Private::BoundsCache::shared().markDirty(this);
 }
 
 // method: flipTextureCoordinatesInAttributeNamed:
 _MDL_INLINE void MDL::Mesh::flipTextureCoordinatesInAttributeNamed(const NS::String* textureCoordinateAttributeName)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(flipTextureCoordinatesInAttributeNamed_), textureCoordinateAttributeName);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(flipTextureCoordinatesInAttributeNamed_), textureCoordinateAttributeName);
+    Private::BoundsCache::shared().markDirty(this);
 }
 
 // method: makeVerticesUnique
 _MDL_INLINE void MDL::Mesh::makeVerticesUnique()
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(makeVerticesUnique));
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(makeVerticesUnique));
+    Private::BoundsCache::shared().markDirty(this);
 }
 
 // method: makeVerticesUniqueAndReturnError:
 _MDL_INLINE BOOL MDL::Mesh::makeVerticesUniqueAndReturnError(NS::Error** error)
 {
-    return Object::sendMessage<BOOL>(this, _MDL_PRIVATE_SEL(makeVerticesUniqueAndReturnError_), error);
+    const BOOL result = Object::sendMessage<BOOL>(this, _MDL_PRIVATE_SEL(makeVerticesUniqueAndReturnError_), error);
+    Private::BoundsCache::shared().markDirty(this);
+    return result;
 }
 
 // method: replaceAttributeNamed:
 _MDL_INLINE void MDL::Mesh::replaceAttributeNamed(const NS::String* name,
                                                   const VertexAttributeData* newData)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(replaceAttributeNamed_), name, newData);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(replaceAttributeNamed_), name, newData);
+    Private::BoundsCache::shared().markDirty(this);
 }
 
 // method: updateAttributeNamed:
 _MDL_INLINE void MDL::Mesh::updateAttributeNamed(const NS::String* name,
                                                   const VertexAttributeData* newData)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(updateAttributeNamed_), name, newData);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(updateAttributeNamed_), name, newData);
+    Private::BoundsCache::shared().markDirty(this);
 }
 
 // method: removeAttributeNamed:
 _MDL_INLINE void MDL::Mesh::removeAttributeNamed(const NS::String* name)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(removeAttributeNamed_), name);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(removeAttributeNamed_), name);
+    Private::BoundsCache::shared().markDirty(this);
 }
 
 // MARK: Mesh-Generators
@@ -929,6 +1026,435 @@ _MDL_INLINE BOOL MDL::Mesh::generateLightMapVertexColorsWithLightsToConsider(con
 
 
 
+// MARK: Mesh-Native
+
+// native: newSimplifiedMesh
+_MDL_INLINE MDL::Mesh* MDL::Mesh::newSimplifiedMesh(float targetRatio,
+                                                     float maxError,
+                                                     class MeshBufferAllocator* allocator)
+{
+    NS::Array* levels = newLevelsOfDetail(&targetRatio, 1, maxError, allocator);
+    if (!levels)
+    {
+        return nullptr;
+    }
+    
+    Mesh* mesh = levels->object<Mesh>(0)->retain();
+    levels->release();
+    return mesh;
+}
+
+// native: newLevelsOfDetail
+_MDL_INLINE NS::Array* MDL::Mesh::newLevelsOfDetail(const float* ratios,
+                                                    NS::UInteger levelCount,
+                                                    float maxError,
+                                                    class MeshBufferAllocator* allocator)
+{
+    VertexAttributeData* positionData = vertexAttributeDataForAttributeNamed(VertexAttributePosition, VertexFormatFloat3);
+    NS::Array*           sourceSubmeshes = submeshes();
+    if (!positionData || !sourceSubmeshes || !levelCount)
+    {
+        return nullptr;
+    }
+    if (!allocator)
+    {
+        allocator = this->allocator();
+    }
+    
+    const NS::UInteger count = vertexCount();
+    const NS::UInteger submeshCount = sourceSubmeshes->count();
+    MeshSimplifier     simplifier(static_cast<const float*>(positionData->dataStart()), positionData->stride(), count);
+    
+    constexpr std::uint32_t Unowned = std::numeric_limits<std::uint32_t>::max();
+    constexpr std::uint32_t Shared = Unowned - 1;
+    std::vector<std::uint32_t> owner(count, Unowned);
+    
+    // Triangle lists to simplify; other geometry types are carried over as is
+    std::vector<std::vector<std::uint32_t>> triangles(submeshCount);
+    std::vector<std::uint8_t>               simplifiable(submeshCount, 0);
+    
+    for (NS::UInteger s = 0; s < submeshCount; ++s)
+    {
+        Submesh* submesh = sourceSubmeshes->object<Submesh>(s);
+        const GeometryType geometryType = submesh->geometryType();
+        MeshBuffer*        buffer = submesh->indexBuffer();
+        const NS::UInteger indexCount = submesh->indexCount();
+        
+        std::vector<std::uint32_t> indices(indexCount);
+        if (buffer && indexCount)
+        {
+            MeshBufferMap* indexMap = Private::readMap(buffer);
+            Private::copyIndices(indexMap->bytes(), indexCount, submesh->indexType(), indices.data());
+        }
+        
+        for (std::uint32_t vertex : indices)
+        {
+            if (vertex < count)
+            {
+                owner[vertex] = (owner[vertex] == Unowned || owner[vertex] == s) ? std::uint32_t(s) : Shared;
+            }
+        }
+        
+        if (geometryType == GeometryTypeTriangleStrips)
+        {
+            Private::triangulateStrip(indices.data(), indices.size(), triangles[s]);
+            simplifiable[s] = 1;
+        }
+        else if (geometryType == GeometryTypeTriangles)
+        {
+            triangles[s].swap(indices);
+            simplifiable[s] = 1;
+        }
+        
+        SubmeshTopology* topology = submesh->topology();
+        if (!topology)
+        {
+            continue;
+        }
+        
+        if (MeshBuffer* creaseIndices = topology->vertexCreaseIndices())
+        {
+            MeshBufferMap*       indexMap = Private::readMap(creaseIndices);
+            const std::uint32_t* creaseVertices = static_cast<const std::uint32_t*>(indexMap->bytes());
+            const float*         creases = nullptr;
+            MeshBufferMap*       creaseMap = nullptr;
+            if (MeshBuffer* creaseBuffer = topology->vertexCreases())
+            {
+                creaseMap = Private::readMap(creaseBuffer);
+                creases = static_cast<const float*>(creaseMap->bytes());
+            }
+            for (NS::UInteger i = 0, n = topology->vertexCreaseCount(); i < n; ++i)
+            {
+                if (creaseVertices[i] < count && (!creases || creases[i] > 0.0f))
+                {
+                    simplifier.lockVertex(creaseVertices[i]);
+                }
+            }
+        }
+        
+        if (MeshBuffer* creaseIndices = topology->edgeCreaseIndices())
+        {
+            MeshBufferMap*       indexMap = Private::readMap(creaseIndices);
+            const std::uint32_t* creaseEdges = static_cast<const std::uint32_t*>(indexMap->bytes());
+            const float*         creases = nullptr;
+            MeshBufferMap*       creaseMap = nullptr;
+            if (MeshBuffer* creaseBuffer = topology->edgeCreases())
+            {
+                creaseMap = Private::readMap(creaseBuffer);
+                creases = static_cast<const float*>(creaseMap->bytes());
+            }
+            for (NS::UInteger i = 0, n = topology->edgeCreaseCount(); i < n; ++i)
+            {
+                if (!creases || creases[i] > 0.0f)
+                {
+                    simplifier.addCrease(creaseEdges[i * 2], creaseEdges[i * 2 + 1]);
+                }
+            }
+        }
+        
+        // Hole faces are indexed per triangle here, so their corners are pinned
+        // and the faces themselves kept out of the collapse
+        if (MeshBuffer* holeBuffer = topology->holes(); holeBuffer && simplifiable[s])
+        {
+            MeshBufferMap*       holeMap = Private::readMap(holeBuffer);
+            const std::uint32_t* holes = static_cast<const std::uint32_t*>(holeMap->bytes());
+            std::vector<std::uint32_t>& list = triangles[s];
+            const NS::UInteger          triangleCount = list.size() / 3;
+            
+            for (NS::UInteger i = 0, n = topology->holeCount(); i < n; ++i)
+            {
+                if (holes[i] < triangleCount)
+                {
+                    for (NS::UInteger corner = 0; corner < 3; ++corner)
+                    {
+                        simplifier.lockVertex(list[holes[i] * 3 + corner]);
+                    }
+                }
+            }
+        }
+    }
+    
+    for (NS::UInteger vertex = 0; vertex < count; ++vertex)
+    {
+        if (owner[vertex] == Shared)
+        {
+            simplifier.lockVertex(std::uint32_t(vertex));
+        }
+    }
+    
+    // levels[submesh][level]
+    std::vector<std::vector<std::vector<std::uint32_t>>> levels(submeshCount);
+    for (NS::UInteger s = 0; s < submeshCount; ++s)
+    {
+        if (simplifiable[s])
+        {
+            levels[s] = simplifier.simplifyLevels(triangles[s].data(), triangles[s].size(), ratios, levelCount, maxError);
+        }
+    }
+    
+    std::vector<const NS::Object*> meshes(levelCount);
+    std::vector<const NS::Object*> submeshObjects(submeshCount);
+    
+    for (NS::UInteger level = 0; level < levelCount; ++level)
+    {
+        std::vector<Submesh*> created;
+        for (NS::UInteger s = 0; s < submeshCount; ++s)
+        {
+            Submesh* source = sourceSubmeshes->object<Submesh>(s);
+            if (!simplifiable[s])
+            {
+                submeshObjects[s] = source;
+                continue;
+            }
+            
+            const std::vector<std::uint32_t>& indices = levels[s][level];
+            const NS::UInteger                length = indices.size() * sizeof(std::uint32_t);
+            MeshBuffer*                       indexBuffer = allocator->newBuffer(length, MeshBufferTypeIndex);
+            if (length)
+            {
+                MeshBufferMap* indexMap = indexBuffer->map();
+                std::memcpy(indexMap->bytes(), indices.data(), length);
+            }
+            
+            Submesh* submesh = Submesh::alloc()->init(source->name(), indexBuffer, indices.size(),
+                                                      IndexBitDepthUInt32, GeometryTypeTriangles, source->material());
+            indexBuffer->release();
+            created.push_back(submesh);
+            submeshObjects[s] = submesh;
+        }
+        
+        NS::Array* submeshArray = NS::Array::alloc()->init(submeshObjects.data(), submeshCount);
+        meshes[level] = Mesh::alloc()->init(vertexBuffers(), count, vertexDescriptor(), submeshArray);
+        
+        submeshArray->release();
+        for (Submesh* submesh : created)
+        {
+            submesh->release();
+        }
+    }
+    
+    // The array holds the only reference to each level
+    NS::Array* result = NS::Array::alloc()->init(meshes.data(), levelCount);
+    for (const NS::Object* mesh : meshes)
+    {
+        const_cast<NS::Object*>(mesh)->release();
+    }
+    return result;
+}
+
+// native: boundingVolumeHierarchy
+_MDL_INLINE std::shared_ptr<MDL::BoundingVolumeHierarchy> MDL::Mesh::boundingVolumeHierarchy()
+{
+    const Private::BoundingVolumeHierarchyCache::Key key = Private::meshHierarchyKey(this);
+    if (std::shared_ptr<BoundingVolumeHierarchy> cached = Private::BoundingVolumeHierarchyCache::shared().find(this, key))
+    {
+        return cached;
+    }
+    
+    VertexAttributeData* positionData = vertexAttributeDataForAttributeNamed(VertexAttributePosition, VertexFormatFloat3);
+    if (!positionData)
+    {
+        return nullptr;
+    }
+    
+    std::vector<std::uint32_t> triangles, rangeOffsets;
+    Private::meshTriangles(this, triangles, rangeOffsets);
+    
+    std::shared_ptr<BoundingVolumeHierarchy> hierarchy = BoundingVolumeHierarchy::build(static_cast<const float*>(positionData->dataStart()),
+                                                                                        positionData->stride(), vertexCount(),
+                                                                                        triangles.data(), triangles.size(),
+                                                                                        std::move(rangeOffsets));
+    Private::BoundingVolumeHierarchyCache::shared().store(this, key, hierarchy);
+    return hierarchy;
+}
+
+// native: refitBoundingVolumeHierarchy
+_MDL_INLINE std::shared_ptr<MDL::BoundingVolumeHierarchy> MDL::Mesh::refitBoundingVolumeHierarchy()
+{
+    const Private::BoundingVolumeHierarchyCache::Key key = Private::meshHierarchyKey(this);
+    std::shared_ptr<BoundingVolumeHierarchy> cached = Private::BoundingVolumeHierarchyCache::shared().findTopology(this, key);
+    VertexAttributeData* positionData = vertexAttributeDataForAttributeNamed(VertexAttributePosition, VertexFormatFloat3);
+    
+    if (!cached || !positionData || cached->vertexCount() != vertexCount())
+    {
+        return boundingVolumeHierarchy();
+    }
+    
+    // Other threads may still be querying the cached hierarchy; refit a copy
+    // and publish it in its place
+    std::shared_ptr<BoundingVolumeHierarchy> hierarchy = std::make_shared<BoundingVolumeHierarchy>(*cached);
+    hierarchy->refit(static_cast<const float*>(positionData->dataStart()), positionData->stride());
+    Private::BoundingVolumeHierarchyCache::shared().store(this, key, hierarchy);
+    return hierarchy;
+}
+
+// native: invalidateBoundingVolumeHierarchy
+_MDL_INLINE void MDL::Mesh::invalidateBoundingVolumeHierarchy() const
+{
+    Private::BoundingVolumeHierarchyCache::shared().invalidate(this);
+}
+
+_MDL_INLINE void MDL::Private::meshTriangles(Mesh* mesh,
+                                             std::vector<std::uint32_t>& triangles,
+                                             std::vector<std::uint32_t>& rangeOffsets)
+{
+    NS::Array*         submeshes = mesh->submeshes();
+    const NS::UInteger submeshCount = submeshes ? submeshes->count() : 0;
+    rangeOffsets.resize(submeshCount);
+    
+    std::vector<std::uint32_t> indices;
+    for (NS::UInteger s = 0; s < submeshCount; ++s)
+    {
+        rangeOffsets[s] = std::uint32_t(triangles.size() / 3);
+        
+        Submesh*           submesh = submeshes->object<Submesh>(s);
+        const GeometryType geometryType = submesh->geometryType();
+        MeshBuffer*        buffer = submesh->indexBuffer();
+        const NS::UInteger indexCount = submesh->indexCount();
+        if (!buffer || !indexCount || (geometryType != GeometryTypeTriangles && geometryType != GeometryTypeTriangleStrips))
+        {
+            continue;
+        }
+        
+        indices.resize(indexCount);
+        MeshBufferMap* indexMap = Private::readMap(buffer);
+        Private::copyIndices(indexMap->bytes(), indexCount, submesh->indexType(), indices.data());
+        
+        if (geometryType == GeometryTypeTriangleStrips)
+        {
+            Private::triangulateStrip(indices.data(), indices.size(), triangles);
+        }
+        else
+        {
+            triangles.insert(triangles.end(), indices.begin(), indices.begin() + (indexCount / 3) * 3);
+        }
+    }
+}
+
+_MDL_INLINE MDL::Private::BoundingVolumeHierarchyCache::Key MDL::Private::meshHierarchyKey(Mesh* mesh)
+{
+    BoundingVolumeHierarchyCache::Key key = { 0, 0, 0.0 };
+    MeshBufferGeneration& generations = MeshBufferGeneration::shared();
+    
+    if (NS::Array* submeshes = mesh->submeshes())
+    {
+        for (NS::UInteger s = 0, n = submeshes->count(); s < n; ++s)
+        {
+            Submesh*    submesh = submeshes->object<Submesh>(s);
+            MeshBuffer* buffer = submesh->indexBuffer();
+            key.topology = hashCombine(key.topology, reinterpret_cast<std::uintptr_t>(buffer));
+            key.topology = hashCombine(key.topology, generations.generation(buffer));
+            key.topology = hashCombine(key.topology, submesh->indexCount());
+            key.topology = hashCombine(key.topology, std::uint64_t(submesh->geometryType()));
+        }
+    }
+    
+    if (NS::Array* vertexBuffers = mesh->vertexBuffers())
+    {
+        for (NS::UInteger b = 0, n = vertexBuffers->count(); b < n; ++b)
+        {
+            MeshBuffer* buffer = vertexBuffers->object<MeshBuffer>(b);
+            key.vertices = hashCombine(key.vertices, reinterpret_cast<std::uintptr_t>(buffer));
+            key.vertices = hashCombine(key.vertices, generations.generation(buffer));
+        }
+    }
+    key.vertices = hashCombine(key.vertices, mesh->vertexCount());
+    return key;
+}
+
+_MDL_INLINE void MDL::Private::meshContent(Mesh* mesh, bool materials, MeshContent& content)
+{
+    content.layout.clear();
+    content.materials.clear();
+    content.spans.clear();
+    content.layout.push_back(mesh->vertexCount());
+    
+    if (VertexDescriptor* descriptor = mesh->vertexDescriptor())
+    {
+        NS::Array* attributes = descriptor->attributes();
+        for (NS::UInteger a = 0, n = attributes ? attributes->count() : 0; a < n; ++a)
+        {
+            VertexAttribute* attribute = attributes->object<VertexAttribute>(a);
+            if (attribute->format() == VertexFormatInvalid)
+            {
+                continue;
+            }
+            NS::String* name = attribute->name();
+            const char* text = name ? name->utf8String() : "";
+            content.layout.push_back(ContentHash::hash(text, std::strlen(text)));
+            content.layout.push_back(attribute->format());
+            content.layout.push_back(attribute->offset());
+            content.layout.push_back(attribute->bufferIndex());
+        }
+        NS::Array* layouts = descriptor->layouts();
+        for (NS::UInteger l = 0, n = layouts ? layouts->count() : 0; l < n; ++l)
+        {
+            content.layout.push_back(layouts->object<VertexBufferLayout>(l)->stride());
+        }
+    }
+    
+    if (NS::Array* vertexBuffers = mesh->vertexBuffers())
+    {
+        for (NS::UInteger b = 0, n = vertexBuffers->count(); b < n; ++b)
+        {
+            MeshBuffer* buffer = vertexBuffers->object<MeshBuffer>(b);
+            content.spans.push_back({ Private::readMap(buffer)->bytes(), buffer->length() });
+        }
+    }
+    
+    if (NS::Array* submeshes = mesh->submeshes())
+    {
+        for (NS::UInteger s = 0, n = submeshes->count(); s < n; ++s)
+        {
+            Submesh*    submesh = submeshes->object<Submesh>(s);
+            MeshBuffer* buffer = submesh->indexBuffer();
+            content.layout.push_back(std::uint64_t(submesh->geometryType()));
+            content.layout.push_back(std::uint64_t(submesh->indexType()));
+            content.layout.push_back(submesh->indexCount());
+            
+            // Only the indices drawn, in case the buffer is shared or padded
+            const NS::UInteger length = buffer ? std::min<NS::UInteger>(submesh->indexCount() * (submesh->indexType() / 8), buffer->length()) : 0;
+            content.spans.push_back({ length ? Private::readMap(buffer)->bytes() : nullptr, length });
+            
+            if (materials)
+            {
+                Material*   material = submesh->material();
+                NS::String* name = material ? reinterpret_cast<Named*>(material)->name() : nullptr;
+                content.materials.push_back(name ? name->utf8String() : "");
+            }
+        }
+    }
+}
+
+_MDL_INLINE bool MDL::Private::vertexComponent(VertexFormat format,
+                                               VertexComponent& component,
+                                               NS::UInteger& componentCount)
+{
+    if (format & VertexFormatPackedBit)
+    {
+        return false;
+    }
+
+    switch (format & 0xF0000)
+    {
+        case VertexFormatFloatBits:             component = VertexComponent::Float;             break;
+        case VertexFormatHalfBits:              component = VertexComponent::Half;              break;
+        case VertexFormatShortBits:             component = VertexComponent::Short;             break;
+        case VertexFormatUShortBits:            component = VertexComponent::UShort;            break;
+        case VertexFormatShortNormalizedBits:   component = VertexComponent::ShortNormalized;   break;
+        case VertexFormatUShortNormalizedBits:  component = VertexComponent::UShortNormalized;  break;
+        case VertexFormatCharBits:              component = VertexComponent::Char;              break;
+        case VertexFormatUCharBits:             component = VertexComponent::UChar;             break;
+        case VertexFormatCharNormalizedBits:    component = VertexComponent::CharNormalized;    break;
+        case VertexFormatUCharNormalizedBits:   component = VertexComponent::UCharNormalized;   break;
+        default:
+            return false;
+    }
+
+    componentCount = format & 0xFF;
+    return componentCount > 0 && componentCount <= 4;
+}
+
 // MARK: - Original Header
 
 //////#import <ModelIO/MDLTypes.h>
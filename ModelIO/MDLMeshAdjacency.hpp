@@ -0,0 +1,528 @@
+/*!
+ @header MDLMeshAdjacency.hpp
+ @framework ModelIO
+ @abstract Compact half-edge adjacency built from submesh indices and topology
+ @copyright Treata Norouzi on 10/19/26.
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include "MDLDefines.hpp"
+#include "MDLObjectLifetime.hpp"
+#include "MDLParallel.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace MDL
+{
+// Half-edges are stored structure-of-arrays and addressed by dense indices. The
+// half-edges of face f are [faceFirstHalfEdge(f), faceFirstHalfEdge(f + 1)) in
+// winding order; half-edge h runs from vertex(h) to vertex(next(h)).
+class MeshAdjacency
+{
+public:
+    static constexpr std::uint32_t      InvalidIndex = std::numeric_limits<std::uint32_t>::max();
+
+    // faceVertexCounts may be null, in which case every face has `uniformFaceSize`
+    // vertices. holeFaces lists faces to leave out of the surface (their edges
+    // become boundary edges of the neighbouring faces).
+    static std::shared_ptr<MeshAdjacency>   build(const std::uint32_t* indices,
+                                                  NS::UInteger indexCount,
+                                                  const std::uint8_t* faceVertexCounts,
+                                                  NS::UInteger faceCount,
+                                                  NS::UInteger uniformFaceSize,
+                                                  const std::uint32_t* holeFaces,
+                                                  NS::UInteger holeCount);
+
+    NS::UInteger                        vertexCount() const;
+    NS::UInteger                        faceCount() const;
+    NS::UInteger                        halfEdgeCount() const;
+
+    std::uint32_t                       vertex(std::uint32_t halfEdge) const;
+    std::uint32_t                       twin(std::uint32_t halfEdge) const;
+    std::uint32_t                       next(std::uint32_t halfEdge) const;
+    std::uint32_t                       face(std::uint32_t halfEdge) const;
+
+    std::uint32_t                       faceFirstHalfEdge(std::uint32_t face) const;
+    std::uint32_t                       faceVertexCount(std::uint32_t face) const;
+    bool                                isHoleFace(std::uint32_t face) const;
+
+    // One outgoing half-edge per vertex, a boundary one when the vertex has any
+    std::uint32_t                       vertexHalfEdge(std::uint32_t vertex) const;
+
+    bool                                isBoundary(std::uint32_t halfEdge) const;
+
+    // One representative half-edge for each edge shared by more than two faces,
+    // or by two faces with the same winding
+    const std::vector<std::uint32_t>&   nonManifoldEdges() const;
+
+    NS::UInteger                        boundaryLoopCount() const;
+    // Boundary half-edges of loop i, in walking order
+    const std::uint32_t*                boundaryLoop(NS::UInteger loop, NS::UInteger* length) const;
+
+private:
+    std::vector<std::uint32_t>          _halfEdgeVertex;
+    std::vector<std::uint32_t>          _halfEdgeTwin;
+    std::vector<std::uint32_t>          _halfEdgeFace;
+    std::vector<std::uint32_t>          _faceOffsets;
+    std::vector<std::uint8_t>           _faceIsHole;
+    std::vector<std::uint8_t>           _halfEdgeFlags;
+    std::vector<std::uint32_t>          _vertexHalfEdge;
+    std::vector<std::uint32_t>          _nonManifoldEdges;
+    std::vector<std::uint32_t>          _boundaryLoopOffsets;
+    std::vector<std::uint32_t>          _boundaryLoopHalfEdges;
+
+    enum : std::uint8_t
+    {
+        FlagBoundary    = 1 << 0,
+        FlagNonManifold = 1 << 1,
+    };
+
+    void                                matchEdges();
+    void                                collectBoundaryLoops();
+};
+
+namespace Private
+{
+    // Widens an 8, 16 or 32 bit index buffer to 32 bit indices
+    void                                copyIndices(const void* bytes, NS::UInteger count, NS::UInteger bitDepth, std::uint32_t* indices);
+
+    // Expands a triangle strip into a triangle list, keeping a consistent winding
+    // and dropping the degenerate triangles used to stitch strips together.
+    void                                triangulateStrip(const std::uint32_t* strip, NS::UInteger count, std::vector<std::uint32_t>& triangles);
+
+    // Per-submesh cache. Entries are validated against the index buffer identity,
+    // its write generation and the index layout, so a replaced or refilled
+    // buffer triggers a rebuild on the next lookup. A submesh's entry goes
+    // when it is initialized or deallocated.
+    class MeshAdjacencyCache
+    {
+    public:
+        struct Key
+        {
+            const void*                 indexBuffer;
+            std::uint64_t               generation;
+            NS::UInteger                indexCount;
+            NS::UInteger                indexType;
+            NS::UInteger                faceCount;
+        };
+
+        static MeshAdjacencyCache&      shared();
+
+        std::shared_ptr<MeshAdjacency>  find(const void* submesh, const Key& key);
+        void                            store(const void* submesh, const Key& key, std::shared_ptr<MeshAdjacency> adjacency);
+        void                            invalidate(const void* submesh);
+
+    private:
+        struct Entry
+        {
+            Key                             key;
+            std::shared_ptr<MeshAdjacency>  adjacency;
+        };
+
+        static void                     evict(const void* submesh);
+
+        std::mutex                                  _mutex;
+        std::unordered_map<const void*, Entry>      _entries;
+    };
+
+} // Private
+} // MDL
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// MARK: - Private Sector
+
+_MDL_INLINE std::shared_ptr<MDL::MeshAdjacency> MDL::MeshAdjacency::build(const std::uint32_t* indices,
+                                                                          NS::UInteger indexCount,
+                                                                          const std::uint8_t* faceVertexCounts,
+                                                                          NS::UInteger faceCount,
+                                                                          NS::UInteger uniformFaceSize,
+                                                                          const std::uint32_t* holeFaces,
+                                                                          NS::UInteger holeCount)
+{
+    std::shared_ptr<MeshAdjacency> adjacency = std::make_shared<MeshAdjacency>();
+    MeshAdjacency&                 a = *adjacency;
+
+    if (!faceVertexCounts)
+    {
+        uniformFaceSize = std::max<NS::UInteger>(uniformFaceSize, 1);
+        faceCount = indexCount / uniformFaceSize;
+    }
+
+    a._faceOffsets.resize(faceCount + 1);
+    a._faceOffsets[0] = 0;
+    for (NS::UInteger f = 0; f < faceCount; ++f)
+    {
+        const NS::UInteger size = faceVertexCounts ? faceVertexCounts[f] : uniformFaceSize;
+        a._faceOffsets[f + 1] = std::uint32_t(std::min<NS::UInteger>(a._faceOffsets[f] + size, indexCount));
+    }
+
+    const NS::UInteger halfEdgeCount = a._faceOffsets[faceCount];
+    a._halfEdgeVertex.assign(indices, indices + halfEdgeCount);
+    a._halfEdgeTwin.assign(halfEdgeCount, InvalidIndex);
+    a._halfEdgeFace.resize(halfEdgeCount);
+    a._halfEdgeFlags.assign(halfEdgeCount, 0);
+
+    a._faceIsHole.assign(faceCount, 0);
+    for (NS::UInteger i = 0; i < holeCount; ++i)
+    {
+        if (holeFaces[i] < faceCount)
+        {
+            a._faceIsHole[holeFaces[i]] = 1;
+        }
+    }
+
+    std::uint32_t maxVertex = 0;
+    for (NS::UInteger h = 0; h < halfEdgeCount; ++h)
+    {
+        maxVertex = std::max(maxVertex, a._halfEdgeVertex[h]);
+    }
+    a._vertexHalfEdge.assign(halfEdgeCount ? NS::UInteger(maxVertex) + 1 : 0, InvalidIndex);
+
+    Private::parallelFor(faceCount, 4096, [&](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger f = begin; f < end; ++f)
+        {
+            for (std::uint32_t h = a._faceOffsets[f]; h < a._faceOffsets[f + 1]; ++h)
+            {
+                a._halfEdgeFace[h] = std::uint32_t(f);
+            }
+        }
+    });
+
+    a.matchEdges();
+    a.collectBoundaryLoops();
+
+    for (std::uint32_t h = 0; h < halfEdgeCount; ++h)
+    {
+        if (a._faceIsHole[a._halfEdgeFace[h]])
+        {
+            continue;
+        }
+        std::uint32_t& slot = a._vertexHalfEdge[a._halfEdgeVertex[h]];
+        if (slot == InvalidIndex || (!a.isBoundary(slot) && a.isBoundary(h)))
+        {
+            slot = h;
+        }
+    }
+
+    return adjacency;
+}
+
+_MDL_INLINE void MDL::MeshAdjacency::matchEdges()
+{
+    const NS::UInteger halfEdgeCount = _halfEdgeVertex.size();
+
+    // Undirected edge keys (min << 32 | max) of every non-hole, non-degenerate
+    // half-edge; sorting brings all half-edges of one edge together.
+    std::vector<std::uint64_t> keys;
+    std::vector<std::uint32_t> halfEdges;
+    keys.reserve(halfEdgeCount);
+    halfEdges.reserve(halfEdgeCount);
+    for (std::uint32_t h = 0; h < halfEdgeCount; ++h)
+    {
+        if (_faceIsHole[_halfEdgeFace[h]])
+        {
+            continue;
+        }
+        const std::uint32_t v0 = _halfEdgeVertex[h];
+        const std::uint32_t v1 = _halfEdgeVertex[next(h)];
+        if (v0 == v1)
+        {
+            continue;
+        }
+        keys.push_back((std::uint64_t(std::min(v0, v1)) << 32) | std::max(v0, v1));
+        halfEdges.push_back(h);
+    }
+
+    Private::radixSort(keys, halfEdges);
+
+    const NS::UInteger keyCount = keys.size();
+    constexpr NS::UInteger kGrain = 1 << 15;
+    std::vector<std::vector<std::uint32_t>> nonManifold((keyCount + kGrain - 1) / kGrain);
+
+    Private::parallelFor(keyCount, kGrain, [&](NS::UInteger begin, NS::UInteger end)
+    {
+        // A chunk owns every run that starts inside it
+        NS::UInteger i = begin;
+        while (i > 0 && i < keyCount && keys[i] == keys[i - 1])
+        {
+            ++i;
+        }
+
+        std::vector<std::uint32_t>& chunkNonManifold = nonManifold[begin / kGrain];
+        while (i < end)
+        {
+            NS::UInteger runEnd = i + 1;
+            while (runEnd < keyCount && keys[runEnd] == keys[i])
+            {
+                ++runEnd;
+            }
+
+            const std::uint32_t h0 = halfEdges[i];
+            if (runEnd - i == 1)
+            {
+                _halfEdgeFlags[h0] |= FlagBoundary;
+            }
+            else if (runEnd - i == 2 && _halfEdgeVertex[h0] != _halfEdgeVertex[halfEdges[i + 1]])
+            {
+                const std::uint32_t h1 = halfEdges[i + 1];
+                _halfEdgeTwin[h0] = h1;
+                _halfEdgeTwin[h1] = h0;
+            }
+            else
+            {
+                for (NS::UInteger j = i; j < runEnd; ++j)
+                {
+                    _halfEdgeFlags[halfEdges[j]] |= FlagNonManifold;
+                }
+                chunkNonManifold.push_back(h0);
+            }
+            i = runEnd;
+        }
+    });
+
+    for (const std::vector<std::uint32_t>& chunk : nonManifold)
+    {
+        _nonManifoldEdges.insert(_nonManifoldEdges.end(), chunk.begin(), chunk.end());
+    }
+}
+
+_MDL_INLINE void MDL::MeshAdjacency::collectBoundaryLoops()
+{
+    // Bucket boundary half-edges by origin vertex so each step of a loop walk
+    // finds its successor (the boundary half-edge leaving our destination).
+    const NS::UInteger         vertexCount = _vertexHalfEdge.size();
+    std::vector<std::uint32_t> bucketOffsets(vertexCount + 1, 0);
+    std::vector<std::uint32_t> buckets;
+
+    for (std::uint32_t h = 0; h < _halfEdgeFlags.size(); ++h)
+    {
+        if (_halfEdgeFlags[h] & FlagBoundary)
+        {
+            ++bucketOffsets[_halfEdgeVertex[h] + 1];
+        }
+    }
+    for (NS::UInteger v = 0; v < vertexCount; ++v)
+    {
+        bucketOffsets[v + 1] += bucketOffsets[v];
+    }
+    buckets.resize(bucketOffsets[vertexCount]);
+    std::vector<std::uint32_t> cursor(bucketOffsets.begin(), bucketOffsets.end() - (vertexCount ? 1 : 0));
+    for (std::uint32_t h = 0; h < _halfEdgeFlags.size(); ++h)
+    {
+        if (_halfEdgeFlags[h] & FlagBoundary)
+        {
+            buckets[cursor[_halfEdgeVertex[h]]++] = h;
+        }
+    }
+
+    std::vector<std::uint8_t> visited(_halfEdgeFlags.size(), 0);
+    _boundaryLoopOffsets.assign(1, 0);
+
+    for (std::uint32_t start : buckets)
+    {
+        if (visited[start])
+        {
+            continue;
+        }
+
+        std::uint32_t h = start;
+        while (h != InvalidIndex && !visited[h])
+        {
+            visited[h] = 1;
+            _boundaryLoopHalfEdges.push_back(h);
+
+            const std::uint32_t destination = _halfEdgeVertex[next(h)];
+            std::uint32_t       successor = InvalidIndex;
+            for (std::uint32_t b = bucketOffsets[destination]; b < bucketOffsets[destination + 1]; ++b)
+            {
+                if (!visited[buckets[b]])
+                {
+                    successor = buckets[b];
+                    break;
+                }
+            }
+            h = successor;
+        }
+        _boundaryLoopOffsets.push_back(std::uint32_t(_boundaryLoopHalfEdges.size()));
+    }
+}
+
+_MDL_INLINE NS::UInteger MDL::MeshAdjacency::vertexCount() const
+{
+    return _vertexHalfEdge.size();
+}
+
+_MDL_INLINE NS::UInteger MDL::MeshAdjacency::faceCount() const
+{
+    return _faceIsHole.size();
+}
+
+_MDL_INLINE NS::UInteger MDL::MeshAdjacency::halfEdgeCount() const
+{
+    return _halfEdgeVertex.size();
+}
+
+_MDL_INLINE std::uint32_t MDL::MeshAdjacency::vertex(std::uint32_t halfEdge) const
+{
+    return _halfEdgeVertex[halfEdge];
+}
+
+_MDL_INLINE std::uint32_t MDL::MeshAdjacency::twin(std::uint32_t halfEdge) const
+{
+    return _halfEdgeTwin[halfEdge];
+}
+
+_MDL_INLINE std::uint32_t MDL::MeshAdjacency::next(std::uint32_t halfEdge) const
+{
+    const std::uint32_t f = _halfEdgeFace[halfEdge];
+    return halfEdge + 1 < _faceOffsets[f + 1] ? halfEdge + 1 : _faceOffsets[f];
+}
+
+_MDL_INLINE std::uint32_t MDL::MeshAdjacency::face(std::uint32_t halfEdge) const
+{
+    return _halfEdgeFace[halfEdge];
+}
+
+_MDL_INLINE std::uint32_t MDL::MeshAdjacency::faceFirstHalfEdge(std::uint32_t face) const
+{
+    return _faceOffsets[face];
+}
+
+_MDL_INLINE std::uint32_t MDL::MeshAdjacency::faceVertexCount(std::uint32_t face) const
+{
+    return _faceOffsets[face + 1] - _faceOffsets[face];
+}
+
+_MDL_INLINE bool MDL::MeshAdjacency::isHoleFace(std::uint32_t face) const
+{
+    return _faceIsHole[face] != 0;
+}
+
+_MDL_INLINE std::uint32_t MDL::MeshAdjacency::vertexHalfEdge(std::uint32_t vertex) const
+{
+    return _vertexHalfEdge[vertex];
+}
+
+_MDL_INLINE bool MDL::MeshAdjacency::isBoundary(std::uint32_t halfEdge) const
+{
+    return (_halfEdgeFlags[halfEdge] & FlagBoundary) != 0;
+}
+
+_MDL_INLINE const std::vector<std::uint32_t>& MDL::MeshAdjacency::nonManifoldEdges() const
+{
+    return _nonManifoldEdges;
+}
+
+_MDL_INLINE NS::UInteger MDL::MeshAdjacency::boundaryLoopCount() const
+{
+    return _boundaryLoopOffsets.empty() ? 0 : _boundaryLoopOffsets.size() - 1;
+}
+
+_MDL_INLINE const std::uint32_t* MDL::MeshAdjacency::boundaryLoop(NS::UInteger loop, NS::UInteger* length) const
+{
+    if (length)
+    {
+        *length = _boundaryLoopOffsets[loop + 1] - _boundaryLoopOffsets[loop];
+    }
+    return _boundaryLoopHalfEdges.data() + _boundaryLoopOffsets[loop];
+}
+
+// MARK: Index helpers
+
+_MDL_INLINE void MDL::Private::copyIndices(const void* bytes, NS::UInteger count, NS::UInteger bitDepth, std::uint32_t* indices)
+{
+    switch (bitDepth)
+    {
+        case 8:
+            std::copy_n(static_cast<const std::uint8_t*>(bytes), count, indices);
+            break;
+        case 16:
+            std::copy_n(static_cast<const std::uint16_t*>(bytes), count, indices);
+            break;
+        default:
+            std::copy_n(static_cast<const std::uint32_t*>(bytes), count, indices);
+            break;
+    }
+}
+
+_MDL_INLINE void MDL::Private::triangulateStrip(const std::uint32_t* strip, NS::UInteger count, std::vector<std::uint32_t>& triangles)
+{
+    triangles.clear();
+    triangles.reserve(count > 2 ? (count - 2) * 3 : 0);
+    for (NS::UInteger i = 2; i < count; ++i)
+    {
+        std::uint32_t a = strip[i - 2], b = strip[i - 1];
+        const std::uint32_t c = strip[i];
+        if (a == b || b == c || a == c)
+        {
+            continue;
+        }
+        if (i & 1)
+        {
+            std::swap(a, b);
+        }
+        triangles.insert(triangles.end(), { a, b, c });
+    }
+}
+
+// MARK: MeshAdjacencyCache
+
+_MDL_INLINE MDL::Private::MeshAdjacencyCache& MDL::Private::MeshAdjacencyCache::shared()
+{
+    static MeshAdjacencyCache cache;
+    return cache;
+}
+
+_MDL_INLINE std::shared_ptr<MDL::MeshAdjacency> MDL::Private::MeshAdjacencyCache::find(const void* submesh, const Key& key)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _entries.find(submesh);
+    if (it == _entries.end())
+    {
+        return nullptr;
+    }
+
+    const Key& cached = it->second.key;
+    if (cached.indexBuffer != key.indexBuffer || cached.generation != key.generation ||
+        cached.indexCount != key.indexCount || cached.indexType != key.indexType || cached.faceCount != key.faceCount)
+    {
+        _entries.erase(it);
+        return nullptr;
+    }
+    return it->second.adjacency;
+}
+
+_MDL_INLINE void MDL::Private::MeshAdjacencyCache::store(const void* submesh, const Key& key, std::shared_ptr<MeshAdjacency> adjacency)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries[submesh] = Entry { key, std::move(adjacency) };
+    }
+    ObjectLifetime::watch(submesh, this, &evict);
+}
+
+_MDL_INLINE void MDL::Private::MeshAdjacencyCache::invalidate(const void* submesh)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.erase(submesh);
+}
+
+_MDL_INLINE void MDL::Private::MeshAdjacencyCache::evict(const void* submesh)
+{
+    shared().invalidate(submesh);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -11,6 +11,11 @@
 #import "Foundation/Foundation.hpp"
 #include "ModelIOExports.hpp"
 #include "MDLTypes.hpp"
+#include "MDLObjectLifetime.hpp"
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
 
 namespace MDL
 {
@@ -43,7 +48,7 @@ public:
     void                            fillData(const NS::Data* data, NS::UInteger offset);
     
     // map
-    MDL::MeshBuffer*                map();
+    class MeshBufferMap*            map();
     
     // - ReadOnly
     NS::UInteger                    length() const;
@@ -137,6 +142,43 @@ public:
     class MeshBufferAllocator*              allocator() const;
 };
 
+namespace Private
+{
+    // Counts writes made through `MeshBuffer::fillData` and through released
+    // `MeshBuffer::map` maps, so native caches built from a buffer's contents
+    // can tell when they went stale. Generations are drawn from one counter
+    // and dropped with their buffer, so a buffer allocated where another one
+    // lived never repeats its generation.
+    class MeshBufferGeneration
+    {
+    public:
+        static MeshBufferGeneration&    shared();
+        
+        std::uint64_t                   generation(const void* buffer);
+        void                            bump(const void* buffer);
+        
+        // Bumps `buffer` once `map`, which may have been written through, is
+        // released
+        void                            watchMap(const void* map, const void* buffer);
+        
+    private:
+        static void                     evictBuffer(const void* buffer);
+        static void                     releaseMap(const void* map);
+        
+        // Under _mutex
+        std::uint64_t&                  entry(const void* buffer);
+        
+        std::mutex                                      _mutex;
+        std::uint64_t                                   _counter = 0;
+        std::unordered_map<const void*, std::uint64_t>  _generations;
+        std::unordered_map<const void*, const void*>    _maps;
+    };
+    
+    // `MeshBuffer::map` for the native readers, which leaves the generation
+    // alone
+    MeshBufferMap*                      readMap(const MeshBuffer* buffer);
+}
+
 }
 
 // MARK: - Private Sector
@@ -164,7 +206,17 @@ _MDL_INLINE void* MDL::MeshBufferMap::bytes() const
 // method: fillData:offset:
 _MDL_INLINE void MDL::MeshBuffer::fillData(const NS::Data* data, NS::UInteger offset)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(fillData_offset_), data, offset);
+    Private::MeshBufferGeneration::shared().bump(this);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(fillData_offset_), data, offset);
+    Private::BoundsCache::shared().markDirty(this);
+}
+
+// method: map
+_MDL_INLINE MDL::MeshBufferMap* MDL::MeshBuffer::map()
+{
+    MeshBufferMap* map = Object::sendMessage<MDL::MeshBufferMap*>(this, _MDL_PRIVATE_SEL(map));
+    Private::MeshBufferGeneration::shared().watchMap(map, this);
+    return map;
 }
 
 // property: length
@@ -303,6 +355,80 @@ _MDL_INLINE MDL::MeshBufferAllocator* MDL::MeshBufferZoneDefault::allocator() co
     return Object::sendMessage<MeshBufferAllocator*>(this, _MDL_PRIVATE_SEL(allocator));
 }
 
+// MARK: MeshBufferGeneration
+
+_MDL_INLINE MDL::Private::MeshBufferGeneration& MDL::Private::MeshBufferGeneration::shared()
+{
+    static MeshBufferGeneration registry;
+    return registry;
+}
+
+_MDL_INLINE std::uint64_t MDL::Private::MeshBufferGeneration::generation(const void* buffer)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return entry(buffer);
+}
+
+_MDL_INLINE void MDL::Private::MeshBufferGeneration::bump(const void* buffer)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    entry(buffer) = ++_counter;
+}
+
+_MDL_INLINE void MDL::Private::MeshBufferGeneration::watchMap(const void* map, const void* buffer)
+{
+    if (!map)
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _maps[map] = buffer;
+    }
+    ObjectLifetime::watch(map, this, &releaseMap);
+}
+
+_MDL_INLINE void MDL::Private::MeshBufferGeneration::evictBuffer(const void* buffer)
+{
+    MeshBufferGeneration&       registry = shared();
+    std::lock_guard<std::mutex> lock(registry._mutex);
+    registry._generations.erase(buffer);
+}
+
+_MDL_INLINE void MDL::Private::MeshBufferGeneration::releaseMap(const void* map)
+{
+    MeshBufferGeneration& registry = shared();
+    const void*           buffer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(registry._mutex);
+        auto it = registry._maps.find(map);
+        if (it == registry._maps.end())
+        {
+            return;
+        }
+        buffer = it->second;
+        registry._maps.erase(it);
+        registry.entry(buffer) = ++registry._counter;
+    }
+    BoundsCache::shared().markDirty(buffer);
+}
+
+_MDL_INLINE std::uint64_t& MDL::Private::MeshBufferGeneration::entry(const void* buffer)
+{
+    auto it = _generations.find(buffer);
+    if (it == _generations.end())
+    {
+        it = _generations.emplace(buffer, ++_counter).first;
+        ObjectLifetime::watch(buffer, this, &evictBuffer);
+    }
+    return it->second;
+}
+
+_MDL_INLINE MDL::MeshBufferMap* MDL::Private::readMap(const MeshBuffer* buffer)
+{
+    return NS::Object::sendMessage<MDL::MeshBufferMap*>(buffer, _MDL_PRIVATE_SEL(map));
+}
+
 
 
 // MARK: - Original Header -
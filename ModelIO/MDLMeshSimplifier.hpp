@@ -0,0 +1,1213 @@
+/*!
+ @header MDLMeshSimplifier.hpp
+ @framework ModelIO
+ @abstract Quadric error mesh simplification and level of detail generation
+ @copyright Treata Norouzi on 10/19/26.
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include "MDLDefines.hpp"
+#include "MDLParallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace MDL
+{
+// Simplifies triangle lists by half-edge collapses ordered by quadric error.
+// Collapses move a vertex onto one of its neighbours, so the output only
+// references existing vertices and every level can share the source vertex
+// buffers. A vertex sharing its position with one other vertex (an attribute
+// seam) collapses together with its twin along the seam, vertices on a
+// creased edge only along the crease, and border vertices only along their
+// border. Vertices on a non-manifold edge, where three or more copies meet,
+// where a seam meets the border, where a crease ends or branches, and those
+// locked by the caller never move.
+class MeshSimplifier
+{
+public:
+    // positions are three floats per vertex, `positionStride` bytes apart
+                                        MeshSimplifier(const float* positions, NS::UInteger positionStride, NS::UInteger vertexCount);
+
+    // Pins a vertex in place, e.g. for vertex creases or vertices shared between submeshes
+    void                                lockVertex(std::uint32_t vertex);
+
+    // Keeps the edge between two vertices sharp
+    void                                addCrease(std::uint32_t a, std::uint32_t b);
+
+    // Reduces `indices` to at most `targetIndexCount` indices, stopping early
+    // once the next collapse would exceed `maxError`, which is relative to the
+    // diagonal of the mesh bounds.
+    std::vector<std::uint32_t>          simplify(const std::uint32_t* indices,
+                                                 NS::UInteger indexCount,
+                                                 NS::UInteger targetIndexCount,
+                                                 float maxError,
+                                                 float* resultError = nullptr) const;
+
+    // Emits one index list per entry of `ratios` (fractions of the source
+    // triangle count, largest first) from a single collapse sequence.
+    std::vector<std::vector<std::uint32_t>> simplifyLevels(const std::uint32_t* indices,
+                                                           NS::UInteger indexCount,
+                                                           const float* ratios,
+                                                           NS::UInteger levelCount,
+                                                           float maxError,
+                                                           float* resultErrors = nullptr) const;
+
+    // Meshes above this many triangles get a parallel pre-pass over spatial slabs
+    static constexpr NS::UInteger       PartitionThreshold = 1 << 17;
+
+private:
+    NS::UInteger                        _vertexCount;
+    std::vector<float>                  _positions;
+    std::vector<std::uint32_t>          _positionGroup;
+    std::vector<std::uint8_t>           _locked;
+    // Position group pairs, by edgeKey
+    std::unordered_set<std::uint64_t>   _creases;
+    float                               _scale;
+};
+
+namespace Private
+{
+    // Order-independent key of the edge between two ids
+    std::uint64_t                       edgeKey(std::uint32_t a, std::uint32_t b);
+
+    struct Quadric
+    {
+        double                          a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+
+        static Quadric                  plane(double a, double b, double c, double d, double weight);
+        void                            add(const Quadric& other);
+        double                          error(const float* p) const;
+    };
+
+    // Indexed 4-ary min-heap over vertex ids; ties in cost never reorder, and
+    // keeping the tree shallow and its nodes adjacent keeps sift-downs in cache.
+    class CollapseHeap
+    {
+    public:
+        explicit                        CollapseHeap(NS::UInteger capacity);
+
+        bool                            empty() const;
+        std::uint32_t                   top() const;
+        float                           topCost() const;
+        void                            update(std::uint32_t vertex, float cost);
+        void                            remove(std::uint32_t vertex);
+
+    private:
+        static constexpr std::uint32_t  Absent = std::numeric_limits<std::uint32_t>::max();
+
+        std::vector<std::uint32_t>      _heap;
+        std::vector<std::uint32_t>      _position;
+        std::vector<float>              _cost;
+
+        void                            siftUp(std::uint32_t slot);
+        void                            siftDown(std::uint32_t slot);
+        void                            place(std::uint32_t slot, std::uint32_t vertex);
+    };
+
+    // Collapse state over a compact, locally indexed triangle list
+    class QuadricCollapser
+    {
+    public:
+        enum : std::uint8_t
+        {
+            KindFree    = 0,
+            KindBorder  = 1,
+            // One of the two copies of a position along an attribute seam
+            KindSeam    = 2,
+            KindLocked  = 3,
+        };
+
+        // `creased` marks vertices with two crease edges out of `creases`
+                                        QuadricCollapser(std::vector<float> positions,
+                                                         std::vector<std::uint32_t> groups,
+                                                         std::vector<std::uint8_t> kinds,
+                                                         std::vector<std::uint8_t> creased,
+                                                         std::vector<Quadric> quadrics,
+                                                         std::vector<std::uint32_t> triangles,
+                                                         std::unordered_set<std::uint64_t> creases);
+
+        // Collapses until each target triangle count is reached in turn, calling
+        // snapshot(level, maxCollapseError) as each one is met. Returns early when
+        // no collapse stays under maxErrorSquared.
+        template <typename _Snapshot>
+        void                            run(const NS::UInteger* targetTriangleCounts,
+                                            NS::UInteger levelCount,
+                                            double maxErrorSquared,
+                                            _Snapshot&& snapshot);
+
+        NS::UInteger                    liveTriangleCount() const;
+        void                            liveTriangles(std::vector<std::uint32_t>& triangles) const;
+        const std::vector<Quadric>&     quadrics() const;
+        // Crease edges as moved by the collapses so far
+        const std::unordered_set<std::uint64_t>&    creases() const;
+
+    private:
+        std::vector<float>                          _positions;
+        std::vector<std::uint32_t>                  _groups;
+        std::vector<std::uint8_t>                   _kinds;
+        std::vector<std::uint8_t>                   _creased;
+        // The other copy of each seam vertex
+        std::vector<std::uint32_t>                  _twin;
+        std::unordered_set<std::uint64_t>           _creases;
+        std::vector<Quadric>                        _quadrics;
+        std::vector<std::uint32_t>                  _triangles;
+        std::vector<std::uint8_t>                   _triangleAlive;
+        std::vector<std::vector<std::uint32_t>>     _vertexTriangles;
+        std::vector<std::uint32_t>                  _target;
+        NS::UInteger                                _liveTriangles;
+
+        struct Candidate
+        {
+            double                                  cost;
+            std::uint32_t                           vertex;
+        };
+        std::vector<Candidate>                      _candidates;
+
+        static constexpr std::uint32_t  None = std::numeric_limits<std::uint32_t>::max();
+
+        double                          collapseCost(std::uint32_t from, std::uint32_t to) const;
+        bool                            collapseAllowed(std::uint32_t from, std::uint32_t to) const;
+        // Where the twin of a seam vertex goes when the vertex collapses onto
+        // `to`: the twin's neighbour at the position of `to`, None when the
+        // edge does not run along the seam
+        std::uint32_t                   twinTarget(std::uint32_t twin, std::uint32_t to) const;
+        float                           bestCollapse(std::uint32_t vertex);
+        void                            collapse(std::uint32_t from, std::uint32_t to);
+        const float*                    position(std::uint32_t vertex) const;
+    };
+
+    // Classifies vertices of a triangle list on its position-welded topology and
+    // accumulates the face quadrics, and the edge quadrics that hold borders,
+    // seams and creases in place.
+    void                                classifyVertices(const float* positions,
+                                                         const std::uint32_t* groups,
+                                                         const std::uint8_t* locked,
+                                                         const std::unordered_set<std::uint64_t>& creases,
+                                                         const std::uint32_t* triangles,
+                                                         NS::UInteger triangleCount,
+                                                         NS::UInteger vertexCount,
+                                                         std::vector<std::uint8_t>& kinds,
+                                                         std::vector<std::uint8_t>& creased,
+                                                         std::vector<Quadric>& quadrics);
+
+} // Private
+} // MDL
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// MARK: - Private Sector
+
+_MDL_INLINE std::uint64_t MDL::Private::edgeKey(std::uint32_t a, std::uint32_t b)
+{
+    return (std::uint64_t(std::min(a, b)) << 32) | std::max(a, b);
+}
+
+// MARK: Quadric
+
+_MDL_INLINE MDL::Private::Quadric MDL::Private::Quadric::plane(double a, double b, double c, double d, double weight)
+{
+    return Quadric { weight * a * a, weight * a * b, weight * a * c, weight * a * d,
+                     weight * b * b, weight * b * c, weight * b * d,
+                     weight * c * c, weight * c * d,
+                     weight * d * d };
+}
+
+_MDL_INLINE void MDL::Private::Quadric::add(const Quadric& o)
+{
+    a2 += o.a2; ab += o.ab; ac += o.ac; ad += o.ad;
+    b2 += o.b2; bc += o.bc; bd += o.bd;
+    c2 += o.c2; cd += o.cd;
+    d2 += o.d2;
+}
+
+_MDL_INLINE double MDL::Private::Quadric::error(const float* p) const
+{
+    const double x = p[0], y = p[1], z = p[2];
+    const double e = a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+                   + b2 * y * y + 2 * bc * y * z + 2 * bd * y
+                   + c2 * z * z + 2 * cd * z
+                   + d2;
+    return std::max(e, 0.0);
+}
+
+// MARK: CollapseHeap
+
+_MDL_INLINE MDL::Private::CollapseHeap::CollapseHeap(NS::UInteger capacity)
+    : _position(capacity, Absent)
+    , _cost(capacity, 0.0f)
+{
+    _heap.reserve(capacity);
+}
+
+_MDL_INLINE bool MDL::Private::CollapseHeap::empty() const
+{
+    return _heap.empty();
+}
+
+_MDL_INLINE std::uint32_t MDL::Private::CollapseHeap::top() const
+{
+    return _heap.front();
+}
+
+_MDL_INLINE float MDL::Private::CollapseHeap::topCost() const
+{
+    return _cost[_heap.front()];
+}
+
+_MDL_INLINE void MDL::Private::CollapseHeap::place(std::uint32_t slot, std::uint32_t vertex)
+{
+    _heap[slot] = vertex;
+    _position[vertex] = slot;
+}
+
+_MDL_INLINE void MDL::Private::CollapseHeap::siftUp(std::uint32_t slot)
+{
+    const std::uint32_t vertex = _heap[slot];
+    const float         cost = _cost[vertex];
+    while (slot > 0)
+    {
+        const std::uint32_t parent = (slot - 1) >> 2;
+        if (_cost[_heap[parent]] <= cost)
+        {
+            break;
+        }
+        place(slot, _heap[parent]);
+        slot = parent;
+    }
+    place(slot, vertex);
+}
+
+_MDL_INLINE void MDL::Private::CollapseHeap::siftDown(std::uint32_t slot)
+{
+    const std::uint32_t vertex = _heap[slot];
+    const float         cost = _cost[vertex];
+    const std::uint32_t size = std::uint32_t(_heap.size());
+    for (;;)
+    {
+        const std::uint32_t first = (slot << 2) + 1;
+        if (first >= size)
+        {
+            break;
+        }
+        std::uint32_t best = first;
+        const std::uint32_t last = std::min(first + 4, size);
+        for (std::uint32_t child = first + 1; child < last; ++child)
+        {
+            if (_cost[_heap[child]] < _cost[_heap[best]])
+            {
+                best = child;
+            }
+        }
+        if (_cost[_heap[best]] >= cost)
+        {
+            break;
+        }
+        place(slot, _heap[best]);
+        slot = best;
+    }
+    place(slot, vertex);
+}
+
+_MDL_INLINE void MDL::Private::CollapseHeap::update(std::uint32_t vertex, float cost)
+{
+    if (_position[vertex] == Absent)
+    {
+        _cost[vertex] = cost;
+        _heap.push_back(vertex);
+        siftUp(std::uint32_t(_heap.size() - 1));
+        return;
+    }
+
+    const float previous = _cost[vertex];
+    _cost[vertex] = cost;
+    if (cost < previous)
+    {
+        siftUp(_position[vertex]);
+    }
+    else
+    {
+        siftDown(_position[vertex]);
+    }
+}
+
+_MDL_INLINE void MDL::Private::CollapseHeap::remove(std::uint32_t vertex)
+{
+    const std::uint32_t slot = _position[vertex];
+    if (slot == Absent)
+    {
+        return;
+    }
+
+    const std::uint32_t last = _heap.back();
+    _heap.pop_back();
+    _position[vertex] = Absent;
+    if (last != vertex)
+    {
+        place(slot, last);
+        siftUp(slot);
+        siftDown(_position[last]);
+    }
+}
+
+// MARK: Vertex classification
+
+_MDL_INLINE void MDL::Private::classifyVertices(const float* positions,
+                                                const std::uint32_t* groups,
+                                                const std::uint8_t* locked,
+                                                const std::unordered_set<std::uint64_t>& creases,
+                                                const std::uint32_t* triangles,
+                                                NS::UInteger triangleCount,
+                                                NS::UInteger vertexCount,
+                                                std::vector<std::uint8_t>& kinds,
+                                                std::vector<std::uint8_t>& creased,
+                                                std::vector<Quadric>& quadrics)
+{
+    kinds.assign(vertexCount, QuadricCollapser::KindFree);
+    creased.assign(vertexCount, 0);
+    quadrics.assign(vertexCount, Quadric {});
+
+    std::vector<std::uint64_t> edgeKeys(triangleCount * 3);
+    std::vector<std::uint32_t> edgeSlots(triangleCount * 3);
+
+    for (NS::UInteger t = 0; t < triangleCount; ++t)
+    {
+        const std::uint32_t* tri = triangles + t * 3;
+        const float*         p0 = positions + NS::UInteger(tri[0]) * 3;
+        const float*         p1 = positions + NS::UInteger(tri[1]) * 3;
+        const float*         p2 = positions + NS::UInteger(tri[2]) * 3;
+
+        const double e1[3] = { double(p1[0]) - p0[0], double(p1[1]) - p0[1], double(p1[2]) - p0[2] };
+        const double e2[3] = { double(p2[0]) - p0[0], double(p2[1]) - p0[1], double(p2[2]) - p0[2] };
+        double       n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+        const double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length > 0)
+        {
+            n[0] /= length; n[1] /= length; n[2] /= length;
+            const double  d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+            const Quadric q = Quadric::plane(n[0], n[1], n[2], d, length * 0.5);
+            for (int k = 0; k < 3; ++k)
+            {
+                quadrics[tri[k]].add(q);
+            }
+        }
+
+        for (int k = 0; k < 3; ++k)
+        {
+            edgeKeys[t * 3 + k] = edgeKey(groups[tri[k]], groups[tri[(k + 1) % 3]]);
+            edgeSlots[t * 3 + k] = std::uint32_t(t * 3 + k);
+        }
+    }
+
+    radixSort(edgeKeys, edgeSlots);
+
+    // Plane through the edge of a half-edge slot, perpendicular to its face,
+    // added to the edge's two vertices
+    auto addEdgePlane = [&](std::uint32_t slot)
+    {
+        const std::uint32_t* tri = triangles + (slot / 3) * 3;
+        const std::uint32_t  v0 = tri[slot % 3], v1 = tri[(slot % 3 + 1) % 3];
+        const float*         p0 = positions + NS::UInteger(v0) * 3;
+        const float*         p1 = positions + NS::UInteger(v1) * 3;
+        const float*         p2 = positions + NS::UInteger(tri[(slot % 3 + 2) % 3]) * 3;
+        const double e[3] = { double(p1[0]) - p0[0], double(p1[1]) - p0[1], double(p1[2]) - p0[2] };
+        const double f[3] = { double(p2[0]) - p0[0], double(p2[1]) - p0[1], double(p2[2]) - p0[2] };
+        const double fn[3] = { e[1] * f[2] - e[2] * f[1], e[2] * f[0] - e[0] * f[2], e[0] * f[1] - e[1] * f[0] };
+        double       n[3] = { e[1] * fn[2] - e[2] * fn[1], e[2] * fn[0] - e[0] * fn[2], e[0] * fn[1] - e[1] * fn[0] };
+        const double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length > 0)
+        {
+            n[0] /= length; n[1] /= length; n[2] /= length;
+            const double  d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+            const double  edgeLengthSquared = e[0] * e[0] + e[1] * e[1] + e[2] * e[2];
+            const Quadric q = Quadric::plane(n[0], n[1], n[2], d, 10.0 * edgeLengthSquared);
+            quadrics[v0].add(q);
+            quadrics[v1].add(q);
+        }
+    };
+
+    std::vector<std::uint8_t>                       border(vertexCount, 0), nonManifold(vertexCount, 0);
+    std::unordered_map<std::uint32_t, std::uint32_t> creaseDegree;
+    for (NS::UInteger i = 0; i < edgeKeys.size();)
+    {
+        NS::UInteger end = i + 1;
+        while (end < edgeKeys.size() && edgeKeys[end] == edgeKeys[i])
+        {
+            ++end;
+        }
+
+        const std::uint32_t  slot = edgeSlots[i];
+        const std::uint32_t* tri = triangles + (slot / 3) * 3;
+        const std::uint32_t  v0 = tri[slot % 3], v1 = tri[(slot % 3 + 1) % 3];
+
+        if (end - i == 1)
+        {
+            border[v0] = border[v1] = 1;
+            addEdgePlane(slot);
+        }
+        else if (end - i == 2)
+        {
+            // Twin half-edges that do not share both vertices run along a seam
+            const std::uint32_t  other = edgeSlots[i + 1];
+            const std::uint32_t* otherTri = triangles + (other / 3) * 3;
+            const bool           seam = otherTri[other % 3] != v1 || otherTri[(other % 3 + 1) % 3] != v0;
+            const bool           crease = creases.count(edgeKeys[i]) != 0;
+            if (seam || crease)
+            {
+                addEdgePlane(slot);
+                addEdgePlane(other);
+            }
+            if (crease)
+            {
+                ++creaseDegree[groups[v0]];
+                ++creaseDegree[groups[v1]];
+            }
+        }
+        else
+        {
+            for (NS::UInteger j = i; j < end; ++j)
+            {
+                const std::uint32_t  s = edgeSlots[j];
+                const std::uint32_t* t = triangles + (s / 3) * 3;
+                nonManifold[t[s % 3]] = 1;
+                nonManifold[t[(s % 3 + 1) % 3]] = 1;
+            }
+        }
+        i = end;
+    }
+
+    std::unordered_map<std::uint32_t, std::uint32_t> groupSize;
+    for (NS::UInteger v = 0; v < vertexCount; ++v)
+    {
+        ++groupSize[groups[v]];
+    }
+
+    for (NS::UInteger v = 0; v < vertexCount; ++v)
+    {
+        const std::uint32_t copies = groupSize[groups[v]];
+        auto                degree = creaseDegree.find(groups[v]);
+        const std::uint32_t creaseEdges = degree == creaseDegree.end() ? 0 : degree->second;
+
+        // Crease vertices lie inside a crease line; its ends and branches stay
+        const bool crease = creaseEdges == 2;
+        if (locked[v] || nonManifold[v] || copies > 2 || (creaseEdges && !crease) ||
+            (border[v] && (copies > 1 || crease)))
+        {
+            kinds[v] = QuadricCollapser::KindLocked;
+            continue;
+        }
+        kinds[v] = copies == 2 ? QuadricCollapser::KindSeam : border[v] ? QuadricCollapser::KindBorder : QuadricCollapser::KindFree;
+        creased[v] = crease;
+    }
+}
+
+// MARK: QuadricCollapser
+
+_MDL_INLINE MDL::Private::QuadricCollapser::QuadricCollapser(std::vector<float> positions,
+                                                             std::vector<std::uint32_t> groups,
+                                                             std::vector<std::uint8_t> kinds,
+                                                             std::vector<std::uint8_t> creased,
+                                                             std::vector<Quadric> quadrics,
+                                                             std::vector<std::uint32_t> triangles,
+                                                             std::unordered_set<std::uint64_t> creases)
+    : _positions(std::move(positions))
+    , _groups(std::move(groups))
+    , _kinds(std::move(kinds))
+    , _creased(std::move(creased))
+    , _creases(std::move(creases))
+    , _quadrics(std::move(quadrics))
+    , _triangles(std::move(triangles))
+{
+    const NS::UInteger triangleCount = _triangles.size() / 3;
+    _triangleAlive.assign(triangleCount, 1);
+    _liveTriangles = triangleCount;
+    _vertexTriangles.resize(_kinds.size());
+    _target.assign(_kinds.size(), None);
+
+    // Pair up seam vertices; one whose twin is not in this list (another
+    // slab's, say) cannot move without it
+    _twin.assign(_kinds.size(), None);
+    std::unordered_map<std::uint32_t, std::uint32_t> firstOfGroup;
+    for (std::uint32_t v = 0; v < _kinds.size(); ++v)
+    {
+        if (_kinds[v] != KindSeam)
+        {
+            continue;
+        }
+        auto inserted = firstOfGroup.emplace(_groups[v], v);
+        if (!inserted.second)
+        {
+            _twin[v] = inserted.first->second;
+            _twin[inserted.first->second] = v;
+        }
+    }
+    for (std::uint32_t v = 0; v < _kinds.size(); ++v)
+    {
+        if (_kinds[v] == KindSeam && _twin[v] == None)
+        {
+            _kinds[v] = KindLocked;
+        }
+    }
+
+    for (std::uint32_t t = 0; t < triangleCount; ++t)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            _vertexTriangles[_triangles[t * 3 + k]].push_back(t);
+        }
+    }
+}
+
+_MDL_INLINE const float* MDL::Private::QuadricCollapser::position(std::uint32_t vertex) const
+{
+    return _positions.data() + NS::UInteger(vertex) * 3;
+}
+
+_MDL_INLINE double MDL::Private::QuadricCollapser::collapseCost(std::uint32_t from, std::uint32_t to) const
+{
+    Quadric q = _quadrics[from];
+    q.add(_quadrics[to]);
+    return q.error(position(to));
+}
+
+_MDL_INLINE bool MDL::Private::QuadricCollapser::collapseAllowed(std::uint32_t from, std::uint32_t to) const
+{
+    if (_kinds[from] == KindLocked || _groups[from] == _groups[to])
+    {
+        return false;
+    }
+    if (_creased[from] && !_creases.count(edgeKey(_groups[from], _groups[to])))
+    {
+        return false;
+    }
+
+    NS::UInteger shared = 0;
+    for (std::uint32_t t : _vertexTriangles[from])
+    {
+        if (!_triangleAlive[t])
+        {
+            continue;
+        }
+
+        const std::uint32_t* tri = &_triangles[NS::UInteger(t) * 3];
+        bool                 containsTarget = false;
+        for (int k = 0; k < 3; ++k)
+        {
+            // A seam twin of the target in our fan means the collapse would
+            // drag attributes across the seam
+            if (tri[k] != to && _groups[tri[k]] == _groups[to])
+            {
+                return false;
+            }
+            containsTarget |= tri[k] == to;
+        }
+        if (containsTarget)
+        {
+            ++shared;
+            continue;
+        }
+
+        // Reject collapses that flip or nearly fold a surviving triangle
+        const float* p[3] = { position(tri[0]), position(tri[1]), position(tri[2]) };
+        float        before[3], after[3];
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            const float* q[3] = { p[0], p[1], p[2] };
+            if (pass == 1)
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    if (tri[k] == from)
+                    {
+                        q[k] = position(to);
+                    }
+                }
+            }
+            const float e1[3] = { q[1][0] - q[0][0], q[1][1] - q[0][1], q[1][2] - q[0][2] };
+            const float e2[3] = { q[2][0] - q[0][0], q[2][1] - q[0][1], q[2][2] - q[0][2] };
+            float*      n = pass == 0 ? before : after;
+            n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+            n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+            n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+        }
+        const float dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+        const float lengths = std::sqrt((before[0] * before[0] + before[1] * before[1] + before[2] * before[2]) *
+                                        (after[0] * after[0] + after[1] * after[1] + after[2] * after[2]));
+        if (dot <= 0.2f * lengths)
+        {
+            return false;
+        }
+    }
+
+    if (shared == 0)
+    {
+        return false;
+    }
+
+    // Border vertices may only travel along a border edge to another border vertex
+    if (_kinds[from] == KindBorder)
+    {
+        return (_kinds[to] == KindBorder || _kinds[to] == KindLocked) && shared == 1;
+    }
+    return true;
+}
+
+_MDL_INLINE std::uint32_t MDL::Private::QuadricCollapser::twinTarget(std::uint32_t twin, std::uint32_t to) const
+{
+    for (std::uint32_t t : _vertexTriangles[twin])
+    {
+        if (!_triangleAlive[t])
+        {
+            continue;
+        }
+        for (int k = 0; k < 3; ++k)
+        {
+            const std::uint32_t vertex = _triangles[NS::UInteger(t) * 3 + k];
+            if (vertex != twin && _groups[vertex] == _groups[to])
+            {
+                return vertex;
+            }
+        }
+    }
+    return None;
+}
+
+_MDL_INLINE float MDL::Private::QuadricCollapser::bestCollapse(std::uint32_t vertex)
+{
+    _target[vertex] = None;
+    if (_kinds[vertex] == KindLocked)
+    {
+        return std::numeric_limits<float>::infinity();
+    }
+
+    // Rank the distinct neighbours by cost and validate cheapest first, so the
+    // (comparatively expensive) fold test usually runs once. A seam vertex
+    // pays for its twin's collapse too, and only has neighbours along the seam.
+    const std::uint32_t twin = _twin[vertex];
+    _candidates.clear();
+    for (std::uint32_t t : _vertexTriangles[vertex])
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            const std::uint32_t candidate = _triangles[NS::UInteger(t) * 3 + k];
+            if (candidate == vertex ||
+                std::any_of(_candidates.begin(), _candidates.end(), [candidate](const Candidate& c) { return c.vertex == candidate; }))
+            {
+                continue;
+            }
+            double cost = collapseCost(vertex, candidate);
+            if (twin != None)
+            {
+                const std::uint32_t paired = twinTarget(twin, candidate);
+                if (paired == None)
+                {
+                    continue;
+                }
+                cost += collapseCost(twin, paired);
+            }
+            _candidates.push_back({ cost, candidate });
+        }
+    }
+    std::sort(_candidates.begin(), _candidates.end(), [](const Candidate& a, const Candidate& b) { return a.cost < b.cost; });
+
+    for (const Candidate& candidate : _candidates)
+    {
+        if (collapseAllowed(vertex, candidate.vertex) &&
+            (twin == None || collapseAllowed(twin, twinTarget(twin, candidate.vertex))))
+        {
+            _target[vertex] = candidate.vertex;
+            return float(candidate.cost);
+        }
+    }
+    return std::numeric_limits<float>::infinity();
+}
+
+_MDL_INLINE void MDL::Private::QuadricCollapser::collapse(std::uint32_t from, std::uint32_t to)
+{
+    _quadrics[to].add(_quadrics[from]);
+
+    std::vector<std::uint32_t>& fromTriangles = _vertexTriangles[from];
+    std::vector<std::uint32_t>& toTriangles = _vertexTriangles[to];
+
+    // The crease edges leaving `from` now leave `to`; a seam twin finds them
+    // already moved
+    if (_creased[from])
+    {
+        for (std::uint32_t t : fromTriangles)
+        {
+            for (int k = 0; k < 3 && _triangleAlive[t]; ++k)
+            {
+                const std::uint32_t other = _triangles[NS::UInteger(t) * 3 + k];
+                if (other != from && _creases.erase(edgeKey(_groups[from], _groups[other])) && _groups[other] != _groups[to])
+                {
+                    _creases.insert(edgeKey(_groups[to], _groups[other]));
+                }
+            }
+        }
+    }
+
+    for (std::uint32_t t : fromTriangles)
+    {
+        if (!_triangleAlive[t])
+        {
+            continue;
+        }
+
+        std::uint32_t* tri = &_triangles[NS::UInteger(t) * 3];
+        if (tri[0] == to || tri[1] == to || tri[2] == to)
+        {
+            _triangleAlive[t] = 0;
+            --_liveTriangles;
+            continue;
+        }
+        for (int k = 0; k < 3; ++k)
+        {
+            if (tri[k] == from)
+            {
+                tri[k] = to;
+            }
+        }
+        toTriangles.push_back(t);
+    }
+    fromTriangles.clear();
+    fromTriangles.shrink_to_fit();
+
+    toTriangles.erase(std::remove_if(toTriangles.begin(), toTriangles.end(),
+                                     [this](std::uint32_t t) { return !_triangleAlive[t]; }),
+                      toTriangles.end());
+}
+
+template <typename _Snapshot>
+_MDL_INLINE void MDL::Private::QuadricCollapser::run(const NS::UInteger* targetTriangleCounts,
+                                                     NS::UInteger levelCount,
+                                                     double maxErrorSquared,
+                                                     _Snapshot&& snapshot)
+{
+    const NS::UInteger vertexCount = _kinds.size();
+    CollapseHeap       heap(vertexCount);
+    double             maxCollapseError = 0.0;
+
+    for (std::uint32_t v = 0; v < vertexCount; ++v)
+    {
+        if (_kinds[v] != KindLocked && !_vertexTriangles[v].empty())
+        {
+            heap.update(v, bestCollapse(v));
+        }
+    }
+
+    std::vector<std::uint32_t> neighbours;
+    NS::UInteger               level = 0;
+
+    while (level < levelCount)
+    {
+        if (_liveTriangles <= targetTriangleCounts[level])
+        {
+            snapshot(level, std::sqrt(maxCollapseError));
+            ++level;
+            continue;
+        }
+
+        if (heap.empty() || heap.topCost() > maxErrorSquared)
+        {
+            break;
+        }
+
+        // Collapses since this vertex was ranked may have moved or removed its
+        // target, or folded its fan, so rank it again against the current
+        // mesh and put it back if it got dearer
+        const std::uint32_t from = heap.top();
+        const float         ranked = heap.topCost();
+        const float         cost = bestCollapse(from);
+        const std::uint32_t to = _target[from];
+        if (to == None)
+        {
+            heap.remove(from);
+            continue;
+        }
+        if (cost > ranked)
+        {
+            heap.update(from, cost);
+            continue;
+        }
+        heap.remove(from);
+
+        const std::uint32_t twin = _twin[from];
+        const std::uint32_t twinTo = twin == None ? None : twinTarget(twin, to);
+        maxCollapseError = std::max(maxCollapseError, collapseCost(from, to) + (twinTo == None ? 0.0 : collapseCost(twin, twinTo)));
+        collapse(from, to);
+        if (twinTo != None)
+        {
+            collapse(twin, twinTo);
+            heap.remove(twin);
+        }
+
+        neighbours.clear();
+        for (std::uint32_t survivor : { to, twinTo })
+        {
+            if (survivor == None)
+            {
+                continue;
+            }
+            for (std::uint32_t t : _vertexTriangles[survivor])
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    neighbours.push_back(_triangles[NS::UInteger(t) * 3 + k]);
+                }
+            }
+        }
+        std::sort(neighbours.begin(), neighbours.end());
+        neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+
+        for (std::uint32_t n : neighbours)
+        {
+            if (_kinds[n] != KindLocked)
+            {
+                heap.update(n, bestCollapse(n));
+            }
+        }
+    }
+
+    // Levels the error bound kept us from reaching repeat the coarsest result
+    for (; level < levelCount; ++level)
+    {
+        snapshot(level, std::sqrt(maxCollapseError));
+    }
+}
+
+_MDL_INLINE NS::UInteger MDL::Private::QuadricCollapser::liveTriangleCount() const
+{
+    return _liveTriangles;
+}
+
+_MDL_INLINE void MDL::Private::QuadricCollapser::liveTriangles(std::vector<std::uint32_t>& triangles) const
+{
+    triangles.clear();
+    triangles.reserve(_liveTriangles * 3);
+    for (NS::UInteger t = 0; t < _triangleAlive.size(); ++t)
+    {
+        if (_triangleAlive[t])
+        {
+            triangles.insert(triangles.end(), &_triangles[t * 3], &_triangles[t * 3] + 3);
+        }
+    }
+}
+
+_MDL_INLINE const std::vector<MDL::Private::Quadric>& MDL::Private::QuadricCollapser::quadrics() const
+{
+    return _quadrics;
+}
+
+_MDL_INLINE const std::unordered_set<std::uint64_t>& MDL::Private::QuadricCollapser::creases() const
+{
+    return _creases;
+}
+
+// MARK: MeshSimplifier
+
+_MDL_INLINE MDL::MeshSimplifier::MeshSimplifier(const float* positions, NS::UInteger positionStride, NS::UInteger vertexCount)
+    : _vertexCount(vertexCount)
+    , _positions(vertexCount * 3)
+    , _positionGroup(vertexCount)
+    , _locked(vertexCount, 0)
+    , _scale(0.0f)
+{
+    float lo[3] = { INFINITY, INFINITY, INFINITY }, hi[3] = { -INFINITY, -INFINITY, -INFINITY };
+
+    const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(positions);
+    for (NS::UInteger v = 0; v < vertexCount; ++v)
+    {
+        std::memcpy(&_positions[v * 3], bytes + v * positionStride, sizeof(float) * 3);
+        for (int k = 0; k < 3; ++k)
+        {
+            lo[k] = std::min(lo[k], _positions[v * 3 + k]);
+            hi[k] = std::max(hi[k], _positions[v * 3 + k]);
+        }
+    }
+    if (vertexCount)
+    {
+        _scale = std::sqrt((hi[0] - lo[0]) * (hi[0] - lo[0]) + (hi[1] - lo[1]) * (hi[1] - lo[1]) + (hi[2] - lo[2]) * (hi[2] - lo[2]));
+    }
+
+    // Vertices with bitwise identical positions form one group; groups with more
+    // than one member are attribute seams
+    struct Hash
+    {
+        const float* p;
+        std::size_t operator()(std::uint32_t v) const
+        {
+            std::uint32_t bits[3];
+            std::memcpy(bits, p + NS::UInteger(v) * 3, sizeof(bits));
+            return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+        }
+    };
+    struct Equal
+    {
+        const float* p;
+        bool operator()(std::uint32_t a, std::uint32_t b) const
+        {
+            return std::memcmp(p + NS::UInteger(a) * 3, p + NS::UInteger(b) * 3, sizeof(float) * 3) == 0;
+        }
+    };
+
+    std::unordered_map<std::uint32_t, std::uint32_t, Hash, Equal> firstOfGroup(vertexCount, Hash { _positions.data() }, Equal { _positions.data() });
+    for (std::uint32_t v = 0; v < vertexCount; ++v)
+    {
+        _positionGroup[v] = firstOfGroup.emplace(v, v).first->second;
+    }
+}
+
+_MDL_INLINE void MDL::MeshSimplifier::lockVertex(std::uint32_t vertex)
+{
+    if (vertex < _vertexCount)
+    {
+        _locked[vertex] = 1;
+    }
+}
+
+_MDL_INLINE void MDL::MeshSimplifier::addCrease(std::uint32_t a, std::uint32_t b)
+{
+    if (a < _vertexCount && b < _vertexCount && _positionGroup[a] != _positionGroup[b])
+    {
+        _creases.insert(Private::edgeKey(_positionGroup[a], _positionGroup[b]));
+    }
+}
+
+_MDL_INLINE std::vector<std::uint32_t> MDL::MeshSimplifier::simplify(const std::uint32_t* indices,
+                                                                     NS::UInteger indexCount,
+                                                                     NS::UInteger targetIndexCount,
+                                                                     float maxError,
+                                                                     float* resultError) const
+{
+    const NS::UInteger triangleCount = indexCount / 3;
+    const float        ratio = triangleCount ? float(targetIndexCount / 3) / float(triangleCount) : 1.0f;
+
+    std::vector<std::vector<std::uint32_t>> levels = simplifyLevels(indices, indexCount, &ratio, 1, maxError, resultError);
+    return std::move(levels.front());
+}
+
+_MDL_INLINE std::vector<std::vector<std::uint32_t>> MDL::MeshSimplifier::simplifyLevels(const std::uint32_t* indices,
+                                                                                        NS::UInteger indexCount,
+                                                                                        const float* ratios,
+                                                                                        NS::UInteger levelCount,
+                                                                                        float maxError,
+                                                                                        float* resultErrors) const
+{
+    using namespace Private;
+
+    const NS::UInteger triangleCount = indexCount / 3;
+    const double       maxErrorSquared = double(maxError) * _scale * double(maxError) * _scale;
+
+    std::vector<NS::UInteger> targets(levelCount);
+    for (NS::UInteger level = 0; level < levelCount; ++level)
+    {
+        targets[level] = NS::UInteger(std::max(0.0f, std::min(ratios[level], 1.0f)) * float(triangleCount));
+        if (level > 0)
+        {
+            targets[level] = std::min(targets[level], targets[level - 1]);
+        }
+    }
+
+    std::vector<std::vector<std::uint32_t>> levels(levelCount);
+    if (levelCount == 0)
+    {
+        return levels;
+    }
+
+    // Compact the referenced vertices into a local index space
+    std::vector<std::uint32_t> used(indices, indices + triangleCount * 3);
+    std::sort(used.begin(), used.end());
+    used.erase(std::unique(used.begin(), used.end()), used.end());
+    used.erase(std::remove_if(used.begin(), used.end(), [this](std::uint32_t v) { return v >= _vertexCount; }), used.end());
+
+    auto localOf = [&used](std::uint32_t v) { return std::uint32_t(std::lower_bound(used.begin(), used.end(), v) - used.begin()); };
+
+    const NS::UInteger         localCount = used.size();
+    std::vector<float>         positions(localCount * 3);
+    std::vector<std::uint32_t> groups(localCount);
+    std::vector<std::uint8_t>  locked(localCount);
+    for (NS::UInteger i = 0; i < localCount; ++i)
+    {
+        std::memcpy(&positions[i * 3], &_positions[NS::UInteger(used[i]) * 3], sizeof(float) * 3);
+        groups[i] = _positionGroup[used[i]];
+        locked[i] = _locked[used[i]];
+    }
+
+    std::vector<std::uint32_t> triangles;
+    triangles.reserve(triangleCount * 3);
+    for (NS::UInteger t = 0; t < triangleCount; ++t)
+    {
+        const std::uint32_t* tri = indices + t * 3;
+        if (tri[0] >= _vertexCount || tri[1] >= _vertexCount || tri[2] >= _vertexCount ||
+            tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2])
+        {
+            continue;
+        }
+        triangles.insert(triangles.end(), { localOf(tri[0]), localOf(tri[1]), localOf(tri[2]) });
+    }
+
+    // Group ids are only compared for equality, so global ids work locally too
+    std::vector<std::uint8_t>         kinds, creased;
+    std::vector<Quadric>              quadrics;
+    std::unordered_set<std::uint64_t> creases = _creases;
+    classifyVertices(positions.data(), groups.data(), locked.data(), creases, triangles.data(), triangles.size() / 3, localCount,
+                     kinds, creased, quadrics);
+
+    // Large meshes: collapse the interior of spatial slabs in parallel first,
+    // pinning vertices shared between slabs, then finish with one global pass.
+    double             slabError = 0.0;
+    const NS::UInteger slabCount = std::min<NS::UInteger>(ThreadPool::shared().threadCount() * 2, 64);
+    if (triangles.size() / 3 > PartitionThreshold && slabCount > 1 && targets.front() < triangles.size() / 3)
+    {
+        const NS::UInteger liveCount = triangles.size() / 3;
+
+        float lo[3] = { INFINITY, INFINITY, INFINITY }, hi[3] = { -INFINITY, -INFINITY, -INFINITY };
+        for (NS::UInteger i = 0; i < localCount * 3; ++i)
+        {
+            lo[i % 3] = std::min(lo[i % 3], positions[i]);
+            hi[i % 3] = std::max(hi[i % 3], positions[i]);
+        }
+        int axis = 0;
+        for (int k = 1; k < 3; ++k)
+        {
+            if (hi[k] - lo[k] > hi[axis] - lo[axis])
+            {
+                axis = k;
+            }
+        }
+
+        // Equal-count slabs along the longest axis by triangle centroid
+        std::vector<std::uint32_t> order(liveCount);
+        std::vector<float>         centroid(liveCount);
+        for (std::uint32_t t = 0; t < liveCount; ++t)
+        {
+            order[t] = t;
+            centroid[t] = positions[NS::UInteger(triangles[t * 3 + 0]) * 3 + axis] +
+                          positions[NS::UInteger(triangles[t * 3 + 1]) * 3 + axis] +
+                          positions[NS::UInteger(triangles[t * 3 + 2]) * 3 + axis];
+        }
+        std::sort(order.begin(), order.end(), [&centroid](std::uint32_t a, std::uint32_t b) { return centroid[a] < centroid[b]; });
+
+        std::vector<std::uint32_t> slabOfVertex(localCount, std::numeric_limits<std::uint32_t>::max());
+        std::vector<std::uint8_t>  sharedVertex(localCount, 0);
+        for (NS::UInteger i = 0; i < liveCount; ++i)
+        {
+            const std::uint32_t slab = std::uint32_t(i * slabCount / liveCount);
+            for (int k = 0; k < 3; ++k)
+            {
+                std::uint32_t& owner = slabOfVertex[triangles[NS::UInteger(order[i]) * 3 + k]];
+                if (owner == std::numeric_limits<std::uint32_t>::max())
+                {
+                    owner = slab;
+                }
+                else if (owner != slab)
+                {
+                    sharedVertex[triangles[NS::UInteger(order[i]) * 3 + k]] = 1;
+                }
+            }
+        }
+
+        std::vector<std::vector<std::uint32_t>> slabTriangles(slabCount);
+        std::vector<std::vector<Quadric>>       slabQuadrics(slabCount);
+        std::vector<std::vector<std::uint32_t>> slabVertices(slabCount);
+        std::vector<double>                     slabErrors(slabCount, 0.0);
+
+        parallelFor(slabCount, 1, [&](NS::UInteger begin, NS::UInteger end)
+        {
+            for (NS::UInteger slab = begin; slab < end; ++slab)
+            {
+                const NS::UInteger first = slab * liveCount / slabCount, last = (slab + 1) * liveCount / slabCount;
+
+                std::vector<std::uint32_t>& vertices = slabVertices[slab];
+                for (NS::UInteger i = first; i < last; ++i)
+                {
+                    vertices.insert(vertices.end(), &triangles[NS::UInteger(order[i]) * 3], &triangles[NS::UInteger(order[i]) * 3] + 3);
+                }
+                std::sort(vertices.begin(), vertices.end());
+                vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+
+                auto slabLocal = [&vertices](std::uint32_t v) { return std::uint32_t(std::lower_bound(vertices.begin(), vertices.end(), v) - vertices.begin()); };
+
+                std::vector<float>         p(vertices.size() * 3);
+                std::vector<std::uint32_t> g(vertices.size());
+                std::vector<std::uint8_t>  k(vertices.size());
+                std::vector<Quadric>       q(vertices.size());
+                for (NS::UInteger i = 0; i < vertices.size(); ++i)
+                {
+                    std::memcpy(&p[i * 3], &positions[NS::UInteger(vertices[i]) * 3], sizeof(float) * 3);
+                    g[i] = groups[vertices[i]];
+                    // Creases are left to the global pass, which follows them across slabs
+                    k[i] = sharedVertex[vertices[i]] || creased[vertices[i]] ? std::uint8_t(QuadricCollapser::KindLocked) : kinds[vertices[i]];
+                    q[i] = quadrics[vertices[i]];
+                }
+
+                std::vector<std::uint32_t> tris;
+                tris.reserve((last - first) * 3);
+                for (NS::UInteger i = first; i < last; ++i)
+                {
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        tris.push_back(slabLocal(triangles[NS::UInteger(order[i]) * 3 + c]));
+                    }
+                }
+
+                const NS::UInteger target = (last - first) * targets.front() / liveCount;
+                QuadricCollapser   collapser(std::move(p), std::move(g), std::move(k), std::vector<std::uint8_t>(vertices.size(), 0),
+                                             std::move(q), std::move(tris), {});
+                collapser.run(&target, 1, maxErrorSquared, [&](NS::UInteger, double error) { slabErrors[slab] = error; });
+
+                collapser.liveTriangles(slabTriangles[slab]);
+                for (std::uint32_t& v : slabTriangles[slab])
+                {
+                    v = vertices[v];
+                }
+                slabQuadrics[slab] = collapser.quadrics();
+            }
+        });
+
+        triangles.clear();
+        for (NS::UInteger slab = 0; slab < slabCount; ++slab)
+        {
+            slabError = std::max(slabError, slabErrors[slab]);
+            triangles.insert(triangles.end(), slabTriangles[slab].begin(), slabTriangles[slab].end());
+            for (NS::UInteger i = 0; i < slabVertices[slab].size(); ++i)
+            {
+                const std::uint32_t v = slabVertices[slab][i];
+                if (!sharedVertex[v])
+                {
+                    quadrics[v] = slabQuadrics[slab][i];
+                }
+            }
+        }
+    }
+
+    QuadricCollapser collapser(std::move(positions), std::move(groups), std::move(kinds), std::move(creased), std::move(quadrics),
+                               std::move(triangles), std::move(creases));
+    collapser.run(targets.data(), levelCount, maxErrorSquared, [&](NS::UInteger level, double error)
+    {
+        collapser.liveTriangles(levels[level]);
+        for (std::uint32_t& v : levels[level])
+        {
+            v = used[v];
+        }
+        if (resultErrors)
+        {
+            resultErrors[level] = _scale > 0 ? float(std::max(error, slabError) / _scale) : 0.0f;
+        }
+    });
+
+    return levels;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
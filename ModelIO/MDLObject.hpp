@@ -23,6 +23,54 @@ public:
 
 }
 
+namespace MDL
+{
+namespace Private
+{
+    _MDL_INLINE BoundsCache::Box            boundsCacheBox(const AxisAlignedBoundingBox& box)
+    {
+        return { { box.minBounds.x, box.minBounds.y, box.minBounds.z }, { box.maxBounds.x, box.maxBounds.y, box.maxBounds.z } };
+    }
+    
+    _MDL_INLINE AxisAlignedBoundingBox      axisAlignedBoundingBox(const BoundsCache::Box& box)
+    {
+        AxisAlignedBoundingBox result;
+        result.minBounds = simd_make_float3(box.min[0], box.min[1], box.min[2]);
+        result.maxBounds = simd_make_float3(box.max[0], box.max[1], box.max[2]);
+        return result;
+    }
+    
+    // Accepts the classes met so far that are `objectClass` or inherit from
+    // it; every object for a null class
+    _MDL_INLINE SceneGraph::ClassFilter     sceneClassFilter(Class objectClass)
+    {
+        const SceneGraph&       graph = SceneGraph::shared();
+        SceneGraph::ClassFilter filter;
+        filter.any = !objectClass;
+        filter.accepted.resize(graph.classCount());
+        for (SceneGraph::ClassId c = 0; c < filter.accepted.size(); ++c)
+        {
+            for (Class cls = static_cast<Class>(const_cast<void*>(graph.classAt(c))); cls; cls = class_getSuperclass(cls))
+            {
+                if (cls == objectClass)
+                {
+                    filter.accepted[c] = true;
+                    filter.mask |= SceneGraph::classBit(c);
+                    break;
+                }
+            }
+        }
+        return filter;
+    }
+    
+    // Whether `hit` is still at `path` below `scope` according to ModelIO,
+    // walking its parents and names upwards; a null `scope` stands for an
+    // asset, whose top level objects have no parent
+    bool                                    confirmPath(const Object* scope, const Object* hit, std::string_view path);
+    
+} // Private
+}
+
 // MARK: - Private Sector
 
 // MARK: Object
@@ -80,6 +128,12 @@ _MDL_INLINE MDL::Object* MDL::Object::instance() const
 {
     return Object::sendMessage<MDL::Object*>(this, _MDL_PRIVATE_SEL(instance));
 }
+// write method: setInstance:
+_MDL_INLINE void MDL::Object::setInstance(const MDL::Object* instance)
+{
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setInstance_), instance);
+    Private::BoundsCache::shared().markDirty(this);
+}
 
 // property: path
 _MDL_INLINE NS::String* MDL::Object::path() const
@@ -88,12 +142,28 @@ _MDL_INLINE NS::String* MDL::Object::path() const
 }
 
 // method: objectAtPath:
+// Looked up in the scene graph's path index and confirmed against ModelIO;
+// misses and stale hits are left to ModelIO
 _MDL_INLINE MDL::Object* MDL::Object::objectAtPath(const NS::String* path)
 {
+    const char*                       utf8 = path ? path->utf8String() : "";
+    const Private::SceneGraph::NodeId scope = sceneNode();
+    const Private::SceneGraph&        graph = Private::SceneGraph::shared();
+    const Private::SceneGraph::NodeId node = graph.findPath(scope, utf8);
+    if (node != Private::SceneGraph::InvalidNode)
+    {
+        Object* hit = static_cast<Object*>(const_cast<void*>(graph.object(node)));
+        if (Private::confirmPath(this, hit, utf8))
+        {
+            return hit;
+        }
+    }
+    
     return Object::sendMessage<MDL::Object*>(this, _MDL_PRIVATE_SEL(objectAtPath_), path);
 }
 
 // method: enumerateChildObjectsOfClass:root:usingBlock:stopPointer:
+// Walks the scene graph below `root`, skipping subtrees without a match
 _MDL_INLINE void MDL::Object::enumerateChildObjectsOfClass(
    const Class objectClass,
    const MDL::Object* root,
@@ -101,9 +171,16 @@ _MDL_INLINE void MDL::Object::enumerateChildObjectsOfClass(
    const void (^block)(const MDL::Object* object, const BOOL* stop),
    const BOOL* stopPointer
 ) {
-    return Object::sendMessage<void>(this,
-                                     _MDL_PRIVATE_SEL(enumerateChildObjectsOfClass_root_usingBlock_stopPointer_),
-                                     objectClass, root, block, stopPointer);
+    if (!root || !block)
+    {
+        return;
+    }
+    
+    root->forEachObjectOfClass(objectClass, [&](Object* object)
+    {
+        block(object, stopPointer);
+        return !(stopPointer && *stopPointer);
+    });
 }
 
 // property: transform
@@ -114,7 +191,9 @@ _MDL_INLINE MDL::TransformComponent* MDL::Object::transform() const
 // write method: setTransform:
 _MDL_INLINE void MDL::Object::setTransform(const MDL::TransformComponent* transform)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setTransform_), transform);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setTransform_), transform);
+    Private::BoundsCache::shared().markDirty(this);
+    Private::syncSceneTransform(Private::SceneGraph::shared().find(this), transform);
 }
 
 // property: children
@@ -125,7 +204,29 @@ _MDL_INLINE MDL::ObjectContainerComponent* MDL::Object::children() const
 // write method: setChildren:
 _MDL_INLINE void MDL::Object::setChildren(const MDL::ObjectContainerComponent* children)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setChildren_), children);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setChildren_), children);
+    Private::BoundsCache::shared().markDirty(this);
+    
+    Private::SceneGraph&              graph = Private::SceneGraph::shared();
+    const Private::SceneGraph::NodeId node = graph.find(this);
+    if (node == Private::SceneGraph::InvalidNode)
+    {
+        return;
+    }
+    
+    std::vector<Private::SceneGraph::NodeId> previous;
+    graph.forEachChild(node, [&](Private::SceneGraph::NodeId child) { previous.push_back(child); });
+    for (Private::SceneGraph::NodeId child : previous)
+    {
+        graph.detach(child);
+    }
+    
+    graph.setContainer(node, children);
+    NS::Array* objects = children ? children->objects() : nullptr;
+    for (NS::UInteger i = 0, n = objects ? objects->count() : 0; i < n; ++i)
+    {
+        graph.attach(objects->object<Object>(i)->sceneNode(), node);
+    }
 }
 
 // property: hidden
@@ -136,19 +237,313 @@ _MDL_INLINE BOOL MDL::Object::hidden() const
 // write method: setHidden:
 _MDL_INLINE void MDL::Object::setHidden(const BOOL hidden)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setHidden_), hidden);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setHidden_), hidden);
+    
+    Private::SceneGraph&              graph = Private::SceneGraph::shared();
+    const Private::SceneGraph::NodeId node = graph.find(this);
+    if (node != Private::SceneGraph::InvalidNode)
+    {
+        graph.setHidden(node, hidden);
+    }
 }
 
 // method: addChild:
 _MDL_INLINE void MDL::Object::addChild(const MDL::Object* child)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(addChild_), child);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(addChild_), child);
+    Private::BoundsCache::shared().markDirty(this);
+    
+    Private::SceneGraph&              graph = Private::SceneGraph::shared();
+    const Private::SceneGraph::NodeId node = graph.find(this);
+    if (node != Private::SceneGraph::InvalidNode && child)
+    {
+        // addChild: creates the container on first use
+        graph.setContainer(node, Object::sendMessage<ObjectContainerComponent*>(this, _MDL_PRIVATE_SEL(children)));
+        graph.attach(child->sceneNode(), node);
+    }
 }
 
 // method: boundingBoxAtTime:
+// Served natively: the cached local bounds, placed by the object's own transform
 _MDL_INLINE MDL::AxisAlignedBoundingBox MDL::Object::boundingBoxAtTime(const NS::TimeInterval time)
 {
-    return Object::sendMessage<MDL::AxisAlignedBoundingBox>(this, _MDL_PRIVATE_SEL(boundingBoxAtTime_), time);
+    AxisAlignedBoundingBox local = localBoundingBoxAtTime(time);
+    TransformComponent*    component = transform();
+    if (!component)
+    {
+        return local;
+    }
+    
+    const matrix_float4x4 matrix = component->localTransformAtTime(time);
+    return Private::axisAlignedBoundingBox(Private::BoundsCache::transform(Private::boundsCacheBox(local),
+                                                                           reinterpret_cast<const float*>(&matrix.columns[0]),
+                                                                           sizeof(matrix.columns[0]) / sizeof(float)));
+}
+
+// native: localBoundingBoxAtTime
+_MDL_INLINE MDL::AxisAlignedBoundingBox MDL::Object::localBoundingBoxAtTime(NS::TimeInterval time)
+{
+    Private::BoundsCache::Box box;
+    if (!Private::BoundsCache::shared().find(this, time, box))
+    {
+        std::vector<double> keyTimes;
+        box = computeLocalBounds(time, &keyTimes);
+        for (double keyTime : keyTimes)
+        {
+            if (keyTime != time)
+            {
+                computeLocalBounds(keyTime, nullptr);
+            }
+        }
+    }
+    return Private::axisAlignedBoundingBox(box);
+}
+
+// native: invalidateBoundingBox
+_MDL_INLINE void MDL::Object::invalidateBoundingBox() const
+{
+    Private::BoundsCache::shared().markDirty(this);
+}
+
+// Post-order walk with an explicit stack; subtrees already in the cache are
+// merged without being opened
+_MDL_INLINE MDL::Private::BoundsCache::Box MDL::Object::computeLocalBounds(NS::TimeInterval time, std::vector<double>* keyTimes)
+{
+    using Box = Private::BoundsCache::Box;
+    Private::BoundsCache& cache = Private::BoundsCache::shared();
+    
+    struct Frame
+    {
+        Object*         object;
+        NS::Array*      children;
+        NS::UInteger    next;
+        Box             box;
+        bool            animated;
+    };
+    
+    auto open = [&](Object* object)
+    {
+        Frame frame = { object, nullptr, 0, Private::BoundsCache::emptyBox(), false };
+        
+        if (Object::sendMessage<BOOL>(object, _MDL_PRIVATE_SEL(isKindOfClass_), _MDL_PRIVATE_CLS(MDLMesh)))
+        {
+            frame.box = Private::boundsCacheBox(Object::sendMessage<AxisAlignedBoundingBox>(object, _MDL_PRIVATE_SEL(boundingBox)));
+            if (NS::Array* buffers = Object::sendMessage<NS::Array*>(object, _MDL_PRIVATE_SEL(vertexBuffers)))
+            {
+                for (NS::UInteger b = 0, n = buffers->count(); b < n; ++b)
+                {
+                    cache.addDependency(buffers->object(b), object);
+                }
+            }
+        }
+        
+        // The original an instance draws, in the instance's space
+        if (Object* instance = object->instance())
+        {
+            const AxisAlignedBoundingBox box = Object::sendMessage<AxisAlignedBoundingBox>(instance, _MDL_PRIVATE_SEL(boundingBoxAtTime_), time);
+            Private::BoundsCache::merge(frame.box, Private::boundsCacheBox(box));
+            cache.addDependency(instance, object);
+        }
+        
+        if (ObjectContainerComponent* children = object->children())
+        {
+            cache.addDependency(children, object);
+            frame.children = children->objects();
+        }
+        return frame;
+    };
+    
+    auto place = [&](Frame& parent, Object* child, const Box& childBox, bool childAnimated)
+    {
+        Box  placed = childBox;
+        bool moving = false;
+        
+        if (TransformComponent* component = child->transform())
+        {
+            const matrix_float4x4 matrix = component->localTransformAtTime(time);
+            placed = Private::BoundsCache::transform(childBox, reinterpret_cast<const float*>(&matrix.columns[0]),
+                                                     sizeof(matrix.columns[0]) / sizeof(float));
+            cache.addDependency(component, parent.object);
+            
+            NS::Array* times = component->keyTimes();
+            moving = times && times->count() > 1;
+            for (NS::UInteger k = 0, n = (moving && keyTimes) ? times->count() : 0; k < n; ++k)
+            {
+                keyTimes->push_back(times->object<NS::Number>(k)->doubleValue());
+            }
+        }
+        
+        cache.addDependency(child, parent.object);
+        Private::BoundsCache::merge(parent.box, placed);
+        parent.animated = parent.animated || childAnimated || moving;
+    };
+    
+    Box result = Private::BoundsCache::emptyBox();
+    std::vector<Frame> stack = { open(this) };
+    while (!stack.empty())
+    {
+        Frame& frame = stack.back();
+        if (frame.children && frame.next < frame.children->count())
+        {
+            Object* child = frame.children->object<Object>(frame.next++);
+            Box     childBox;
+            bool    childAnimated = false;
+            if (cache.find(child, time, childBox, &childAnimated))
+            {
+                place(frame, child, childBox, childAnimated);
+            }
+            else
+            {
+                stack.push_back(open(child));
+            }
+            continue;
+        }
+        
+        const Frame done = frame;
+        stack.pop_back();
+        cache.store(done.object, time, done.animated, done.box);
+        
+        if (stack.empty())
+        {
+            result = done.box;
+        }
+        else
+        {
+            place(stack.back(), done.object, done.box, done.animated);
+        }
+    }
+    
+    if (keyTimes)
+    {
+        std::sort(keyTimes->begin(), keyTimes->end());
+        keyTimes->erase(std::unique(keyTimes->begin(), keyTimes->end()), keyTimes->end());
+        if (keyTimes->size() > Private::BoundsCache::MaxSamples / 4)
+        {
+            keyTimes->clear();
+        }
+    }
+    return result;
+}
+
+// native: sceneNode
+// Imports from the topmost ancestor so that every node's parent link is known
+_MDL_INLINE bool MDL::Private::confirmPath(const Object* scope, const Object* hit, std::string_view path)
+{
+    const Object* object = hit;
+    std::size_t   end = path.size();
+    while (end > 0)
+    {
+        const std::size_t slash = path.rfind('/', end - 1);
+        const std::size_t begin = (slash == std::string_view::npos) ? 0 : slash + 1;
+        if (end > begin)
+        {
+            NS::String*      name = object ? NS::Object::sendMessage<NS::String*>(object, _MDL_PRIVATE_SEL(name)) : nullptr;
+            std::string_view component = path.substr(begin, end - begin);
+            if (!object || component != std::string_view(name ? name->utf8String() : ""))
+            {
+                return false;
+            }
+            object = object->parent();
+        }
+        end = (slash == std::string_view::npos) ? 0 : slash;
+    }
+    return object == scope;
+}
+
+_MDL_INLINE MDL::Private::SceneGraph::NodeId MDL::Object::sceneNode() const
+{
+    using NodeId = Private::SceneGraph::NodeId;
+    Private::SceneGraph& graph = Private::SceneGraph::shared();
+    
+    NodeId node = graph.find(this);
+    if (node != Private::SceneGraph::InvalidNode)
+    {
+        return node;
+    }
+    
+    Object* top = const_cast<Object*>(this);
+    while (Object* parent = Object::sendMessage<Object*>(top, _MDL_PRIVATE_SEL(parent)))
+    {
+        if (graph.find(parent) != Private::SceneGraph::InvalidNode)
+        {
+            break;
+        }
+        top = parent;
+    }
+    
+    auto import = [&](Object* object)
+    {
+        const NodeId node = graph.insert(object);
+        NS::String*  name = Object::sendMessage<NS::String*>(object, _MDL_PRIVATE_SEL(name));
+        graph.setName(node, name ? name->utf8String() : "");
+        graph.setHidden(node, Object::sendMessage<BOOL>(object, _MDL_PRIVATE_SEL(hidden)));
+        graph.setClass(node, object_getClass(reinterpret_cast<id>(object)));
+        Private::syncSceneTransform(node, Object::sendMessage<TransformComponent*>(object, _MDL_PRIVATE_SEL(transform)));
+        return node;
+    };
+    
+    // Objects whose children are still to be read
+    std::vector<std::pair<Object*, NodeId>> pending = { { top, import(top) } };
+    if (Object* parent = Object::sendMessage<Object*>(top, _MDL_PRIVATE_SEL(parent)))
+    {
+        graph.attach(pending.front().second, graph.find(parent));
+    }
+    
+    while (!pending.empty())
+    {
+        auto [object, id] = pending.back();
+        pending.pop_back();
+        
+        ObjectContainerComponent* children = Object::sendMessage<ObjectContainerComponent*>(object, _MDL_PRIVATE_SEL(children));
+        graph.setContainer(id, children);
+        NS::Array* objects = children ? children->objects() : nullptr;
+        for (NS::UInteger i = 0, n = objects ? objects->count() : 0; i < n; ++i)
+        {
+            Object* child = objects->object<Object>(i);
+            NodeId  childId = graph.find(child);
+            if (childId == Private::SceneGraph::InvalidNode)
+            {
+                childId = import(child);
+                pending.push_back({ child, childId });
+            }
+            graph.attach(childId, id);
+        }
+    }
+    
+    return graph.find(this);
+}
+
+// native: forEachObjectOfClass
+template <typename _Fn>
+_MDL_INLINE void MDL::Object::forEachObjectOfClass(Class objectClass, _Fn&& fn) const
+{
+    // Importing the object may meet new classes, so the filter is built after it
+    const Private::SceneGraph::NodeId root = sceneNode();
+    const Private::SceneGraph&        graph = Private::SceneGraph::shared();
+    graph.traverse(root, Private::sceneClassFilter(objectClass), [&](Private::SceneGraph::NodeId node)
+    {
+        return node == root || fn(static_cast<Object*>(const_cast<void*>(graph.object(node))));
+    });
+}
+
+// native: forEachObjectOfClassParallel
+template <typename _Fn>
+_MDL_INLINE void MDL::Object::forEachObjectOfClassParallel(Class objectClass, _Fn&& fn) const
+{
+    // Importing the object may meet new classes, so the filter is built after it
+    const Private::SceneGraph::NodeId root = sceneNode();
+    const Private::SceneGraph&        graph = Private::SceneGraph::shared();
+    graph.traverseParallel(root, Private::sceneClassFilter(objectClass), [&](Private::SceneGraph::NodeId node)
+    {
+        return node == root || fn(static_cast<Object*>(const_cast<void*>(graph.object(node))));
+    });
+}
+
+// native: invalidateSceneGraph
+_MDL_INLINE void MDL::Object::invalidateSceneGraph() const
+{
+    Private::SceneGraph& graph = Private::SceneGraph::shared();
+    graph.remove(graph.find(this));
 }
 
 // MARK: ObjectContainer
@@ -0,0 +1,111 @@
+/*!
+ @header MDLObjectLifetime.hpp
+ @framework ModelIO
+ @abstract Ties native caches keyed by Objective-C objects to those objects' lifetimes
+ @copyright Treata Norouzi on 10/19/26.
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include "MDLDefines.hpp"
+#include "Foundation/Foundation.hpp"
+
+#include <mutex>
+#include <new>
+
+#include <objc/message.h>
+#include <objc/runtime.h>
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace MDL
+{
+namespace Private
+{
+    // The native stores key their entries by the address of the ModelIO
+    // object they describe. A watch associates a small token object with the
+    // owner; the runtime releases it while the owner is destroyed, before its
+    // memory can be handed to a new object, and the token's dealloc evicts the
+    // owner's entries. Entries therefore neither leak nor pass to a later
+    // object allocated at the same address.
+    class ObjectLifetime
+    {
+    public:
+        using Evict = void (*)(const void* object);
+
+        // Calls `evict(object)` once `object` is deallocated. `key` names the
+        // watching store; watching an object twice under one key is a no-op.
+        static void                 watch(const void* object, const void* key, Evict evict);
+
+    private:
+        struct Watch
+        {
+            const void*             object;
+            Evict                   evict;
+        };
+
+        static ::Class              tokenClass();
+        static void                 dealloc(id token, SEL selector);
+    };
+
+} // Private
+} // MDL
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// MARK: - Private Sector
+
+_MDL_INLINE void MDL::Private::ObjectLifetime::watch(const void* object, const void* key, Evict evict)
+{
+    if (!object)
+    {
+        return;
+    }
+
+    // Serializes the check with the association, so racing watches on one
+    // object leave a single token
+    static std::mutex           mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+
+    id owner = reinterpret_cast<id>(const_cast<void*>(object));
+    if (objc_getAssociatedObject(owner, key))
+    {
+        return;
+    }
+
+    id token = class_createInstance(tokenClass(), sizeof(Watch));
+    new (object_getIndexedIvars(token)) Watch { object, evict };
+    objc_setAssociatedObject(owner, key, token, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    reinterpret_cast<NS::Object*>(token)->release();
+}
+
+_MDL_INLINE ::Class MDL::Private::ObjectLifetime::tokenClass()
+{
+    static ::Class cls = []
+    {
+        // Another image embedding these headers may have registered it first;
+        // its tokens share this layout
+        if (::Class registered = objc_lookUpClass("MDLCppObjectLifetimeToken"))
+        {
+            return registered;
+        }
+        ::Class token = objc_allocateClassPair(objc_lookUpClass("NSObject"), "MDLCppObjectLifetimeToken", 0);
+        class_addMethod(token, sel_registerName("dealloc"), reinterpret_cast<IMP>(&ObjectLifetime::dealloc), "v@:");
+        objc_registerClassPair(token);
+        return token;
+    }();
+    return cls;
+}
+
+_MDL_INLINE void MDL::Private::ObjectLifetime::dealloc(id token, SEL selector)
+{
+    const Watch* watch = static_cast<const Watch*>(object_getIndexedIvars(token));
+    watch->evict(watch->object);
+
+    objc_super super = { token, class_getSuperclass(object_getClass(token)) };
+    reinterpret_cast<void (*)(objc_super*, SEL)>(&objc_msgSendSuper)(&super, selector);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
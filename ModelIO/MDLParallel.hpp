@@ -0,0 +1,293 @@
+/*!
+ @header MDLParallel.hpp
+ @framework ModelIO
+ @abstract Worker pool and parallel primitives shared by the native engines
+ @copyright Treata Norouzi on 10/19/26.
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include "MDLDefines.hpp"
+#include "Foundation/NSTypes.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace MDL
+{
+namespace Private
+{
+    // Persistent pool; the calling thread always takes part in the work, so a
+    // pool with zero workers degrades to a plain serial loop.
+    class ThreadPool
+    {
+    public:
+        static ThreadPool&          shared();
+
+        explicit                    ThreadPool(NS::UInteger workerCount);
+                                    ~ThreadPool();
+
+                                    ThreadPool(const ThreadPool&) = delete;
+        ThreadPool&                 operator=(const ThreadPool&) = delete;
+
+        // Workers plus the calling thread
+        NS::UInteger                threadCount() const;
+
+        // fn(begin, end) is invoked over [0, count) in chunks of `grain`; chunks
+        // are claimed dynamically so uneven work balances itself. Calls made
+        // from inside a running job execute serially on the current thread.
+        template <typename _Fn>
+        void                        parallelFor(NS::UInteger count, NS::UInteger grain, _Fn&& fn);
+
+    private:
+        struct Job
+        {
+            void                    (*invoke)(void* context);
+            void*                   context;
+        };
+
+        static bool&                insideJob();
+
+        void                        run(const Job& job);
+        void                        workerLoop();
+
+        std::vector<std::thread>    _workers;
+        std::mutex                  _submitMutex;
+        std::mutex                  _mutex;
+        std::condition_variable     _wake;
+        std::condition_variable     _done;
+        Job                         _job = { nullptr, nullptr };
+        std::uint64_t               _generation = 0;
+        NS::UInteger                _pending = 0;
+        bool                        _stop = false;
+    };
+
+    template <typename _Fn>
+    void                            parallelFor(NS::UInteger count, NS::UInteger grain, _Fn&& fn);
+
+    // Stable LSD radix sort of 64-bit keys carrying a 32-bit payload. Byte
+    // passes on which every key agrees are skipped, so small vertex ranges
+    // only pay for the digits they actually use.
+    void                            radixSort(std::vector<std::uint64_t>& keys, std::vector<std::uint32_t>& values);
+
+} // Private
+} // MDL
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// MARK: - Private Sector
+
+_MDL_INLINE MDL::Private::ThreadPool& MDL::Private::ThreadPool::shared()
+{
+    static ThreadPool pool(std::max<NS::UInteger>(std::thread::hardware_concurrency(), 1) - 1);
+    return pool;
+}
+
+_MDL_INLINE MDL::Private::ThreadPool::ThreadPool(NS::UInteger workerCount)
+{
+    _workers.reserve(workerCount);
+    for (NS::UInteger i = 0; i < workerCount; ++i)
+    {
+        _workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+_MDL_INLINE MDL::Private::ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wake.notify_all();
+    for (std::thread& worker : _workers)
+    {
+        worker.join();
+    }
+}
+
+_MDL_INLINE NS::UInteger MDL::Private::ThreadPool::threadCount() const
+{
+    return _workers.size() + 1;
+}
+
+_MDL_INLINE bool& MDL::Private::ThreadPool::insideJob()
+{
+    static thread_local bool inside = false;
+    return inside;
+}
+
+template <typename _Fn>
+_MDL_INLINE void MDL::Private::ThreadPool::parallelFor(NS::UInteger count, NS::UInteger grain, _Fn&& fn)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    grain = std::max<NS::UInteger>(grain, 1);
+    const NS::UInteger chunkCount = (count + grain - 1) / grain;
+
+    if (chunkCount == 1 || _workers.empty() || insideJob())
+    {
+        fn(NS::UInteger(0), count);
+        return;
+    }
+
+    struct Context
+    {
+        _Fn&                        fn;
+        NS::UInteger                count;
+        NS::UInteger                grain;
+        NS::UInteger                chunkCount;
+        std::atomic<NS::UInteger>   next;
+    } context { fn, count, grain, chunkCount, { 0 } };
+
+    Job job;
+    job.context = &context;
+    job.invoke = [](void* opaque)
+    {
+        Context& ctx = *static_cast<Context*>(opaque);
+        for (NS::UInteger chunk = ctx.next.fetch_add(1); chunk < ctx.chunkCount; chunk = ctx.next.fetch_add(1))
+        {
+            const NS::UInteger begin = chunk * ctx.grain;
+            ctx.fn(begin, std::min(begin + ctx.grain, ctx.count));
+        }
+    };
+
+    run(job);
+}
+
+_MDL_INLINE void MDL::Private::ThreadPool::run(const Job& job)
+{
+    std::lock_guard<std::mutex> submit(_submitMutex);
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _job = job;
+        _pending = _workers.size();
+        ++_generation;
+    }
+    _wake.notify_all();
+
+    insideJob() = true;
+    job.invoke(job.context);
+    insideJob() = false;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _done.wait(lock, [this]() { return _pending == 0; });
+    _job = { nullptr, nullptr };
+}
+
+_MDL_INLINE void MDL::Private::ThreadPool::workerLoop()
+{
+    insideJob() = true;
+
+    std::uint64_t seen = 0;
+    for (;;)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _wake.wait(lock, [&]() { return _stop || _generation != seen; });
+            if (_stop)
+            {
+                return;
+            }
+            seen = _generation;
+            job = _job;
+        }
+
+        job.invoke(job.context);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (--_pending == 0)
+        {
+            _done.notify_one();
+        }
+    }
+}
+
+template <typename _Fn>
+_MDL_INLINE void MDL::Private::parallelFor(NS::UInteger count, NS::UInteger grain, _Fn&& fn)
+{
+    ThreadPool::shared().parallelFor(count, grain, std::forward<_Fn>(fn));
+}
+
+_MDL_INLINE void MDL::Private::radixSort(std::vector<std::uint64_t>& keys, std::vector<std::uint32_t>& values)
+{
+    const NS::UInteger count = keys.size();
+    if (count < 2)
+    {
+        return;
+    }
+
+    constexpr NS::UInteger kGrain = 1 << 16;
+    const NS::UInteger     chunkCount = (count + kGrain - 1) / kGrain;
+
+    std::uint64_t allOr = 0, allAnd = ~std::uint64_t(0);
+    for (std::uint64_t key : keys)
+    {
+        allOr |= key;
+        allAnd &= key;
+    }
+    const std::uint64_t varying = allOr ^ allAnd;
+
+    std::vector<std::uint64_t> keyScratch(count);
+    std::vector<std::uint32_t> valueScratch(count);
+    std::vector<NS::UInteger>  histograms(chunkCount * 256);
+
+    for (unsigned shift = 0; shift < 64; shift += 8)
+    {
+        if (((varying >> shift) & 0xFF) == 0)
+        {
+            continue;
+        }
+
+        std::fill(histograms.begin(), histograms.end(), 0);
+        parallelFor(count, kGrain, [&](NS::UInteger begin, NS::UInteger end)
+        {
+            NS::UInteger* histogram = &histograms[(begin / kGrain) * 256];
+            for (NS::UInteger i = begin; i < end; ++i)
+            {
+                ++histogram[(keys[i] >> shift) & 0xFF];
+            }
+        });
+
+        // Exclusive scan in (digit, chunk) order keeps the scatter stable
+        NS::UInteger offset = 0;
+        for (NS::UInteger digit = 0; digit < 256; ++digit)
+        {
+            for (NS::UInteger chunk = 0; chunk < chunkCount; ++chunk)
+            {
+                const NS::UInteger n = histograms[chunk * 256 + digit];
+                histograms[chunk * 256 + digit] = offset;
+                offset += n;
+            }
+        }
+
+        parallelFor(count, kGrain, [&](NS::UInteger begin, NS::UInteger end)
+        {
+            NS::UInteger* cursor = &histograms[(begin / kGrain) * 256];
+            for (NS::UInteger i = begin; i < end; ++i)
+            {
+                const NS::UInteger slot = cursor[(keys[i] >> shift) & 0xFF]++;
+                keyScratch[slot] = keys[i];
+                valueScratch[slot] = values[i];
+            }
+        });
+
+        keys.swap(keyScratch);
+        values.swap(valueScratch);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
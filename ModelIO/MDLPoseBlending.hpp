@@ -0,0 +1,234 @@
+/*!
+ @header MDLPoseBlending.hpp
+ @framework ModelIO
+ @abstract Blending and layering kernels over local joint poses
+ @copyright Treata Norouzi on 10/19/26.
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include "MDLDefines.hpp"
+#include "Foundation/NSTypes.hpp"
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define _MDL_POSE_BLENDING_SSE 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define _MDL_POSE_BLENDING_NEON 1
+#endif
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace MDL
+{
+_MDL_ENUM(NS::UInteger, PoseBlendRotation) {
+    // Normalized after every blend
+    PoseBlendRotationNlerp = 0,
+    // Left unnormalized until the final pose, which is cheaper when several
+    // blends feed each other and exact when weights are 0 or 1
+    PoseBlendRotationLerp = 1,
+};
+
+namespace Private
+{
+    // Local poses hold a translation, a rotation quaternion (x, y, z, w) and
+    // a scale per joint, four floats each, in skeleton joint order. Every
+    // kernel takes a blend weight and an optional per-joint mask that scales
+    // it; outputs may alias inputs.
+    struct PoseBlending
+    {
+        struct Pose
+        {
+            float*                      translations;
+            float*                      rotations;
+            float*                      scales;
+        };
+
+        struct ConstPose
+        {
+            const float*                translations;
+            const float*                rotations;
+            const float*                scales;
+        };
+
+        // From `a` towards `b` by the weight; rotations take the shorter arc
+        static void                     blend(ConstPose a, ConstPose b, float weight, const float* mask, NS::UInteger jointCount,
+                                              PoseBlendRotation rotation, Pose out);
+
+        // `layer` relative to `reference`, added onto `base` by the weight:
+        // translations add, rotations compose in joint space and scales
+        // multiply. Input rotations are normalized first, so they may come
+        // from PoseBlendRotationLerp blends
+        static void                     add(ConstPose base, ConstPose layer, ConstPose reference, float weight, const float* mask,
+                                            NS::UInteger jointCount, Pose out);
+
+        static void                     normalizeRotations(float* rotations, NS::UInteger jointCount);
+
+    private:
+        static void                     multiply(const float* a, const float* b, float* out);
+        // `q` scaled to unit length; zero quaternions are left as they are
+        static void                     normalize(const float* q, float* out);
+    };
+
+} // Private
+} // MDL
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// MARK: - Private Sector
+
+_MDL_INLINE void MDL::Private::PoseBlending::blend(ConstPose a, ConstPose b, float weight, const float* mask, NS::UInteger jointCount,
+                                                   PoseBlendRotation rotation, Pose out)
+{
+    const bool normalize = rotation == PoseBlendRotationNlerp;
+    for (NS::UInteger j = 0; j < jointCount; ++j)
+    {
+        const NS::UInteger i = j * 4;
+        const float        w = mask ? weight * mask[j] : weight;
+        const float*       qa = a.rotations + i;
+        const float*       qb = b.rotations + i;
+        const float        dot = qa[0] * qb[0] + qa[1] * qb[1] + qa[2] * qb[2] + qa[3] * qb[3];
+        const float        wb = dot < 0.0f ? -w : w;
+#if defined(_MDL_POSE_BLENDING_SSE)
+        const __m128 weights = _mm_set1_ps(w);
+        const __m128 ta = _mm_loadu_ps(a.translations + i);
+        const __m128 sa = _mm_loadu_ps(a.scales + i);
+        _mm_storeu_ps(out.translations + i, _mm_add_ps(ta, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b.translations + i), ta), weights)));
+        _mm_storeu_ps(out.scales + i, _mm_add_ps(sa, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b.scales + i), sa), weights)));
+        __m128 q = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(qa), _mm_set1_ps(1.0f - w)), _mm_mul_ps(_mm_loadu_ps(qb), _mm_set1_ps(wb)));
+        if (normalize)
+        {
+            __m128 lengthSquared = _mm_mul_ps(q, q);
+            lengthSquared = _mm_add_ps(lengthSquared, _mm_shuffle_ps(lengthSquared, lengthSquared, _MM_SHUFFLE(2, 3, 0, 1)));
+            lengthSquared = _mm_add_ps(lengthSquared, _mm_shuffle_ps(lengthSquared, lengthSquared, _MM_SHUFFLE(1, 0, 3, 2)));
+            q = _mm_div_ps(q, _mm_sqrt_ps(lengthSquared));
+        }
+        _mm_storeu_ps(out.rotations + i, q);
+#elif defined(_MDL_POSE_BLENDING_NEON)
+        const float32x4_t ta = vld1q_f32(a.translations + i);
+        const float32x4_t sa = vld1q_f32(a.scales + i);
+        vst1q_f32(out.translations + i, vfmaq_n_f32(ta, vsubq_f32(vld1q_f32(b.translations + i), ta), w));
+        vst1q_f32(out.scales + i, vfmaq_n_f32(sa, vsubq_f32(vld1q_f32(b.scales + i), sa), w));
+        float32x4_t q = vfmaq_n_f32(vmulq_n_f32(vld1q_f32(qa), 1.0f - w), vld1q_f32(qb), wb);
+        if (normalize)
+        {
+            q = vdivq_f32(q, vdupq_n_f32(std::sqrt(vaddvq_f32(vmulq_f32(q, q)))));
+        }
+        vst1q_f32(out.rotations + i, q);
+#else
+        float q[4];
+        for (int c = 0; c < 4; ++c)
+        {
+            out.translations[i + c] = a.translations[i + c] + (b.translations[i + c] - a.translations[i + c]) * w;
+            out.scales[i + c] = a.scales[i + c] + (b.scales[i + c] - a.scales[i + c]) * w;
+            q[c] = qa[c] * (1.0f - w) + qb[c] * wb;
+        }
+        const float scale = normalize ? 1.0f / std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]) : 1.0f;
+        for (int c = 0; c < 4; ++c)
+        {
+            out.rotations[i + c] = q[c] * scale;
+        }
+#endif
+    }
+}
+
+_MDL_INLINE void MDL::Private::PoseBlending::add(ConstPose base, ConstPose layer, ConstPose reference, float weight, const float* mask,
+                                                 NS::UInteger jointCount, Pose out)
+{
+    for (NS::UInteger j = 0; j < jointCount; ++j)
+    {
+        const NS::UInteger i = j * 4;
+        const float        w = mask ? weight * mask[j] : weight;
+
+        // Rotation delta of the layer from its reference, scaled by nlerp
+        // from the identity, then applied after the base rotation. The
+        // conjugate only inverts unit quaternions.
+        float r[4], l[4], b[4];
+        normalize(reference.rotations + i, r);
+        normalize(layer.rotations + i, l);
+        normalize(base.rotations + i, b);
+        const float  inverse[4] = { -r[0], -r[1], -r[2], r[3] };
+        float        delta[4];
+        multiply(inverse, l, delta);
+        const float  sign = delta[3] < 0.0f ? -w : w;
+        float        partial[4] = { delta[0] * sign, delta[1] * sign, delta[2] * sign, delta[3] * sign + (1.0f - w) };
+        const float  length = std::sqrt(partial[0] * partial[0] + partial[1] * partial[1] + partial[2] * partial[2] + partial[3] * partial[3]);
+        for (int c = 0; c < 4; ++c)
+        {
+            partial[c] /= length;
+        }
+        multiply(b, partial, out.rotations + i);
+
+#if defined(_MDL_POSE_BLENDING_SSE)
+        const __m128 weights = _mm_set1_ps(w);
+        const __m128 referenceScale = _mm_loadu_ps(reference.scales + i);
+        const __m128 ratio = _mm_div_ps(_mm_loadu_ps(layer.scales + i),
+                                        _mm_or_ps(_mm_and_ps(_mm_cmpneq_ps(referenceScale, _mm_setzero_ps()), referenceScale),
+                                                  _mm_and_ps(_mm_cmpeq_ps(referenceScale, _mm_setzero_ps()), _mm_set1_ps(1.0f))));
+        const __m128 translation = _mm_sub_ps(_mm_loadu_ps(layer.translations + i), _mm_loadu_ps(reference.translations + i));
+        _mm_storeu_ps(out.translations + i, _mm_add_ps(_mm_loadu_ps(base.translations + i), _mm_mul_ps(translation, weights)));
+        _mm_storeu_ps(out.scales + i, _mm_mul_ps(_mm_loadu_ps(base.scales + i),
+                                                 _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_sub_ps(ratio, _mm_set1_ps(1.0f)), weights))));
+#elif defined(_MDL_POSE_BLENDING_NEON)
+        const float32x4_t referenceScale = vld1q_f32(reference.scales + i);
+        const float32x4_t safeScale = vbslq_f32(vceqq_f32(referenceScale, vdupq_n_f32(0.0f)), vdupq_n_f32(1.0f), referenceScale);
+        const float32x4_t ratio = vdivq_f32(vld1q_f32(layer.scales + i), safeScale);
+        const float32x4_t translation = vsubq_f32(vld1q_f32(layer.translations + i), vld1q_f32(reference.translations + i));
+        vst1q_f32(out.translations + i, vfmaq_n_f32(vld1q_f32(base.translations + i), translation, w));
+        vst1q_f32(out.scales + i, vmulq_f32(vld1q_f32(base.scales + i), vfmaq_n_f32(vdupq_n_f32(1.0f), vsubq_f32(ratio, vdupq_n_f32(1.0f)), w)));
+#else
+        for (int c = 0; c < 4; ++c)
+        {
+            const float referenceScale = reference.scales[i + c] != 0.0f ? reference.scales[i + c] : 1.0f;
+            out.translations[i + c] = base.translations[i + c] + (layer.translations[i + c] - reference.translations[i + c]) * w;
+            out.scales[i + c] = base.scales[i + c] * (1.0f + (layer.scales[i + c] / referenceScale - 1.0f) * w);
+        }
+#endif
+    }
+}
+
+_MDL_INLINE void MDL::Private::PoseBlending::normalizeRotations(float* rotations, NS::UInteger jointCount)
+{
+    for (NS::UInteger j = 0; j < jointCount; ++j)
+    {
+        float*      q = rotations + j * 4;
+        const float length = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        if (length > 0.0f)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                q[c] /= length;
+            }
+        }
+    }
+}
+
+// Hamilton product of (x, y, z, w) quaternions; `out` may alias `a` or `b`
+_MDL_INLINE void MDL::Private::PoseBlending::multiply(const float* a, const float* b, float* out)
+{
+    const float x = a[3] * b[0] + a[0] * b[3] + a[1] * b[2] - a[2] * b[1];
+    const float y = a[3] * b[1] - a[0] * b[2] + a[1] * b[3] + a[2] * b[0];
+    const float z = a[3] * b[2] + a[0] * b[1] - a[1] * b[0] + a[2] * b[3];
+    const float w = a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2];
+    out[0] = x;
+    out[1] = y;
+    out[2] = z;
+    out[3] = w;
+}
+
+_MDL_INLINE void MDL::Private::PoseBlending::normalize(const float* q, float* out)
+{
+    const float length = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    const float scale = length > 0.0f ? 1.0f / length : 1.0f;
+    for (int c = 0; c < 4; ++c)
+    {
+        out[c] = q[c] * scale;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,406 @@
+/*!
+ @header MDLRetargeting.hpp
+ @framework ModelIO
+ @abstract Joint maps and rest-pose corrections for moving animation between skeletons
+ @copyright Treata Norouzi on 10/19/26.
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include "MDLDefines.hpp"
+#include "MDLAlignedAllocator.hpp"
+#include "MDLJointHierarchy.hpp"
+#include "MDLSkinning.hpp"
+#include "Foundation/NSTypes.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define _MDL_RETARGETING_SSE 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define _MDL_RETARGETING_NEON 1
+#endif
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace MDL
+{
+_MDL_ENUM(NS::UInteger, RetargetTranslation) {
+    // Root joints carry the source motion, scaled to the target's proportions;
+    // the other joints keep the target's bone lengths
+    RetargetTranslationRoots = 0,
+    // Every joint carries the source motion, scaled per bone
+    RetargetTranslationAll = 1,
+    // Every joint keeps the target's rest translation
+    RetargetTranslationNone = 2,
+};
+
+// Renames source joints before matching: a source path equal to
+// `sourcePrefix`, or below it, is matched as if it started with
+// `targetPrefix` instead. "Armature/Hips" -> "Root/Pelvis" maps
+// "Armature/Hips/Spine" onto "Root/Pelvis/Spine".
+struct RetargetRule
+{
+    std::string                         sourcePrefix;
+    std::string                         targetPrefix;
+};
+
+struct RetargetSettings
+{
+    // Tried in order; the first rule that applies renames the path
+    std::vector<RetargetRule>           rules;
+    // Joints still unmatched pair up by their last path component, when it
+    // names a single source joint
+    bool                                matchJointNames = true;
+    RetargetTranslation                 translations = RetargetTranslationRoots;
+};
+
+namespace Private
+{
+    // Per target joint, how the local transform of its source joint turns
+    // into its own: the rotation is right-multiplied by the source rest
+    // inverse and the target rest, translations are scaled and offset from
+    // the source rest onto the target rest, and scales are rescaled.
+    class RetargetProgram
+    {
+    public:
+        NS::UInteger                    jointCount() const;
+        // Joints of the animation the program reads
+        NS::UInteger                    sourceCount() const;
+
+        // Local translations, rotations and scales of the animation joints,
+        // four floats apart, into those of the target joints
+        void                            apply(const float* translations, const float* rotations, const float* scales,
+                                              float* targetTranslations, float* targetRotations, float* targetScales) const;
+
+    private:
+        friend class RetargetMap;
+
+        // Animation joint per target joint, JointHierarchy::NoJoint for the
+        // target rest pose
+        std::vector<std::int32_t>       _sources;
+        NS::UInteger                    _sourceCount = 0;
+        // 4x4 column-major per joint: the rotation quaternion as a column
+        // vector, times this, is the corrected rotation
+        AlignedVector<float>            _rotations;
+        AlignedVector<float>            _translationScales;
+        AlignedVector<float>            _translationOffsets;
+        AlignedVector<float>            _scales;
+    };
+
+    // Target joints matched to source joints, with the rest transforms of
+    // both decomposed, compiled once per skeleton pair
+    class RetargetMap
+    {
+    public:
+        // Rest transforms are column-major 4x4, one per joint of each skeleton
+        static std::shared_ptr<RetargetMap> build(const JointHierarchy& source, const std::vector<std::string>& sourceJointPaths,
+                                                  const float* sourceRestTransforms,
+                                                  const JointHierarchy& target, const std::vector<std::string>& targetJointPaths,
+                                                  const float* targetRestTransforms,
+                                                  const RetargetSettings& settings);
+
+        NS::UInteger                    targetJointCount() const;
+        NS::UInteger                    matchedJointCount() const;
+        // Source joint of each target joint, JointHierarchy::NoJoint where
+        // the target keeps its rest pose
+        const std::int32_t*             sourceJoints() const;
+
+        // The per-frame program for an animation of the source skeleton;
+        // `sourceAnimation` maps source joints to the animation's joints
+        std::shared_ptr<RetargetProgram> compile(const JointMap& sourceAnimation) const;
+
+    private:
+        struct Rest
+        {
+            float                       translation[4];
+            float                       rotation[4];
+            float                       scale[4];
+        };
+
+        static void                     decompose(const float* matrix, Rest& rest);
+        static void                     rightMultiplication(const float* q, float* matrix);
+
+        std::vector<std::int32_t>       _sourceJoints;
+        std::vector<Rest>               _sourceRest;
+        std::vector<Rest>               _targetRest;
+        // Source to target bone length per target joint, 0 when its
+        // translation is not carried over
+        std::vector<float>              _translationRatios;
+        NS::UInteger                    _matchedJointCount = 0;
+    };
+
+} // Private
+} // MDL
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// MARK: - Private Sector
+
+_MDL_INLINE NS::UInteger MDL::Private::RetargetProgram::jointCount() const
+{
+    return _sources.size();
+}
+
+_MDL_INLINE NS::UInteger MDL::Private::RetargetProgram::sourceCount() const
+{
+    return _sourceCount;
+}
+
+_MDL_INLINE void MDL::Private::RetargetProgram::apply(const float* translations, const float* rotations, const float* scales,
+                                                      float* targetTranslations, float* targetRotations, float* targetScales) const
+{
+    alignas(16) static const float identity[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    alignas(16) static const float unit[4] = { 1.0f, 1.0f, 1.0f, 0.0f };
+
+    const NS::UInteger count = _sources.size();
+    for (NS::UInteger j = 0; j < count; ++j)
+    {
+        const std::int32_t source = _sources[j];
+        const NS::UInteger offset = NS::UInteger(source) * 4;
+        const float*       t = source == JointHierarchy::NoJoint ? identity : translations + offset;
+        const float*       q = source == JointHierarchy::NoJoint ? identity : rotations + offset;
+        const float*       s = source == JointHierarchy::NoJoint ? unit : scales + offset;
+        const float*       m = _rotations.data() + j * 16;
+        const float*       ts = _translationScales.data() + j * 4;
+        const float*       to = _translationOffsets.data() + j * 4;
+        const float*       sk = _scales.data() + j * 4;
+#if defined(_MDL_RETARGETING_SSE)
+        __m128 r = _mm_mul_ps(_mm_load_ps(m), _mm_set1_ps(q[0]));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(m + 4), _mm_set1_ps(q[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(m + 8), _mm_set1_ps(q[2])));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(m + 12), _mm_set1_ps(q[3])));
+        _mm_storeu_ps(targetRotations + j * 4, r);
+        _mm_storeu_ps(targetTranslations + j * 4, _mm_add_ps(_mm_mul_ps(_mm_load_ps(ts), _mm_loadu_ps(t)), _mm_load_ps(to)));
+        _mm_storeu_ps(targetScales + j * 4, _mm_mul_ps(_mm_load_ps(sk), _mm_loadu_ps(s)));
+#elif defined(_MDL_RETARGETING_NEON)
+        const float32x4_t qv = vld1q_f32(q);
+        float32x4_t r = vmulq_laneq_f32(vld1q_f32(m), qv, 0);
+        r = vfmaq_laneq_f32(r, vld1q_f32(m + 4), qv, 1);
+        r = vfmaq_laneq_f32(r, vld1q_f32(m + 8), qv, 2);
+        r = vfmaq_laneq_f32(r, vld1q_f32(m + 12), qv, 3);
+        vst1q_f32(targetRotations + j * 4, r);
+        vst1q_f32(targetTranslations + j * 4, vfmaq_f32(vld1q_f32(to), vld1q_f32(ts), vld1q_f32(t)));
+        vst1q_f32(targetScales + j * 4, vmulq_f32(vld1q_f32(sk), vld1q_f32(s)));
+#else
+        for (int c = 0; c < 4; ++c)
+        {
+            targetRotations[j * 4 + c] = m[c] * q[0] + m[4 + c] * q[1] + m[8 + c] * q[2] + m[12 + c] * q[3];
+            targetTranslations[j * 4 + c] = ts[c] * t[c] + to[c];
+            targetScales[j * 4 + c] = sk[c] * s[c];
+        }
+#endif
+    }
+}
+
+_MDL_INLINE std::shared_ptr<MDL::Private::RetargetMap> MDL::Private::RetargetMap::build(const JointHierarchy& source,
+                                                                                        const std::vector<std::string>& sourceJointPaths,
+                                                                                        const float* sourceRestTransforms,
+                                                                                        const JointHierarchy& target,
+                                                                                        const std::vector<std::string>& targetJointPaths,
+                                                                                        const float* targetRestTransforms,
+                                                                                        const RetargetSettings& settings)
+{
+    auto map = std::make_shared<RetargetMap>();
+    const NS::UInteger sourceCount = source.jointCount();
+    const NS::UInteger targetCount = target.jointCount();
+
+    // Source joints by their renamed paths, and by their names
+    auto leaf = [](const std::string& path) { return path.substr(path.rfind('/') + 1); };
+    std::unordered_map<std::string, std::int32_t> renamed;
+    std::unordered_map<std::string, std::int32_t> named;
+    for (NS::UInteger i = 0; i < sourceCount; ++i)
+    {
+        std::string path = sourceJointPaths[i];
+        for (const RetargetRule& rule : settings.rules)
+        {
+            const std::size_t length = rule.sourcePrefix.size();
+            if (path.compare(0, length, rule.sourcePrefix) == 0 && (path.size() == length || path[length] == '/'))
+            {
+                path = rule.targetPrefix + path.substr(length);
+                break;
+            }
+        }
+        renamed.emplace(path, std::int32_t(i));
+        auto name = named.emplace(leaf(sourceJointPaths[i]), std::int32_t(i));
+        if (!name.second)
+        {
+            name.first->second = JointHierarchy::NoJoint;
+        }
+    }
+
+    map->_sourceJoints.assign(targetCount, JointHierarchy::NoJoint);
+    for (NS::UInteger j = 0; j < targetCount; ++j)
+    {
+        auto match = renamed.find(targetJointPaths[j]);
+        if (match != renamed.end())
+        {
+            map->_sourceJoints[j] = match->second;
+        }
+        else if (settings.matchJointNames)
+        {
+            auto name = named.find(leaf(targetJointPaths[j]));
+            map->_sourceJoints[j] = name != named.end() ? name->second : JointHierarchy::NoJoint;
+        }
+        map->_matchedJointCount += map->_sourceJoints[j] != JointHierarchy::NoJoint;
+    }
+
+    map->_sourceRest.resize(sourceCount);
+    map->_targetRest.resize(targetCount);
+    for (NS::UInteger i = 0; i < sourceCount; ++i)
+    {
+        decompose(sourceRestTransforms + i * 16, map->_sourceRest[i]);
+    }
+    for (NS::UInteger j = 0; j < targetCount; ++j)
+    {
+        decompose(targetRestTransforms + j * 16, map->_targetRest[j]);
+    }
+
+    // Bone length ratios; roots move by the ratio over the whole skeleton
+    auto length = [](const Rest& rest)
+    {
+        const float* t = rest.translation;
+        return std::sqrt(t[0] * t[0] + t[1] * t[1] + t[2] * t[2]);
+    };
+    float sourceLength = 0.0f;
+    float targetLength = 0.0f;
+    map->_translationRatios.assign(targetCount, 0.0f);
+    for (NS::UInteger j = 0; j < targetCount; ++j)
+    {
+        const std::int32_t joint = map->_sourceJoints[j];
+        if (joint == JointHierarchy::NoJoint || target.parents()[j] == JointHierarchy::NoJoint)
+        {
+            continue;
+        }
+        const float s = length(map->_sourceRest[joint]);
+        const float t = length(map->_targetRest[j]);
+        sourceLength += s;
+        targetLength += t;
+        if (settings.translations == RetargetTranslationAll)
+        {
+            map->_translationRatios[j] = s > 1e-6f ? t / s : 1.0f;
+        }
+    }
+    const float rootRatio = sourceLength > 1e-6f ? targetLength / sourceLength : 1.0f;
+    for (NS::UInteger j = 0; j < targetCount; ++j)
+    {
+        if (target.parents()[j] == JointHierarchy::NoJoint && settings.translations != RetargetTranslationNone)
+        {
+            map->_translationRatios[j] = rootRatio;
+        }
+    }
+    return map;
+}
+
+_MDL_INLINE NS::UInteger MDL::Private::RetargetMap::targetJointCount() const
+{
+    return _sourceJoints.size();
+}
+
+_MDL_INLINE NS::UInteger MDL::Private::RetargetMap::matchedJointCount() const
+{
+    return _matchedJointCount;
+}
+
+_MDL_INLINE const std::int32_t* MDL::Private::RetargetMap::sourceJoints() const
+{
+    return _sourceJoints.data();
+}
+
+_MDL_INLINE std::shared_ptr<MDL::Private::RetargetProgram> MDL::Private::RetargetMap::compile(const JointMap& sourceAnimation) const
+{
+    auto program = std::make_shared<RetargetProgram>();
+    const NS::UInteger count = _sourceJoints.size();
+    program->_sources.assign(count, JointHierarchy::NoJoint);
+    program->_sourceCount = sourceAnimation.sourceCount;
+    program->_rotations.resize(count * 16);
+    program->_translationScales.assign(count * 4, 0.0f);
+    program->_translationOffsets.assign(count * 4, 0.0f);
+    program->_scales.assign(count * 4, 0.0f);
+
+    for (NS::UInteger j = 0; j < count; ++j)
+    {
+        const Rest&        target = _targetRest[j];
+        const std::int32_t joint = _sourceJoints[j];
+        const std::int32_t animated = joint == JointHierarchy::NoJoint ? JointHierarchy::NoJoint : sourceAnimation.sources[joint];
+        float*             translationScale = program->_translationScales.data() + j * 4;
+        float*             translationOffset = program->_translationOffsets.data() + j * 4;
+        float*             scale = program->_scales.data() + j * 4;
+
+        // Joints without motion hold the target rest pose, reached from the
+        // identity the program reads for them
+        if (animated == JointHierarchy::NoJoint)
+        {
+            rightMultiplication(target.rotation, program->_rotations.data() + j * 16);
+            for (int c = 0; c < 3; ++c)
+            {
+                translationOffset[c] = target.translation[c];
+                scale[c] = target.scale[c];
+            }
+            continue;
+        }
+
+        const Rest& source = _sourceRest[joint];
+        const float ratio = _translationRatios[j];
+        const float inverse[4] = { -source.rotation[0], -source.rotation[1], -source.rotation[2], source.rotation[3] };
+        float       correction[4];
+        const float* a = inverse;
+        const float* b = target.rotation;
+        correction[0] = a[3] * b[0] + a[0] * b[3] + a[1] * b[2] - a[2] * b[1];
+        correction[1] = a[3] * b[1] - a[0] * b[2] + a[1] * b[3] + a[2] * b[0];
+        correction[2] = a[3] * b[2] + a[0] * b[1] - a[1] * b[0] + a[2] * b[3];
+        correction[3] = a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2];
+
+        program->_sources[j] = animated;
+        rightMultiplication(correction, program->_rotations.data() + j * 16);
+        for (int c = 0; c < 3; ++c)
+        {
+            translationScale[c] = ratio;
+            translationOffset[c] = target.translation[c] - source.translation[c] * ratio;
+            scale[c] = source.scale[c] != 0.0f ? target.scale[c] / source.scale[c] : target.scale[c];
+        }
+    }
+    return program;
+}
+
+_MDL_INLINE void MDL::Private::RetargetMap::decompose(const float* matrix, Rest& rest)
+{
+    for (int c = 0; c < 3; ++c)
+    {
+        const float* column = matrix + c * 4;
+        rest.translation[c] = matrix[12 + c];
+        rest.scale[c] = std::sqrt(column[0] * column[0] + column[1] * column[1] + column[2] * column[2]);
+    }
+    rest.translation[3] = 0.0f;
+    rest.scale[3] = 0.0f;
+
+    float dualQuaternion[8];
+    Skinning::toDualQuaternion(matrix, dualQuaternion);
+    std::copy(dualQuaternion, dualQuaternion + 4, rest.rotation);
+}
+
+// Columns of the matrix that right-multiplies a quaternion (x, y, z, w) by `q`
+_MDL_INLINE void MDL::Private::RetargetMap::rightMultiplication(const float* q, float* matrix)
+{
+    const float x = q[0], y = q[1], z = q[2], w = q[3];
+    const float columns[16] =
+    {
+         w, -z,  y, -x,
+         z,  w, -x, -y,
+        -y,  x,  w, -z,
+         x,  y,  z,  w,
+    };
+    std::copy(columns, columns + 16, matrix);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
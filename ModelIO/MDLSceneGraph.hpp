@@ -0,0 +1,971 @@
+/*!
+ @header MDLSceneGraph.hpp
+ @framework ModelIO
+ @abstract Flat, natively stored mirror of the object hierarchy
+ @copyright Treata Norouzi on 10/19/26.
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include "MDLDefines.hpp"
+#include "MDLObjectLifetime.hpp"
+#include "Foundation/NSTypes.hpp"
+#include "MDLParallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace MDL
+{
+namespace Private
+{
+    // Hierarchy, names, hidden flags and local transforms of every object the
+    // bridge has seen, in structure-of-arrays tables indexed by dense node ids.
+    // Objects are imported from ModelIO on first use and kept in step by the
+    // bridge's mutators (addChild, setChildren, addObject, removeObject,
+    // setName, setHidden, transform setters); changes made behind the bridge's
+    // back need Object::invalidateSceneGraph(). Objects, containers and
+    // transform components are watched, so a node and its keys go away when
+    // what they stand for is deallocated. Mutations are serialised
+    // internally; queries must not overlap them, as with the ModelIO
+    // containers this mirrors.
+    //
+    // Every node below a root is also indexed by a hash of the interned names
+    // on its path, so resolving a path costs one hash per component plus one
+    // table probe, whatever the size of the tree. Renames and moves re-index
+    // the subtree they affect.
+    //
+    // Each node also records its class and a mask of the classes found below
+    // it, so that typed traversals skip subtrees holding nothing they want.
+    class SceneGraph
+    {
+    public:
+        using NodeId = std::uint32_t;
+        using NameId = std::uint32_t;
+        using ClassId = std::uint32_t;
+        using ClassMask = std::uint64_t;
+
+        static constexpr NodeId                     InvalidNode = std::numeric_limits<NodeId>::max();
+        static constexpr NameId                     EmptyName = 0;
+        static constexpr ClassId                    NoClass = std::numeric_limits<ClassId>::max();
+
+        enum Flags : std::uint8_t
+        {
+            FlagLive            = 1 << 0,
+            FlagHidden          = 1 << 1,
+            FlagTransform       = 1 << 2,
+            FlagResetsTransform = 1 << 3,
+            // The transform has more than one key time; localTransform holds
+            // its `matrix` and callers sample the component for other times
+            FlagAnimated        = 1 << 4,
+            // Stands for a container that is not an object (an asset): it is
+            // nobody's parent object and is not part of any path
+            FlagContainer       = 1 << 5,
+        };
+
+        struct alignas(16) Matrix
+        {
+            float                                   columns[16];
+        };
+
+        // Classes a typed traversal accepts, by class id. Built by the bridge,
+        // which knows how the classes inherit from one another.
+        struct ClassFilter
+        {
+            ClassMask                               mask = 0;
+            std::vector<bool>                       accepted;
+            // Every object, whatever its class
+            bool                                    any = false;
+        };
+
+        static SceneGraph&                          shared();
+
+        NodeId                                      find(const void* object) const;
+        NodeId                                      findContainer(const void* container) const;
+        NodeId                                      findTransform(const void* component) const;
+
+        // Node of `object`, created detached and unnamed if it has none yet
+        NodeId                                      insert(const void* object, std::uint8_t flags = 0);
+        // Forgets `node` and everything below it; their ids are reused
+        void                                        remove(NodeId node);
+
+        // Appends `node` to the children of `parent`, leaving its old parent.
+        // Ignored if `parent` lies below `node`.
+        void                                        attach(NodeId node, NodeId parent);
+        void                                        detach(NodeId node);
+
+        // The container whose objects are the children of `node`
+        void                                        setContainer(NodeId node, const void* container);
+        void                                        setName(NodeId node, std::string_view name);
+        void                                        setHidden(NodeId node, bool hidden);
+        // `objectClass` is the node's exact class
+        void                                        setClass(NodeId node, const void* objectClass);
+        // `columns` is a column-major 4x4 matrix; a null component clears the transform
+        void                                        setTransform(NodeId node, const void* component, const float* columns,
+                                                                 bool resetsTransform, bool animated);
+
+        void                                        clear();
+
+        // Node ids are below capacity(); free ids have no FlagLive
+        NS::UInteger                                capacity() const;
+        NS::UInteger                                nodeCount() const;
+        // Bumped by every change to the hierarchy or to names
+        std::uint64_t                               generation() const;
+        // Bumped by every change to a local transform
+        std::uint64_t                               transformGeneration() const;
+
+        const void*                                 object(NodeId node) const;
+        const void*                                 container(NodeId node) const;
+        const void*                                 transform(NodeId node) const;
+        NodeId                                      parent(NodeId node) const;
+        NodeId                                      firstChild(NodeId node) const;
+        NodeId                                      nextSibling(NodeId node) const;
+        NameId                                      name(NodeId node) const;
+        std::uint8_t                                flags(NodeId node) const;
+        const Matrix&                               localTransform(NodeId node) const;
+
+        ClassId                                     classId(NodeId node) const;
+        // Classes met so far, by id
+        NS::UInteger                                classCount() const;
+        const void*                                 classAt(ClassId id) const;
+        // Bit standing for `id` in the subtree masks; ids past 62 share the top bit
+        static ClassMask                            classBit(ClassId id);
+
+        std::string_view                            nameString(NameId name) const;
+        // EmptyName for "" and for names never interned
+        NameId                                      findName(std::string_view name) const;
+
+        // Node at `path` ("/a/b/c", or "a/b/c") below `scope`, or InvalidNode.
+        // Of siblings sharing a name, the first attached wins.
+        NodeId                                      findPath(NodeId scope, std::string_view path) const;
+
+        template <typename _Fn>
+        void                                        forEachChild(NodeId node, _Fn&& fn) const;
+
+        // Pre-order ids of `root` and everything below it
+        void                                        subtree(NodeId root, std::vector<NodeId>& nodes) const;
+
+        // Calls `fn(NodeId)` in pre-order for `root` and every object node
+        // below it that `filter` accepts, until `fn` returns false. Returns
+        // false if stopped early.
+        template <typename _Fn>
+        bool                                        traverse(NodeId root, const ClassFilter& filter, _Fn&& fn) const;
+
+        // Same, with the tree split into subtrees that the worker pool hands
+        // out as workers free up. `fn` must be thread-safe; nodes arrive in no
+        // particular order, and stopping is seen by the other workers at their
+        // next node.
+        template <typename _Fn>
+        void                                        traverseParallel(NodeId root, const ClassFilter& filter, _Fn&& fn) const;
+
+    private:
+        SceneGraph();
+
+        NameId                                      intern(std::string_view name);
+        void                                        unlink(NodeId node);
+
+        static void                                 evictObject(const void* object);
+        static void                                 evictContainer(const void* container);
+        static void                                 evictTransform(const void* component);
+
+        static std::uint64_t                        rootKey(const void* object);
+        static std::uint64_t                        pathKey(std::uint64_t parentKey, NameId name);
+        void                                        unindex(NodeId node);
+        // Recomputes the path keys of `root` and everything below it
+        void                                        reindex(NodeId root);
+        // Adds `mask` to `node` and its ancestors. Masks only grow: detaching
+        // leaves a superset behind, which costs a wasted visit, not a miss.
+        void                                        spreadClasses(NodeId node, ClassMask mask);
+        bool                                        accepts(const ClassFilter& filter, NodeId node) const;
+        bool                                        reaches(const ClassFilter& filter, NodeId node) const;
+
+        mutable std::mutex                          _mutex;
+
+        // Per-node columns
+        std::vector<const void*>                    _objects;
+        std::vector<const void*>                    _containers;
+        std::vector<const void*>                    _transforms;
+        std::vector<NodeId>                         _parents;
+        std::vector<NodeId>                         _firstChildren;
+        std::vector<NodeId>                         _lastChildren;
+        std::vector<NodeId>                         _nextSiblings;
+        std::vector<NodeId>                         _previousSiblings;
+        std::vector<NameId>                         _names;
+        std::vector<std::uint8_t>                   _flags;
+        std::vector<Matrix>                         _localTransforms;
+        std::vector<std::uint64_t>                  _pathKeys;
+        std::vector<ClassId>                        _nodeClasses;
+        std::vector<ClassMask>                      _subtreeClasses;
+
+        std::vector<NodeId>                         _freeNodes;
+        std::unordered_map<const void*, NodeId>     _objectNodes;
+        std::unordered_map<const void*, NodeId>     _containerNodes;
+        std::unordered_map<const void*, NodeId>     _transformNodes;
+        // Path key to the nodes carrying it, in attach order
+        std::unordered_map<std::uint64_t, std::vector<NodeId>>  _pathIndex;
+
+        // Deque storage keeps the views used as keys stable
+        std::deque<std::string>                                 _nameStrings;
+        std::unordered_map<std::string_view, NameId>            _nameIds;
+
+        std::vector<const void*>                    _classes;
+        std::unordered_map<const void*, ClassId>    _classIndex;
+
+        std::uint64_t                               _generation = 0;
+        std::uint64_t                               _transformGeneration = 0;
+    };
+
+} // Private
+} // MDL
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// MARK: - Private Sector
+
+_MDL_INLINE MDL::Private::SceneGraph& MDL::Private::SceneGraph::shared()
+{
+    static SceneGraph graph;
+    return graph;
+}
+
+_MDL_INLINE MDL::Private::SceneGraph::SceneGraph()
+{
+    _nameStrings.emplace_back();
+    _nameIds.emplace(std::string_view(_nameStrings.front()), EmptyName);
+}
+
+_MDL_INLINE MDL::Private::SceneGraph::NodeId MDL::Private::SceneGraph::find(const void* object) const
+{
+    auto it = _objectNodes.find(object);
+    return it == _objectNodes.end() ? InvalidNode : it->second;
+}
+
+_MDL_INLINE MDL::Private::SceneGraph::NodeId MDL::Private::SceneGraph::findContainer(const void* container) const
+{
+    auto it = _containerNodes.find(container);
+    return it == _containerNodes.end() ? InvalidNode : it->second;
+}
+
+_MDL_INLINE MDL::Private::SceneGraph::NodeId MDL::Private::SceneGraph::findTransform(const void* component) const
+{
+    auto it = _transformNodes.find(component);
+    return it == _transformNodes.end() ? InvalidNode : it->second;
+}
+
+_MDL_INLINE MDL::Private::SceneGraph::NodeId MDL::Private::SceneGraph::insert(const void* object, std::uint8_t flags)
+{
+    ObjectLifetime::watch(object, &_objectNodes, &SceneGraph::evictObject);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _objectNodes.find(object);
+    if (it != _objectNodes.end())
+    {
+        return it->second;
+    }
+
+    NodeId node;
+    if (!_freeNodes.empty())
+    {
+        node = _freeNodes.back();
+        _freeNodes.pop_back();
+    }
+    else
+    {
+        node = NodeId(_objects.size());
+        _objects.push_back(nullptr);
+        _containers.push_back(nullptr);
+        _transforms.push_back(nullptr);
+        _parents.push_back(InvalidNode);
+        _firstChildren.push_back(InvalidNode);
+        _lastChildren.push_back(InvalidNode);
+        _nextSiblings.push_back(InvalidNode);
+        _previousSiblings.push_back(InvalidNode);
+        _names.push_back(EmptyName);
+        _flags.push_back(0);
+        _localTransforms.emplace_back();
+        _pathKeys.push_back(0);
+        _nodeClasses.push_back(NoClass);
+        _subtreeClasses.push_back(0);
+    }
+
+    _objects[node] = object;
+    _containers[node] = nullptr;
+    _transforms[node] = nullptr;
+    _parents[node] = _firstChildren[node] = _lastChildren[node] = InvalidNode;
+    _nextSiblings[node] = _previousSiblings[node] = InvalidNode;
+    _names[node] = EmptyName;
+    _flags[node] = FlagLive | flags;
+    _localTransforms[node] = Matrix { { 1, 0, 0, 0,  0, 1, 0, 0,  0, 0, 1, 0,  0, 0, 0, 1 } };
+    _pathKeys[node] = rootKey(object);
+    _nodeClasses[node] = NoClass;
+    _subtreeClasses[node] = 0;
+
+    _objectNodes.emplace(object, node);
+    ++_generation;
+    return node;
+}
+
+_MDL_INLINE void MDL::Private::SceneGraph::remove(NodeId node)
+{
+    if (node >= _objects.size() || !(_flags[node] & FlagLive))
+    {
+        return;
+    }
+
+    std::vector<NodeId> nodes;
+    subtree(node, nodes);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (NodeId n : nodes)
+    {
+        unindex(n);
+    }
+    unlink(node);
+    for (NodeId n : nodes)
+    {
+        _objectNodes.erase(_objects[n]);
+        if (_containers[n])
+        {
+            _containerNodes.erase(_containers[n]);
+        }
+        if (_transforms[n])
+        {
+            _transformNodes.erase(_transforms[n]);
+        }
+
+        _objects[n] = _containers[n] = _transforms[n] = nullptr;
+        _parents[n] = _firstChildren[n] = _lastChildren[n] = InvalidNode;
+        _nextSiblings[n] = _previousSiblings[n] = InvalidNode;
+        _flags[n] = 0;
+        _freeNodes.push_back(n);
+    }
+    ++_generation;
+}
+
+_MDL_INLINE void MDL::Private::SceneGraph::attach(NodeId node, NodeId parent)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (node >= _objects.size() || parent >= _objects.size() || _parents[node] == parent)
+    {
+        return;
+    }
+    for (NodeId ancestor = parent; ancestor != InvalidNode; ancestor = _parents[ancestor])
+    {
+        if (ancestor == node)
+        {
+            return;
+        }
+    }
+
+    unlink(node);
+    _parents[node] = parent;
+    _previousSiblings[node] = _lastChildren[parent];
+    if (_lastChildren[parent] != InvalidNode)
+    {
+        _nextSiblings[_lastChildren[parent]] = node;
+    }
+    else
+    {
+        _firstChildren[parent] = node;
+    }
+    _lastChildren[parent] = node;
+    reindex(node);
+    spreadClasses(parent, _subtreeClasses[node]);
+    ++_generation;
+}
+
+_MDL_INLINE void MDL::Private::SceneGraph::detach(NodeId node)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (node < _objects.size() && _parents[node] != InvalidNode)
+    {
+        unlink(node);
+        reindex(node);
+        ++_generation;
+    }
+}
+
+_MDL_INLINE void MDL::Private::SceneGraph::unlink(NodeId node)
+{
+    const NodeId parent = _parents[node];
+    if (parent == InvalidNode)
+    {
+        return;
+    }
+    unindex(node);
+
+    const NodeId previous = _previousSiblings[node];
+    const NodeId next = _nextSiblings[node];
+    (previous != InvalidNode ? _nextSiblings[previous] : _firstChildren[parent]) = next;
+    (next != InvalidNode ? _previousSiblings[next] : _lastChildren[parent]) = previous;
+
+    _parents[node] = _nextSiblings[node] = _previousSiblings[node] = InvalidNode;
+}
+
+_MDL_INLINE void MDL::Private::SceneGraph::setContainer(NodeId node, const void* container)
+{
+    ObjectLifetime::watch(container, &_containerNodes, &SceneGraph::evictContainer);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (node >= _objects.size())
+    {
+        return;
+    }
+    if (_containers[node])
+    {
+        _containerNodes.erase(_containers[node]);
+    }
+    _containers[node] = container;
+    if (container)
+    {
+        _containerNodes[container] = node;
+    }
+}
+
+_MDL_INLINE void MDL::Private::SceneGraph::setName(NodeId node, std::string_view name)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (node < _objects.size())
+    {
+        const NameId id = intern(name);
+        if (id != _names[node])
+        {
+            _names[node] = id;
+            // Paths start below a root, so a root's own name keys nothing
+            if (_parents[node] != InvalidNode)
+            {
+                reindex(node);
+            }
+            ++_generation;
+        }
+    }
+}
+
+_MDL_INLINE void MDL::Private::SceneGraph::setHidden(NodeId node, bool hidden)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (node < _objects.size())
+    {
+        _flags[node] = hidden ? (_flags[node] | FlagHidden) : (_flags[node] & ~FlagHidden);
+    }
+}
+
+_MDL_INLINE void MDL::Private::SceneGraph::setClass(NodeId node, const void* objectClass)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (node >= _objects.size() || !objectClass)
+    {
+        return;
+    }
+
+    auto it = _classIndex.find(objectClass);
+    if (it == _classIndex.end())
+    {
+        it = _classIndex.emplace(objectClass, ClassId(_classes.size())).first;
+        _classes.push_back(objectClass);
+    }
+    _nodeClasses[node] = it->second;
+    spreadClasses(node, classBit(it->second));
+}
+
+_MDL_INLINE void MDL::Private::SceneGraph::spreadClasses(NodeId node, ClassMask mask)
+{
+    // Parents hold a superset of their children, so the first ancestor that
+    // already has every bit ends the walk
+    for (; node != InvalidNode && (_subtreeClasses[node] & mask) != mask; node = _parents[node])
+    {
+        _subtreeClasses[node] |= mask;
+    }
+}
+
+_MDL_INLINE void MDL::Private::SceneGraph::setTransform(NodeId node, const void* component, const float* columns,
+                                                        bool resetsTransform, bool animated)
+{
+    ObjectLifetime::watch(component, &_transformNodes, &SceneGraph::evictTransform);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (node >= _objects.size())
+    {
+        return;
+    }
+    if (_transforms[node] && _transforms[node] != component)
+    {
+        _transformNodes.erase(_transforms[node]);
+    }
+
+    _transforms[node] = component;
+    std::uint8_t flags = _flags[node] & ~(FlagTransform | FlagResetsTransform | FlagAnimated);
+    if (component)
+    {
+        _transformNodes[component] = node;
+        std::memcpy(_localTransforms[node].columns, columns, sizeof(Matrix::columns));
+        flags |= FlagTransform | (resetsTransform ? FlagResetsTransform : 0) | (animated ? FlagAnimated : 0);
+    }
+    else
+    {
+        _localTransforms[node] = Matrix { { 1, 0, 0, 0,  0, 1, 0, 0,  0, 0, 1, 0,  0, 0, 0, 1 } };
+    }
+    _flags[node] = flags;
+    ++_transformGeneration;
+}
+
+_MDL_INLINE void MDL::Private::SceneGraph::evictObject(const void* object)
+{
+    // Objects below it may outlive it; they are imported again on next use
+    SceneGraph& graph = shared();
+    graph.remove(graph.find(object));
+}
+
+_MDL_INLINE void MDL::Private::SceneGraph::evictContainer(const void* container)
+{
+    SceneGraph&  graph = shared();
+    const NodeId node = graph.findContainer(container);
+    if (node != InvalidNode)
+    {
+        graph.setContainer(node, nullptr);
+    }
+}
+
+_MDL_INLINE void MDL::Private::SceneGraph::evictTransform(const void* component)
+{
+    SceneGraph&  graph = shared();
+    const NodeId node = graph.findTransform(component);
+    if (node != InvalidNode)
+    {
+        graph.setTransform(node, nullptr, nullptr, false, false);
+    }
+}
+
+_MDL_INLINE void MDL::Private::SceneGraph::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (std::vector<const void*>* column : { &_objects, &_containers, &_transforms })
+    {
+        column->clear();
+    }
+    for (std::vector<NodeId>* column : { &_parents, &_firstChildren, &_lastChildren, &_nextSiblings, &_previousSiblings, &_freeNodes })
+    {
+        column->clear();
+    }
+    _names.clear();
+    _flags.clear();
+    _localTransforms.clear();
+    _pathKeys.clear();
+    _pathIndex.clear();
+    _nodeClasses.clear();
+    _subtreeClasses.clear();
+    _objectNodes.clear();
+    _containerNodes.clear();
+    _transformNodes.clear();
+    ++_generation;
+}
+
+_MDL_INLINE MDL::Private::SceneGraph::NameId MDL::Private::SceneGraph::intern(std::string_view name)
+{
+    auto it = _nameIds.find(name);
+    if (it != _nameIds.end())
+    {
+        return it->second;
+    }
+
+    const NameId id = NameId(_nameStrings.size());
+    _nameStrings.emplace_back(name);
+    _nameIds.emplace(std::string_view(_nameStrings.back()), id);
+    return id;
+}
+
+_MDL_INLINE std::uint64_t MDL::Private::SceneGraph::rootKey(const void* object)
+{
+    std::uint64_t key = std::uint64_t(reinterpret_cast<std::uintptr_t>(object));
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ull;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EBull;
+    return key ^ (key >> 31);
+}
+
+_MDL_INLINE std::uint64_t MDL::Private::SceneGraph::pathKey(std::uint64_t parentKey, NameId name)
+{
+    std::uint64_t key = parentKey ^ ((std::uint64_t(name) + 1) * 0x9E3779B97F4A7C15ull);
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ull;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EBull;
+    return key ^ (key >> 31);
+}
+
+_MDL_INLINE void MDL::Private::SceneGraph::unindex(NodeId node)
+{
+    if (_parents[node] == InvalidNode)
+    {
+        return;
+    }
+
+    auto it = _pathIndex.find(_pathKeys[node]);
+    if (it == _pathIndex.end())
+    {
+        return;
+    }
+    std::vector<NodeId>& nodes = it->second;
+    nodes.erase(std::remove(nodes.begin(), nodes.end(), node), nodes.end());
+    if (nodes.empty())
+    {
+        _pathIndex.erase(it);
+    }
+}
+
+_MDL_INLINE void MDL::Private::SceneGraph::reindex(NodeId root)
+{
+    std::vector<NodeId> nodes;
+    subtree(root, nodes);
+
+    // Removing an absent node is harmless, so a root that is already out of
+    // the index (see unlink) needs no special case
+    for (NodeId node : nodes)
+    {
+        unindex(node);
+    }
+
+    // Pre-order puts parents first, so their keys are fresh when read
+    for (NodeId node : nodes)
+    {
+        const NodeId parent = _parents[node];
+        if (parent == InvalidNode)
+        {
+            _pathKeys[node] = rootKey(_objects[node]);
+            continue;
+        }
+        _pathKeys[node] = pathKey(_pathKeys[parent], _names[node]);
+        _pathIndex[_pathKeys[node]].push_back(node);
+    }
+}
+
+_MDL_INLINE MDL::Private::SceneGraph::NodeId MDL::Private::SceneGraph::findPath(NodeId scope, std::string_view path) const
+{
+    if (scope >= _objects.size() || !(_flags[scope] & FlagLive))
+    {
+        return InvalidNode;
+    }
+
+    std::uint64_t key = _pathKeys[scope];
+    bool          empty = true;
+    for (std::size_t begin = 0; begin < path.size();)
+    {
+        std::size_t end = path.find('/', begin);
+        end = (end == std::string_view::npos) ? path.size() : end;
+        if (end > begin)
+        {
+            const NameId name = findName(path.substr(begin, end - begin));
+            if (name == EmptyName)
+            {
+                return InvalidNode;
+            }
+            key = pathKey(key, name);
+            empty = false;
+        }
+        begin = end + 1;
+    }
+    if (empty)
+    {
+        return InvalidNode;
+    }
+
+    auto it = _pathIndex.find(key);
+    if (it == _pathIndex.end())
+    {
+        return InvalidNode;
+    }
+
+    // Keys can collide; confirm the names walking up, reading the path backwards
+    for (NodeId candidate : it->second)
+    {
+        NodeId      node = candidate;
+        std::size_t end = path.size();
+        bool        matches = true;
+        while (matches)
+        {
+            while (end > 0 && path[end - 1] == '/')
+            {
+                --end;
+            }
+            if (end == 0)
+            {
+                matches = (node == scope);
+                break;
+            }
+
+            const std::size_t slash = path.rfind('/', end - 1);
+            const std::size_t begin = (slash == std::string_view::npos) ? 0 : slash + 1;
+            matches = node != InvalidNode && nameString(_names[node]) == path.substr(begin, end - begin);
+            node = (node != InvalidNode) ? _parents[node] : InvalidNode;
+            end = begin;
+        }
+        if (matches)
+        {
+            return candidate;
+        }
+    }
+    return InvalidNode;
+}
+
+_MDL_INLINE NS::UInteger MDL::Private::SceneGraph::capacity() const
+{
+    return _objects.size();
+}
+
+_MDL_INLINE NS::UInteger MDL::Private::SceneGraph::nodeCount() const
+{
+    return _objects.size() - _freeNodes.size();
+}
+
+_MDL_INLINE std::uint64_t MDL::Private::SceneGraph::generation() const
+{
+    return _generation;
+}
+
+_MDL_INLINE std::uint64_t MDL::Private::SceneGraph::transformGeneration() const
+{
+    return _transformGeneration;
+}
+
+_MDL_INLINE const void* MDL::Private::SceneGraph::object(NodeId node) const
+{
+    return _objects[node];
+}
+
+_MDL_INLINE const void* MDL::Private::SceneGraph::container(NodeId node) const
+{
+    return _containers[node];
+}
+
+_MDL_INLINE const void* MDL::Private::SceneGraph::transform(NodeId node) const
+{
+    return _transforms[node];
+}
+
+_MDL_INLINE MDL::Private::SceneGraph::NodeId MDL::Private::SceneGraph::parent(NodeId node) const
+{
+    return _parents[node];
+}
+
+_MDL_INLINE MDL::Private::SceneGraph::NodeId MDL::Private::SceneGraph::firstChild(NodeId node) const
+{
+    return _firstChildren[node];
+}
+
+_MDL_INLINE MDL::Private::SceneGraph::NodeId MDL::Private::SceneGraph::nextSibling(NodeId node) const
+{
+    return _nextSiblings[node];
+}
+
+_MDL_INLINE MDL::Private::SceneGraph::NameId MDL::Private::SceneGraph::name(NodeId node) const
+{
+    return _names[node];
+}
+
+_MDL_INLINE std::uint8_t MDL::Private::SceneGraph::flags(NodeId node) const
+{
+    return _flags[node];
+}
+
+_MDL_INLINE const MDL::Private::SceneGraph::Matrix& MDL::Private::SceneGraph::localTransform(NodeId node) const
+{
+    return _localTransforms[node];
+}
+
+_MDL_INLINE MDL::Private::SceneGraph::ClassId MDL::Private::SceneGraph::classId(NodeId node) const
+{
+    return _nodeClasses[node];
+}
+
+_MDL_INLINE NS::UInteger MDL::Private::SceneGraph::classCount() const
+{
+    return _classes.size();
+}
+
+_MDL_INLINE const void* MDL::Private::SceneGraph::classAt(ClassId id) const
+{
+    return _classes[id];
+}
+
+_MDL_INLINE MDL::Private::SceneGraph::ClassMask MDL::Private::SceneGraph::classBit(ClassId id)
+{
+    return ClassMask(1) << std::min<ClassId>(id, 63);
+}
+
+_MDL_INLINE std::string_view MDL::Private::SceneGraph::nameString(NameId name) const
+{
+    return _nameStrings[name];
+}
+
+_MDL_INLINE MDL::Private::SceneGraph::NameId MDL::Private::SceneGraph::findName(std::string_view name) const
+{
+    auto it = _nameIds.find(name);
+    return it == _nameIds.end() ? EmptyName : it->second;
+}
+
+template <typename _Fn>
+_MDL_INLINE void MDL::Private::SceneGraph::forEachChild(NodeId node, _Fn&& fn) const
+{
+    for (NodeId child = _firstChildren[node]; child != InvalidNode; child = _nextSiblings[child])
+    {
+        fn(child);
+    }
+}
+
+_MDL_INLINE void MDL::Private::SceneGraph::subtree(NodeId root, std::vector<NodeId>& nodes) const
+{
+    if (root >= _objects.size() || !(_flags[root] & FlagLive))
+    {
+        return;
+    }
+
+    // Sibling links make pre-order iterative without a stack: go down first,
+    // then right, then back up until there is a right
+    NodeId node = root;
+    while (node != InvalidNode)
+    {
+        nodes.push_back(node);
+        if (_firstChildren[node] != InvalidNode)
+        {
+            node = _firstChildren[node];
+            continue;
+        }
+        while (node != root && _nextSiblings[node] == InvalidNode)
+        {
+            node = _parents[node];
+        }
+        node = (node == root) ? InvalidNode : _nextSiblings[node];
+    }
+}
+
+_MDL_INLINE bool MDL::Private::SceneGraph::accepts(const ClassFilter& filter, NodeId node) const
+{
+    if (_flags[node] & FlagContainer)
+    {
+        return false;
+    }
+    const ClassId id = _nodeClasses[node];
+    return filter.any || (id < filter.accepted.size() && filter.accepted[id]);
+}
+
+_MDL_INLINE bool MDL::Private::SceneGraph::reaches(const ClassFilter& filter, NodeId node) const
+{
+    return filter.any || (_subtreeClasses[node] & filter.mask);
+}
+
+template <typename _Fn>
+_MDL_INLINE bool MDL::Private::SceneGraph::traverse(NodeId root, const ClassFilter& filter, _Fn&& fn) const
+{
+    if (root >= _objects.size() || !(_flags[root] & FlagLive))
+    {
+        return true;
+    }
+
+    NodeId node = root;
+    while (node != InvalidNode)
+    {
+        if (reaches(filter, node))
+        {
+            if (accepts(filter, node) && !fn(node))
+            {
+                return false;
+            }
+            if (_firstChildren[node] != InvalidNode)
+            {
+                node = _firstChildren[node];
+                continue;
+            }
+        }
+        while (node != root && _nextSiblings[node] == InvalidNode)
+        {
+            node = _parents[node];
+        }
+        node = (node == root) ? InvalidNode : _nextSiblings[node];
+    }
+    return true;
+}
+
+template <typename _Fn>
+_MDL_INLINE void MDL::Private::SceneGraph::traverseParallel(NodeId root, const ClassFilter& filter, _Fn&& fn) const
+{
+    if (root >= _objects.size() || !(_flags[root] & FlagLive) || !reaches(filter, root))
+    {
+        return;
+    }
+
+    // Open the tree breadth-first, visiting the nodes opened on the way,
+    // until there are a few untouched subtrees per worker
+    const NS::UInteger  target = 8 * ThreadPool::shared().threadCount();
+    std::vector<NodeId> frontier = { root }, next;
+    bool                opened = true;
+    while (opened && frontier.size() < target)
+    {
+        opened = false;
+        next.clear();
+        for (NodeId node : frontier)
+        {
+            if (_firstChildren[node] == InvalidNode)
+            {
+                next.push_back(node);
+                continue;
+            }
+
+            if (accepts(filter, node) && !fn(node))
+            {
+                return;
+            }
+            for (NodeId child = _firstChildren[node]; child != InvalidNode; child = _nextSiblings[child])
+            {
+                if (reaches(filter, child))
+                {
+                    next.push_back(child);
+                }
+            }
+            opened = true;
+        }
+        frontier.swap(next);
+    }
+
+    std::atomic<bool> stopped(false);
+    parallelFor(frontier.size(), 1, [&](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger i = begin; i < end && !stopped.load(std::memory_order_relaxed); ++i)
+        {
+            traverse(frontier[i], filter, [&](NodeId node)
+            {
+                if (stopped.load(std::memory_order_relaxed))
+                {
+                    return false;
+                }
+                if (!fn(node))
+                {
+                    stopped.store(true, std::memory_order_relaxed);
+                    return false;
+                }
+                return true;
+            });
+        }
+    });
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,632 @@
+/*!
+ @header MDLSkinning.hpp
+ @framework ModelIO
+ @abstract Joint palettes and linear-blend and dual-quaternion vertex skinning
+ @copyright Treata Norouzi on 10/19/26.
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include "MDLDefines.hpp"
+#include "MDLAlignedAllocator.hpp"
+#include "MDLParallel.hpp"
+#include "MDLJointHierarchy.hpp"
+#include "MDLObjectLifetime.hpp"
+#include "MDLTransformProgram.hpp"
+#include "Foundation/NSTypes.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// The vertex kernels are picked when the including file is compiled, like the
+// other SIMD paths of the bridge: the AVX2 one needs -mavx2 -mfma (or
+// -march=haswell and later), otherwise x86-64 builds use SSE2 and Apple
+// silicon builds use NEON. Only enable AVX2 for binaries that never run on
+// processors without it.
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define _MDL_SKINNING_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define _MDL_SKINNING_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define _MDL_SKINNING_NEON 1
+#endif
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace MDL
+{
+_MDL_ENUM(NS::UInteger, SkinningMode) {
+    // Weighted sum of joint matrices; handles scale, but thins joints that
+    // twist or bend sharply
+    SkinningModeLinearBlend = 0,
+    // Weighted sum of joint dual quaternions; keeps volume, but ignores any
+    // scale in the joint transforms
+    SkinningModeDualQuaternion = 1,
+};
+
+// Where skinned vertices are written in the target buffer, as three floats
+// each; normals are skipped when `normalOffset` is NotWritten
+struct SkinningLayout
+{
+    static constexpr NS::UInteger       NotWritten = ~NS::UInteger(0);
+
+    NS::UInteger                        positionOffset = 0;
+    NS::UInteger                        positionStride = 3 * sizeof(float);
+    NS::UInteger                        normalOffset = NotWritten;
+    NS::UInteger                        normalStride = 3 * sizeof(float);
+};
+
+namespace Private
+{
+    // Vertex kernels over a palette of joint transforms. Every vertex has four
+    // joint indices and weights; indices past the palette use its last entry.
+    class Skinning
+    {
+    public:
+        struct Input
+        {
+            const float*                positions;
+            NS::UInteger                positionStride;
+            // Optional
+            const float*                normals;
+            NS::UInteger                normalStride;
+            const std::uint16_t*        joints;
+            NS::UInteger                jointStride;
+            const float*                weights;
+            NS::UInteger                weightStride;
+            NS::UInteger                vertexCount;
+        };
+
+        struct Output
+        {
+            float*                      positions;
+            NS::UInteger                positionStride;
+            // Written when both this and Input::normals are set
+            float*                      normals;
+            NS::UInteger                normalStride;
+        };
+
+        // Vertices handed to one worker at a time
+        static constexpr NS::UInteger   ChunkSize = 2048;
+
+        // `palette` holds 16 floats per joint, column-major 4x4 matrices
+        static void                     linearBlend(const Input& input, const float* palette, NS::UInteger jointCount,
+                                                    const Output& output);
+        // `dualQuaternions` holds 8 floats per joint, the real part then the
+        // dual part, x, y, z, w each; `geometryBind` (column-major 4x4, or
+        // nullptr for the identity) is applied to the vertices first
+        static void                     dualQuaternion(const Input& input, const float* dualQuaternions, NS::UInteger jointCount,
+                                                       const float* geometryBind, const Output& output);
+
+        // Rigid part of a column-major 4x4 matrix as a unit dual quaternion
+        static void                     toDualQuaternion(const float* matrix, float* out);
+
+    private:
+        static void                     linearBlendVertex(const Input& input, const float* palette, NS::UInteger lastJoint,
+                                                          NS::UInteger vertex, const Output& output);
+        static void                     dualQuaternionVertex(const Input& input, const float* dualQuaternions,
+                                                             NS::UInteger lastJoint, const float* geometryBind,
+                                                             NS::UInteger vertex, const Output& output);
+    };
+
+    // Joint hierarchy of a skeleton, matched against the joints of an
+    // animation and the joint indices of a mesh, compiled once per binding
+    class SkinningRig
+    {
+    public:
+        // Matrices are column-major 4x4, one per skeleton joint. An empty
+        // `meshJointPaths` binds mesh joint index i to skeleton joint i.
+        static std::shared_ptr<SkinningRig> build(std::shared_ptr<const JointHierarchy> hierarchy,
+                                                  const float* restTransforms,
+                                                  const float* bindTransforms,
+                                                  const std::vector<std::string>& animationJointPaths,
+                                                  const std::vector<std::string>& meshJointPaths,
+                                                  const double* geometryBindTransform);
+
+        NS::UInteger                    jointCount() const;
+        NS::UInteger                    animationJointCount() const;
+        // Entries of the palette, one per mesh joint index
+        NS::UInteger                    paletteCount() const;
+        // nullptr when it is the identity
+        const float*                    geometryBindTransform() const;
+
+        // Model-space transforms of every skeleton joint, 16 floats each,
+        // from the animation's translations, rotations and scales (four
+        // floats apart); joints the animation lacks keep their rest pose.
+        void                            pose(const float* translations, const float* rotations, const float* scales,
+                                             float* world) const;
+        // Skin matrices per mesh joint: world * inverse bind, followed by
+        // the geometry bind transform when `withGeometryBind` is set
+        void                            palette(const float* world, bool withGeometryBind, float* out) const;
+
+    private:
+        std::shared_ptr<const JointHierarchy> _hierarchy;
+        JointMap                        _animationJoints;
+        std::vector<std::uint32_t>      _meshJoints;
+        AlignedVector<float>            _restTransforms;
+        AlignedVector<float>            _inverseBindTransforms;
+        float                           _geometryBind[16];
+        bool                            _hasGeometryBind = false;
+    };
+
+    // Rigs by animation bind component, until the component is next edited
+    // through the bridge or deallocated
+    class SkinningRigCache
+    {
+    public:
+        static SkinningRigCache&                    shared();
+
+        std::shared_ptr<const SkinningRig>          find(const void* component);
+        void                                        store(const void* component, std::shared_ptr<const SkinningRig> rig);
+        void                                        remove(const void* component);
+        void                                        clear();
+
+    private:
+        static void                                 evict(const void* component);
+
+        std::mutex                                  _mutex;
+        std::unordered_map<const void*, std::shared_ptr<const SkinningRig>> _rigs;
+    };
+
+} // Private
+} // MDL
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// MARK: - Private Sector
+
+_MDL_INLINE void MDL::Private::Skinning::linearBlend(const Input& input, const float* palette, NS::UInteger jointCount,
+                                                     const Output& output)
+{
+    if (!jointCount)
+    {
+        return;
+    }
+    ThreadPool::shared().parallelFor(input.vertexCount, ChunkSize, [&](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger vertex = begin; vertex < end; ++vertex)
+        {
+            linearBlendVertex(input, palette, jointCount - 1, vertex, output);
+        }
+    });
+}
+
+_MDL_INLINE void MDL::Private::Skinning::dualQuaternion(const Input& input, const float* dualQuaternions, NS::UInteger jointCount,
+                                                        const float* geometryBind, const Output& output)
+{
+    if (!jointCount)
+    {
+        return;
+    }
+    ThreadPool::shared().parallelFor(input.vertexCount, ChunkSize, [&](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger vertex = begin; vertex < end; ++vertex)
+        {
+            dualQuaternionVertex(input, dualQuaternions, jointCount - 1, geometryBind, vertex, output);
+        }
+    });
+}
+
+_MDL_INLINE void MDL::Private::Skinning::linearBlendVertex(const Input& input, const float* palette, NS::UInteger lastJoint,
+                                                           NS::UInteger vertex, const Output& output)
+{
+    const float*         p = reinterpret_cast<const float*>(reinterpret_cast<const char*>(input.positions) + vertex * input.positionStride);
+    const std::uint16_t* j = reinterpret_cast<const std::uint16_t*>(reinterpret_cast<const char*>(input.joints) + vertex * input.jointStride);
+    const float*         w = reinterpret_cast<const float*>(reinterpret_cast<const char*>(input.weights) + vertex * input.weightStride);
+    const float*         n = input.normals && output.normals
+                           ? reinterpret_cast<const float*>(reinterpret_cast<const char*>(input.normals) + vertex * input.normalStride)
+                           : nullptr;
+    float* outPosition = reinterpret_cast<float*>(reinterpret_cast<char*>(output.positions) + vertex * output.positionStride);
+    float* outNormal = n ? reinterpret_cast<float*>(reinterpret_cast<char*>(output.normals) + vertex * output.normalStride) : nullptr;
+
+    float position[4];
+    float normal[4];
+
+#if defined(_MDL_SKINNING_AVX2)
+    // Blended matrix as two registers: columns 0 and 1, columns 2 and 3
+    __m256 c01 = _mm256_setzero_ps();
+    __m256 c23 = _mm256_setzero_ps();
+    for (int i = 0; i < 4; ++i)
+    {
+        const float* m = palette + std::min<NS::UInteger>(j[i], lastJoint) * 16;
+        const __m256 weight = _mm256_set1_ps(w[i]);
+        c01 = _mm256_fmadd_ps(weight, _mm256_loadu_ps(m), c01);
+        c23 = _mm256_fmadd_ps(weight, _mm256_loadu_ps(m + 8), c23);
+    }
+    const __m256 xy = _mm256_setr_ps(p[0], p[0], p[0], p[0], p[1], p[1], p[1], p[1]);
+    const __m256 z1 = _mm256_setr_ps(p[2], p[2], p[2], p[2], 1.0f, 1.0f, 1.0f, 1.0f);
+    const __m256 sum = _mm256_fmadd_ps(c23, z1, _mm256_mul_ps(c01, xy));
+    _mm_storeu_ps(position, _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1)));
+    if (n)
+    {
+        const __m256 nxy = _mm256_setr_ps(n[0], n[0], n[0], n[0], n[1], n[1], n[1], n[1]);
+        const __m256 nz0 = _mm256_setr_ps(n[2], n[2], n[2], n[2], 0.0f, 0.0f, 0.0f, 0.0f);
+        const __m256 nsum = _mm256_fmadd_ps(c23, nz0, _mm256_mul_ps(c01, nxy));
+        _mm_storeu_ps(normal, _mm_add_ps(_mm256_castps256_ps128(nsum), _mm256_extractf128_ps(nsum, 1)));
+    }
+#elif defined(_MDL_SKINNING_SSE)
+    __m128 c[4] = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+    for (int i = 0; i < 4; ++i)
+    {
+        const float* m = palette + std::min<NS::UInteger>(j[i], lastJoint) * 16;
+        const __m128 weight = _mm_set1_ps(w[i]);
+        for (int k = 0; k < 4; ++k)
+        {
+            c[k] = _mm_add_ps(c[k], _mm_mul_ps(weight, _mm_loadu_ps(m + 4 * k)));
+        }
+    }
+    _mm_storeu_ps(position, _mm_add_ps(_mm_add_ps(_mm_mul_ps(c[0], _mm_set1_ps(p[0])), _mm_mul_ps(c[1], _mm_set1_ps(p[1]))),
+                                       _mm_add_ps(_mm_mul_ps(c[2], _mm_set1_ps(p[2])), c[3])));
+    if (n)
+    {
+        _mm_storeu_ps(normal, _mm_add_ps(_mm_add_ps(_mm_mul_ps(c[0], _mm_set1_ps(n[0])), _mm_mul_ps(c[1], _mm_set1_ps(n[1]))),
+                                         _mm_mul_ps(c[2], _mm_set1_ps(n[2]))));
+    }
+#elif defined(_MDL_SKINNING_NEON)
+    float32x4_t c[4] = { vdupq_n_f32(0.0f), vdupq_n_f32(0.0f), vdupq_n_f32(0.0f), vdupq_n_f32(0.0f) };
+    for (int i = 0; i < 4; ++i)
+    {
+        const float* m = palette + std::min<NS::UInteger>(j[i], lastJoint) * 16;
+        for (int k = 0; k < 4; ++k)
+        {
+            c[k] = vmlaq_n_f32(c[k], vld1q_f32(m + 4 * k), w[i]);
+        }
+    }
+    vst1q_f32(position, vaddq_f32(vmlaq_n_f32(vmulq_n_f32(c[0], p[0]), c[1], p[1]), vmlaq_n_f32(c[3], c[2], p[2])));
+    if (n)
+    {
+        vst1q_f32(normal, vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(c[0], n[0]), c[1], n[1]), c[2], n[2]));
+    }
+#else
+    float c[16] = {};
+    for (int i = 0; i < 4; ++i)
+    {
+        const float* m = palette + std::min<NS::UInteger>(j[i], lastJoint) * 16;
+        for (int k = 0; k < 16; ++k)
+        {
+            c[k] += w[i] * m[k];
+        }
+    }
+    for (int r = 0; r < 3; ++r)
+    {
+        position[r] = c[r] * p[0] + c[4 + r] * p[1] + c[8 + r] * p[2] + c[12 + r];
+        if (n)
+        {
+            normal[r] = c[r] * n[0] + c[4 + r] * n[1] + c[8 + r] * n[2];
+        }
+    }
+#endif
+
+    std::memcpy(outPosition, position, 3 * sizeof(float));
+    if (n)
+    {
+        // The blended matrix stands in for its inverse transpose, exact for
+        // rotations and uniform scale
+        const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        const float inverseLength = length > 0.0f ? 1.0f / length : 0.0f;
+        for (int r = 0; r < 3; ++r)
+        {
+            outNormal[r] = normal[r] * inverseLength;
+        }
+    }
+}
+
+_MDL_INLINE void MDL::Private::Skinning::dualQuaternionVertex(const Input& input, const float* dualQuaternions,
+                                                              NS::UInteger lastJoint, const float* geometryBind,
+                                                              NS::UInteger vertex, const Output& output)
+{
+    const float*         p = reinterpret_cast<const float*>(reinterpret_cast<const char*>(input.positions) + vertex * input.positionStride);
+    const std::uint16_t* j = reinterpret_cast<const std::uint16_t*>(reinterpret_cast<const char*>(input.joints) + vertex * input.jointStride);
+    const float*         w = reinterpret_cast<const float*>(reinterpret_cast<const char*>(input.weights) + vertex * input.weightStride);
+    const float*         n = input.normals && output.normals
+                           ? reinterpret_cast<const float*>(reinterpret_cast<const char*>(input.normals) + vertex * input.normalStride)
+                           : nullptr;
+    float* outPosition = reinterpret_cast<float*>(reinterpret_cast<char*>(output.positions) + vertex * output.positionStride);
+    float* outNormal = n ? reinterpret_cast<float*>(reinterpret_cast<char*>(output.normals) + vertex * output.normalStride) : nullptr;
+
+    // Blend along the hemisphere of the first influence
+    const float* first = dualQuaternions + std::min<NS::UInteger>(j[0], lastJoint) * 8;
+    float        blended[8];
+#if defined(_MDL_SKINNING_AVX2)
+    const __m128 pivot = _mm_loadu_ps(first);
+    __m256       sum = _mm256_setzero_ps();
+    for (int i = 0; i < 4; ++i)
+    {
+        const float* dq = dualQuaternions + std::min<NS::UInteger>(j[i], lastJoint) * 8;
+        const __m256 q = _mm256_loadu_ps(dq);
+        __m128 dot = _mm_mul_ps(pivot, _mm256_castps256_ps128(q));
+        dot = _mm_add_ps(dot, _mm_movehl_ps(dot, dot));
+        dot = _mm_add_ss(dot, _mm_shuffle_ps(dot, dot, 1));
+        const float weight = _mm_cvtss_f32(dot) < 0.0f ? -w[i] : w[i];
+        sum = _mm256_fmadd_ps(_mm256_set1_ps(weight), q, sum);
+    }
+    _mm256_storeu_ps(blended, sum);
+#elif defined(_MDL_SKINNING_SSE)
+    __m128 real = _mm_setzero_ps();
+    __m128 dual = _mm_setzero_ps();
+    for (int i = 0; i < 4; ++i)
+    {
+        const float* dq = dualQuaternions + std::min<NS::UInteger>(j[i], lastJoint) * 8;
+        const float  dot = first[0] * dq[0] + first[1] * dq[1] + first[2] * dq[2] + first[3] * dq[3];
+        const __m128 weight = _mm_set1_ps(dot < 0.0f ? -w[i] : w[i]);
+        real = _mm_add_ps(real, _mm_mul_ps(weight, _mm_loadu_ps(dq)));
+        dual = _mm_add_ps(dual, _mm_mul_ps(weight, _mm_loadu_ps(dq + 4)));
+    }
+    _mm_storeu_ps(blended, real);
+    _mm_storeu_ps(blended + 4, dual);
+#elif defined(_MDL_SKINNING_NEON)
+    float32x4_t real = vdupq_n_f32(0.0f);
+    float32x4_t dual = vdupq_n_f32(0.0f);
+    const float32x4_t pivot = vld1q_f32(first);
+    for (int i = 0; i < 4; ++i)
+    {
+        const float* dq = dualQuaternions + std::min<NS::UInteger>(j[i], lastJoint) * 8;
+        const float32x4_t q = vld1q_f32(dq);
+        const float weight = vaddvq_f32(vmulq_f32(pivot, q)) < 0.0f ? -w[i] : w[i];
+        real = vmlaq_n_f32(real, q, weight);
+        dual = vmlaq_n_f32(dual, vld1q_f32(dq + 4), weight);
+    }
+    vst1q_f32(blended, real);
+    vst1q_f32(blended + 4, dual);
+#else
+    std::fill(blended, blended + 8, 0.0f);
+    for (int i = 0; i < 4; ++i)
+    {
+        const float* dq = dualQuaternions + std::min<NS::UInteger>(j[i], lastJoint) * 8;
+        const float  dot = first[0] * dq[0] + first[1] * dq[1] + first[2] * dq[2] + first[3] * dq[3];
+        const float  weight = dot < 0.0f ? -w[i] : w[i];
+        for (int k = 0; k < 8; ++k)
+        {
+            blended[k] += weight * dq[k];
+        }
+    }
+#endif
+
+    const float length = std::sqrt(blended[0] * blended[0] + blended[1] * blended[1] + blended[2] * blended[2] + blended[3] * blended[3]);
+    const float inverseLength = length > 0.0f ? 1.0f / length : 0.0f;
+    const float rx = blended[0] * inverseLength, ry = blended[1] * inverseLength, rz = blended[2] * inverseLength, rw = blended[3] * inverseLength;
+    const float dx = blended[4] * inverseLength, dy = blended[5] * inverseLength, dz = blended[6] * inverseLength, dw = blended[7] * inverseLength;
+
+    float v[3] = { p[0], p[1], p[2] };
+    float m[3] = { n ? n[0] : 0.0f, n ? n[1] : 0.0f, n ? n[2] : 0.0f };
+    if (geometryBind)
+    {
+        const float* g = geometryBind;
+        const float  x = v[0], y = v[1], z = v[2];
+        const float  nx = m[0], ny = m[1], nz = m[2];
+        for (int r = 0; r < 3; ++r)
+        {
+            v[r] = g[r] * x + g[4 + r] * y + g[8 + r] * z + g[12 + r];
+            m[r] = g[r] * nx + g[4 + r] * ny + g[8 + r] * nz;
+        }
+    }
+
+    // Rotation: v + 2 r x (r x v + w v); translation: 2 (w d - dw r + r x d)
+    auto rotate = [&](const float* in, float* out)
+    {
+        const float cx = ry * in[2] - rz * in[1] + rw * in[0];
+        const float cy = rz * in[0] - rx * in[2] + rw * in[1];
+        const float cz = rx * in[1] - ry * in[0] + rw * in[2];
+        out[0] = in[0] + 2.0f * (ry * cz - rz * cy);
+        out[1] = in[1] + 2.0f * (rz * cx - rx * cz);
+        out[2] = in[2] + 2.0f * (rx * cy - ry * cx);
+    };
+    float position[3];
+    rotate(v, position);
+    outPosition[0] = position[0] + 2.0f * (rw * dx - dw * rx + ry * dz - rz * dy);
+    outPosition[1] = position[1] + 2.0f * (rw * dy - dw * ry + rz * dx - rx * dz);
+    outPosition[2] = position[2] + 2.0f * (rw * dz - dw * rz + rx * dy - ry * dx);
+    if (n)
+    {
+        float normal[3];
+        rotate(m, normal);
+        const float normalLength = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        const float inverseNormalLength = normalLength > 0.0f ? 1.0f / normalLength : 0.0f;
+        for (int r = 0; r < 3; ++r)
+        {
+            outNormal[r] = normal[r] * inverseNormalLength;
+        }
+    }
+}
+
+_MDL_INLINE void MDL::Private::Skinning::toDualQuaternion(const float* matrix, float* out)
+{
+    // Columns normalized first, dropping scale
+    float r[9];
+    for (int column = 0; column < 3; ++column)
+    {
+        const float* c = matrix + 4 * column;
+        const float  length = std::sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+        const float  inverseLength = length > 0.0f ? 1.0f / length : 0.0f;
+        for (int row = 0; row < 3; ++row)
+        {
+            r[3 * column + row] = c[row] * inverseLength;
+        }
+    }
+
+    // r[3 * column + row]
+    const float trace = r[0] + r[4] + r[8];
+    float q[4];
+    if (trace > 0.0f)
+    {
+        const float s = 2.0f * std::sqrt(trace + 1.0f);
+        q[3] = 0.25f * s;
+        q[0] = (r[5] - r[7]) / s;
+        q[1] = (r[6] - r[2]) / s;
+        q[2] = (r[1] - r[3]) / s;
+    }
+    else if (r[0] > r[4] && r[0] > r[8])
+    {
+        const float s = 2.0f * std::sqrt(1.0f + r[0] - r[4] - r[8]);
+        q[3] = (r[5] - r[7]) / s;
+        q[0] = 0.25f * s;
+        q[1] = (r[3] + r[1]) / s;
+        q[2] = (r[6] + r[2]) / s;
+    }
+    else if (r[4] > r[8])
+    {
+        const float s = 2.0f * std::sqrt(1.0f + r[4] - r[0] - r[8]);
+        q[3] = (r[6] - r[2]) / s;
+        q[0] = (r[3] + r[1]) / s;
+        q[1] = 0.25f * s;
+        q[2] = (r[7] + r[5]) / s;
+    }
+    else
+    {
+        const float s = 2.0f * std::sqrt(1.0f + r[8] - r[0] - r[4]);
+        q[3] = (r[1] - r[3]) / s;
+        q[0] = (r[6] + r[2]) / s;
+        q[1] = (r[7] + r[5]) / s;
+        q[2] = 0.25f * s;
+    }
+
+    // dual = 0.5 * (t, 0) * q
+    const float tx = matrix[12], ty = matrix[13], tz = matrix[14];
+    out[0] = q[0];
+    out[1] = q[1];
+    out[2] = q[2];
+    out[3] = q[3];
+    out[4] = 0.5f * ( tx * q[3] + ty * q[2] - tz * q[1]);
+    out[5] = 0.5f * (-tx * q[2] + ty * q[3] + tz * q[0]);
+    out[6] = 0.5f * ( tx * q[1] - ty * q[0] + tz * q[3]);
+    out[7] = 0.5f * (-tx * q[0] - ty * q[1] - tz * q[2]);
+}
+
+_MDL_INLINE std::shared_ptr<MDL::Private::SkinningRig> MDL::Private::SkinningRig::build(std::shared_ptr<const JointHierarchy> hierarchy,
+                                                                                        const float* restTransforms,
+                                                                                        const float* bindTransforms,
+                                                                                        const std::vector<std::string>& animationJointPaths,
+                                                                                        const std::vector<std::string>& meshJointPaths,
+                                                                                        const double* geometryBindTransform)
+{
+    auto rig = std::make_shared<SkinningRig>();
+    const NS::UInteger jointCount = hierarchy->jointCount();
+    rig->_animationJoints = hierarchy->mapJoints(animationJointPaths);
+
+    if (meshJointPaths.empty())
+    {
+        rig->_meshJoints.resize(jointCount);
+        for (NS::UInteger i = 0; i < jointCount; ++i)
+        {
+            rig->_meshJoints[i] = std::uint32_t(i);
+        }
+    }
+    else
+    {
+        // Mesh joints missing from the skeleton follow the root
+        rig->_meshJoints.resize(meshJointPaths.size());
+        for (NS::UInteger i = 0; i < meshJointPaths.size(); ++i)
+        {
+            const std::int32_t joint = hierarchy->jointIndex(meshJointPaths[i]);
+            rig->_meshJoints[i] = joint != JointHierarchy::NoJoint ? std::uint32_t(joint) : (jointCount ? hierarchy->order()[0] : 0);
+        }
+    }
+
+    rig->_restTransforms.assign(restTransforms, restTransforms + jointCount * 16);
+    rig->_inverseBindTransforms.resize(jointCount * 16);
+    for (NS::UInteger i = 0; i < jointCount; ++i)
+    {
+        TransformProgram::invert(bindTransforms + i * 16, rig->_inverseBindTransforms.data() + i * 16);
+    }
+
+    for (int i = 0; i < 16; ++i)
+    {
+        rig->_geometryBind[i] = geometryBindTransform ? float(geometryBindTransform[i]) : float(i % 5 == 0);
+        rig->_hasGeometryBind |= rig->_geometryBind[i] != float(i % 5 == 0);
+    }
+    rig->_hierarchy = std::move(hierarchy);
+    return rig;
+}
+
+_MDL_INLINE NS::UInteger MDL::Private::SkinningRig::jointCount() const
+{
+    return _hierarchy->jointCount();
+}
+
+_MDL_INLINE NS::UInteger MDL::Private::SkinningRig::animationJointCount() const
+{
+    return _animationJoints.sourceCount;
+}
+
+_MDL_INLINE NS::UInteger MDL::Private::SkinningRig::paletteCount() const
+{
+    return _meshJoints.size();
+}
+
+_MDL_INLINE const float* MDL::Private::SkinningRig::geometryBindTransform() const
+{
+    return _hasGeometryBind ? _geometryBind : nullptr;
+}
+
+_MDL_INLINE void MDL::Private::SkinningRig::pose(const float* translations, const float* rotations, const float* scales,
+                                                 float* world) const
+{
+    _hierarchy->pose(translations, rotations, scales, _animationJoints, _restTransforms.data(), world);
+}
+
+_MDL_INLINE void MDL::Private::SkinningRig::palette(const float* world, bool withGeometryBind, float* out) const
+{
+    for (NS::UInteger i = 0; i < _meshJoints.size(); ++i)
+    {
+        const NS::UInteger joint = _meshJoints[i];
+        float* matrix = out + i * 16;
+        TransformProgram::multiply(world + joint * 16, _inverseBindTransforms.data() + joint * 16, matrix);
+        if (withGeometryBind && _hasGeometryBind)
+        {
+            TransformProgram::multiply(matrix, _geometryBind, matrix);
+        }
+    }
+}
+
+_MDL_INLINE MDL::Private::SkinningRigCache& MDL::Private::SkinningRigCache::shared()
+{
+    static SkinningRigCache cache;
+    return cache;
+}
+
+_MDL_INLINE std::shared_ptr<const MDL::Private::SkinningRig> MDL::Private::SkinningRigCache::find(const void* component)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _rigs.find(component);
+    return it == _rigs.end() ? nullptr : it->second;
+}
+
+_MDL_INLINE void MDL::Private::SkinningRigCache::store(const void* component, std::shared_ptr<const SkinningRig> rig)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _rigs[component] = std::move(rig);
+    }
+    ObjectLifetime::watch(component, this, &SkinningRigCache::evict);
+}
+
+_MDL_INLINE void MDL::Private::SkinningRigCache::remove(const void* component)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _rigs.erase(component);
+}
+
+_MDL_INLINE void MDL::Private::SkinningRigCache::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _rigs.clear();
+}
+
+_MDL_INLINE void MDL::Private::SkinningRigCache::evict(const void* component)
+{
+    shared().remove(component);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -9,6 +9,7 @@
 #include "MDLTypes.hpp"
 #include "MDLMaterial.hpp"
 #include "MDLMeshBuffer.hpp"
+#include "MDLMeshAdjacency.hpp"
 
 namespace MDL
 {
@@ -38,6 +39,15 @@ public:
     // !!!: Unnecessary probably
     void                            setVertexCreaseCount(NS::UInteger vertexCreaseCount);
     
+    class MeshBuffer*               edgeCreaseIndices() const;
+    void                            setEdgeCreaseIndices(const class MeshBuffer* edgeCreaseIndices);
+    
+    class MeshBuffer*               edgeCreases() const;
+    void                            setEdgeCreases(const class MeshBuffer* edgeCreases);
+    
+    NS::UInteger                    edgeCreaseCount() const;
+    void                            setEdgeCreaseCount(NS::UInteger edgeCreaseCount);
+    
     class MeshBuffer*               holes() const;
     void                            setHoles(const class MeshBuffer* holes);
     
@@ -100,6 +110,13 @@ public:
     
     NS::String*             name() const;
     void                    setName(const NS::String* name);
+    
+    // - Native
+    // Half-edge adjacency of the faces, built on first use and cached until the
+    // index buffer is replaced or refilled
+    std::shared_ptr<MeshAdjacency>  adjacency() const;
+    
+    void                            invalidateAdjacency() const;
 };
 
 }
@@ -173,6 +190,39 @@ _MDL_INLINE void MDL::SubmeshTopology::setVertexCreaseCount(NS::UInteger vertexC
     return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setVertexCreaseCount_), vertexCreaseCount);
 }
 
+// property: edgeCreaseIndices
+_MDL_INLINE MDL::MeshBuffer* MDL::SubmeshTopology::edgeCreaseIndices() const
+{
+    return Object::sendMessage<MeshBuffer*>(this, _MDL_PRIVATE_SEL(edgeCreaseIndices));
+}
+// write method: setEdgeCreaseIndices:
+_MDL_INLINE void MDL::SubmeshTopology::setEdgeCreaseIndices(const class MeshBuffer* edgeCreaseIndices)
+{
+    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setEdgeCreaseIndices_), edgeCreaseIndices);
+}
+
+// property: edgeCreases
+_MDL_INLINE MDL::MeshBuffer* MDL::SubmeshTopology::edgeCreases() const
+{
+    return Object::sendMessage<MeshBuffer*>(this, _MDL_PRIVATE_SEL(edgeCreases));
+}
+// write method: setEdgeCreases:
+_MDL_INLINE void MDL::SubmeshTopology::setEdgeCreases(const class MeshBuffer* edgeCreases)
+{
+    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setEdgeCreases_), edgeCreases);
+}
+
+// property: edgeCreaseCount
+_MDL_INLINE NS::UInteger MDL::SubmeshTopology::edgeCreaseCount() const
+{
+    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(edgeCreaseCount));
+}
+// write method: setEdgeCreaseCount:
+_MDL_INLINE void MDL::SubmeshTopology::setEdgeCreaseCount(NS::UInteger edgeCreaseCount)
+{
+    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setEdgeCreaseCount_), edgeCreaseCount);
+}
+
 // property: holes
 _MDL_INLINE MDL::MeshBuffer* MDL::SubmeshTopology::holes() const
 {
@@ -211,6 +261,7 @@ _MDL_INLINE MDL::Submesh* MDL::Submesh::init(const NS::String* name,
                                              GeometryType geometryType,
                                              const Material* material)
 {
+    Private::MeshAdjacencyCache::shared().invalidate(this);
     return Object::sendMessage<Submesh*>(this,
                                          _MDL_PRIVATE_SEL(initWithName_indexBuffer_indexCount_indexType_geometryType_material_),
                                          name, indexBuffer, indexCount, indexType, geometryType, material);
@@ -223,6 +274,7 @@ _MDL_INLINE MDL::Submesh* MDL::Submesh::init(const NS::String* name,
                                              GeometryType geometryType,
                                              const Material* material)
 {
+    Private::MeshAdjacencyCache::shared().invalidate(this);
     return Object::sendMessage<Submesh*>(this,
                                          _MDL_PRIVATE_SEL(initWithIndexBuffer_indexCount_indexType_geometryType_material_),
                                          name, indexCount, indexType, geometryType, material);
@@ -237,6 +289,7 @@ _MDL_INLINE MDL::Submesh* MDL::Submesh::init(const NS::String* name,
                                              const Material* material,
                                              const SubmeshTopology* topology)
 {
+    Private::MeshAdjacencyCache::shared().invalidate(this);
     return Object::sendMessage<Submesh*>(this,
                                          _MDL_PRIVATE_SEL(initWithName_indexBuffer_indexCount_indexType_geometryType_material_topology_),
                                          name, indexBuffer, indexCount, indexType, geometryType, material, topology);
@@ -247,6 +300,7 @@ _MDL_INLINE MDL::Submesh* MDL::Submesh::init(const Submesh* submesh,
                                              IndexBitDepth indexType,
                                              GeometryType geometryType)
 {
+    Private::MeshAdjacencyCache::shared().invalidate(this);
     return Object::sendMessage<Submesh*>(this,
                                          _MDL_PRIVATE_SEL(initWithMDLSubmesh_indexType_geometryType_),
                                          submesh, indexType, geometryType);
@@ -315,6 +369,88 @@ _MDL_INLINE void MDL::Submesh::setName(const NS::String* name)
     return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setName_), name);
 }
 
+// native: adjacency
+_MDL_INLINE std::shared_ptr<MDL::MeshAdjacency> MDL::Submesh::adjacency() const
+{
+    MeshBuffer*      buffer = indexBuffer();
+    SubmeshTopology* submeshTopology = topology();
+    
+    Private::MeshAdjacencyCache::Key key;
+    key.indexBuffer = buffer;
+    key.generation = Private::MeshBufferGeneration::shared().generation(buffer);
+    key.indexCount = indexCount();
+    key.indexType = indexType();
+    key.faceCount = submeshTopology ? submeshTopology->faceCount() : 0;
+    
+    if (std::shared_ptr<MeshAdjacency> cached = Private::MeshAdjacencyCache::shared().find(this, key))
+    {
+        return cached;
+    }
+    
+    std::vector<std::uint32_t> indices(key.indexCount);
+    if (buffer && key.indexCount)
+    {
+        MeshBufferMap* indexMap = Private::readMap(buffer);
+        Private::copyIndices(indexMap->bytes(), key.indexCount, key.indexType, indices.data());
+    }
+    
+    NS::UInteger faceSize = 3;
+    switch (geometryType())
+    {
+        case GeometryTypePoints:
+            faceSize = 1;
+            break;
+        case GeometryTypeLines:
+            faceSize = 2;
+            break;
+        case GeometryTypeTriangleStrips:
+        {
+            std::vector<std::uint32_t> triangles;
+            Private::triangulateStrip(indices.data(), indices.size(), triangles);
+            indices.swap(triangles);
+            break;
+        }
+        case GeometryTypeQuads:
+            faceSize = 4;
+            break;
+        default:
+            break;
+    }
+    
+    const std::uint8_t*  faceVertexCounts = nullptr;
+    const std::uint32_t* holes = nullptr;
+    NS::UInteger         holeCount = 0;
+    MeshBufferMap*       faceMap = nullptr;
+    MeshBufferMap*       holeMap = nullptr;
+    
+    if (submeshTopology && key.faceCount)
+    {
+        if (MeshBuffer* faceTopology = submeshTopology->faceTopology())
+        {
+            faceMap = Private::readMap(faceTopology);
+            faceVertexCounts = static_cast<const std::uint8_t*>(faceMap->bytes());
+        }
+        if (MeshBuffer* holeBuffer = submeshTopology->holes())
+        {
+            holeMap = Private::readMap(holeBuffer);
+            holes = static_cast<const std::uint32_t*>(holeMap->bytes());
+            holeCount = submeshTopology->holeCount();
+        }
+    }
+    
+    std::shared_ptr<MeshAdjacency> adjacency = MeshAdjacency::build(indices.data(), indices.size(),
+                                                                    faceVertexCounts, key.faceCount, faceSize,
+                                                                    holes, holeCount);
+    Private::MeshAdjacencyCache::shared().store(this, key, adjacency);
+    return adjacency;
+}
+
+// native: invalidateAdjacency
+_MDL_INLINE void MDL::Submesh::invalidateAdjacency() const
+{
+    Private::MeshAdjacencyCache::shared().invalidate(this);
+}
+
 // MARK: - Original Header
 
 //#import <ModelIO/MDLTypes.h>
@@ -8,6 +8,7 @@
 
 #include "MDLObject.hpp"
 #include "MDLTypes.hpp"
+#include "MDLTransformProgram.hpp"
 #import "Foundation/Foundation.hpp"
 //#include <simd/simd.h>
 
@@ -117,6 +118,27 @@ public:
     void                        setScale(vector_float3 scale);
 };
 
+namespace Private
+{
+    // Copies the matrix and flags of `component` into the scene graph node
+    // that carries it; nothing for InvalidNode
+    void                        syncSceneTransform(SceneGraph::NodeId node, const TransformComponent* component);
+    
+    // Records `component`, when it is a transform stack, as an owner of the
+    // animated values its ops sample
+    void                        recordStackValues(const TransformComponent* component);
+    
+    // World matrices of `root` and everything below it at `time`, from the
+    // shared cache
+    std::shared_ptr<const WorldTransformTable>  worldTransformTable(SceneGraph::NodeId root, NS::TimeInterval time, bool parallel);
+    
+    // Product of the local transforms from `object` up to the root, stopping
+    // at the first transform that resets its parents. Read from the table of
+    // the object's whole tree, so later objects at the same time are lookups.
+    matrix_float4x4             worldTransformAtTime(const MDL::Object* object, NS::TimeInterval time);
+    
+} // Private
+
 }
 
 // MARK: - Private Sector
@@ -131,7 +153,9 @@ _MDL_INLINE matrix_float4x4 MDL::TransformComponent::matrix() const
 // write method: setMatrix:
 _MDL_INLINE void MDL::TransformComponent::setMatrix(matrix_float4x4 matrix)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setMatrix_), matrix);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setMatrix_), matrix);
+    Private::BoundsCache::shared().markDirty(this);
+    Private::syncSceneTransform(Private::SceneGraph::shared().findTransform(this), this);
 }
 
 // property: resetsTransform
@@ -142,7 +166,9 @@ _MDL_INLINE BOOL MDL::TransformComponent::resetsTransform() const
 // write method: setResetsTransform:
 _MDL_INLINE void MDL::TransformComponent::setResetsTransform(BOOL resetsTransform)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setResetsTransform_), resetsTransform);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setResetsTransform_), resetsTransform);
+    Private::BoundsCache::shared().markDirty(this);
+    Private::syncSceneTransform(Private::SceneGraph::shared().findTransform(this), this);
 }
 
 // property: minimumTime
@@ -166,13 +192,17 @@ _MDL_INLINE NS::Array* MDL::TransformComponent::keyTimes() const
 // method: setLocalTransform:forTime:
 _MDL_INLINE void MDL::TransformComponent::setLocalTransform(matrix_float4x4 transform, NS::TimeInterval time)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setLocalTransform_forTime_), transform, time);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setLocalTransform_forTime_), transform, time);
+    Private::BoundsCache::shared().markDirty(this);
+    Private::syncSceneTransform(Private::SceneGraph::shared().findTransform(this), this);
 }
 
 // method: setLocalTransform:
 _MDL_INLINE void MDL::TransformComponent::setLocalTransform(matrix_float4x4 transform)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setLocalTransform_), transform);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setLocalTransform_), transform);
+    Private::BoundsCache::shared().markDirty(this);
+    Private::syncSceneTransform(Private::SceneGraph::shared().findTransform(this), this);
 }
 
 // method: localTransformAtTime:
@@ -182,9 +212,82 @@ _MDL_INLINE matrix_float4x4 MDL::TransformComponent::localTransformAtTime(NS::Ti
 }
 
 // method: globalTransformWithObject:atTime:
+// Served from the batched world transform table of the object's tree
 _MDL_INLINE matrix_float4x4 MDL::TransformComponent::globalTransformWithObject(const MDL::Object* object, NS::TimeInterval time)
 {
-    return Object::sendMessage<matrix_float4x4>(this, _MDL_PRIVATE_SEL(globalTransformWithObject_atTime_), time);
+    return object ? Private::worldTransformAtTime(object, time) : matrix_identity_float4x4;
+}
+
+// native: syncSceneTransform
+_MDL_INLINE void MDL::Private::syncSceneTransform(SceneGraph::NodeId node, const TransformComponent* component)
+{
+    if (node == SceneGraph::InvalidNode)
+    {
+        return;
+    }
+    if (!component)
+    {
+        SceneGraph::shared().setTransform(node, nullptr, nullptr, false, false);
+        return;
+    }
+    
+    // The mirrored matrix goes stale when a value of the stack is edited
+    recordStackValues(component);
+    
+    const matrix_float4x4 matrix = component->matrix();
+    NS::Array*            keyTimes = component->keyTimes();
+    SceneGraph::shared().setTransform(node, component, reinterpret_cast<const float*>(&matrix.columns[0]),
+                                      component->resetsTransform(), keyTimes && keyTimes->count() > 1);
+}
+
+// native: recordStackValues
+_MDL_INLINE void MDL::Private::recordStackValues(const TransformComponent* component)
+{
+    if (!component || object_getClass(reinterpret_cast<id>(const_cast<TransformComponent*>(component))) != _MDL_PRIVATE_CLS(MDLTransformStack))
+    {
+        return;
+    }
+    
+    TransformProgramCache& cache = TransformProgramCache::shared();
+    NS::Array*             ops = Object::sendMessage<NS::Array*>(component, _MDL_PRIVATE_SEL(transformOps));
+    for (NS::UInteger i = 0, n = ops ? ops->count() : 0; i < n; ++i)
+    {
+        cache.addOwner(Object::sendMessage<NS::Object*>(ops->object(i), _MDL_PRIVATE_SEL(animatedValue)), component);
+    }
+}
+
+// native: worldTransformTable
+_MDL_INLINE std::shared_ptr<const MDL::WorldTransformTable> MDL::Private::worldTransformTable(SceneGraph::NodeId root,
+                                                                                             NS::TimeInterval time,
+                                                                                             bool parallel)
+{
+    const SceneGraph& graph = SceneGraph::shared();
+    return WorldTransformCache::shared().evaluate(root, time, parallel, [&](SceneGraph::NodeId node, double sampleTime, float* columns)
+    {
+        TransformComponent*   component = static_cast<TransformComponent*>(const_cast<void*>(graph.transform(node)));
+        const matrix_float4x4 matrix = component->localTransformAtTime(sampleTime);
+        std::memcpy(columns, &matrix.columns[0], sizeof(float) * 16);
+    });
+}
+
+// native: worldTransformAtTime
+_MDL_INLINE matrix_float4x4 MDL::Private::worldTransformAtTime(const MDL::Object* object, NS::TimeInterval time)
+{
+    const SceneGraph&        graph = SceneGraph::shared();
+    const SceneGraph::NodeId node = object->sceneNode();
+    SceneGraph::NodeId       top = node;
+    while (graph.parent(top) != SceneGraph::InvalidNode)
+    {
+        top = graph.parent(top);
+    }
+    
+    matrix_float4x4 world = matrix_identity_float4x4;
+    std::shared_ptr<const WorldTransformTable> table = worldTransformTable(top, time, false);
+    if (const SceneGraph::Matrix* matrix = table ? table->find(node) : nullptr)
+    {
+        std::memcpy(&world.columns[0], matrix->columns, sizeof(float) * 16);
+    }
+    return world;
 }
 
 // MARK: class Transform
@@ -228,7 +331,9 @@ _MDL_INLINE MDL::Transform* MDL::Transform::init(matrix_float4x4 matrix, BOOL re
 // method: setIdentity
 _MDL_INLINE void MDL::Transform::setIdentity()
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setIdentity));
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setIdentity));
+    Private::BoundsCache::shared().markDirty(this);
+    Private::syncSceneTransform(Private::SceneGraph::shared().findTransform(this), this);
 }
 
 // method: translationAtTime:
@@ -258,31 +363,41 @@ _MDL_INLINE vector_float3 MDL::Transform::scaleAtTime(NS::TimeInterval time)
 // method: setMatrix:forTime:
 _MDL_INLINE void MDL::Transform::setMatrix(matrix_float4x4 matrix, NS::TimeInterval time)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setMatrix_forTime_), matrix, time);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setMatrix_forTime_), matrix, time);
+    Private::BoundsCache::shared().markDirty(this);
+    Private::syncSceneTransform(Private::SceneGraph::shared().findTransform(this), this);
 }
 
 // method: setTranslation:forTime:
 _MDL_INLINE void MDL::Transform::setTranslation(vector_float3 translation, NS::TimeInterval time)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setTranslation_forTime_), translation, time);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setTranslation_forTime_), translation, time);
+    Private::BoundsCache::shared().markDirty(this);
+    Private::syncSceneTransform(Private::SceneGraph::shared().findTransform(this), this);
 }
 
 // method: setRotation:forTime:
 _MDL_INLINE void MDL::Transform::setRotation(vector_float3 rotation, NS::TimeInterval time)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setRotation_forTime_), rotation, time);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setRotation_forTime_), rotation, time);
+    Private::BoundsCache::shared().markDirty(this);
+    Private::syncSceneTransform(Private::SceneGraph::shared().findTransform(this), this);
 }
 
 // method: setShear:forTime:
 _MDL_INLINE void MDL::Transform::setShear(vector_float3 shear, NS::TimeInterval time)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setShear_forTime_), shear, time);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setShear_forTime_), shear, time);
+    Private::BoundsCache::shared().markDirty(this);
+    Private::syncSceneTransform(Private::SceneGraph::shared().findTransform(this), this);
 }
 
 // method: setScale:forTime:
 _MDL_INLINE void MDL::Transform::setScale(vector_float3 scale, NS::TimeInterval time)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setScale_forTime_), scale, time);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setScale_forTime_), scale, time);
+    Private::BoundsCache::shared().markDirty(this);
+    Private::syncSceneTransform(Private::SceneGraph::shared().findTransform(this), this);
 }
 
 // method: rotationMatrixAtTime:
@@ -299,7 +414,9 @@ _MDL_INLINE vector_float3 MDL::Transform::translation() const
 // write method: setTranslation:
 _MDL_INLINE void MDL::Transform::setTranslation(vector_float3 translation)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setTranslation_), translation);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setTranslation_), translation);
+    Private::BoundsCache::shared().markDirty(this);
+    Private::syncSceneTransform(Private::SceneGraph::shared().findTransform(this), this);
 }
 
 // property: rotation
@@ -310,7 +427,9 @@ _MDL_INLINE vector_float3 MDL::Transform::rotation() const
 // write method: setRotation:
 _MDL_INLINE void MDL::Transform::setRotation(vector_float3 rotation)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setRotation_), rotation);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setRotation_), rotation);
+    Private::BoundsCache::shared().markDirty(this);
+    Private::syncSceneTransform(Private::SceneGraph::shared().findTransform(this), this);
 }
 
 // property: shear
@@ -321,7 +440,9 @@ _MDL_INLINE vector_float3 MDL::Transform::shear() const
 // write method: setShear:
 _MDL_INLINE void MDL::Transform::setShear(vector_float3 shear)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setShear_), shear);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setShear_), shear);
+    Private::BoundsCache::shared().markDirty(this);
+    Private::syncSceneTransform(Private::SceneGraph::shared().findTransform(this), this);
 }
 
 // property: scale
@@ -332,7 +453,9 @@ _MDL_INLINE vector_float3 MDL::Transform::scale() const
 // write method: setScale:
 _MDL_INLINE void MDL::Transform::setScale(vector_float3 scale)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setScale_), scale);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setScale_), scale);
+    Private::BoundsCache::shared().markDirty(this);
+    Private::syncSceneTransform(Private::SceneGraph::shared().findTransform(this), this);
 }
 
 // MARK: - Original Header
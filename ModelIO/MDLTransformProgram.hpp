@@ -0,0 +1,738 @@
+/*!
+ @header MDLTransformProgram.hpp
+ @framework ModelIO
+ @abstract Transform stacks compiled into flat evaluation programs
+ @copyright Treata Norouzi on 10/19/26.
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include "MDLDefines.hpp"
+#include "MDLObjectLifetime.hpp"
+#include "Foundation/NSTypes.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define _MDL_TRANSFORM_PROGRAM_SSE 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define _MDL_TRANSFORM_PROGRAM_NEON 1
+#endif
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace MDL
+{
+namespace Private
+{
+    // The ops of a transform stack as a flat list of instructions. Runs of
+    // ops whose values do not change over time are folded into one constant
+    // matrix when the program is built; only the animated ops are sampled
+    // on evaluation, and all their rotation angles go through one batched
+    // sine/cosine. Matrices are column-major and ops compose left to right,
+    // so the first op of the stack is the outermost.
+    class TransformProgram
+    {
+    public:
+        enum Opcode : std::uint8_t
+        {
+            OpcodeConstant,
+            // x, y, z
+            OpcodeTranslate,
+            // x, y, z
+            OpcodeScale,
+            // Radians
+            OpcodeRotateX,
+            OpcodeRotateY,
+            OpcodeRotateZ,
+            // Radians about x, y, z, applied in `order`
+            OpcodeRotate,
+            // Quaternion x, y, z, w
+            OpcodeOrient,
+            // 16 values, column-major
+            OpcodeMatrix,
+        };
+
+        // Same values as TransformOpRotationOrder
+        enum Order : std::uint8_t
+        {
+            OrderXYZ = 1,
+            OrderXZY,
+            OrderYXZ,
+            OrderYZX,
+            OrderZXY,
+            OrderZYX,
+        };
+
+        struct Instruction
+        {
+            Opcode                  opcode;
+            Order                   order;
+            bool                    inverse;
+            // Animated value sampled for the op, nullptr for constants
+            const void*             source;
+            // First sampled value, or first constant matrix element
+            std::uint32_t           operand;
+            // First angle in the batched sine/cosine
+            std::uint32_t           angle;
+        };
+
+        // Values an op of `opcode` is sampled into
+        static constexpr NS::UInteger   operandCount(Opcode opcode);
+
+        // Folds the op into the constant matrix ending the program, starting
+        // one if the last instruction is animated
+        void                            appendConstant(Opcode opcode, Order order, bool inverse, const double* values);
+        void                            appendAnimated(Opcode opcode, Order order, bool inverse, const void* source);
+
+        NS::UInteger                    instructionCount() const;
+        const Instruction*              instructions() const;
+        // Animated instructions only
+        NS::UInteger                    sampledCount() const;
+
+        // When set, the program disagreed with ModelIO's own evaluation of
+        // the stack and callers should use that instead
+        bool                            fallback() const;
+        void                            setFallback(bool fallback);
+
+        // `sample(instruction, time, _Scalar* values)` writes
+        // operandCount(instruction.opcode) values of an animated op at `time`
+        template <typename _Scalar, typename _Sampler>
+        void                            evaluate(double time, _Sampler&& sample, _Scalar* columns) const;
+
+        // sin and cos of `count` angles; four at a time for float
+        static void                     sinCos(const float* angles, NS::UInteger count, float* sines, float* cosines);
+        static void                     sinCos(const double* angles, NS::UInteger count, double* sines, double* cosines);
+
+        // out = a * b, column-major; out may alias a or b
+        template <typename _Scalar>
+        static void                     multiply(const _Scalar* a, const _Scalar* b, _Scalar* out);
+        // General inverse; the identity for a singular matrix
+        template <typename _Scalar>
+        static void                     invert(const _Scalar* m, _Scalar* out);
+
+    private:
+        template <typename _Scalar>
+        static void                     rotateColumns(_Scalar* columns, int axis, _Scalar sine, _Scalar cosine);
+        template <typename _Scalar>
+        static void                     apply(_Scalar* columns, const Instruction& instruction, const _Scalar* values,
+                                              const _Scalar* sines, const _Scalar* cosines);
+        template <typename _Scalar>
+        const _Scalar*                  constants() const;
+
+        std::vector<Instruction>        _instructions;
+        std::vector<double>             _constants;
+        std::vector<float>              _constantsFloat;
+        std::uint32_t                   _valueCount = 0;
+        std::uint32_t                   _angleCount = 0;
+        std::uint32_t                   _sampledCount = 0;
+        bool                            _fallback = false;
+    };
+
+    // Compiled programs by transform stack. A program is rebuilt after an op
+    // is added to its stack, or after an animated value one of its ops
+    // samples is edited through the bridge, since that can turn a folded
+    // constant into an animated op; the cache records which stacks sample
+    // each value for that. Entries go away with their stacks, ops and values.
+    class TransformProgramCache
+    {
+    public:
+        static TransformProgramCache&           shared();
+
+        // Program of `stack`, or nullptr if it needs compiling
+        std::shared_ptr<const TransformProgram> find(const void* stack);
+        // `generation` is the value of generation() read before compiling
+        void                                    store(const void* stack, std::shared_ptr<const TransformProgram> program,
+                                                      std::uint64_t generation);
+        void                                    invalidate(const void* stack);
+
+        // Bumped by every edit of an animated value, so that a program
+        // compiled across an edit is not stored
+        std::uint64_t                           generation() const;
+        void                                    touch();
+
+        // ModelIO does not expose the order of a rotate op, so the bridge
+        // records it when the op is added
+        void                                    setRotationOrder(const void* op, TransformProgram::Order order);
+        // 0 for an op the bridge did not add
+        std::uint8_t                            rotationOrder(const void* op);
+
+        // `stack` has an op sampling `value`; recorded when the stack is
+        // compiled, mirrored into the scene graph or given an op
+        void                                    addOwner(const void* value, const void* stack);
+        std::vector<const void*>                owners(const void* value);
+
+        void                                    clear();
+
+    private:
+        std::mutex                                  _mutex;
+        std::unordered_map<const void*, std::shared_ptr<const TransformProgram>> _programs;
+        std::unordered_map<const void*, std::uint8_t> _orders;
+        std::unordered_map<const void*, std::vector<const void*>> _owners;
+        std::atomic<std::uint64_t>                  _generation { 0 };
+
+        static void                                 evictStack(const void* stack);
+        static void                                 evictOp(const void* op);
+        static void                                 evictValue(const void* value);
+    };
+
+} // Private
+} // MDL
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// MARK: - Private Sector
+
+_MDL_INLINE constexpr NS::UInteger MDL::Private::TransformProgram::operandCount(Opcode opcode)
+{
+    switch (opcode)
+    {
+        case OpcodeRotateX:
+        case OpcodeRotateY:
+        case OpcodeRotateZ:
+            return 1;
+        case OpcodeTranslate:
+        case OpcodeScale:
+        case OpcodeRotate:
+            return 3;
+        case OpcodeOrient:
+            return 4;
+        case OpcodeMatrix:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+_MDL_INLINE void MDL::Private::TransformProgram::appendConstant(Opcode opcode, Order order, bool inverse, const double* values)
+{
+    double matrix[16] = { 1, 0, 0, 0,  0, 1, 0, 0,  0, 0, 1, 0,  0, 0, 0, 1 };
+    Instruction instruction = { opcode, order, inverse, nullptr, 0, 0 };
+    double sines[3];
+    double cosines[3];
+    if (opcode == OpcodeRotate)
+    {
+        sinCos(values, 3, sines, cosines);
+    }
+    else if (opcode == OpcodeRotateX || opcode == OpcodeRotateY || opcode == OpcodeRotateZ)
+    {
+        sinCos(values, 1, sines, cosines);
+    }
+    apply<double>(matrix, instruction, values, sines, cosines);
+
+    if (_instructions.empty() || _instructions.back().opcode != OpcodeConstant)
+    {
+        _instructions.push_back({ OpcodeConstant, OrderXYZ, false, nullptr, std::uint32_t(_constants.size()), 0 });
+        _constants.insert(_constants.end(), matrix, matrix + 16);
+        _constantsFloat.insert(_constantsFloat.end(), matrix, matrix + 16);
+        return;
+    }
+
+    double* folded = _constants.data() + _instructions.back().operand;
+    multiply(folded, matrix, folded);
+    for (int i = 0; i < 16; ++i)
+    {
+        _constantsFloat[_instructions.back().operand + i] = float(folded[i]);
+    }
+}
+
+_MDL_INLINE void MDL::Private::TransformProgram::appendAnimated(Opcode opcode, Order order, bool inverse, const void* source)
+{
+    _instructions.push_back({ opcode, order, inverse, source, _valueCount, _angleCount });
+    _valueCount += std::uint32_t(operandCount(opcode));
+    _angleCount += opcode == OpcodeRotate ? 3 : (opcode == OpcodeRotateX || opcode == OpcodeRotateY || opcode == OpcodeRotateZ);
+    ++_sampledCount;
+}
+
+_MDL_INLINE NS::UInteger MDL::Private::TransformProgram::instructionCount() const
+{
+    return _instructions.size();
+}
+
+_MDL_INLINE const MDL::Private::TransformProgram::Instruction* MDL::Private::TransformProgram::instructions() const
+{
+    return _instructions.data();
+}
+
+_MDL_INLINE NS::UInteger MDL::Private::TransformProgram::sampledCount() const
+{
+    return _sampledCount;
+}
+
+_MDL_INLINE bool MDL::Private::TransformProgram::fallback() const
+{
+    return _fallback;
+}
+
+_MDL_INLINE void MDL::Private::TransformProgram::setFallback(bool fallback)
+{
+    _fallback = fallback;
+}
+
+template <typename _Scalar>
+_MDL_INLINE const _Scalar* MDL::Private::TransformProgram::constants() const
+{
+    if constexpr (std::is_same<_Scalar, float>::value)
+    {
+        return _constantsFloat.data();
+    }
+    else
+    {
+        return _constants.data();
+    }
+}
+
+template <typename _Scalar, typename _Sampler>
+_MDL_INLINE void MDL::Private::TransformProgram::evaluate(double time, _Sampler&& sample, _Scalar* columns) const
+{
+    static thread_local std::vector<_Scalar> scratch;
+    scratch.resize(_valueCount + 3 * NS::UInteger(_angleCount));
+    _Scalar* values = scratch.data();
+    _Scalar* angles = values + _valueCount;
+    _Scalar* sines = angles + _angleCount;
+    _Scalar* cosines = sines + _angleCount;
+
+    for (const Instruction& instruction : _instructions)
+    {
+        if (instruction.source)
+        {
+            _Scalar* operands = values + instruction.operand;
+            sample(instruction, time, operands);
+            if (instruction.opcode == OpcodeRotate)
+            {
+                angles[instruction.angle + 0] = operands[0];
+                angles[instruction.angle + 1] = operands[1];
+                angles[instruction.angle + 2] = operands[2];
+            }
+            else if (instruction.opcode == OpcodeRotateX || instruction.opcode == OpcodeRotateY ||
+                     instruction.opcode == OpcodeRotateZ)
+            {
+                angles[instruction.angle] = operands[0];
+            }
+        }
+    }
+    sinCos(angles, _angleCount, sines, cosines);
+
+    for (int i = 0; i < 16; ++i)
+    {
+        columns[i] = _Scalar(i % 5 == 0);
+    }
+    for (const Instruction& instruction : _instructions)
+    {
+        if (instruction.opcode == OpcodeConstant)
+        {
+            multiply(columns, constants<_Scalar>() + instruction.operand, columns);
+        }
+        else
+        {
+            apply(columns, instruction, values + instruction.operand, sines + instruction.angle, cosines + instruction.angle);
+        }
+    }
+}
+
+// Right-multiplies the columns by a rotation about `axis`
+template <typename _Scalar>
+_MDL_INLINE void MDL::Private::TransformProgram::rotateColumns(_Scalar* columns, int axis, _Scalar sine, _Scalar cosine)
+{
+    // The two columns mixed by a rotation about x, y and z, in the order
+    // that keeps the sine signs the same for all three
+    static constexpr int first[3] = { 1, 2, 0 };
+    static constexpr int second[3] = { 2, 0, 1 };
+    _Scalar* a = columns + 4 * first[axis];
+    _Scalar* b = columns + 4 * second[axis];
+    for (int row = 0; row < 4; ++row)
+    {
+        const _Scalar ar = a[row];
+        const _Scalar br = b[row];
+        a[row] = ar * cosine + br * sine;
+        b[row] = br * cosine - ar * sine;
+    }
+}
+
+template <typename _Scalar>
+_MDL_INLINE void MDL::Private::TransformProgram::apply(_Scalar* columns, const Instruction& instruction, const _Scalar* values,
+                                                       const _Scalar* sines, const _Scalar* cosines)
+{
+    // Axes of each rotation order, in the order they are applied
+    static constexpr int axes[7][3] = { { 0, 1, 2 }, { 0, 1, 2 }, { 0, 2, 1 }, { 1, 0, 2 }, { 1, 2, 0 }, { 2, 0, 1 }, { 2, 1, 0 } };
+    const bool inverse = instruction.inverse;
+
+    switch (instruction.opcode)
+    {
+        case OpcodeTranslate:
+        {
+            const _Scalar sign = inverse ? _Scalar(-1) : _Scalar(1);
+            for (int row = 0; row < 4; ++row)
+            {
+                columns[12 + row] += sign * (columns[row] * values[0] + columns[4 + row] * values[1] + columns[8 + row] * values[2]);
+            }
+            break;
+        }
+        case OpcodeScale:
+        {
+            for (int column = 0; column < 3; ++column)
+            {
+                const _Scalar scale = inverse ? _Scalar(1) / values[column] : values[column];
+                for (int row = 0; row < 4; ++row)
+                {
+                    columns[4 * column + row] *= scale;
+                }
+            }
+            break;
+        }
+        case OpcodeRotateX:
+        case OpcodeRotateY:
+        case OpcodeRotateZ:
+        {
+            rotateColumns(columns, instruction.opcode - OpcodeRotateX, inverse ? -sines[0] : sines[0], cosines[0]);
+            break;
+        }
+        case OpcodeRotate:
+        {
+            // R = R3 * R2 * R1 for axes applied 1, 2, 3; its inverse applies
+            // the negated rotations the other way round
+            const int* order = axes[instruction.order <= OrderZYX ? instruction.order : OrderXYZ];
+            for (int step = 0; step < 3; ++step)
+            {
+                const int axis = inverse ? order[step] : order[2 - step];
+                rotateColumns(columns, axis, inverse ? -sines[axis] : sines[axis], cosines[axis]);
+            }
+            break;
+        }
+        case OpcodeOrient:
+        {
+            const _Scalar sign = inverse ? _Scalar(-1) : _Scalar(1);
+            const _Scalar x = sign * values[0];
+            const _Scalar y = sign * values[1];
+            const _Scalar z = sign * values[2];
+            const _Scalar w = values[3];
+            const _Scalar r[9] =
+            {
+                1 - 2 * (y * y + z * z), 2 * (x * y + z * w),     2 * (x * z - y * w),
+                2 * (x * y - z * w),     1 - 2 * (x * x + z * z), 2 * (y * z + x * w),
+                2 * (x * z + y * w),     2 * (y * z - x * w),     1 - 2 * (x * x + y * y),
+            };
+            _Scalar mixed[12];
+            for (int column = 0; column < 3; ++column)
+            {
+                for (int row = 0; row < 4; ++row)
+                {
+                    mixed[4 * column + row] = columns[row] * r[3 * column] + columns[4 + row] * r[3 * column + 1] +
+                                              columns[8 + row] * r[3 * column + 2];
+                }
+            }
+            for (int i = 0; i < 12; ++i)
+            {
+                columns[i] = mixed[i];
+            }
+            break;
+        }
+        case OpcodeMatrix:
+        {
+            if (inverse)
+            {
+                _Scalar inverted[16];
+                invert(values, inverted);
+                multiply(columns, inverted, columns);
+            }
+            else
+            {
+                multiply(columns, values, columns);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+template <typename _Scalar>
+_MDL_INLINE void MDL::Private::TransformProgram::multiply(const _Scalar* a, const _Scalar* b, _Scalar* out)
+{
+    _Scalar result[16];
+    for (int column = 0; column < 4; ++column)
+    {
+        for (int row = 0; row < 4; ++row)
+        {
+            result[4 * column + row] = a[row] * b[4 * column] + a[4 + row] * b[4 * column + 1] +
+                                       a[8 + row] * b[4 * column + 2] + a[12 + row] * b[4 * column + 3];
+        }
+    }
+    for (int i = 0; i < 16; ++i)
+    {
+        out[i] = result[i];
+    }
+}
+
+template <typename _Scalar>
+_MDL_INLINE void MDL::Private::TransformProgram::invert(const _Scalar* m, _Scalar* out)
+{
+    // 2x2 minors of the first two and last two columns
+    const _Scalar s0 = m[0] * m[5] - m[1] * m[4];
+    const _Scalar s1 = m[0] * m[6] - m[2] * m[4];
+    const _Scalar s2 = m[0] * m[7] - m[3] * m[4];
+    const _Scalar s3 = m[1] * m[6] - m[2] * m[5];
+    const _Scalar s4 = m[1] * m[7] - m[3] * m[5];
+    const _Scalar s5 = m[2] * m[7] - m[3] * m[6];
+    const _Scalar c5 = m[10] * m[15] - m[11] * m[14];
+    const _Scalar c4 = m[9] * m[15] - m[11] * m[13];
+    const _Scalar c3 = m[9] * m[14] - m[10] * m[13];
+    const _Scalar c2 = m[8] * m[15] - m[11] * m[12];
+    const _Scalar c1 = m[8] * m[14] - m[10] * m[12];
+    const _Scalar c0 = m[8] * m[13] - m[9] * m[12];
+
+    const _Scalar determinant = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    if (determinant == _Scalar(0))
+    {
+        for (int i = 0; i < 16; ++i)
+        {
+            out[i] = _Scalar(i % 5 == 0);
+        }
+        return;
+    }
+    const _Scalar d = _Scalar(1) / determinant;
+
+    const _Scalar result[16] =
+    {
+        ( m[5] * c5 - m[6] * c4 + m[7] * c3) * d,
+        (-m[1] * c5 + m[2] * c4 - m[3] * c3) * d,
+        ( m[13] * s5 - m[14] * s4 + m[15] * s3) * d,
+        (-m[9] * s5 + m[10] * s4 - m[11] * s3) * d,
+
+        (-m[4] * c5 + m[6] * c2 - m[7] * c1) * d,
+        ( m[0] * c5 - m[2] * c2 + m[3] * c1) * d,
+        (-m[12] * s5 + m[14] * s2 - m[15] * s1) * d,
+        ( m[8] * s5 - m[10] * s2 + m[11] * s1) * d,
+
+        ( m[4] * c4 - m[5] * c2 + m[7] * c0) * d,
+        (-m[0] * c4 + m[1] * c2 - m[3] * c0) * d,
+        ( m[12] * s4 - m[13] * s2 + m[15] * s0) * d,
+        (-m[8] * s4 + m[9] * s2 - m[11] * s0) * d,
+
+        (-m[4] * c3 + m[5] * c1 - m[6] * c0) * d,
+        ( m[0] * c3 - m[1] * c1 + m[2] * c0) * d,
+        (-m[12] * s3 + m[13] * s1 - m[14] * s0) * d,
+        ( m[8] * s3 - m[9] * s1 + m[10] * s0) * d,
+    };
+    for (int i = 0; i < 16; ++i)
+    {
+        out[i] = result[i];
+    }
+}
+
+_MDL_INLINE void MDL::Private::TransformProgram::sinCos(const double* angles, NS::UInteger count, double* sines, double* cosines)
+{
+    for (NS::UInteger i = 0; i < count; ++i)
+    {
+        sines[i] = std::sin(angles[i]);
+        cosines[i] = std::cos(angles[i]);
+    }
+}
+
+// Reduces by multiples of pi/2 in three parts and evaluates minimax
+// polynomials on [-pi/4, pi/4]; the quadrant picks which of the two
+// polynomials lands in sin and cos and their signs. Accurate to a couple of
+// ulps for the angles rigs use.
+_MDL_INLINE void MDL::Private::TransformProgram::sinCos(const float* angles, NS::UInteger count, float* sines, float* cosines)
+{
+    constexpr float TwoOverPi = 0.636619772367581343f;
+    constexpr float PiOverTwo0 = 1.5703125f;
+    constexpr float PiOverTwo1 = 4.837512969970703125e-4f;
+    constexpr float PiOverTwo2 = 7.54978995489188216e-8f;
+    constexpr float S0 = -1.6666654611e-1f, S1 = 8.3321608736e-3f, S2 = -1.9515295891e-4f;
+    constexpr float C0 = 4.166664568298827e-2f, C1 = -1.388731625493765e-3f, C2 = 2.443315711809948e-5f;
+
+    NS::UInteger i = 0;
+#if defined(_MDL_TRANSFORM_PROGRAM_SSE)
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i two = _mm_set1_epi32(2);
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128  x = _mm_loadu_ps(angles + i);
+        const __m128i q = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(TwoOverPi)));
+        const __m128  j = _mm_cvtepi32_ps(q);
+        __m128 y = _mm_sub_ps(x, _mm_mul_ps(j, _mm_set1_ps(PiOverTwo0)));
+        y = _mm_sub_ps(y, _mm_mul_ps(j, _mm_set1_ps(PiOverTwo1)));
+        y = _mm_sub_ps(y, _mm_mul_ps(j, _mm_set1_ps(PiOverTwo2)));
+        const __m128 z = _mm_mul_ps(y, y);
+
+        __m128 s = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(S2), z), _mm_set1_ps(S1));
+        s = _mm_add_ps(_mm_mul_ps(s, z), _mm_set1_ps(S0));
+        s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, z), y), y);
+        __m128 c = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(C2), z), _mm_set1_ps(C1));
+        c = _mm_add_ps(_mm_mul_ps(c, z), _mm_set1_ps(C0));
+        c = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(c, z), z), _mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(z, _mm_set1_ps(0.5f))));
+
+        const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, one), one));
+        const __m128 sine = _mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s));
+        const __m128 cosine = _mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c));
+        const __m128 sineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, two), 30));
+        const __m128 cosineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, one), two), 30));
+        _mm_storeu_ps(sines + i, _mm_xor_ps(sine, sineSign));
+        _mm_storeu_ps(cosines + i, _mm_xor_ps(cosine, cosineSign));
+    }
+#elif defined(_MDL_TRANSFORM_PROGRAM_NEON)
+    const uint32x4_t one = vdupq_n_u32(1);
+    const uint32x4_t two = vdupq_n_u32(2);
+    for (; i + 4 <= count; i += 4)
+    {
+        const float32x4_t x = vld1q_f32(angles + i);
+        const int32x4_t   q = vcvtnq_s32_f32(vmulq_n_f32(x, TwoOverPi));
+        const float32x4_t j = vcvtq_f32_s32(q);
+        float32x4_t y = vmlsq_n_f32(x, j, PiOverTwo0);
+        y = vmlsq_n_f32(y, j, PiOverTwo1);
+        y = vmlsq_n_f32(y, j, PiOverTwo2);
+        const float32x4_t z = vmulq_f32(y, y);
+
+        float32x4_t s = vmlaq_n_f32(vdupq_n_f32(S1), z, S2);
+        s = vmlaq_f32(vdupq_n_f32(S0), s, z);
+        s = vmlaq_f32(y, vmulq_f32(s, z), y);
+        float32x4_t c = vmlaq_n_f32(vdupq_n_f32(C1), z, C2);
+        c = vmlaq_f32(vdupq_n_f32(C0), c, z);
+        c = vmlaq_f32(vmlsq_n_f32(vdupq_n_f32(1.0f), z, 0.5f), vmulq_f32(c, z), z);
+
+        const uint32x4_t bits = vreinterpretq_u32_s32(q);
+        const uint32x4_t swap = vceqq_u32(vandq_u32(bits, one), one);
+        const float32x4_t sine = vbslq_f32(swap, c, s);
+        const float32x4_t cosine = vbslq_f32(swap, s, c);
+        const uint32x4_t sineSign = vshlq_n_u32(vandq_u32(bits, two), 30);
+        const uint32x4_t cosineSign = vshlq_n_u32(vandq_u32(vaddq_u32(bits, one), two), 30);
+        vst1q_f32(sines + i, vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(sine), sineSign)));
+        vst1q_f32(cosines + i, vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(cosine), cosineSign)));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        sines[i] = std::sin(angles[i]);
+        cosines[i] = std::cos(angles[i]);
+    }
+}
+
+_MDL_INLINE MDL::Private::TransformProgramCache& MDL::Private::TransformProgramCache::shared()
+{
+    static TransformProgramCache cache;
+    return cache;
+}
+
+_MDL_INLINE std::shared_ptr<const MDL::Private::TransformProgram> MDL::Private::TransformProgramCache::find(const void* stack)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _programs.find(stack);
+    return it == _programs.end() ? nullptr : it->second;
+}
+
+_MDL_INLINE void MDL::Private::TransformProgramCache::store(const void* stack, std::shared_ptr<const TransformProgram> program,
+                                                            std::uint64_t generation)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        // An edit while the program was compiled may not be in it
+        if (generation != _generation.load(std::memory_order_acquire))
+        {
+            return;
+        }
+        _programs[stack] = std::move(program);
+    }
+    ObjectLifetime::watch(stack, &_programs, &TransformProgramCache::evictStack);
+}
+
+_MDL_INLINE void MDL::Private::TransformProgramCache::invalidate(const void* stack)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _programs.erase(stack);
+}
+
+_MDL_INLINE std::uint64_t MDL::Private::TransformProgramCache::generation() const
+{
+    return _generation.load(std::memory_order_acquire);
+}
+
+_MDL_INLINE void MDL::Private::TransformProgramCache::touch()
+{
+    _generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+_MDL_INLINE void MDL::Private::TransformProgramCache::setRotationOrder(const void* op, TransformProgram::Order order)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _orders[op] = order;
+    }
+    ObjectLifetime::watch(op, &_orders, &TransformProgramCache::evictOp);
+}
+
+_MDL_INLINE std::uint8_t MDL::Private::TransformProgramCache::rotationOrder(const void* op)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _orders.find(op);
+    return it == _orders.end() ? 0 : it->second;
+}
+
+_MDL_INLINE void MDL::Private::TransformProgramCache::addOwner(const void* value, const void* stack)
+{
+    if (!value || !stack)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<const void*>& stacks = _owners[value];
+        if (std::find(stacks.begin(), stacks.end(), stack) != stacks.end())
+        {
+            return;
+        }
+        stacks.push_back(stack);
+    }
+    ObjectLifetime::watch(value, &_owners, &TransformProgramCache::evictValue);
+}
+
+_MDL_INLINE std::vector<const void*> MDL::Private::TransformProgramCache::owners(const void* value)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _owners.find(value);
+    return it == _owners.end() ? std::vector<const void*>() : it->second;
+}
+
+_MDL_INLINE void MDL::Private::TransformProgramCache::evictStack(const void* stack)
+{
+    TransformProgramCache&      cache = shared();
+    std::lock_guard<std::mutex> lock(cache._mutex);
+    cache._programs.erase(stack);
+}
+
+_MDL_INLINE void MDL::Private::TransformProgramCache::evictOp(const void* op)
+{
+    TransformProgramCache&      cache = shared();
+    std::lock_guard<std::mutex> lock(cache._mutex);
+    cache._orders.erase(op);
+}
+
+_MDL_INLINE void MDL::Private::TransformProgramCache::evictValue(const void* value)
+{
+    TransformProgramCache&      cache = shared();
+    std::lock_guard<std::mutex> lock(cache._mutex);
+    cache._owners.erase(value);
+}
+
+_MDL_INLINE void MDL::Private::TransformProgramCache::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _programs.clear();
+    _orders.clear();
+    _owners.clear();
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
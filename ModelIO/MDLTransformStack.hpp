@@ -11,6 +11,7 @@
 #import "MDLTypes.hpp"
 #import "MDLTransform.hpp"
 #import "MDLAnimatedValueTypes.hpp"
+#import "MDLTransformProgram.hpp"
 
 namespace MDL
 {
@@ -186,6 +187,21 @@ public:
     NS::Array*                          keyTimes() const;
     
     NS::Array*                          transformOps() const;
+    
+    // - Native
+    
+    // Drops the compiled program of the stack, for ops or animated values
+    // edited outside the bridge
+    void                                invalidateProgram();
+    
+private:
+    // The stack compiled into a flat program, built on first use
+    std::shared_ptr<const Private::TransformProgram>    program();
+    
+    // Values of the animated value `source` of an op at `time`
+    template <typename _Scalar>
+    static void                         sampleOperands(Private::TransformProgram::Opcode opcode, const void* source,
+                                                       NS::TimeInterval time, _Scalar* values);
 };
 
 }
@@ -442,57 +458,78 @@ _MDL_INLINE MDL::TransformStack* MDL::TransformStack::init()
 _MDL_INLINE MDL::TransformTranslateOp* MDL::TransformStack::addTranslateOp(const NS::String* animatedValueName,
                                                                  bool inverse)
 {
-    return Object::sendMessage<TransformTranslateOp*>(this, _MDL_PRIVATE_SEL(addTranslateOp_inverse_), animatedValueName, inverse);
+    TransformTranslateOp* op = Object::sendMessage<TransformTranslateOp*>(this, _MDL_PRIVATE_SEL(addTranslateOp_inverse_), animatedValueName, inverse);
+    invalidateProgram();
+    return op;
 }
 
 // method: addRotateXOp:inverse:
 _MDL_INLINE MDL::TransformRotateXOp* MDL::TransformStack::addRotateXOp(const NS::String* animatedValueName,
                                                                          bool inverse)
 {
-    return Object::sendMessage<TransformRotateXOp*>(this, _MDL_PRIVATE_SEL(addRotateXOp_inverse_), animatedValueName, inverse);
+    TransformRotateXOp* op = Object::sendMessage<TransformRotateXOp*>(this, _MDL_PRIVATE_SEL(addRotateXOp_inverse_), animatedValueName, inverse);
+    invalidateProgram();
+    return op;
 }
 
 // method: addRotateYOp:inverse:
 _MDL_INLINE MDL::TransformRotateYOp* MDL::TransformStack::addRotateYOp(const NS::String* animatedValueName,
                                                                        bool inverse)
 {
-    return Object::sendMessage<TransformRotateYOp*>(this, _MDL_PRIVATE_SEL(addRotateYOp_inverse_), animatedValueName, inverse);
+    TransformRotateYOp* op = Object::sendMessage<TransformRotateYOp*>(this, _MDL_PRIVATE_SEL(addRotateYOp_inverse_), animatedValueName, inverse);
+    invalidateProgram();
+    return op;
 }
 
 // method: addRotateZOp:inverse:
 _MDL_INLINE MDL::TransformRotateZOp* MDL::TransformStack::addRotateZOp(const NS::String* animatedValueName,
                                                                        bool inverse)
 {
-    return Object::sendMessage<TransformRotateZOp*>(this, _MDL_PRIVATE_SEL(addRotateZOp_inverse_), animatedValueName, inverse);
+    TransformRotateZOp* op = Object::sendMessage<TransformRotateZOp*>(this, _MDL_PRIVATE_SEL(addRotateZOp_inverse_), animatedValueName, inverse);
+    invalidateProgram();
+    return op;
 }
 
-// method: addRotateOp:inverse:
+// method: addRotateOp:order:inverse:
 _MDL_INLINE MDL::TransformRotateOp* MDL::TransformStack::addRotateOp(const NS::String* animatedValueName,
                                                                      TransformOpRotationOrder order,
                                                                      bool inverse)
 {
-    return Object::sendMessage<TransformRotateOp*>(this, _MDL_PRIVATE_SEL(addRotateOp_inverse_), animatedValueName, order, inverse);
+    TransformRotateOp* op = Object::sendMessage<TransformRotateOp*>(this, _MDL_PRIVATE_SEL(addRotateOp_order_inverse_),
+                                                                    animatedValueName, order, inverse);
+    if (op)
+    {
+        Private::TransformProgramCache::shared().setRotationOrder(op, Private::TransformProgram::Order(order));
+    }
+    invalidateProgram();
+    return op;
 }
 
 // method: addScaleOp:inverse:
 _MDL_INLINE MDL::TransformScaleOp* MDL::TransformStack::addScaleOp(const NS::String* animatedValueName,
                                                                    bool inverse)
 {
-    return Object::sendMessage<TransformScaleOp*>(this, _MDL_PRIVATE_SEL(addScaleOp_inverse_), animatedValueName, inverse);
+    TransformScaleOp* op = Object::sendMessage<TransformScaleOp*>(this, _MDL_PRIVATE_SEL(addScaleOp_inverse_), animatedValueName, inverse);
+    invalidateProgram();
+    return op;
 }
 
 // method: addMatrixOp:inverse:
 _MDL_INLINE MDL::TransformMatrixOp* MDL::TransformStack::addMatrixOp(const NS::String* animatedValueName,
                                                                      bool inverse)
 {
-    return Object::sendMessage<TransformMatrixOp*>(this, _MDL_PRIVATE_SEL(addMatrixOp_inverse_), animatedValueName, inverse);
+    TransformMatrixOp* op = Object::sendMessage<TransformMatrixOp*>(this, _MDL_PRIVATE_SEL(addMatrixOp_inverse_), animatedValueName, inverse);
+    invalidateProgram();
+    return op;
 }
 
 // method: addOrientOp:inverse:
 _MDL_INLINE MDL::TransformOrientOp* MDL::TransformStack::addOrientOp(const NS::String* animatedValueName,
                                                                      bool inverse)
 {
-    return Object::sendMessage<TransformOrientOp*>(this, _MDL_PRIVATE_SEL(addOrientOp_inverse_), animatedValueName, inverse);
+    TransformOrientOp* op = Object::sendMessage<TransformOrientOp*>(this, _MDL_PRIVATE_SEL(addOrientOp_inverse_), animatedValueName, inverse);
+    invalidateProgram();
+    return op;
 }
 
 // method: animatedValueWithName:
@@ -501,16 +538,38 @@ _MDL_INLINE MDL::AnimatedValue* MDL::TransformStack::animatedValueWithName(const
     return Object::sendMessage<AnimatedValue*>(this, _MDL_PRIVATE_SEL(animatedValueWithName_), name);
 }
 
-// method: float4x4AtTime:
+// native: float4x4AtTime:
 _MDL_INLINE matrix_float4x4 MDL::TransformStack::float4x4AtTime(NS::TimeInterval time)
 {
-    return Object::sendMessage<matrix_float4x4>(this, _MDL_PRIVATE_SEL(float4x4AtTime_), time);
+    std::shared_ptr<const Private::TransformProgram> compiled = program();
+    if (compiled->fallback())
+    {
+        return Object::sendMessage<matrix_float4x4>(this, _MDL_PRIVATE_SEL(float4x4AtTime_), time);
+    }
+    
+    matrix_float4x4 matrix;
+    compiled->evaluate<float>(time, [](const Private::TransformProgram::Instruction& instruction, double sampleTime, float* values)
+    {
+        sampleOperands<float>(instruction.opcode, instruction.source, sampleTime, values);
+    }, reinterpret_cast<float*>(&matrix.columns[0]));
+    return matrix;
 }
 
-// method: double4x4AtTime:
+// native: double4x4AtTime:
 _MDL_INLINE matrix_double4x4 MDL::TransformStack::double4x4AtTime(NS::TimeInterval time)
 {
-    return Object::sendMessage<matrix_double4x4>(this, _MDL_PRIVATE_SEL(double4x4AtTime_), time);
+    std::shared_ptr<const Private::TransformProgram> compiled = program();
+    if (compiled->fallback())
+    {
+        return Object::sendMessage<matrix_double4x4>(this, _MDL_PRIVATE_SEL(double4x4AtTime_), time);
+    }
+    
+    matrix_double4x4 matrix;
+    compiled->evaluate<double>(time, [](const Private::TransformProgram::Instruction& instruction, double sampleTime, double* values)
+    {
+        sampleOperands<double>(instruction.opcode, instruction.source, sampleTime, values);
+    }, reinterpret_cast<double*>(&matrix.columns[0]));
+    return matrix;
 }
 
 // property: keyTimes
@@ -525,6 +584,165 @@ _MDL_INLINE NS::Array* MDL::TransformStack::transformOps() const
     return Object::sendMessage<NS::Array*>(this, _MDL_PRIVATE_SEL(transformOps));
 }
 
+// native: invalidateProgram
+_MDL_INLINE void MDL::TransformStack::invalidateProgram()
+{
+    Private::recordStackValues(reinterpret_cast<const TransformComponent*>(this));
+    Private::TransformProgramCache::shared().invalidate(this);
+    Private::BoundsCache::shared().markDirty(this);
+    Private::syncSceneTransform(Private::SceneGraph::shared().findTransform(this), reinterpret_cast<const TransformComponent*>(this));
+}
+
+// native: sampleOperands
+template <typename _Scalar>
+_MDL_INLINE void MDL::TransformStack::sampleOperands(Private::TransformProgram::Opcode opcode, const void* source,
+                                                     NS::TimeInterval time, _Scalar* values)
+{
+    using Program = Private::TransformProgram;
+    constexpr bool single = std::is_same<_Scalar, float>::value;
+    
+    switch (opcode)
+    {
+        case Program::OpcodeRotateX:
+        case Program::OpcodeRotateY:
+        case Program::OpcodeRotateZ:
+            if constexpr (single)
+            {
+                values[0] = Object::sendMessage<float>(source, _MDL_PRIVATE_SEL(floatAtTime_), time);
+            }
+            else
+            {
+                values[0] = Object::sendMessage<double>(source, _MDL_PRIVATE_SEL(doubleAtTime_), time);
+            }
+            break;
+        case Program::OpcodeTranslate:
+        case Program::OpcodeScale:
+        case Program::OpcodeRotate:
+            if constexpr (single)
+            {
+                const vector_float3 value = Object::sendMessage<vector_float3>(source, _MDL_PRIVATE_SEL(float3AtTime_), time);
+                values[0] = value.x; values[1] = value.y; values[2] = value.z;
+            }
+            else
+            {
+                const vector_double3 value = Object::sendMessage<vector_double3>(source, _MDL_PRIVATE_SEL(double3AtTime_), time);
+                values[0] = value.x; values[1] = value.y; values[2] = value.z;
+            }
+            break;
+        case Program::OpcodeOrient:
+            if constexpr (single)
+            {
+                const simd_quatf value = Object::sendMessage<simd_quatf>(source, _MDL_PRIVATE_SEL(floatQuaternionAtTime_), time);
+                std::memcpy(values, &value.vector, sizeof(_Scalar) * 4);
+            }
+            else
+            {
+                const simd_quatd value = Object::sendMessage<simd_quatd>(source, _MDL_PRIVATE_SEL(doubleQuaternionAtTime_), time);
+                std::memcpy(values, &value.vector, sizeof(_Scalar) * 4);
+            }
+            break;
+        case Program::OpcodeMatrix:
+            // Also how ops the program has no native form for are sampled
+            if constexpr (single)
+            {
+                const matrix_float4x4 value = Object::sendMessage<matrix_float4x4>(source, _MDL_PRIVATE_SEL(float4x4AtTime_), time);
+                std::memcpy(values, &value.columns[0], sizeof(_Scalar) * 16);
+            }
+            else
+            {
+                const matrix_double4x4 value = Object::sendMessage<matrix_double4x4>(source, _MDL_PRIVATE_SEL(double4x4AtTime_), time);
+                std::memcpy(values, &value.columns[0], sizeof(_Scalar) * 16);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// native: program
+_MDL_INLINE std::shared_ptr<const MDL::Private::TransformProgram> MDL::TransformStack::program()
+{
+    using Program = Private::TransformProgram;
+    Private::TransformProgramCache& cache = Private::TransformProgramCache::shared();
+    if (std::shared_ptr<const Program> compiled = cache.find(this))
+    {
+        return compiled;
+    }
+    
+    const std::uint64_t generation = cache.generation();
+    auto compiled = std::make_shared<Program>();
+    
+    NS::Array* ops = transformOps();
+    const NS::UInteger count = ops ? ops->count() : 0;
+    for (NS::UInteger i = 0; i < count; ++i)
+    {
+        NS::Object*       op = ops->object(i);
+        const void*       cls = object_getClass(reinterpret_cast<id>(op));
+        Program::Order    order = Program::OrderXYZ;
+        Program::Opcode   opcode = Program::OpcodeMatrix;
+        if      (cls == _MDL_PRIVATE_CLS(MDLTransformTranslateOp)) opcode = Program::OpcodeTranslate;
+        else if (cls == _MDL_PRIVATE_CLS(MDLTransformScaleOp))     opcode = Program::OpcodeScale;
+        else if (cls == _MDL_PRIVATE_CLS(MDLTransformRotateXOp))   opcode = Program::OpcodeRotateX;
+        else if (cls == _MDL_PRIVATE_CLS(MDLTransformRotateYOp))   opcode = Program::OpcodeRotateY;
+        else if (cls == _MDL_PRIVATE_CLS(MDLTransformRotateZOp))   opcode = Program::OpcodeRotateZ;
+        else if (cls == _MDL_PRIVATE_CLS(MDLTransformOrientOp))    opcode = Program::OpcodeOrient;
+        else if (cls == _MDL_PRIVATE_CLS(MDLTransformRotateOp) && cache.rotationOrder(op))
+        {
+            opcode = Program::OpcodeRotate;
+            order = Program::Order(cache.rotationOrder(op));
+        }
+        
+        // Ops without a native form (a rotate op of unknown order) are
+        // sampled whole as a matrix, inverse included
+        const bool    native = opcode != Program::OpcodeMatrix || cls == _MDL_PRIVATE_CLS(MDLTransformMatrixOp);
+        AnimatedValue* value = Object::sendMessage<AnimatedValue*>(op, _MDL_PRIVATE_SEL(animatedValue));
+        cache.addOwner(value, this);
+        const void*   source = native ? static_cast<const void*>(value) : static_cast<const void*>(op);
+        const bool    inverse = native && Object::sendMessage<bool>(op, _MDL_PRIVATE_SEL(IsInverseOp));
+        if (value && value->isAnimated())
+        {
+            compiled->appendAnimated(opcode, order, inverse, source);
+        }
+        else
+        {
+            double values[16];
+            sampleOperands<double>(opcode, source, 0.0, values);
+            compiled->appendConstant(opcode, order, inverse, values);
+        }
+    }
+    
+    // Check the program against ModelIO at the first and last key time; a
+    // stack it disagrees with keeps being evaluated by ModelIO
+    NS::Array*       keyTimes = this->keyTimes();
+    NS::TimeInterval times[2] = { 0.0, 0.0 };
+    if (keyTimes && keyTimes->count())
+    {
+        times[0] = keyTimes->object<NS::Number>(0)->doubleValue();
+        times[1] = keyTimes->object<NS::Number>(keyTimes->count() - 1)->doubleValue();
+    }
+    for (NS::TimeInterval time : times)
+    {
+        double evaluated[16];
+        compiled->evaluate<double>(time, [](const Program::Instruction& instruction, double sampleTime, double* values)
+        {
+            sampleOperands<double>(instruction.opcode, instruction.source, sampleTime, values);
+        }, evaluated);
+        
+        const matrix_double4x4 expected = Object::sendMessage<matrix_double4x4>(this, _MDL_PRIVATE_SEL(double4x4AtTime_), time);
+        const double*          reference = reinterpret_cast<const double*>(&expected.columns[0]);
+        for (int e = 0; e < 16; ++e)
+        {
+            if (std::fabs(evaluated[e] - reference[e]) > 1e-4 * (1.0 + std::fabs(reference[e])))
+            {
+                compiled->setFallback(true);
+            }
+        }
+    }
+    
+    cache.store(this, compiled, generation);
+    return compiled;
+}
+
 
 
 
@@ -9,6 +9,9 @@
 #import "ModelIOExports.hpp"
 #include "MDLDefines.hpp"
 #include "MDLHeaderBridge.hpp"
+#include "MDLBoundsCache.hpp"
+#include "MDLSceneGraph.hpp"
+#include "MDLWorldTransforms.hpp"
 
 #import <Foundation/Foundation.hpp>
 #include <simd/simd.h>
@@ -91,6 +94,7 @@ public:
     class Object*           parent() const;
     
     class Object*           instance() const;
+    void                    setInstance(const MDL::Object* instance);
     
     NS::String*             path() const;
     
@@ -118,6 +122,37 @@ public:
     
     // boundingBoxAtTime:
     class AxisAlignedBoundingBox    boundingBoxAtTime(const NS::TimeInterval time);
+    
+    // - Native
+    // Bounds of the object and its children in the object's own space, served
+    // from a cache that transform, child and vertex buffer changes invalidate
+    // incrementally. Animated subtrees are sampled at their key times up front.
+    class AxisAlignedBoundingBox    localBoundingBoxAtTime(NS::TimeInterval time);
+    
+    void                            invalidateBoundingBox() const;
+    
+    // Node of the object in the native scene graph, importing it and
+    // everything below it from ModelIO on first use
+    Private::SceneGraph::NodeId     sceneNode() const;
+    
+    // Calls `fn(Object*)` for each object below this one that is kind of
+    // `objectClass` (every object for nullptr), in pre-order, until `fn`
+    // returns false. Subtrees holding no such class are skipped.
+    template <typename _Fn>
+    void                            forEachObjectOfClass(Class objectClass, _Fn&& fn) const;
+    
+    // Same, with subtrees spread over the worker pool; `fn` must be
+    // thread-safe and sees the objects in no particular order
+    template <typename _Fn>
+    void                            forEachObjectOfClassParallel(Class objectClass, _Fn&& fn) const;
+    
+    // Drops the object and everything below it from the scene graph, to be
+    // imported afresh; needed after changes made outside this bridge. A top
+    // level object loses its asset, so refresh those through the asset.
+    void                            invalidateSceneGraph() const;
+    
+private:
+    Private::BoundsCache::Box       computeLocalBounds(NS::TimeInterval time, std::vector<double>* keyTimes);
 };
 
 
@@ -159,7 +194,14 @@ _MDL_INLINE NS::String* MDL::Named::name() const
 // write method: setStrides:
 _MDL_INLINE void MDL::Named::setName(const NS::String* name)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setName_), name);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setName_), name);
+    
+    Private::SceneGraph& graph = Private::SceneGraph::shared();
+    const Private::SceneGraph::NodeId node = graph.find(this);
+    if (node != Private::SceneGraph::InvalidNode)
+    {
+        graph.setName(node, name ? name->utf8String() : "");
+    }
 }
 
 /*
@@ -169,13 +211,30 @@ _MDL_INLINE void MDL::Named::setName(const NS::String* name)
 // method: addObject:
 _MDL_INLINE void MDL::ObjectContainerComponent::addObject(const MDL::Object* object)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(addObject_), object);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(addObject_), object);
+    Private::BoundsCache::shared().markDirty(this);
+    
+    Private::SceneGraph& graph = Private::SceneGraph::shared();
+    const Private::SceneGraph::NodeId owner = graph.findContainer(this);
+    if (owner != Private::SceneGraph::InvalidNode && object)
+    {
+        graph.attach(object->sceneNode(), owner);
+    }
 }
 
-// method: addObject:
+// method: removeObject:
 _MDL_INLINE void MDL::ObjectContainerComponent::removeObject(const MDL::Object* object)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(removeObject_), object);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(removeObject_), object);
+    Private::BoundsCache::shared().markDirty(this);
+    
+    Private::SceneGraph& graph = Private::SceneGraph::shared();
+    const Private::SceneGraph::NodeId owner = graph.findContainer(this);
+    const Private::SceneGraph::NodeId node = graph.find(object);
+    if (owner != Private::SceneGraph::InvalidNode && node != Private::SceneGraph::InvalidNode && graph.parent(node) == owner)
+    {
+        graph.detach(node);
+    }
 }
 
 // method: objectAtIndexedSubscript:
@@ -11,6 +11,11 @@
 
 #include "MDLDefines.hpp"
 #include "MDLPrivate.hpp"
+#include "MDLMatrixBuffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
 
 namespace MDL
 {
@@ -36,9 +41,23 @@ public:
     void                            setDouble4x4Array(const matrix_double4x4* valuesArray, NS::UInteger count);
     
     
-    void                            getFloat4x4Array(const matrix_float4x4* valuesArray, NS::UInteger maxCount);
+    NS::UInteger                    getFloat4x4Array(const matrix_float4x4* valuesArray, NS::UInteger maxCount);
+    
+    NS::UInteger                    getDouble4x4Array(const matrix_double4x4* valuesArray, NS::UInteger maxCount);
+    
+    // - Native
+    
+    // Aligned native copy of the matrices, read once from ModelIO and kept
+    // until the array is next edited through the bridge; getFloat4x4Array
+    // and getDouble4x4Array read from it while it lasts
+    std::shared_ptr<const Matrix4x4Buffer>  buffer() const;
     
-    void                            getDouble4x4Array(const matrix_double4x4* valuesArray, NS::UInteger maxCount);
+    // Stores the matrices of `buffer` and keeps it as the native copy,
+    // shared rather than copied
+    void                            setBuffer(std::shared_ptr<const Matrix4x4Buffer> buffer);
+    
+    // Drops the native copy, for arrays edited outside the bridge
+    void                            invalidateBuffer();
 };
 
 }
@@ -48,18 +67,20 @@ public:
 // static method: alloc
 _MDL_INLINE MDL::Matrix4x4Array* MDL::Matrix4x4Array::alloc()
 {
-    return NS::Object::alloc<MDL::Matrix4x4Array>(_MDL_PRIVATE_CLS(MTLMatrix4x4Array));
+    return NS::Object::alloc<MDL::Matrix4x4Array>(_MDL_PRIVATE_CLS(MDLMatrix4x4Array));
 }
 
 // method: init
 _MDL_INLINE MDL::Matrix4x4Array* MDL::Matrix4x4Array::init()
 {
+    Private::MatrixBufferStore::shared().remove(this);
     return NS::Object::init<MDL::Matrix4x4Array>();
 }
 
 // method: initWithElementCount:
 _MDL_INLINE MDL::Matrix4x4Array* MDL::Matrix4x4Array::init(const NS::UInteger arrayElementCount)
 {
+    Private::MatrixBufferStore::shared().remove(this);
     return Object::sendMessage<MDL::Matrix4x4Array*>(this, _MDL_PRIVATE_SEL(initWithElementCount_), arrayElementCount);
 }
 
@@ -78,31 +99,110 @@ _MDL_INLINE MDL::DataPrecision MDL::Matrix4x4Array::precision() const
 // method: clear
 _MDL_INLINE void MDL::Matrix4x4Array::clear()
 {
-    return Object::sendMessage<void>( this, _MDL_PRIVATE_SEL(clear) );
+    Object::sendMessage<void>( this, _MDL_PRIVATE_SEL(clear) );
+    Private::MatrixBufferStore::shared().remove(this);
 }
 
 // method: setFloat4x4Array:count:
 _MDL_INLINE void MDL::Matrix4x4Array::setFloat4x4Array(const matrix_float4x4* valuesArray, NS::UInteger count)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setFloat4x4Array_count_), valuesArray, count);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setFloat4x4Array_count_), valuesArray, count);
+    Private::MatrixBufferStore::shared().remove(this);
 }
 
 // method: setDouble4x4Array:count:
 _MDL_INLINE void MDL::Matrix4x4Array::setDouble4x4Array(const matrix_double4x4* valuesArray, NS::UInteger count)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setDouble4x4Array_count_), valuesArray, count);
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setDouble4x4Array_count_), valuesArray, count);
+    Private::MatrixBufferStore::shared().remove(this);
 }
 
 // method: getFloat4x4Array:maxCount:
-_MDL_INLINE void MDL::Matrix4x4Array::getFloat4x4Array(const matrix_float4x4* valuesArray, NS::UInteger maxCount)
+_MDL_INLINE NS::UInteger MDL::Matrix4x4Array::getFloat4x4Array(const matrix_float4x4* valuesArray, NS::UInteger maxCount)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(getFloat4x4Array_maxCount_), valuesArray, maxCount);
+    if (std::shared_ptr<const Matrix4x4Buffer> buffer = Private::MatrixBufferStore::shared().find(this))
+    {
+        const NS::UInteger count = std::min(maxCount, buffer->count());
+        float*             out = reinterpret_cast<float*>(const_cast<matrix_float4x4*>(valuesArray));
+        if (buffer->floats())
+        {
+            std::memcpy(out, buffer->floats(), count * 16 * sizeof(float));
+        }
+        else
+        {
+            Private::MatrixKernels::narrow(buffer->doubles(), out, count * 16);
+        }
+        return count;
+    }
+    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getFloat4x4Array_maxCount_), valuesArray, maxCount);
 }
 
 // method: getDouble4x4Array:maxCount:
-_MDL_INLINE void MDL::Matrix4x4Array::getDouble4x4Array(const matrix_double4x4* valuesArray, NS::UInteger maxCount)
+_MDL_INLINE NS::UInteger MDL::Matrix4x4Array::getDouble4x4Array(const matrix_double4x4* valuesArray, NS::UInteger maxCount)
+{
+    if (std::shared_ptr<const Matrix4x4Buffer> buffer = Private::MatrixBufferStore::shared().find(this))
+    {
+        const NS::UInteger count = std::min(maxCount, buffer->count());
+        double*            out = reinterpret_cast<double*>(const_cast<matrix_double4x4*>(valuesArray));
+        if (buffer->doubles())
+        {
+            std::memcpy(out, buffer->doubles(), count * 16 * sizeof(double));
+        }
+        else
+        {
+            Private::MatrixKernels::widen(buffer->floats(), out, count * 16);
+        }
+        return count;
+    }
+    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getDouble4x4Array_maxCount_), valuesArray, maxCount);
+}
+
+// MARK: - Native
+
+// native: buffer
+_MDL_INLINE std::shared_ptr<const MDL::Matrix4x4Buffer> MDL::Matrix4x4Array::buffer() const
+{
+    if (std::shared_ptr<const Matrix4x4Buffer> buffer = Private::MatrixBufferStore::shared().find(this))
+    {
+        return buffer;
+    }
+    
+    const bool doubles = precision() == DataPrecisionDouble;
+    auto       buffer = std::make_shared<Matrix4x4Buffer>(elementCount(), doubles ? DataPrecisionDouble : DataPrecisionFloat);
+    if (doubles)
+    {
+        Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getDouble4x4Array_maxCount_), buffer->doubles(), buffer->count());
+    }
+    else
+    {
+        Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(getFloat4x4Array_maxCount_), buffer->floats(), buffer->count());
+    }
+    Private::MatrixBufferStore::shared().insert(this, buffer);
+    return buffer;
+}
+
+// native: setBuffer
+_MDL_INLINE void MDL::Matrix4x4Array::setBuffer(std::shared_ptr<const Matrix4x4Buffer> buffer)
+{
+    if (!buffer)
+    {
+        return clear();
+    }
+    if (buffer->doubles())
+    {
+        Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setDouble4x4Array_count_), buffer->doubles(), buffer->count());
+    }
+    else
+    {
+        Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setFloat4x4Array_count_), buffer->floats(), buffer->count());
+    }
+    Private::MatrixBufferStore::shared().insert(this, std::move(buffer));
+}
+
+// native: invalidateBuffer
+_MDL_INLINE void MDL::Matrix4x4Array::invalidateBuffer()
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(getDouble4x4Array_maxCount_), valuesArray, maxCount);
+    Private::MatrixBufferStore::shared().remove(this);
 }
 
 
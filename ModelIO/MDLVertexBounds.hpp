@@ -0,0 +1,556 @@
+/*!
+ @header MDLVertexBounds.hpp
+ @framework ModelIO
+ @abstract Min/max reduction over strided vertex attributes in their stored format
+ @copyright Treata Norouzi on 10/19/26.
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include "MDLDefines.hpp"
+#include "MDLParallel.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define _MDL_VERTEX_BOUNDS_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define _MDL_VERTEX_BOUNDS_NEON 1
+#endif
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace MDL
+{
+namespace Private
+{
+    enum class VertexComponent
+    {
+        Float,
+        Half,
+        Short,
+        UShort,
+        ShortNormalized,
+        UShortNormalized,
+        Char,
+        UChar,
+        CharNormalized,
+        UCharNormalized,
+    };
+
+    // Axis-aligned bounds of the first three components of `count` elements
+    // spaced `stride` bytes apart. Components beyond `componentCount` count as
+    // zero. Integer formats are reduced as integers and only the two results
+    // are converted, so normalized data never goes through a float pass.
+    // Returns false for an empty range.
+    bool                                vertexBounds(const void* data,
+                                                     NS::UInteger stride,
+                                                     NS::UInteger count,
+                                                     VertexComponent component,
+                                                     NS::UInteger componentCount,
+                                                     float* min,
+                                                     float* max);
+
+    // Ranges above this many elements are split across the worker pool
+    constexpr NS::UInteger              VertexBoundsParallelThreshold = 1 << 17;
+
+    float                               halfToFloat(std::uint16_t half);
+
+} // Private
+} // MDL
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// MARK: - Private Sector
+
+_MDL_INLINE float MDL::Private::halfToFloat(std::uint16_t half)
+{
+    const std::uint32_t sign = std::uint32_t(half & 0x8000) << 16;
+    const std::uint32_t exponent = (half >> 10) & 0x1F;
+    std::uint32_t       mantissa = half & 0x3FF;
+    std::uint32_t       bits;
+
+    if (exponent == 0x1F)
+    {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    }
+    else if (exponent != 0)
+    {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    else if (mantissa == 0)
+    {
+        bits = sign;
+    }
+    else
+    {
+        // Subnormal: renormalise into the float range
+        std::uint32_t shift = 0;
+        while (!(mantissa & 0x400))
+        {
+            mantissa <<= 1;
+            ++shift;
+        }
+        bits = sign | ((113 - shift) << 23) | ((mantissa & 0x3FF) << 13);
+    }
+
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+namespace MDL
+{
+namespace Private
+{
+    // Each reducer handles a run of elements whose vector loads stay inside
+    // the attribute: the last element is always finished with scalar loads,
+    // which read only the element's first `components` components (1-3).
+    // Results land in lanes 0-2 of `lo`/`hi`, as floats or as integers.
+
+    _MDL_INLINE void                    reduceFloat(const unsigned char* bytes, NS::UInteger stride, NS::UInteger begin,
+                                                    NS::UInteger end, NS::UInteger vectorEnd, NS::UInteger components,
+                                                    float* lo, float* hi)
+    {
+        NS::UInteger i = begin;
+#if defined(_MDL_VERTEX_BOUNDS_SSE)
+        if (i < vectorEnd)
+        {
+#if defined(__AVX2__)
+            // Two elements per 256-bit register, two registers in flight
+            const __m128 seedLo = _mm_setr_ps(lo[0], lo[1], lo[2], 0.0f);
+            const __m128 seedHi = _mm_setr_ps(hi[0], hi[1], hi[2], 0.0f);
+            __m256 lo0 = _mm256_set_m128(seedLo, seedLo), hi0 = _mm256_set_m128(seedHi, seedHi);
+            __m256 lo1 = lo0, hi1 = hi0;
+            for (; i + 4 <= vectorEnd; i += 4)
+            {
+                const __m256 a = _mm256_set_m128(_mm_loadu_ps(reinterpret_cast<const float*>(bytes + (i + 1) * stride)),
+                                                 _mm_loadu_ps(reinterpret_cast<const float*>(bytes + i * stride)));
+                const __m256 b = _mm256_set_m128(_mm_loadu_ps(reinterpret_cast<const float*>(bytes + (i + 3) * stride)),
+                                                 _mm_loadu_ps(reinterpret_cast<const float*>(bytes + (i + 2) * stride)));
+                lo0 = _mm256_min_ps(lo0, a);
+                hi0 = _mm256_max_ps(hi0, a);
+                lo1 = _mm256_min_ps(lo1, b);
+                hi1 = _mm256_max_ps(hi1, b);
+            }
+            lo0 = _mm256_min_ps(lo0, lo1);
+            hi0 = _mm256_max_ps(hi0, hi1);
+            __m128 vlo = _mm_min_ps(_mm256_castps256_ps128(lo0), _mm256_extractf128_ps(lo0, 1));
+            __m128 vhi = _mm_max_ps(_mm256_castps256_ps128(hi0), _mm256_extractf128_ps(hi0, 1));
+#else
+            __m128 vlo = _mm_setr_ps(lo[0], lo[1], lo[2], 0.0f), vhi = _mm_setr_ps(hi[0], hi[1], hi[2], 0.0f);
+            __m128 vlo1 = vlo, vhi1 = vhi;
+            for (; i + 2 <= vectorEnd; i += 2)
+            {
+                const __m128 a = _mm_loadu_ps(reinterpret_cast<const float*>(bytes + i * stride));
+                const __m128 b = _mm_loadu_ps(reinterpret_cast<const float*>(bytes + (i + 1) * stride));
+                vlo = _mm_min_ps(vlo, a);
+                vhi = _mm_max_ps(vhi, a);
+                vlo1 = _mm_min_ps(vlo1, b);
+                vhi1 = _mm_max_ps(vhi1, b);
+            }
+            vlo = _mm_min_ps(vlo, vlo1);
+            vhi = _mm_max_ps(vhi, vhi1);
+#endif
+            for (; i < vectorEnd; ++i)
+            {
+                const __m128 a = _mm_loadu_ps(reinterpret_cast<const float*>(bytes + i * stride));
+                vlo = _mm_min_ps(vlo, a);
+                vhi = _mm_max_ps(vhi, a);
+            }
+            alignas(16) float outLo[4], outHi[4];
+            _mm_store_ps(outLo, vlo);
+            _mm_store_ps(outHi, vhi);
+            std::copy(outLo, outLo + 3, lo);
+            std::copy(outHi, outHi + 3, hi);
+        }
+#elif defined(_MDL_VERTEX_BOUNDS_NEON)
+        if (i < vectorEnd)
+        {
+            const float seedLo[4] = { lo[0], lo[1], lo[2], 0.0f };
+            const float seedHi[4] = { hi[0], hi[1], hi[2], 0.0f };
+            float32x4_t vlo = vld1q_f32(seedLo), vhi = vld1q_f32(seedHi);
+            float32x4_t vlo1 = vlo, vhi1 = vhi;
+            for (; i + 2 <= vectorEnd; i += 2)
+            {
+                const float32x4_t a = vld1q_f32(reinterpret_cast<const float*>(bytes + i * stride));
+                const float32x4_t b = vld1q_f32(reinterpret_cast<const float*>(bytes + (i + 1) * stride));
+                vlo = vminq_f32(vlo, a);
+                vhi = vmaxq_f32(vhi, a);
+                vlo1 = vminq_f32(vlo1, b);
+                vhi1 = vmaxq_f32(vhi1, b);
+            }
+            vlo = vminq_f32(vlo, vlo1);
+            vhi = vmaxq_f32(vhi, vhi1);
+            for (; i < vectorEnd; ++i)
+            {
+                const float32x4_t a = vld1q_f32(reinterpret_cast<const float*>(bytes + i * stride));
+                vlo = vminq_f32(vlo, a);
+                vhi = vmaxq_f32(vhi, a);
+            }
+            float outLo[4], outHi[4];
+            vst1q_f32(outLo, vlo);
+            vst1q_f32(outHi, vhi);
+            std::copy(outLo, outLo + 3, lo);
+            std::copy(outHi, outHi + 3, hi);
+        }
+#endif
+        for (; i < end; ++i)
+        {
+            float p[3];
+            std::memcpy(p, bytes + i * stride, components * sizeof(float));
+            for (NS::UInteger axis = 0; axis < components; ++axis)
+            {
+                lo[axis] = std::min(lo[axis], p[axis]);
+                hi[axis] = std::max(hi[axis], p[axis]);
+            }
+        }
+    }
+
+    _MDL_INLINE void                    reduceHalf(const unsigned char* bytes, NS::UInteger stride, NS::UInteger begin,
+                                                   NS::UInteger end, NS::UInteger vectorEnd, NS::UInteger components,
+                                                   float* lo, float* hi)
+    {
+        NS::UInteger i = begin;
+#if defined(_MDL_VERTEX_BOUNDS_SSE) && defined(__F16C__)
+        if (i < vectorEnd)
+        {
+            __m128 vlo = _mm_setr_ps(lo[0], lo[1], lo[2], 0.0f), vhi = _mm_setr_ps(hi[0], hi[1], hi[2], 0.0f);
+            for (; i < vectorEnd; ++i)
+            {
+                const __m128 a = _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(bytes + i * stride)));
+                vlo = _mm_min_ps(vlo, a);
+                vhi = _mm_max_ps(vhi, a);
+            }
+            alignas(16) float outLo[4], outHi[4];
+            _mm_store_ps(outLo, vlo);
+            _mm_store_ps(outHi, vhi);
+            std::copy(outLo, outLo + 3, lo);
+            std::copy(outHi, outHi + 3, hi);
+        }
+#elif defined(_MDL_VERTEX_BOUNDS_NEON) && defined(__aarch64__)
+        if (i < vectorEnd)
+        {
+            const float seedLo[4] = { lo[0], lo[1], lo[2], 0.0f };
+            const float seedHi[4] = { hi[0], hi[1], hi[2], 0.0f };
+            float32x4_t vlo = vld1q_f32(seedLo), vhi = vld1q_f32(seedHi);
+            for (; i < vectorEnd; ++i)
+            {
+                const float32x4_t a = vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(reinterpret_cast<const std::uint16_t*>(bytes + i * stride))));
+                vlo = vminq_f32(vlo, a);
+                vhi = vmaxq_f32(vhi, a);
+            }
+            float outLo[4], outHi[4];
+            vst1q_f32(outLo, vlo);
+            vst1q_f32(outHi, vhi);
+            std::copy(outLo, outLo + 3, lo);
+            std::copy(outHi, outHi + 3, hi);
+        }
+#else
+        (void)vectorEnd;
+#endif
+        for (; i < end; ++i)
+        {
+            std::uint16_t h[3];
+            std::memcpy(h, bytes + i * stride, components * sizeof(std::uint16_t));
+            for (NS::UInteger axis = 0; axis < components; ++axis)
+            {
+                const float value = halfToFloat(h[axis]);
+                lo[axis] = std::min(lo[axis], value);
+                hi[axis] = std::max(hi[axis], value);
+            }
+        }
+    }
+
+    // 16-bit integers; unsigned data is biased into signed range so that
+    // SSE2's signed min/max apply to both. Vector accumulators start at the
+    // type's extremes and are folded into `lo`/`hi` afterwards.
+    _MDL_INLINE void                    reduceShort(const unsigned char* bytes, NS::UInteger stride, NS::UInteger begin,
+                                                    NS::UInteger end, NS::UInteger vectorEnd, NS::UInteger components,
+                                                    bool isUnsigned, std::int32_t* lo, std::int32_t* hi)
+    {
+        const std::int32_t bias = isUnsigned ? 0x8000 : 0;
+        NS::UInteger i = begin;
+#if defined(_MDL_VERTEX_BOUNDS_SSE)
+        if (i < vectorEnd)
+        {
+            const __m128i flip = _mm_set1_epi16(isUnsigned ? std::int16_t(0x8000) : 0);
+            __m128i vlo = _mm_set1_epi16(std::numeric_limits<std::int16_t>::max());
+            __m128i vhi = _mm_set1_epi16(std::numeric_limits<std::int16_t>::min());
+            for (; i < vectorEnd; ++i)
+            {
+                const __m128i a = _mm_xor_si128(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(bytes + i * stride)), flip);
+                vlo = _mm_min_epi16(vlo, a);
+                vhi = _mm_max_epi16(vhi, a);
+            }
+            alignas(16) std::int16_t outLo[8], outHi[8];
+            _mm_store_si128(reinterpret_cast<__m128i*>(outLo), vlo);
+            _mm_store_si128(reinterpret_cast<__m128i*>(outHi), vhi);
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                lo[axis] = std::min(lo[axis], std::int32_t(outLo[axis]) + bias);
+                hi[axis] = std::max(hi[axis], std::int32_t(outHi[axis]) + bias);
+            }
+        }
+#elif defined(_MDL_VERTEX_BOUNDS_NEON)
+        if (i < vectorEnd)
+        {
+            if (isUnsigned)
+            {
+                uint16x4_t vlo = vdup_n_u16(std::numeric_limits<std::uint16_t>::max()), vhi = vdup_n_u16(0);
+                for (; i < vectorEnd; ++i)
+                {
+                    const uint16x4_t a = vld1_u16(reinterpret_cast<const std::uint16_t*>(bytes + i * stride));
+                    vlo = vmin_u16(vlo, a);
+                    vhi = vmax_u16(vhi, a);
+                }
+                std::uint16_t outLo[4], outHi[4];
+                vst1_u16(outLo, vlo);
+                vst1_u16(outHi, vhi);
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    lo[axis] = std::min(lo[axis], std::int32_t(outLo[axis]));
+                    hi[axis] = std::max(hi[axis], std::int32_t(outHi[axis]));
+                }
+            }
+            else
+            {
+                int16x4_t vlo = vdup_n_s16(std::numeric_limits<std::int16_t>::max());
+                int16x4_t vhi = vdup_n_s16(std::numeric_limits<std::int16_t>::min());
+                for (; i < vectorEnd; ++i)
+                {
+                    const int16x4_t a = vld1_s16(reinterpret_cast<const std::int16_t*>(bytes + i * stride));
+                    vlo = vmin_s16(vlo, a);
+                    vhi = vmax_s16(vhi, a);
+                }
+                std::int16_t outLo[4], outHi[4];
+                vst1_s16(outLo, vlo);
+                vst1_s16(outHi, vhi);
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    lo[axis] = std::min(lo[axis], std::int32_t(outLo[axis]));
+                    hi[axis] = std::max(hi[axis], std::int32_t(outHi[axis]));
+                }
+            }
+        }
+#else
+        (void)vectorEnd;
+        (void)bias;
+#endif
+        for (; i < end; ++i)
+        {
+            for (NS::UInteger axis = 0; axis < components; ++axis)
+            {
+                std::int32_t value;
+                if (isUnsigned)
+                {
+                    std::uint16_t v;
+                    std::memcpy(&v, bytes + i * stride + axis * 2, 2);
+                    value = v;
+                }
+                else
+                {
+                    std::int16_t v;
+                    std::memcpy(&v, bytes + i * stride + axis * 2, 2);
+                    value = v;
+                }
+                lo[axis] = std::min(lo[axis], value);
+                hi[axis] = std::max(hi[axis], value);
+            }
+        }
+    }
+
+    _MDL_INLINE void                    reduceChar(const unsigned char* bytes, NS::UInteger stride, NS::UInteger begin,
+                                                   NS::UInteger end, NS::UInteger components, bool isUnsigned,
+                                                   std::int32_t* lo, std::int32_t* hi)
+    {
+        for (NS::UInteger i = begin; i < end; ++i)
+        {
+            for (NS::UInteger axis = 0; axis < components; ++axis)
+            {
+                const unsigned char raw = bytes[i * stride + axis];
+                const std::int32_t  value = isUnsigned ? std::int32_t(raw) : std::int32_t(static_cast<signed char>(raw));
+                lo[axis] = std::min(lo[axis], value);
+                hi[axis] = std::max(hi[axis], value);
+            }
+        }
+    }
+
+} // Private
+} // MDL
+
+_MDL_INLINE bool MDL::Private::vertexBounds(const void* data,
+                                            NS::UInteger stride,
+                                            NS::UInteger count,
+                                            VertexComponent component,
+                                            NS::UInteger componentCount,
+                                            float* min,
+                                            float* max)
+{
+    if (!data || count == 0)
+    {
+        return false;
+    }
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    const bool isFloat = component == VertexComponent::Float || component == VertexComponent::Half;
+
+    NS::UInteger componentSize = 1;
+    switch (component)
+    {
+        case VertexComponent::Float:
+            componentSize = 4;
+            break;
+        case VertexComponent::Half:
+        case VertexComponent::Short:
+        case VertexComponent::UShort:
+        case VertexComponent::ShortNormalized:
+        case VertexComponent::UShortNormalized:
+            componentSize = 2;
+            break;
+        default:
+            break;
+    }
+
+    // Vector paths load four components; element i may do so as long as the
+    // load ends inside the last element's own components
+    const NS::UInteger components = std::min<NS::UInteger>(componentCount, 3);
+    const NS::UInteger lastEnd = (count - 1) * stride + componentSize * components;
+    const NS::UInteger loadSize = componentSize * 4;
+    NS::UInteger       vectorCount = 0;
+    if (componentCount >= 3)
+    {
+        vectorCount = (lastEnd >= loadSize) ? std::min<NS::UInteger>((lastEnd - loadSize) / std::max<NS::UInteger>(stride, 1) + 1, count) : 0;
+    }
+
+    struct Partial
+    {
+        float           lo[3];
+        float           hi[3];
+        std::int32_t    ilo[3];
+        std::int32_t    ihi[3];
+    };
+
+    auto reduce = [&](Partial& partial, NS::UInteger begin, NS::UInteger end)
+    {
+        constexpr float inf = std::numeric_limits<float>::infinity();
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            partial.lo[axis] = inf;
+            partial.hi[axis] = -inf;
+            partial.ilo[axis] = std::numeric_limits<std::int32_t>::max();
+            partial.ihi[axis] = std::numeric_limits<std::int32_t>::min();
+        }
+
+        const NS::UInteger vectorEnd = std::max(begin, std::min(end, vectorCount));
+        switch (component)
+        {
+            case VertexComponent::Float:
+                reduceFloat(bytes, stride, begin, end, vectorEnd, components, partial.lo, partial.hi);
+                break;
+            case VertexComponent::Half:
+                reduceHalf(bytes, stride, begin, end, vectorEnd, components, partial.lo, partial.hi);
+                break;
+            case VertexComponent::Short:
+            case VertexComponent::ShortNormalized:
+                reduceShort(bytes, stride, begin, end, vectorEnd, components, false, partial.ilo, partial.ihi);
+                break;
+            case VertexComponent::UShort:
+            case VertexComponent::UShortNormalized:
+                reduceShort(bytes, stride, begin, end, vectorEnd, components, true, partial.ilo, partial.ihi);
+                break;
+            case VertexComponent::Char:
+            case VertexComponent::CharNormalized:
+                reduceChar(bytes, stride, begin, end, components, false, partial.ilo, partial.ihi);
+                break;
+            case VertexComponent::UChar:
+            case VertexComponent::UCharNormalized:
+                reduceChar(bytes, stride, begin, end, components, true, partial.ilo, partial.ihi);
+                break;
+        }
+    };
+
+    // Vector loads read components past `componentCount` as whatever follows
+    // in the element; narrow formats always take the scalar path, which stays
+    // inside the element, and missing axes are zeroed below
+    Partial total;
+    if (count > VertexBoundsParallelThreshold && componentCount >= 3)
+    {
+        constexpr NS::UInteger kGrain = 1 << 16;
+        std::vector<Partial>   partials((count + kGrain - 1) / kGrain);
+        parallelFor(count, kGrain, [&](NS::UInteger begin, NS::UInteger end)
+        {
+            // The pool may hand out several grains at once
+            for (NS::UInteger chunk = begin; chunk < end; chunk += kGrain)
+            {
+                reduce(partials[chunk / kGrain], chunk, std::min(chunk + kGrain, end));
+            }
+        });
+
+        total = partials.front();
+        for (const Partial& partial : partials)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                total.lo[axis] = std::min(total.lo[axis], partial.lo[axis]);
+                total.hi[axis] = std::max(total.hi[axis], partial.hi[axis]);
+                total.ilo[axis] = std::min(total.ilo[axis], partial.ilo[axis]);
+                total.ihi[axis] = std::max(total.ihi[axis], partial.ihi[axis]);
+            }
+        }
+    }
+    else
+    {
+        reduce(total, 0, count);
+    }
+
+    float scale = 1.0f, lowest = -std::numeric_limits<float>::infinity();
+    switch (component)
+    {
+        case VertexComponent::ShortNormalized:
+            scale = 1.0f / 32767.0f;
+            lowest = -1.0f;
+            break;
+        case VertexComponent::UShortNormalized:
+            scale = 1.0f / 65535.0f;
+            break;
+        case VertexComponent::CharNormalized:
+            scale = 1.0f / 127.0f;
+            lowest = -1.0f;
+            break;
+        case VertexComponent::UCharNormalized:
+            scale = 1.0f / 255.0f;
+            break;
+        default:
+            break;
+    }
+
+    for (NS::UInteger axis = 0; axis < 3; ++axis)
+    {
+        if (axis >= componentCount)
+        {
+            min[axis] = max[axis] = 0.0f;
+        }
+        else if (isFloat)
+        {
+            min[axis] = total.lo[axis];
+            max[axis] = total.hi[axis];
+        }
+        else
+        {
+            min[axis] = std::max(float(total.ilo[axis]) * scale, lowest);
+            max[axis] = std::max(float(total.ihi[axis]) * scale, lowest);
+        }
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
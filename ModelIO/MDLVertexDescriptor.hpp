@@ -138,8 +138,8 @@ public:
     MDL::VertexBufferLayout*            init(const NS::UInteger stride);
     
     // Read&Write
-    NS::UInteger*                        stride() const;
-    void                                 setStride(const NS::UInteger* stride);
+    NS::UInteger                        stride() const;
+    void                                setStride(const NS::UInteger stride);
 };
 
 // MARK: VertexAttribute
@@ -184,6 +184,8 @@ class VertexDescriptor : public NS::Copying<VertexDescriptor>
 public:
     static class VertexDescriptor*  alloc();
     
+    MDL::VertexDescriptor*          init();
+    
     // initVertexDescriptor:
     MDL::VertexDescriptor*          init(const MDL::VertexDescriptor* vertexDescriptor);
     
@@ -258,12 +260,12 @@ _MDL_INLINE MDL::VertexBufferLayout* MDL::VertexBufferLayout::init(const NS::UIn
 }
 
 // property: stride
-_MDL_INLINE NS::UInteger* MDL::VertexBufferLayout::stride() const
+_MDL_INLINE NS::UInteger MDL::VertexBufferLayout::stride() const
 {
-    return Object::sendMessage<NS::UInteger*>(this, _MDL_PRIVATE_SEL(stride));
+    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(stride));
 }
 // write method: setStrides:
-_MDL_INLINE void MDL::VertexBufferLayout::setStride(const NS::UInteger* stride)
+_MDL_INLINE void MDL::VertexBufferLayout::setStride(const NS::UInteger stride)
 {
     Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setStride_), stride);
 }
@@ -313,6 +315,17 @@ _MDL_INLINE void MDL::VertexAttribute::setOffset(const NS::UInteger offset)
     Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setOffset_), offset);
 }
 
+// property: bufferIndex
+_MDL_INLINE NS::UInteger MDL::VertexAttribute::bufferIndex() const
+{
+    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(bufferIndex));
+}
+// write method: setBufferIndex:
+_MDL_INLINE void MDL::VertexAttribute::setBufferIndex(const NS::UInteger bufferIndex)
+{
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setBufferIndex_), bufferIndex);
+}
+
 // property: time
 _MDL_INLINE NS::TimeInterval MDL::VertexAttribute::time() const
 {
@@ -341,6 +354,12 @@ _MDL_INLINE MDL::VertexDescriptor* MDL::VertexDescriptor::alloc()
     return NS::Object::alloc<MDL::VertexDescriptor>(_MDL_PRIVATE_CLS(MDLVertexDescriptor));
 }
 
+// method: init
+_MDL_INLINE MDL::VertexDescriptor* MDL::VertexDescriptor::init()
+{
+    return NS::Object::init<MDL::VertexDescriptor>();
+}
+
 // initVertexDescriptor:
 _MDL_INLINE MDL::VertexDescriptor* MDL::VertexDescriptor::init(const MDL::VertexDescriptor* vertexDescriptor)
 {
@@ -365,9 +384,17 @@ _MDL_INLINE void MDL::VertexDescriptor::removeAttributeNamed(const NS::String* n
     Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(removeAttributeNamed_), name);
 }
 
-// TODO: attributes
+// property: attributes
+_MDL_INLINE NS::Array* MDL::VertexDescriptor::attributes() const
+{
+    return Object::sendMessage<NS::Array*>(this, _MDL_PRIVATE_SEL(attributes));
+}
 
-// TODO: layouts
+// property: layouts
+_MDL_INLINE NS::Array* MDL::VertexDescriptor::layouts() const
+{
+    return Object::sendMessage<NS::Array*>(this, _MDL_PRIVATE_SEL(layouts));
+}
 
 // method: reset:
 _MDL_INLINE void MDL::VertexDescriptor::reset()
@@ -375,16 +402,16 @@ _MDL_INLINE void MDL::VertexDescriptor::reset()
     Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(reset_));
 }
 
-// method: setPackedStrides:
+// method: setPackedStrides
 _MDL_INLINE void MDL::VertexDescriptor::setPackedStrides()
 {
-    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setPackedStrides_));
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setPackedStrides));
 }
 
-// method: setPackedOffsets:
+// method: setPackedOffsets
 _MDL_INLINE void MDL::VertexDescriptor::setPackedOffsets()
 {
-    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setPackedOffsets_));
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setPackedOffsets));
 }
 
 
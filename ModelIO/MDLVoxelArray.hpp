@@ -10,8 +10,16 @@
 #include "MDLMeshBuffer.hpp"
 #include "MDLObject.hpp"
 #include "MDLAssetResolver.hpp"
+#include "MDLMesh.hpp"
+#include "MDLVoxelDistanceField.hpp"
+#include "MDLVoxelSurface.hpp"
+#include "MDLVoxelization.hpp"
 #include <simd/simd.h>
 
+#include <limits>
+#include <memory>
+#include <vector>
+
 namespace MDL
 {
 // !!!: Uncertain
@@ -27,6 +35,7 @@ class Mesh; // Forward-declaration
 
 class VoxelArray : public NS::Referencing<Object>
 {
+public:
     static class VoxelArray*        alloc();
     
     // initWithAsset:divisions:patchRadius:
@@ -91,6 +100,7 @@ class VoxelArray : public NS::Referencing<Object>
     
     AxisAlignedBoundingBox          boundingBox() const;
     
+    // Answered on the native grid, like their batched forms below
     // indexOfSpatialLocation:
     VoxelIndex                      indexOfSpatialLocation(vector_float3 location);
     
@@ -111,7 +121,8 @@ class VoxelArray : public NS::Referencing<Object>
     float                           shellFieldExteriorThickness() const;
     void                            setShellFieldExteriorThickness(float shellFieldExteriorThickness);
     
-    // !!!: Uncertain about the next 3
+    // Extracted natively, with positions and normals interleaved in one
+    // vertex buffer and a single submesh of 32-bit triangle indices
     // coarseMesh:
     class Mesh*                     coarseMesh();
     
@@ -121,6 +132,83 @@ class VoxelArray : public NS::Referencing<Object>
     // meshUsingAllocator:
     class Mesh*                     meshUsingAllocator(const class MeshBufferAllocator* allocator);
     
+    // - Native
+    // Placement of voxel indices: voxel (0, 0, 0) has its minimum corner at
+    // the origin. An array without voxels takes its grid from the first mesh
+    // voxelized into it.
+    VoxelGrid                       voxelGrid() const;
+    
+    // Voxels and shells in a sparse tree of 8^3 bitmask bricks, imported from
+    // ModelIO on first use. Counts, extents and voxel queries are answered
+    // from it, and voxels set through the bridge reach ModelIO only before a
+    // call that needs them there. Snapshots are not affected by later
+    // changes.
+    std::shared_ptr<const VoxelBrickMap> voxelBricks() const;
+    
+    // Drops the native occupancy after the array was changed behind the
+    // bridge's back
+    void                            invalidateVoxelBricks() const;
+    
+    // The three conversions above for many voxels at once, spread over the
+    // worker pool. Locations are voxel centers.
+    void                            indicesOfSpatialLocations(const vector_float3* locations, NS::UInteger count, VoxelIndex* indices) const;
+    void                            spatialLocationsOfIndices(const VoxelIndex* indices, NS::UInteger count, vector_float3* locations) const;
+    void                            voxelBoundingBoxesAtIndices(const VoxelIndex* indices, NS::UInteger count, AxisAlignedBoundingBox* boxes) const;
+    
+    // First voxel set along origin + t * direction for t within
+    // [0, maxDistance], with its shell, and the t where the ray enters it
+    bool                            firstVoxelAlongRay(vector_float3 origin, vector_float3 direction, float maxDistance,
+                                                       VoxelIndex& index, float& distance) const;
+    // Over the worker pool; misses get an infinite distance
+    void                            firstVoxelsAlongRays(const vector_float3* origins, const vector_float3* directions, NS::UInteger count,
+                                                         float maxDistance, VoxelIndex* indices, float* distances) const;
+    
+    // Distances behind the signed shell field, while the array is one. The
+    // shell of each voxel is its distance in voxels, rounded; the field
+    // interpolates the distances themselves.
+    std::shared_ptr<const VoxelDistanceField> distanceField() const;
+    
+    // The surface of the voxels themselves when coarse, cutting their faces
+    // on the bias; otherwise the zero level of the distance field, or of one
+    // built for the occasion while the array is not a signed shell field
+    void                            extractSurface(bool coarse, VoxelSurface& surface) const;
+    
+private:
+    std::shared_ptr<Private::VoxelArrayState> voxelState() const;
+    
+    static NS::Data*                voxelData(const std::vector<VoxelIndex>& voxels);
+    static NS::Data*                voxelData(const VoxelBrickMap& voxels);
+    
+    // Box for handing `voxels` to ModelIO on `grid`: it starts at the
+    // grid's origin, so voxel indices carry over, and reaches past the
+    // highest voxel
+    static AxisAlignedBoundingBox   gridBounds(const VoxelGrid& grid, const VoxelBrickMap& voxels);
+    
+    // Runs on the bricks at once; ModelIO gets the result when next flushed
+    void                            combineVoxels(const VoxelArray* voxels, VoxelBoolean operation);
+    
+    // Hands the bricks to ModelIO in one go, and then a pending conversion
+    // to a signed shell field, before it works on them or answers anything
+    // that depends on them
+    void                            flushVoxels() const;
+    
+    static Mesh*                    surfaceMesh(const VoxelSurface& surface, MeshBufferAllocator* allocator);
+    
+    // Around the voxels of shell zero, exact when the meshes voxelized are
+    // still at hand
+    static std::shared_ptr<const VoxelDistanceField> distanceField(const Private::VoxelArrayState& state,
+                                                                   float interiorThickness, float exteriorThickness);
+    
+    // Replaces the voxels with the band of a distance field around those of
+    // shell zero, and defers the conversion in ModelIO
+    void                            buildShellField(const std::shared_ptr<Private::VoxelArrayState>& state,
+                                                    float interiorThickness, float exteriorThickness);
+    
+    // Surface voxels of `mesh`, grown by the larger of the shell counts and
+    // the widths in voxels on either side
+    void                            voxelizeMesh(const Mesh* mesh, int divisions, float patchRadius,
+                                                 int interiorShells, int exteriorShells,
+                                                 float interiorWidth, float exteriorWidth);
 };
 
 }
@@ -136,12 +224,14 @@ _MDL_INLINE MDL::VoxelArray* MDL::VoxelArray::alloc()
 // method: initWithAsset:divisions:patchRadius:
 _MDL_INLINE MDL::VoxelArray* MDL::VoxelArray::init(const MDL::Asset* asset, int divisions, float patchRadius)
 {
+    Private::VoxelArrayStore::shared().remove(this);
     return Object::sendMessage<MDL::VoxelArray*>(this, _MDL_PRIVATE_SEL(initWithAsset_divisions_patchRadius_), asset, divisions, patchRadius);
 }
 
 // method: initWithData:boundingBox:voxelExtent:
 _MDL_INLINE MDL::VoxelArray* MDL::VoxelArray::init(const NS::Data* voxelData, MDL::AxisAlignedBoundingBox boundingBox, float voxelExtent)
 {
+    Private::VoxelArrayStore::shared().remove(this);
     return Object::sendMessage<MDL::VoxelArray*>(this, _MDL_PRIVATE_SEL(initWithData_boundingBox_voxelExtent_), voxelData, boundingBox, voxelExtent);
 }
 
@@ -152,6 +242,7 @@ _MDL_INLINE MDL::VoxelArray* MDL::VoxelArray::init(const MDL::Asset* asset,
                                                    int exteriorShells,
                                                    float patchRadius)
 {
+    Private::VoxelArrayStore::shared().remove(this);
     return Object::sendMessage<MDL::VoxelArray*>(this,
                                                  _MDL_PRIVATE_SEL(initWithAsset_divisions_interiorShells_exteriorShells_patchRadius_),
                                                  asset, divisions, interiorShells, exteriorShells, patchRadius);
@@ -160,13 +251,19 @@ _MDL_INLINE MDL::VoxelArray* MDL::VoxelArray::init(const MDL::Asset* asset,
 // property: count
 _MDL_INLINE NS::UInteger MDL::VoxelArray::count() const
 {
-    return Object::sendMessage<NS::UInteger>(this, _MDL_PRIVATE_SEL(count));
+    return voxelState()->bricks->count();
 }
 
 // property: voxelIndexExtent
 _MDL_INLINE MDL::VoxelIndexExtent MDL::VoxelArray::voxelIndexExtent() const
 {
-    return Object::sendMessage<VoxelIndexExtent>(this, _MDL_PRIVATE_SEL(voxelIndexExtent));
+    std::int32_t minimum[4] = { 0, 0, 0, 0 }, maximum[4] = { 0, 0, 0, 0 };
+    voxelState()->bricks->extent(minimum, maximum);
+    
+    VoxelIndexExtent extent;
+    extent.minimumExtent = VoxelIndex { minimum[0], minimum[1], minimum[2], minimum[3] };
+    extent.maximumExtent = VoxelIndex { maximum[0], maximum[1], maximum[2], maximum[3] };
+    return extent;
 }
 
 // method: voxelExistsAtIndex:allowAnyX:allowAnyY:allowAnyZ:allowAnyShell:
@@ -174,35 +271,62 @@ _MDL_INLINE BOOL MDL::VoxelArray::voxelExistsAtIndex(VoxelIndex index,
                                                      BOOL allowAnyX, BOOL allowAnyY, BOOL allowAnyZ,
                                                      BOOL allowAnyShell)
 {
-    return Object::sendMessage<BOOL>(this,
-                                     _MDL_PRIVATE_SEL(voxelExistsAtIndex_allowAnyX_allowAnyY_allowAnyZ_allowAnyShell_),
-                                     index,
-                                     allowAnyX, allowAnyY, allowAnyZ,
-                                     allowAnyShell);
+    const VoxelBrickMap& bricks = *voxelState()->bricks;
+    if (!allowAnyX && !allowAnyY && !allowAnyZ)
+    {
+        return bricks.test(index.x, index.y, index.z) && (allowAnyShell || bricks.shell(index.x, index.y, index.z) == index.w);
+    }
+    
+    constexpr std::int32_t lowest = std::numeric_limits<std::int32_t>::min();
+    constexpr std::int32_t highest = std::numeric_limits<std::int32_t>::max();
+    const std::int32_t     minimum[3] = { allowAnyX ? lowest : index.x, allowAnyY ? lowest : index.y, allowAnyZ ? lowest : index.z };
+    const std::int32_t     maximum[3] = { allowAnyX ? highest : index.x, allowAnyY ? highest : index.y, allowAnyZ ? highest : index.z };
+    const std::int32_t     shell = index.w;
+    return !bricks.forEachVoxelWithin(minimum, maximum, [&](std::int32_t, std::int32_t, std::int32_t, std::int32_t voxelShell)
+    {
+        return !allowAnyShell && voxelShell != shell;
+    });
 }
 
 // method: voxelsWithinExtent:
 _MDL_INLINE NS::Data* MDL::VoxelArray::voxelsWithinExtent(VoxelIndexExtent extent)
 {
-    return Object::sendMessage<NS::Data*>(this, _MDL_PRIVATE_SEL(voxelsWithinExtent_), extent);
+    const std::int32_t minimum[3] = { extent.minimumExtent.x, extent.minimumExtent.y, extent.minimumExtent.z };
+    const std::int32_t maximum[3] = { extent.maximumExtent.x, extent.maximumExtent.y, extent.maximumExtent.z };
+    
+    std::vector<VoxelIndex> voxels;
+    voxelState()->bricks->forEachVoxelWithin(minimum, maximum, [&](std::int32_t x, std::int32_t y, std::int32_t z, std::int32_t shell)
+    {
+        if (shell >= extent.minimumExtent.w && shell <= extent.maximumExtent.w)
+        {
+            voxels.push_back(VoxelIndex { x, y, z, shell });
+        }
+        return true;
+    });
+    return voxelData(voxels);
 }
 
 // method: voxelIndices
 _MDL_INLINE NS::Data* MDL::VoxelArray::voxelIndices()
 {
-    return Object::sendMessage<NS::Data*>(this, _MDL_PRIVATE_SEL(voxelIndices));
+    return voxelData(*voxelState()->bricks);
 }
 
 // method: setVoxelAtIndex
 _MDL_INLINE void MDL::VoxelArray::setVoxelAtIndex(VoxelIndex index)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setVoxelAtIndex_), index);
+    std::shared_ptr<Private::VoxelArrayState> state = voxelState();
+    state->writableBricks().set(index.x, index.y, index.z, index.w);
+    state->field.reset();
+    state->sourcePositions.clear();
+    state->sourceTriangles.clear();
+    state->modified = true;
 }
 
 // method: setVoxelsForMesh:divisions:patchRadius:
 _MDL_INLINE void MDL::VoxelArray::setVoxelsForMesh(const Mesh* mesh, int divisions, float patchRadius)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setVoxelsForMesh_divisions_patchRadius_), index);
+    voxelizeMesh(mesh, divisions, patchRadius, 0, 0, 0.0f, 0.0f);
 }
 
 // method: setVoxelsForMesh:divisions:interiorShells:exteriorShells:patchRadius:
@@ -212,9 +336,7 @@ _MDL_INLINE void MDL::VoxelArray::setVoxelsForMesh(const Mesh* mesh,
                                                    int exteriorShells,
                                                    float patchRadius)
 {
-    return Object::sendMessage<void>(this,
-                                     _MDL_PRIVATE_SEL(setVoxelsForMesh_divisions_interiorShells_exteriorShells_patchRadius_),
-                                     mesh, divisions, interiorShells, exteriorShells, patchRadius);
+    voxelizeMesh(mesh, divisions, patchRadius, interiorShells, exteriorShells, 0.0f, 0.0f);
 }
 
 // method: setVoxelsForMesh:divisions:interiorNBWidth:exteriorNBWidth:patchRadius:
@@ -224,103 +346,598 @@ _MDL_INLINE void MDL::VoxelArray::setVoxelsForMesh(const Mesh* mesh,
                                                    float exteriorNBWidth,
                                                    float patchRadius)
 {
-    return Object::sendMessage<void>(this,
-                                     _MDL_PRIVATE_SEL(setVoxelsForMesh_divisions_interiorNBWidth_exteriorNBWidth_patchRadius_),
-                                     mesh, divisions, interiorNBWidth, exteriorNBWidth, patchRadius);
+    voxelizeMesh(mesh, divisions, patchRadius, 0, 0, interiorNBWidth, exteriorNBWidth);
 }
 
 // method: unionWithVoxels:
 _MDL_INLINE void MDL::VoxelArray::unionWithVoxels(const VoxelArray* voxels)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(unionWithVoxels_), voxels);
+    combineVoxels(voxels, VoxelBooleanUnion);
 }
 
 // method: intersectWithVoxels:
 _MDL_INLINE void MDL::VoxelArray::intersectWithVoxels(const VoxelArray* voxels)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(intersectWithVoxels_), voxels);
+    combineVoxels(voxels, VoxelBooleanIntersection);
 }
 
 // method: differenceWithVoxels:
 _MDL_INLINE void MDL::VoxelArray::differenceWithVoxels(const VoxelArray* voxels)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(differenceWithVoxels_), voxels);
+    combineVoxels(voxels, VoxelBooleanDifference);
 }
 
 // property: boundingBox
 _MDL_INLINE MDL::AxisAlignedBoundingBox MDL::VoxelArray::boundingBox() const
 {
+    flushVoxels();
     return Object::sendMessage<AxisAlignedBoundingBox>(this, _MDL_PRIVATE_SEL(boundingBox));
 }
 
-// method: indexOfSpatialLocation:
+// native: indexOfSpatialLocation:
 _MDL_INLINE MDL::VoxelIndex MDL::VoxelArray::indexOfSpatialLocation(vector_float3 location)
 {
-    return Object::sendMessage<VoxelIndex>(this, _MDL_PRIVATE_SEL(indexOfSpatialLocation_), location);
+    VoxelIndex index;
+    indicesOfSpatialLocations(&location, 1, &index);
+    return index;
 }
 
-// method: spatialLocationOfIndex:
+// native: spatialLocationOfIndex:
 _MDL_INLINE vector_float3 MDL::VoxelArray::spatialLocationOfIndex(VoxelIndex index)
 {
-    return Object::sendMessage<vector_float3>(this, _MDL_PRIVATE_SEL(spatialLocationOfIndex_), index);
+    vector_float3 location;
+    spatialLocationsOfIndices(&index, 1, &location);
+    return location;
 }
 
-// method: voxelBoundingBoxAtIndex:
+// native: voxelBoundingBoxAtIndex:
 _MDL_INLINE MDL::AxisAlignedBoundingBox MDL::VoxelArray::voxelBoundingBoxAtIndex(VoxelIndex index)
 {
-    return Object::sendMessage<AxisAlignedBoundingBox>(this, _MDL_PRIVATE_SEL(voxelBoundingBoxAtIndex_), index);
+    AxisAlignedBoundingBox box;
+    voxelBoundingBoxesAtIndices(&index, 1, &box);
+    return box;
 }
 
-// method: convertToSignedShellField:
+// method: convertToSignedShellField
 _MDL_INLINE void MDL::VoxelArray::convertToSignedShellField()
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(convertToSignedShellField_));
+    // As thick as the shells the array already has, and at least a voxel
+    std::shared_ptr<Private::VoxelArrayState> state = voxelState();
+    std::int32_t                              minimum[4], maximum[4];
+    if (!state->bricks->extent(minimum, maximum))
+    {
+        minimum[3] = maximum[3] = 0;
+    }
+    buildShellField(state, float(std::max(-minimum[3], 1)) * state->grid.voxelSize, float(std::max(maximum[3], 1)) * state->grid.voxelSize);
 }
 
 // property: isValidSignedShellField
 _MDL_INLINE BOOL MDL::VoxelArray::isValidSignedShellField() const
 {
+    if (std::shared_ptr<Private::VoxelArrayState> state = Private::VoxelArrayStore::shared().find(this))
+    {
+        return state->field ? YES : NO;
+    }
     return Object::sendMessage<BOOL>(this, _MDL_PRIVATE_SEL(isValidSignedShellField));
 }
 
 // property: shellFieldInteriorThickness
 _MDL_INLINE float MDL::VoxelArray::shellFieldInteriorThickness() const
 {
+    std::shared_ptr<Private::VoxelArrayState> state = Private::VoxelArrayStore::shared().find(this);
+    if (state && state->field)
+    {
+        return state->field->interiorWidth();
+    }
     return Object::sendMessage<float>(this, _MDL_PRIVATE_SEL(shellFieldInteriorThickness));
 }
 // write method: setShellFieldInteriorThickness:
 _MDL_INLINE void MDL::VoxelArray::setShellFieldInteriorThickness(float shellFieldInteriorThickness)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setShellFieldInteriorThickness_), shellFieldInteriorThickness);
+    std::shared_ptr<Private::VoxelArrayState> state = Private::VoxelArrayStore::shared().find(this);
+    if (state && state->field)
+    {
+        return buildShellField(state, shellFieldInteriorThickness, state->field->exteriorWidth());
+    }
+    flushVoxels();
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setShellFieldInteriorThickness_), shellFieldInteriorThickness);
 }
 
 // property: shellFieldExteriorThickness
 _MDL_INLINE float MDL::VoxelArray::shellFieldExteriorThickness() const
 {
+    std::shared_ptr<Private::VoxelArrayState> state = Private::VoxelArrayStore::shared().find(this);
+    if (state && state->field)
+    {
+        return state->field->exteriorWidth();
+    }
     return Object::sendMessage<float>(this, _MDL_PRIVATE_SEL(shellFieldExteriorThickness));
 }
 // write method: setShellFieldExteriorThickness:
 _MDL_INLINE void MDL::VoxelArray::setShellFieldExteriorThickness(float shellFieldExteriorThickness)
 {
-    return Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setShellFieldExteriorThickness_), shellFieldExteriorThickness);
+    std::shared_ptr<Private::VoxelArrayState> state = Private::VoxelArrayStore::shared().find(this);
+    if (state && state->field)
+    {
+        return buildShellField(state, state->field->interiorWidth(), shellFieldExteriorThickness);
+    }
+    flushVoxels();
+    Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setShellFieldExteriorThickness_), shellFieldExteriorThickness);
 }
 
 // method: coarseMesh
 _MDL_INLINE MDL::Mesh* MDL::VoxelArray::coarseMesh()
 {
-    return Object::sendMessage<MDL::Mesh*>(this, _MDL_PRIVATE_SEL(coarseMesh));
+    MeshBufferDataAllocator* allocator = MeshBufferDataAllocator::alloc()->init();
+    Mesh*                    mesh = coarseMeshUsingAllocator(reinterpret_cast<MeshBufferAllocator*>(allocator));
+    allocator->release();
+    return mesh;
 }
 
 // method: coarseMeshUsingAllocator:
 _MDL_INLINE MDL::Mesh* MDL::VoxelArray::coarseMeshUsingAllocator(const class MeshBufferAllocator* allocator)
 {
-    return Object::sendMessage<MDL::Mesh*>(this, _MDL_PRIVATE_SEL(coarseMeshUsingAllocator_), allocator);
+    VoxelSurface surface;
+    extractSurface(true, surface);
+    return surfaceMesh(surface, const_cast<MeshBufferAllocator*>(allocator));
 }
 
 // method: meshUsingAllocator:
 _MDL_INLINE MDL::Mesh* MDL::VoxelArray::meshUsingAllocator(const class MeshBufferAllocator* allocator)
 {
-    return Object::sendMessage<MDL::Mesh*>(this, _MDL_PRIVATE_SEL(meshUsingAllocator_), allocator);
+    VoxelSurface surface;
+    extractSurface(false, surface);
+    return surfaceMesh(surface, const_cast<MeshBufferAllocator*>(allocator));
+}
+
+// native: voxelGrid
+_MDL_INLINE MDL::VoxelGrid MDL::VoxelArray::voxelGrid() const
+{
+    if (std::shared_ptr<Private::VoxelArrayState> state = Private::VoxelArrayStore::shared().find(this))
+    {
+        return state->grid;
+    }
+    
+    const VoxelIndex             origin = { 0, 0, 0, 0 };
+    const AxisAlignedBoundingBox voxel = Object::sendMessage<AxisAlignedBoundingBox>(this, _MDL_PRIVATE_SEL(voxelBoundingBoxAtIndex_), origin);
+    
+    VoxelGrid grid;
+    grid.origin[0] = voxel.minBounds.x;
+    grid.origin[1] = voxel.minBounds.y;
+    grid.origin[2] = voxel.minBounds.z;
+    grid.voxelSize = voxel.maxBounds.x - voxel.minBounds.x;
+    if (!(grid.voxelSize > 0.0f) || !std::isfinite(grid.voxelSize))
+    {
+        grid = VoxelGrid();
+    }
+    return grid;
+}
+
+// native: voxelBricks
+_MDL_INLINE std::shared_ptr<const MDL::VoxelBrickMap> MDL::VoxelArray::voxelBricks() const
+{
+    return voxelState()->bricks;
+}
+
+// native: invalidateVoxelBricks
+_MDL_INLINE void MDL::VoxelArray::invalidateVoxelBricks() const
+{
+    Private::VoxelArrayStore::shared().remove(this);
+}
+
+// native: indicesOfSpatialLocations
+_MDL_INLINE void MDL::VoxelArray::indicesOfSpatialLocations(const vector_float3* locations, NS::UInteger count, VoxelIndex* indices) const
+{
+    // simd vectors of three floats take the room of four
+    Private::voxelIndices(voxelGrid(), reinterpret_cast<const float*>(locations), count, reinterpret_cast<std::int32_t*>(indices));
+}
+
+// native: spatialLocationsOfIndices
+_MDL_INLINE void MDL::VoxelArray::spatialLocationsOfIndices(const VoxelIndex* indices, NS::UInteger count, vector_float3* locations) const
+{
+    Private::voxelCenters(voxelGrid(), reinterpret_cast<const std::int32_t*>(indices), count, reinterpret_cast<float*>(locations));
+}
+
+// native: voxelBoundingBoxesAtIndices
+_MDL_INLINE void MDL::VoxelArray::voxelBoundingBoxesAtIndices(const VoxelIndex* indices, NS::UInteger count, AxisAlignedBoundingBox* boxes) const
+{
+    Private::voxelBounds(voxelGrid(), reinterpret_cast<const std::int32_t*>(indices), count, reinterpret_cast<float*>(boxes));
+}
+
+// native: firstVoxelAlongRay
+_MDL_INLINE bool MDL::VoxelArray::firstVoxelAlongRay(vector_float3 origin, vector_float3 direction, float maxDistance,
+                                                     VoxelIndex& index, float& distance) const
+{
+    firstVoxelsAlongRays(&origin, &direction, 1, maxDistance, &index, &distance);
+    return std::isfinite(distance);
+}
+
+// native: firstVoxelsAlongRays
+_MDL_INLINE void MDL::VoxelArray::firstVoxelsAlongRays(const vector_float3* origins, const vector_float3* directions, NS::UInteger count,
+                                                       float maxDistance, VoxelIndex* indices, float* distances) const
+{
+    std::shared_ptr<Private::VoxelArrayState> state = voxelState();
+    std::shared_ptr<const VoxelBrickMap>      voxels = state->bricks;
+    const VoxelGrid                           grid = state->grid;
+    const float                               inverse = grid.voxelSize > 0.0f ? 1.0f / grid.voxelSize : 0.0f;
+    
+    // In voxel units t stays as it is
+    Private::parallelFor(count, 256, [&](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger i = begin; i < end; ++i)
+        {
+            const float* source = reinterpret_cast<const float*>(&origins[i]);
+            const float* toward = reinterpret_cast<const float*>(&directions[i]);
+            const float  origin[3] = { (source[0] - grid.origin[0]) * inverse, (source[1] - grid.origin[1]) * inverse,
+                                       (source[2] - grid.origin[2]) * inverse };
+            const float  direction[3] = { toward[0] * inverse, toward[1] * inverse, toward[2] * inverse };
+            
+            std::int32_t voxel[3];
+            float        t = 0.0f;
+            if (inverse > 0.0f && voxels->march(origin, direction, 0.0f, maxDistance, voxel, t))
+            {
+                indices[i] = VoxelIndex { voxel[0], voxel[1], voxel[2], voxels->shell(voxel[0], voxel[1], voxel[2]) };
+                distances[i] = t;
+            }
+            else
+            {
+                indices[i] = VoxelIndex { 0, 0, 0, 0 };
+                distances[i] = std::numeric_limits<float>::infinity();
+            }
+        }
+    });
+}
+
+// native: distanceField
+_MDL_INLINE std::shared_ptr<const MDL::VoxelDistanceField> MDL::VoxelArray::distanceField() const
+{
+    std::shared_ptr<Private::VoxelArrayState> state = Private::VoxelArrayStore::shared().find(this);
+    return state ? state->field : nullptr;
+}
+
+// native: extractSurface
+_MDL_INLINE void MDL::VoxelArray::extractSurface(bool coarse, VoxelSurface& surface) const
+{
+    std::shared_ptr<Private::VoxelArrayState> state = voxelState();
+    std::shared_ptr<const VoxelBrickMap>      voxels = state->bricks;
+    
+    // Cells below and beside the voxels reach them as corners
+    if (coarse)
+    {
+        VoxelBrickMap cells;
+        Private::Voxelizer::dilate(*voxels, cells);
+        Private::SurfaceNets::extract(cells, state->grid, 0.0f, [&](std::int32_t x, std::int32_t y, std::int32_t z, float& value)
+        {
+            value = voxels->test(x, y, z) ? -1.0f : 1.0f;
+            return true;
+        }, surface);
+        return;
+    }
+    
+    std::shared_ptr<const VoxelDistanceField> field = state->field;
+    if (!field)
+    {
+        field = distanceField(*state, state->grid.voxelSize * 1.5f, state->grid.voxelSize * 1.5f);
+    }
+    
+    Private::SurfaceNets::extract(field->band(), state->grid, 0.0f, [&](std::int32_t x, std::int32_t y, std::int32_t z, float& value)
+    {
+        return field->distance(x, y, z, value);
+    }, surface);
+}
+
+// native: surfaceMesh
+_MDL_INLINE MDL::Mesh* MDL::VoxelArray::surfaceMesh(const VoxelSurface& surface, MeshBufferAllocator* allocator)
+{
+    const NS::UInteger vertexCount = surface.positions.size() / 3;
+    const NS::UInteger stride = sizeof(float) * 6;
+    MeshBuffer*        vertexBuffer = allocator->newBuffer(vertexCount * stride, MeshBufferTypeVertex);
+    MeshBuffer*        indexBuffer = allocator->newBuffer(surface.indices.size() * sizeof(std::uint32_t), MeshBufferTypeIndex);
+    if (vertexCount)
+    {
+        MeshBufferMap* vertexMap = vertexBuffer->map();
+        float*         vertices = static_cast<float*>(vertexMap->bytes());
+        Private::parallelFor(vertexCount, 4096, [&](NS::UInteger begin, NS::UInteger end)
+        {
+            for (NS::UInteger v = begin; v < end; ++v)
+            {
+                std::memcpy(vertices + v * 6, &surface.positions[v * 3], sizeof(float) * 3);
+                std::memcpy(vertices + v * 6 + 3, &surface.normals[v * 3], sizeof(float) * 3);
+            }
+        });
+        
+        MeshBufferMap* indexMap = indexBuffer->map();
+        std::memcpy(indexMap->bytes(), surface.indices.data(), surface.indices.size() * sizeof(std::uint32_t));
+    }
+    
+    VertexDescriptor* descriptor = VertexDescriptor::alloc()->init();
+    VertexAttribute*  position = VertexAttribute::alloc()->init(VertexAttributePosition, VertexFormatFloat3, 0, 0);
+    VertexAttribute*  normal = VertexAttribute::alloc()->init(VertexAttributeNormal, VertexFormatFloat3, sizeof(float) * 3, 0);
+    descriptor->addOrReplaceAttribute(position);
+    descriptor->addOrReplaceAttribute(normal);
+    descriptor->setPackedStrides();
+    position->release();
+    normal->release();
+    
+    Submesh*          submesh = Submesh::alloc()->init(NS::String::string("", NS::UTF8StringEncoding), indexBuffer, surface.indices.size(),
+                                                       IndexBitDepthUInt32, GeometryTypeTriangles, nullptr);
+    const NS::Object* submeshObject = submesh;
+    NS::Array*        submeshes = NS::Array::alloc()->init(&submeshObject, 1);
+    Mesh*             mesh = Mesh::alloc()->init(vertexBuffer, vertexCount, descriptor, submeshes);
+    
+    submeshes->release();
+    submesh->release();
+    descriptor->release();
+    indexBuffer->release();
+    vertexBuffer->release();
+    return mesh->autorelease();
+}
+
+// native: voxelState
+_MDL_INLINE std::shared_ptr<MDL::Private::VoxelArrayState> MDL::VoxelArray::voxelState() const
+{
+    if (std::shared_ptr<Private::VoxelArrayState> state = Private::VoxelArrayStore::shared().find(this))
+    {
+        return state;
+    }
+    
+    std::shared_ptr<Private::VoxelArrayState> state = std::make_shared<Private::VoxelArrayState>();
+    state->grid = voxelGrid();
+    state->bricks = std::make_shared<VoxelBrickMap>();
+    
+    if (NS::Data* indices = Object::sendMessage<NS::Data*>(this, _MDL_PRIVATE_SEL(voxelIndices)))
+    {
+        const VoxelIndex*  voxels = static_cast<const VoxelIndex*>(indices->mutableBytes());
+        const NS::UInteger count = indices->length() / sizeof(VoxelIndex);
+        for (NS::UInteger v = 0; v < count; ++v)
+        {
+            state->bricks->set(voxels[v].x, voxels[v].y, voxels[v].z, voxels[v].w);
+        }
+    }
+    
+    Private::VoxelArrayStore::shared().insert(this, state);
+    return state;
+}
+
+// native: voxelData
+_MDL_INLINE NS::Data* MDL::VoxelArray::voxelData(const std::vector<VoxelIndex>& voxels)
+{
+    return Object::sendMessage<NS::Data*>(_MDL_PRIVATE_CLS(NSData), _MDL_PRIVATE_SEL(dataWithBytes_length_),
+                                          static_cast<const void*>(voxels.data()), NS::UInteger(voxels.size() * sizeof(VoxelIndex)));
+}
+
+// native: voxelData
+_MDL_INLINE NS::Data* MDL::VoxelArray::voxelData(const VoxelBrickMap& bricks)
+{
+    std::vector<VoxelIndex> voxels;
+    voxels.reserve(bricks.count());
+    for (NS::UInteger b = 0; b < bricks.brickCount(); ++b)
+    {
+        std::int32_t coordinate[3];
+        bricks.brickCoordinate(b, coordinate);
+        VoxelBrickMap::forEachVoxel(bricks.brickAt(b), coordinate, [&](std::int32_t x, std::int32_t y, std::int32_t z)
+        {
+            voxels.push_back(VoxelIndex { x, y, z, bricks.brickShell(b, (x & 7) | ((y & 7) << 3) | ((z & 7) << 6)) });
+        });
+    }
+    return voxelData(voxels);
+}
+
+// native: gridBounds
+_MDL_INLINE MDL::AxisAlignedBoundingBox MDL::VoxelArray::gridBounds(const VoxelGrid& grid, const VoxelBrickMap& voxels)
+{
+    std::int32_t minimum[4], maximum[4] = { 0, 0, 0, 0 };
+    voxels.extent(minimum, maximum);
+    
+    AxisAlignedBoundingBox bounds;
+    bounds.minBounds = vector_float3 { grid.origin[0], grid.origin[1], grid.origin[2] };
+    bounds.maxBounds = vector_float3 { grid.origin[0] + float(std::max(maximum[0], 0) + 1) * grid.voxelSize,
+                                       grid.origin[1] + float(std::max(maximum[1], 0) + 1) * grid.voxelSize,
+                                       grid.origin[2] + float(std::max(maximum[2], 0) + 1) * grid.voxelSize };
+    return bounds;
+}
+
+// native: combineVoxels
+_MDL_INLINE void MDL::VoxelArray::combineVoxels(const VoxelArray* voxels, VoxelBoolean operation)
+{
+    std::shared_ptr<const VoxelBrickMap>      other = voxels->voxelBricks();
+    std::shared_ptr<Private::VoxelArrayState> state = voxelState();
+    
+    state->writableBricks().combine(*other, operation);
+    state->modified = true;
+    state->field.reset();
+    state->sourcePositions.clear();
+    state->sourceTriangles.clear();
+}
+
+// native: buildShellField
+_MDL_INLINE void MDL::VoxelArray::buildShellField(const std::shared_ptr<Private::VoxelArrayState>& state,
+                                                  float interiorThickness, float exteriorThickness)
+{
+    const float                               size = state->grid.voxelSize;
+    std::shared_ptr<const VoxelDistanceField> field = distanceField(*state, interiorThickness, exteriorThickness);
+    
+    // Off the surface, shells round away from zero so they keep their side
+    std::shared_ptr<VoxelBrickMap> bricks = std::make_shared<VoxelBrickMap>();
+    bricks->reserve(field->band().brickCount());
+    field->band().forEachVoxel([&](std::int32_t x, std::int32_t y, std::int32_t z)
+    {
+        float distance = 0.0f;
+        field->distance(x, y, z, distance);
+        
+        std::int32_t shell = 0;
+        if (!field->isSurface(x, y, z))
+        {
+            shell = std::int32_t(std::max(std::fabs(std::round(distance / size)), 1.0f));
+            shell = std::min<std::int32_t>(shell, std::numeric_limits<std::int16_t>::max());
+            shell = distance < 0.0f ? -shell : shell;
+        }
+        bricks->set(x, y, z, shell);
+    });
+    
+    state->bricks = bricks;
+    state->field = field;
+    
+    state->modified = true;
+    state->shellField = true;
+    state->interiorThickness = field->interiorWidth();
+    state->exteriorThickness = field->exteriorWidth();
+}
+
+// native: flushVoxels
+_MDL_INLINE void MDL::VoxelArray::flushVoxels() const
+{
+    std::shared_ptr<Private::VoxelArrayState> state = Private::VoxelArrayStore::shared().find(this);
+    if (!state || (!state->modified && !state->shellField))
+    {
+        return;
+    }
+    
+    // ModelIO keys voxels by index and shell: intersecting with the bricks
+    // drops those no longer set, and the union adds the rest
+    if (state->modified)
+    {
+        VoxelArray* voxels = VoxelArray::alloc()->init(voxelData(*state->bricks), gridBounds(state->grid, *state->bricks), state->grid.voxelSize);
+        Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(intersectWithVoxels_), voxels);
+        Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(unionWithVoxels_), voxels);
+        voxels->release();
+    }
+    
+    // ModelIO derives its own distances; only the thickness carries over
+    if (state->shellField)
+    {
+        if (!Object::sendMessage<BOOL>(this, _MDL_PRIVATE_SEL(isValidSignedShellField)))
+        {
+            Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(convertToSignedShellField));
+        }
+        Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setShellFieldInteriorThickness_), state->interiorThickness);
+        Object::sendMessage<void>(this, _MDL_PRIVATE_SEL(setShellFieldExteriorThickness_), state->exteriorThickness);
+    }
+    
+    state->modified = false;
+    state->shellField = false;
+}
+
+// native: distanceField
+_MDL_INLINE std::shared_ptr<const MDL::VoxelDistanceField> MDL::VoxelArray::distanceField(const Private::VoxelArrayState& state,
+                                                                                        float interiorThickness, float exteriorThickness)
+{
+    const VoxelBrickMap& voxels = *state.bricks;
+    
+    VoxelBrickMap surface;
+    for (NS::UInteger b = 0; b < voxels.brickCount(); ++b)
+    {
+        std::int32_t coordinate[3];
+        voxels.brickCoordinate(b, coordinate);
+        VoxelBrickMap::forEachVoxel(voxels.brickAt(b), coordinate, [&](std::int32_t x, std::int32_t y, std::int32_t z)
+        {
+            if (voxels.brickShell(b, (x & 7) | ((y & 7) << 3) | ((z & 7) << 6)) == 0)
+            {
+                surface.set(x, y, z);
+            }
+        });
+    }
+    
+    std::shared_ptr<BoundingVolumeHierarchy> hierarchy;
+    VoxelDistanceField::Source               source = {};
+    if (!state.sourceTriangles.empty())
+    {
+        hierarchy = BoundingVolumeHierarchy::build(state.sourcePositions.data(), sizeof(float) * 3, state.sourcePositions.size() / 3,
+                                                   state.sourceTriangles.data(), state.sourceTriangles.size());
+        source.triangles = { state.sourcePositions.data(), sizeof(float) * 3, state.sourceTriangles.data(), state.sourceTriangles.size() / 3 };
+        source.hierarchy = hierarchy.get();
+    }
+    
+    return VoxelDistanceField::build(state.grid, surface, &voxels, hierarchy ? &source : nullptr, interiorThickness, exteriorThickness);
+}
+
+// native: voxelizeMesh
+_MDL_INLINE void MDL::VoxelArray::voxelizeMesh(const Mesh* mesh, int divisions, float patchRadius,
+                                               int interiorShells, int exteriorShells,
+                                               float interiorWidth, float exteriorWidth)
+{
+    Mesh*                source = const_cast<Mesh*>(mesh);
+    VertexAttributeData* positionData = source ? source->vertexAttributeDataForAttributeNamed(VertexAttributePosition, VertexFormatFloat3) : nullptr;
+    if (!positionData || divisions <= 0)
+    {
+        return;
+    }
+    
+    const unsigned char* bytes = static_cast<const unsigned char*>(positionData->dataStart());
+    const NS::UInteger   stride = positionData->stride();
+    const NS::UInteger   vertexCount = source->vertexCount();
+    
+    std::vector<std::uint32_t> triangles, rangeOffsets;
+    Private::meshTriangles(source, triangles, rangeOffsets);
+    if (triangles.empty())
+    {
+        return;
+    }
+    
+    // An array without a grid yet divides the vertical extent of the mesh,
+    // falling back to its longest side for flat meshes
+    std::shared_ptr<Private::VoxelArrayState> state = voxelState();
+    if (!(state->grid.voxelSize > 0.0f))
+    {
+        float low[3] = { INFINITY, INFINITY, INFINITY }, high[3] = { -INFINITY, -INFINITY, -INFINITY };
+        for (NS::UInteger v = 0; v < vertexCount; ++v)
+        {
+            const float* p = reinterpret_cast<const float*>(bytes + v * stride);
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                low[axis] = std::min(low[axis], p[axis]);
+                high[axis] = std::max(high[axis], p[axis]);
+            }
+        }
+        
+        const float height = high[1] - low[1];
+        const float longest = std::max(high[0] - low[0], std::max(height, high[2] - low[2]));
+        state->grid.voxelSize = (height > 0.0f ? height : longest) / float(divisions);
+        if (!(state->grid.voxelSize > 0.0f))
+        {
+            state->grid = VoxelGrid();
+            return;
+        }
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            state->grid.origin[axis] = low[axis];
+        }
+    }
+    
+    const Private::Voxelizer::Triangles input = { reinterpret_cast<const float*>(bytes), stride, triangles.data(), triangles.size() / 3 };
+    const int interior = std::max(interiorShells, int(std::ceil(interiorWidth / state->grid.voxelSize)));
+    const int exterior = std::max(exteriorShells, int(std::ceil(exteriorWidth / state->grid.voxelSize)));
+    
+    VoxelBrickMap surface;
+    Private::Voxelizer::surface(input, state->grid, patchRadius, surface);
+    
+    std::vector<VoxelBrickMap> layers;
+    Private::Voxelizer::shells(input, state->grid, surface, interior, exterior, layers);
+    
+    if (state->bricks->count() == 0 || !state->sourceTriangles.empty())
+    {
+        const std::uint32_t base = std::uint32_t(state->sourcePositions.size() / 3);
+        for (NS::UInteger v = 0; v < vertexCount; ++v)
+        {
+            const float* p = reinterpret_cast<const float*>(bytes + v * stride);
+            state->sourcePositions.insert(state->sourcePositions.end(), p, p + 3);
+        }
+        for (std::uint32_t index : triangles)
+        {
+            state->sourceTriangles.push_back(base + index);
+        }
+    }
+    state->field.reset();
+    
+    // Voxels the array already holds keep their shell
+    VoxelBrickMap& bricks = state->writableBricks();
+    for (NS::UInteger layer = 0; layer < layers.size(); ++layer)
+    {
+        const std::int32_t shell = std::int32_t(layer) - interior;
+        layers[layer].fillShells(shell);
+        bricks.merge(layers[layer]);
+    }
+    state->modified = true;
 }
 
 
@@ -0,0 +1,494 @@
+/*!
+ @header MDLVoxelDistanceField.hpp
+ @framework ModelIO
+ @abstract Narrow-band signed distance fields over sparse voxel bricks
+ @copyright Treata Norouzi on 10/19/26.
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include "MDLDefines.hpp"
+#include "MDLAlignedAllocator.hpp"
+#include "MDLBoundingVolumeHierarchy.hpp"
+#include "MDLParallel.hpp"
+#include "MDLVoxelization.hpp"
+#include "Foundation/NSTypes.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <vector>
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace MDL
+{
+// Signed distances from voxel centers to a surface, negative inside, kept
+// only in a band `interiorWidth` deep inside and `exteriorWidth` out. Voxels
+// next to the surface take the closest point of the source triangles when
+// there are any, the center of the nearest surface voxel otherwise, and jump
+// flooding (Rong and Tan) carries those closest points across the band in
+// log2(width) passes over its bricks rather than sweeps over the whole grid.
+class VoxelDistanceField
+{
+public:
+    // Triangles the surface was voxelized from, with a hierarchy over them
+    struct Source
+    {
+        Private::Voxelizer::Triangles       triangles;
+        const BoundingVolumeHierarchy*      hierarchy;
+    };
+
+    // `surface` holds the voxels the surface passes through. Sides come from
+    // the parity of `source` when given; otherwise from the signs of the
+    // shells in `shells`, spread through the band around the surface, with
+    // voxels no side reaches taken as outside.
+    static std::shared_ptr<VoxelDistanceField> build(const VoxelGrid& grid, const VoxelBrickMap& surface,
+                                                     const VoxelBrickMap* shells, const Source* source,
+                                                     float interiorWidth, float exteriorWidth);
+
+    const VoxelGrid&                        grid() const;
+    float                                   interiorWidth() const;
+    float                                   exteriorWidth() const;
+    // Voxels with a distance; the surface voxels always are
+    const VoxelBrickMap&                    band() const;
+    bool                                    isSurface(std::int32_t x, std::int32_t y, std::int32_t z) const;
+
+    // At the center of a voxel; false outside the band
+    bool                                    distance(std::int32_t x, std::int32_t y, std::int32_t z, float& distance) const;
+
+    // Trilinear between the eight voxel centers around `position`, with the
+    // gradient of that interpolation; false when one of them is outside the
+    // band
+    bool                                    sample(const float* position, float& distance, float* gradient = nullptr) const;
+    // Float3 positions `stride` bytes apart, spread over the worker pool;
+    // infinity where sample() fails
+    void                                    sample(const float* positions, NS::UInteger stride, NS::UInteger count, float* distances) const;
+
+private:
+    static constexpr int                    BrickVoxels = VoxelBrickMap::BrickSize * VoxelBrickMap::BrickSize * VoxelBrickMap::BrickSize;
+
+    struct Seed
+    {
+        float                               point[3];
+    };
+
+    // One jump flooding pass at `step` voxels
+    void                                    flood(int step, const std::vector<Seed>& from, std::vector<Seed>& to) const;
+    // Sides of every band voxel from the shells, by brick and bit
+    void                                    spreadSides(const VoxelBrickMap& shells, std::vector<std::int8_t>& sides) const;
+    void                                    center(std::int32_t x, std::int32_t y, std::int32_t z, float* point) const;
+
+    VoxelGrid                               _grid;
+    float                                   _interiorWidth = 0.0f;
+    float                                   _exteriorWidth = 0.0f;
+    VoxelBrickMap                           _band;
+    VoxelBrickMap                           _surface;
+    // BrickVoxels per brick of _band, by bit
+    Private::AlignedVector<float>           _distances;
+};
+
+}
+
+// MARK: - Private Sector
+
+_MDL_INLINE std::shared_ptr<MDL::VoxelDistanceField> MDL::VoxelDistanceField::build(const VoxelGrid& grid, const VoxelBrickMap& surface,
+                                                                                   const VoxelBrickMap* shells, const Source* source,
+                                                                                   float interiorWidth, float exteriorWidth)
+{
+    std::shared_ptr<VoxelDistanceField> field = std::make_shared<VoxelDistanceField>();
+    field->_grid = grid;
+    field->_interiorWidth = std::max(interiorWidth, 0.0f);
+    field->_exteriorWidth = std::max(exteriorWidth, 0.0f);
+
+    const float size = grid.voxelSize;
+    if (!(size > 0.0f) || surface.count() == 0)
+    {
+        return field;
+    }
+
+    // Surface voxels sit within half a diagonal of the surface, so one ring
+    // more than the wider side covers the band
+    VoxelBrickMap& band = field->_band;
+    VoxelBrickMap  adjacent, next;
+    Private::Voxelizer::dilate(surface, adjacent);
+    band = adjacent;
+    const int rings = int(std::ceil(std::max(field->_interiorWidth, field->_exteriorWidth) / size)) + 1;
+    for (int ring = 1; ring < rings; ++ring)
+    {
+        Private::Voxelizer::dilate(band, next);
+        std::swap(band, next);
+    }
+    for (NS::UInteger b = 0; b < surface.brickCount(); ++b)
+    {
+        std::int32_t coordinate[3];
+        surface.brickCoordinate(b, coordinate);
+        field->_surface.brick(coordinate[0], coordinate[1], coordinate[2]) = surface.brickAt(b);
+    }
+
+    const NS::UInteger       brickCount = band.brickCount();
+    const float              none = std::numeric_limits<float>::quiet_NaN();
+    std::vector<Seed>        seeds(brickCount * BrickVoxels, Seed { { none, none, none } });
+    std::vector<Seed>        flooded(seeds);
+
+    // Exact closest points around the surface, or the surface voxel centers
+    const float reach = size * 4.0f;
+    Private::parallelFor(brickCount, 16, [&](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger b = begin; b < end; ++b)
+        {
+            std::int32_t coordinate[3];
+            band.brickCoordinate(b, coordinate);
+            VoxelBrickMap::forEachVoxel(band.brickAt(b), coordinate, [&](std::int32_t x, std::int32_t y, std::int32_t z)
+            {
+                Seed& seed = seeds[b * BrickVoxels + ((x & 7) | ((y & 7) << 3) | ((z & 7) << 6))];
+                if (source && source->hierarchy)
+                {
+                    BoundingVolumeHierarchy::Closest closest;
+                    float                            point[3];
+                    field->center(x, y, z, point);
+                    if (adjacent.test(x, y, z) && source->hierarchy->closestPoint(point, reach, closest))
+                    {
+                        std::copy(closest.point, closest.point + 3, seed.point);
+                    }
+                }
+                else if (surface.test(x, y, z))
+                {
+                    field->center(x, y, z, seed.point);
+                }
+            });
+        }
+    });
+
+    int step = 1;
+    while (step * 2 <= rings)
+    {
+        step *= 2;
+    }
+    for (; step >= 1; step /= 2)
+    {
+        field->flood(step, seeds, flooded);
+        std::swap(seeds, flooded);
+    }
+    // A last pass at one voxel mends most of what the long jumps missed
+    field->flood(1, seeds, flooded);
+    std::swap(seeds, flooded);
+
+    std::vector<std::int8_t>         sides;
+    Private::Voxelizer::Crossings    crossings;
+    const bool                       parity = source && source->triangles.count > 0;
+    if (parity)
+    {
+        Private::Voxelizer::crossings(source->triangles, grid, crossings);
+    }
+    else if (shells)
+    {
+        field->spreadSides(*shells, sides);
+    }
+
+    field->_distances.assign(brickCount * BrickVoxels, std::numeric_limits<float>::infinity());
+    Private::parallelFor(brickCount, 16, [&](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger b = begin; b < end; ++b)
+        {
+            std::int32_t          coordinate[3];
+            VoxelBrickMap::Brick& brick = band.brickAt(b);
+            band.brickCoordinate(b, coordinate);
+            VoxelBrickMap::forEachVoxel(VoxelBrickMap::Brick(brick), coordinate, [&](std::int32_t x, std::int32_t y, std::int32_t z)
+            {
+                const int   bit = (x & 7) | ((y & 7) << 3) | ((z & 7) << 6);
+                const Seed& seed = seeds[b * BrickVoxels + bit];
+                const bool  onSurface = surface.test(x, y, z);
+
+                float distance = std::numeric_limits<float>::infinity();
+                if (!std::isnan(seed.point[0]))
+                {
+                    float point[3];
+                    field->center(x, y, z, point);
+                    const float d[3] = { seed.point[0] - point[0], seed.point[1] - point[1], seed.point[2] - point[2] };
+                    distance = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+                }
+                else if (onSurface)
+                {
+                    distance = 0.0f;
+                }
+
+                const bool inside = parity ? crossings.inside(x, y, z, grid) : !sides.empty() && sides[b * BrickVoxels + bit] < 0;
+                if (inside)
+                {
+                    distance = -distance;
+                }
+
+                if (onSurface || (distance >= -field->_interiorWidth && distance <= field->_exteriorWidth))
+                {
+                    field->_distances[b * BrickVoxels + bit] = distance;
+                }
+                else
+                {
+                    brick.words[bit >> 6] &= ~(std::uint64_t(1) << (bit & 63));
+                }
+            });
+        }
+    });
+
+    return field;
+}
+
+// native: grid
+_MDL_INLINE const MDL::VoxelGrid& MDL::VoxelDistanceField::grid() const
+{
+    return _grid;
+}
+
+// native: interiorWidth
+_MDL_INLINE float MDL::VoxelDistanceField::interiorWidth() const
+{
+    return _interiorWidth;
+}
+
+// native: exteriorWidth
+_MDL_INLINE float MDL::VoxelDistanceField::exteriorWidth() const
+{
+    return _exteriorWidth;
+}
+
+// native: band
+_MDL_INLINE const MDL::VoxelBrickMap& MDL::VoxelDistanceField::band() const
+{
+    return _band;
+}
+
+// native: isSurface
+_MDL_INLINE bool MDL::VoxelDistanceField::isSurface(std::int32_t x, std::int32_t y, std::int32_t z) const
+{
+    return _surface.test(x, y, z);
+}
+
+// native: distance
+_MDL_INLINE bool MDL::VoxelDistanceField::distance(std::int32_t x, std::int32_t y, std::int32_t z, float& distance) const
+{
+    const NS::Integer b = _band.brickIndex(x >> VoxelBrickMap::BrickShift, y >> VoxelBrickMap::BrickShift, z >> VoxelBrickMap::BrickShift);
+    if (b < 0)
+    {
+        return false;
+    }
+
+    const int bit = (x & 7) | ((y & 7) << 3) | ((z & 7) << 6);
+    if (!(_band.brickAt(NS::UInteger(b)).words[bit >> 6] >> (bit & 63) & 1))
+    {
+        return false;
+    }
+    distance = _distances[NS::UInteger(b) * BrickVoxels + bit];
+    return true;
+}
+
+// native: sample
+_MDL_INLINE bool MDL::VoxelDistanceField::sample(const float* position, float& distance, float* gradient) const
+{
+    if (!(_grid.voxelSize > 0.0f))
+    {
+        return false;
+    }
+
+    const float  inverse = 1.0f / _grid.voxelSize;
+    std::int32_t base[3];
+    float        t[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float u = (position[axis] - _grid.origin[axis]) * inverse - 0.5f;
+        const float low = std::floor(u);
+        if (!(std::fabs(low) < 1.0e9f))
+        {
+            return false;
+        }
+        base[axis] = std::int32_t(low);
+        t[axis] = u - low;
+    }
+
+    // c[x + 2 * y + 4 * z]
+    float c[8];
+    for (int corner = 0; corner < 8; ++corner)
+    {
+        if (!this->distance(base[0] + (corner & 1), base[1] + (corner >> 1 & 1), base[2] + (corner >> 2), c[corner]))
+        {
+            return false;
+        }
+    }
+
+    const float x0 = c[0] + (c[1] - c[0]) * t[0], x1 = c[2] + (c[3] - c[2]) * t[0];
+    const float x2 = c[4] + (c[5] - c[4]) * t[0], x3 = c[6] + (c[7] - c[6]) * t[0];
+    const float y0 = x0 + (x1 - x0) * t[1], y1 = x2 + (x3 - x2) * t[1];
+    distance = y0 + (y1 - y0) * t[2];
+
+    if (gradient)
+    {
+        const float sy = 1.0f - t[1], sz = 1.0f - t[2];
+        gradient[0] = ((c[1] - c[0]) * sy * sz + (c[3] - c[2]) * t[1] * sz + (c[5] - c[4]) * sy * t[2] + (c[7] - c[6]) * t[1] * t[2]) * inverse;
+        gradient[1] = ((x1 - x0) * sz + (x3 - x2) * t[2]) * inverse;
+        gradient[2] = (y1 - y0) * inverse;
+    }
+    return true;
+}
+
+// native: sample
+_MDL_INLINE void MDL::VoxelDistanceField::sample(const float* positions, NS::UInteger stride, NS::UInteger count, float* distances) const
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(positions);
+    Private::parallelFor(count, 1024, [&](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger i = begin; i < end; ++i)
+        {
+            if (!sample(reinterpret_cast<const float*>(bytes + i * stride), distances[i]))
+            {
+                distances[i] = std::numeric_limits<float>::infinity();
+            }
+        }
+    });
+}
+
+// Every band voxel keeps the nearest of its own seed and those of the 26
+// voxels `step` away. Steps of a brick or more land on the same bit of the
+// bricks `step / 8` away, shorter ones on the brick itself or a neighbor;
+// per axis, both are tabulated once for the pass.
+_MDL_INLINE void MDL::VoxelDistanceField::flood(int step, const std::vector<Seed>& from, std::vector<Seed>& to) const
+{
+    constexpr int BrickSize = VoxelBrickMap::BrickSize;
+    const int     brickStep = step >= BrickSize ? step / BrickSize : 1;
+
+    // Neighbor brick along the axis (0 to 2) and coordinate within it, by
+    // direction and coordinate
+    int landingBrick[3][BrickSize], landingLocal[3][BrickSize];
+    for (int d = 0; d < 3; ++d)
+    {
+        for (int local = 0; local < BrickSize; ++local)
+        {
+            const int moved = step >= BrickSize ? local : local + (d - 1) * step;
+            landingBrick[d][local] = step >= BrickSize ? d : (moved >> VoxelBrickMap::BrickShift) + 1;
+            landingLocal[d][local] = moved & (BrickSize - 1);
+        }
+    }
+
+    Private::parallelFor(_band.brickCount(), 16, [&](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger b = begin; b < end; ++b)
+        {
+            std::int32_t coordinate[3];
+            _band.brickCoordinate(b, coordinate);
+
+            // By x + 3 * y + 9 * z
+            NS::Integer neighbors[27];
+            for (int n = 0; n < 27; ++n)
+            {
+                neighbors[n] = _band.brickIndex(coordinate[0] + (n % 3 - 1) * brickStep,
+                                                coordinate[1] + (n / 3 % 3 - 1) * brickStep,
+                                                coordinate[2] + (n / 9 - 1) * brickStep);
+            }
+
+            VoxelBrickMap::forEachVoxel(_band.brickAt(b), coordinate, [&](std::int32_t x, std::int32_t y, std::int32_t z)
+            {
+                const int lx = x & (BrickSize - 1), ly = y & (BrickSize - 1), lz = z & (BrickSize - 1);
+                const int bit = lx | (ly << 3) | (lz << 6);
+                float     point[3];
+                center(x, y, z, point);
+
+                Seed  best = from[b * BrickVoxels + bit];
+                float bestDistance = std::numeric_limits<float>::infinity();
+                if (!std::isnan(best.point[0]))
+                {
+                    const float d[3] = { best.point[0] - point[0], best.point[1] - point[1], best.point[2] - point[2] };
+                    bestDistance = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+                }
+
+                for (int dz = 0; dz < 3; ++dz)
+                {
+                    for (int dy = 0; dy < 3; ++dy)
+                    {
+                        const int brickYZ = landingBrick[dz][lz] * 9 + landingBrick[dy][ly] * 3;
+                        const int localYZ = (landingLocal[dz][lz] << 6) | (landingLocal[dy][ly] << 3);
+                        for (int dx = 0; dx < 3; ++dx)
+                        {
+                            const NS::Integer neighbor = neighbors[brickYZ + landingBrick[dx][lx]];
+                            if (neighbor < 0 || (dx == 1 && dy == 1 && dz == 1))
+                            {
+                                continue;
+                            }
+
+                            const Seed& candidate = from[NS::UInteger(neighbor) * BrickVoxels + (localYZ | landingLocal[dx][lx])];
+                            const float d[3] = { candidate.point[0] - point[0], candidate.point[1] - point[1], candidate.point[2] - point[2] };
+                            const float distanceSquared = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+                            // False for seeds not set yet, being NaN
+                            if (distanceSquared < bestDistance)
+                            {
+                                best = candidate;
+                                bestDistance = distanceSquared;
+                            }
+                        }
+                    }
+                }
+
+                to[b * BrickVoxels + bit] = best;
+            });
+        }
+    });
+}
+
+// Breadth first from the band voxels with a shell, through the six faces,
+// never crossing the surface
+_MDL_INLINE void MDL::VoxelDistanceField::spreadSides(const VoxelBrickMap& shells, std::vector<std::int8_t>& sides) const
+{
+    sides.assign(_band.brickCount() * BrickVoxels, 0);
+
+    std::deque<std::int32_t> queue;
+    for (NS::UInteger b = 0; b < _band.brickCount(); ++b)
+    {
+        std::int32_t coordinate[3];
+        _band.brickCoordinate(b, coordinate);
+        VoxelBrickMap::forEachVoxel(_band.brickAt(b), coordinate, [&](std::int32_t x, std::int32_t y, std::int32_t z)
+        {
+            const std::int32_t shell = shells.shell(x, y, z);
+            if (shell != 0 && !_surface.test(x, y, z))
+            {
+                sides[b * BrickVoxels + ((x & 7) | ((y & 7) << 3) | ((z & 7) << 6))] = shell < 0 ? -1 : 1;
+                queue.insert(queue.end(), { x, y, z });
+            }
+        });
+    }
+
+    static const int faces[6][3] = { { -1, 0, 0 }, { 1, 0, 0 }, { 0, -1, 0 }, { 0, 1, 0 }, { 0, 0, -1 }, { 0, 0, 1 } };
+    while (!queue.empty())
+    {
+        const std::int32_t x = queue[0], y = queue[1], z = queue[2];
+        queue.erase(queue.begin(), queue.begin() + 3);
+
+        const std::int8_t side = sides[NS::UInteger(_band.brickIndex(x >> 3, y >> 3, z >> 3)) * BrickVoxels + ((x & 7) | ((y & 7) << 3) | ((z & 7) << 6))];
+        for (const int* face : faces)
+        {
+            const std::int32_t nx = x + face[0], ny = y + face[1], nz = z + face[2];
+            const NS::Integer  b = _band.brickIndex(nx >> 3, ny >> 3, nz >> 3);
+            if (b < 0 || !_band.test(nx, ny, nz) || _surface.test(nx, ny, nz))
+            {
+                continue;
+            }
+
+            std::int8_t& reached = sides[NS::UInteger(b) * BrickVoxels + ((nx & 7) | ((ny & 7) << 3) | ((nz & 7) << 6))];
+            if (reached == 0)
+            {
+                reached = side;
+                queue.insert(queue.end(), { nx, ny, nz });
+            }
+        }
+    }
+}
+
+// native: center
+_MDL_INLINE void MDL::VoxelDistanceField::center(std::int32_t x, std::int32_t y, std::int32_t z, float* point) const
+{
+    point[0] = _grid.origin[0] + (float(x) + 0.5f) * _grid.voxelSize;
+    point[1] = _grid.origin[1] + (float(y) + 0.5f) * _grid.voxelSize;
+    point[2] = _grid.origin[2] + (float(z) + 0.5f) * _grid.voxelSize;
+}
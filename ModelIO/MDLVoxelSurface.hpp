@@ -0,0 +1,317 @@
+/*!
+ @header MDLVoxelSurface.hpp
+ @framework ModelIO
+ @abstract Brick-parallel surface extraction from sparse voxel fields
+ @copyright Treata Norouzi on 10/19/26.
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include "MDLDefines.hpp"
+#include "MDLParallel.hpp"
+#include "MDLVoxelization.hpp"
+#include "Foundation/NSTypes.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace MDL
+{
+// Indexed triangles, counter-clockwise seen from outside
+struct VoxelSurface
+{
+    // Float3 each
+    std::vector<float>                      positions;
+    std::vector<float>                      normals;
+    std::vector<std::uint32_t>              indices;
+};
+
+namespace Private
+{
+    // Naive surface nets, that is dual contouring without the error
+    // quadric: one vertex in every cell whose corners straddle the level, at
+    // the mean of its edge crossings, and a quad across every cell edge the
+    // level crosses. A cell is the cube between eight voxel centers, named by
+    // its lowest corner, so each vertex belongs to exactly one cell and is
+    // shared by every quad around it without any merging. Bricks of cells
+    // are placed in parallel, numbered by a prefix sum, and joined by quads
+    // in a second parallel pass.
+    struct SurfaceNets
+    {
+        // value(x, y, z, value) for the voxel centers, false where there is
+        // none; cells with such a corner are left out. Values below `level`
+        // are inside.
+        template <typename _Value>
+        static void                 extract(const VoxelBrickMap& cells, const VoxelGrid& grid, float level,
+                                            _Value&& value, VoxelSurface& out);
+
+    private:
+        static constexpr int        BrickSize = VoxelBrickMap::BrickSize;
+        static constexpr int        BrickVoxels = BrickSize * BrickSize * BrickSize;
+        static constexpr int        BlockSize = BrickSize + 1;
+
+        // Vertex of a cell from its corners, by x + 2 * y + 4 * z: position
+        // within the cell and the gradient of the trilinear interpolation
+        static void                 placeVertex(const float* corners, unsigned inside, float level, float* position, float* normal);
+    };
+}
+
+}
+
+// MARK: - Private Sector
+
+template <typename _Value>
+_MDL_INLINE void MDL::Private::SurfaceNets::extract(const VoxelBrickMap& cells, const VoxelGrid& grid, float level,
+                                                    _Value&& value, VoxelSurface& out)
+{
+    out.positions.clear();
+    out.normals.clear();
+    out.indices.clear();
+
+    const NS::UInteger brickCount = cells.brickCount();
+    if (brickCount == 0 || !(grid.voxelSize > 0.0f))
+    {
+        return;
+    }
+
+    // Per cell, its inside corners (zero without a vertex) and its vertex
+    // among those of its brick
+    std::vector<std::uint8_t>               insides(brickCount * BrickVoxels, 0);
+    std::vector<std::uint32_t>              ordinals(brickCount * BrickVoxels);
+    // Per brick, position and normal of each vertex
+    std::vector<std::vector<float>>         vertices(brickCount);
+    std::vector<std::vector<std::uint32_t>> quads(brickCount);
+
+    parallelFor(brickCount, 8, [&](NS::UInteger begin, NS::UInteger end)
+    {
+        float block[BlockSize * BlockSize * BlockSize];
+        for (NS::UInteger b = begin; b < end; ++b)
+        {
+            const VoxelBrickMap::Brick& brick = cells.brickAt(b);
+            if (VoxelBrickMap::empty(brick))
+            {
+                continue;
+            }
+
+            // Corners of the brick's cells reach one voxel into the next bricks
+            std::int32_t coordinate[3];
+            cells.brickCoordinate(b, coordinate);
+            const std::int32_t base[3] = { coordinate[0] * BrickSize, coordinate[1] * BrickSize, coordinate[2] * BrickSize };
+            for (int z = 0, i = 0; z < BlockSize; ++z)
+            {
+                for (int y = 0; y < BlockSize; ++y)
+                {
+                    for (int x = 0; x < BlockSize; ++x, ++i)
+                    {
+                        if (!value(base[0] + x, base[1] + y, base[2] + z, block[i]))
+                        {
+                            block[i] = std::numeric_limits<float>::quiet_NaN();
+                        }
+                    }
+                }
+            }
+
+            std::uint32_t       count = 0;
+            std::vector<float>& list = vertices[b];
+            VoxelBrickMap::forEachVoxel(brick, coordinate, [&](std::int32_t x, std::int32_t y, std::int32_t z)
+            {
+                const int lx = x - base[0], ly = y - base[1], lz = z - base[2];
+                float     corners[8];
+                unsigned  inside = 0;
+                for (int corner = 0; corner < 8; ++corner)
+                {
+                    corners[corner] = block[(lx + (corner & 1)) + BlockSize * ((ly + (corner >> 1 & 1)) + BlockSize * (lz + (corner >> 2)))];
+                    if (std::isnan(corners[corner]))
+                    {
+                        return;
+                    }
+                    inside |= unsigned(corners[corner] < level) << corner;
+                }
+                if (inside == 0 || inside == 0xFF)
+                {
+                    return;
+                }
+
+                float position[3], normal[3];
+                placeVertex(corners, inside, level, position, normal);
+                const std::int32_t cell[3] = { x, y, z };
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    position[axis] = grid.origin[axis] + (float(cell[axis]) + 0.5f + position[axis]) * grid.voxelSize;
+                }
+                list.insert(list.end(), { position[0], position[1], position[2], normal[0], normal[1], normal[2] });
+
+                const NS::UInteger slot = b * BrickVoxels + (lx | (ly << 3) | (lz << 6));
+                insides[slot] = std::uint8_t(inside);
+                ordinals[slot] = count++;
+            });
+        }
+    });
+
+    std::vector<std::uint32_t> firstVertex(brickCount + 1, 0);
+    for (NS::UInteger b = 0; b < brickCount; ++b)
+    {
+        firstVertex[b + 1] = firstVertex[b] + std::uint32_t(vertices[b].size() / 6);
+    }
+
+    // Each cell closes the quads around the edges leaving its lowest corner;
+    // the other three cells around such an edge lie below it, in this brick
+    // or the ones before it
+    parallelFor(brickCount, 8, [&](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger b = begin; b < end; ++b)
+        {
+            if (vertices[b].empty())
+            {
+                continue;
+            }
+
+            std::int32_t coordinate[3];
+            cells.brickCoordinate(b, coordinate);
+
+            // By -x + 2 * -y + 4 * -z
+            NS::Integer below[8];
+            for (int n = 0; n < 8; ++n)
+            {
+                below[n] = cells.brickIndex(coordinate[0] - (n & 1), coordinate[1] - (n >> 1 & 1), coordinate[2] - (n >> 2));
+            }
+
+            constexpr std::uint32_t None = std::numeric_limits<std::uint32_t>::max();
+            auto vertexOf = [&](std::int32_t x, std::int32_t y, std::int32_t z)
+            {
+                const int         n = int(x >> 3 != coordinate[0]) | (int(y >> 3 != coordinate[1]) << 1) | (int(z >> 3 != coordinate[2]) << 2);
+                const NS::Integer brick = below[n];
+                if (brick < 0)
+                {
+                    return None;
+                }
+                const NS::UInteger slot = NS::UInteger(brick) * BrickVoxels + ((x & 7) | ((y & 7) << 3) | ((z & 7) << 6));
+                return insides[slot] ? firstVertex[brick] + ordinals[slot] : None;
+            };
+
+            std::vector<std::uint32_t>& list = quads[b];
+            VoxelBrickMap::forEachVoxel(cells.brickAt(b), coordinate, [&](std::int32_t x, std::int32_t y, std::int32_t z)
+            {
+                const NS::UInteger slot = b * BrickVoxels + ((x & 7) | ((y & 7) << 3) | ((z & 7) << 6));
+                const unsigned     inside = insides[slot];
+                if (!inside)
+                {
+                    return;
+                }
+
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    // The edge to corner 1 << axis; seen from that corner the
+                    // cells around it run counter-clockwise in this order
+                    if ((inside & 1) == (inside >> (1 << axis) & 1))
+                    {
+                        continue;
+                    }
+
+                    const int          u = (axis + 1) % 3, v = (axis + 2) % 3;
+                    std::int32_t       side[3] = { x, y, z }, corner[3] = { x, y, z }, across[3] = { x, y, z };
+                    side[u] -= 1;
+                    corner[u] -= 1;
+                    corner[v] -= 1;
+                    across[v] -= 1;
+
+                    const std::uint32_t quad[4] = { firstVertex[b] + ordinals[slot],
+                                                    vertexOf(side[0], side[1], side[2]),
+                                                    vertexOf(corner[0], corner[1], corner[2]),
+                                                    vertexOf(across[0], across[1], across[2]) };
+                    if (quad[1] == None || quad[2] == None || quad[3] == None)
+                    {
+                        continue;
+                    }
+
+                    // Outward is towards the outside corner
+                    if (inside & 1)
+                    {
+                        list.insert(list.end(), { quad[0], quad[1], quad[2], quad[0], quad[2], quad[3] });
+                    }
+                    else
+                    {
+                        list.insert(list.end(), { quad[0], quad[3], quad[2], quad[0], quad[2], quad[1] });
+                    }
+                }
+            });
+        }
+    });
+
+    std::vector<NS::UInteger> firstIndex(brickCount + 1, 0);
+    for (NS::UInteger b = 0; b < brickCount; ++b)
+    {
+        firstIndex[b + 1] = firstIndex[b] + quads[b].size();
+    }
+
+    out.positions.resize(NS::UInteger(firstVertex[brickCount]) * 3);
+    out.normals.resize(NS::UInteger(firstVertex[brickCount]) * 3);
+    out.indices.resize(firstIndex[brickCount]);
+    parallelFor(brickCount, 64, [&](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger b = begin; b < end; ++b)
+        {
+            const std::vector<float>& list = vertices[b];
+            for (NS::UInteger i = 0, n = list.size() / 6; i < n; ++i)
+            {
+                const NS::UInteger vertex = NS::UInteger(firstVertex[b]) + i;
+                std::copy(&list[i * 6], &list[i * 6] + 3, &out.positions[vertex * 3]);
+                std::copy(&list[i * 6] + 3, &list[i * 6] + 6, &out.normals[vertex * 3]);
+            }
+            std::copy(quads[b].begin(), quads[b].end(), out.indices.begin() + firstIndex[b]);
+        }
+    });
+}
+
+_MDL_INLINE void MDL::Private::SurfaceNets::placeVertex(const float* corners, unsigned inside, float level, float* position, float* normal)
+{
+    // Edges by corner pairs: four along x, then y, then z
+    static const std::uint8_t edges[12][2] = { { 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 },
+                                               { 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 },
+                                               { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 } };
+
+    float sum[3] = { 0.0f, 0.0f, 0.0f };
+    int   crossings = 0;
+    for (const std::uint8_t* edge : edges)
+    {
+        if ((inside >> edge[0] & 1) == (inside >> edge[1] & 1))
+        {
+            continue;
+        }
+
+        const float t = (level - corners[edge[0]]) / (corners[edge[1]] - corners[edge[0]]);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            const float from = float(edge[0] >> axis & 1), to = float(edge[1] >> axis & 1);
+            sum[axis] += from + (to - from) * t;
+        }
+        ++crossings;
+    }
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        position[axis] = sum[axis] / float(crossings);
+    }
+
+    // Values grow outwards, and so does their gradient
+    const float tx = position[0], ty = position[1], tz = position[2];
+    const float sy = 1.0f - ty, sz = 1.0f - tz;
+    const float x0 = corners[0] + (corners[1] - corners[0]) * tx, x1 = corners[2] + (corners[3] - corners[2]) * tx;
+    const float x2 = corners[4] + (corners[5] - corners[4]) * tx, x3 = corners[6] + (corners[7] - corners[6]) * tx;
+    normal[0] = (corners[1] - corners[0]) * sy * sz + (corners[3] - corners[2]) * ty * sz
+              + (corners[5] - corners[4]) * sy * tz + (corners[7] - corners[6]) * ty * tz;
+    normal[1] = (x1 - x0) * sz + (x3 - x2) * tz;
+    normal[2] = (x2 + (x3 - x2) * ty) - (x0 + (x1 - x0) * ty);
+
+    const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+    const float scale = length > 0.0f ? 1.0f / length : 0.0f;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        normal[axis] *= scale;
+    }
+}
@@ -0,0 +1,1805 @@
+/*!
+ @header MDLVoxelization.hpp
+ @framework ModelIO
+ @abstract Sparse brick occupancy and a parallel conservative voxelizer
+ @copyright Treata Norouzi on 10/19/26.
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include "MDLDefines.hpp"
+#include "MDLAlignedAllocator.hpp"
+#include "MDLObjectLifetime.hpp"
+#include "MDLParallel.hpp"
+#include "Foundation/NSTypes.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define _MDL_VOXELIZATION_AVX2 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define _MDL_VOXELIZATION_SSE 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define _MDL_VOXELIZATION_NEON 1
+#endif
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace MDL
+{
+class VoxelDistanceField; // Forward-declaration
+
+_MDL_ENUM(NS::UInteger, VoxelBoolean) {
+    VoxelBooleanUnion = 0,
+    VoxelBooleanIntersection = 1,
+    // Voxels of the first operand not in the second
+    VoxelBooleanDifference = 2,
+};
+
+// Voxel (i, j, k) spans origin + (i, j, k) * voxelSize to one voxel further
+// along every axis
+struct VoxelGrid
+{
+    float                           origin[3] = { 0.0f, 0.0f, 0.0f };
+    float                           voxelSize = 0.0f;
+};
+
+// Sparse occupancy laid out like OpenVDB: a hash on 1024^3 voxel regions at
+// the root, internal nodes of 16^3 and 8^3 children below it, and leaf bricks
+// of 8x8x8 voxels as 512 bits. A lookup is one hash probe and two array
+// reads, extent queries skip untouched regions whole, and memory follows the
+// surface voxelized rather than the extent of the grid. Voxels carry a shell
+// (within +-32767), stored per brick only once one of its shells is not zero.
+class VoxelBrickMap
+{
+public:
+    static constexpr int            BrickShift = 3;
+    static constexpr int            BrickSize = 1 << BrickShift;
+    // Bricks per side of a lower node, and lower nodes per side of an upper
+    // node
+    static constexpr int            LowerShift = 3;
+    static constexpr int            UpperShift = 4;
+
+    // Bit x + 8 * y of word z
+    struct alignas(64) Brick
+    {
+        std::uint64_t               words[8];
+    };
+
+    NS::UInteger                    brickCount() const;
+    // Voxels set
+    NS::UInteger                    count() const;
+
+    bool                            test(std::int32_t x, std::int32_t y, std::int32_t z) const;
+    void                            set(std::int32_t x, std::int32_t y, std::int32_t z);
+    void                            set(std::int32_t x, std::int32_t y, std::int32_t z, std::int32_t shell);
+    // Zero for voxels without a shell and for voxels not set
+    std::int32_t                    shell(std::int32_t x, std::int32_t y, std::int32_t z) const;
+    // Gives every voxel set the same shell
+    void                            fillShells(std::int32_t shell);
+
+    // Lowest and highest x, y, z and shell of the voxels set; false when
+    // there are none
+    bool                            extent(std::int32_t* minimum, std::int32_t* maximum) const;
+
+    // Position of a brick in brickAt order, or -1 when it was never touched
+    NS::Integer                     brickIndex(std::int32_t bx, std::int32_t by, std::int32_t bz) const;
+    // nullptr when the brick was never touched
+    const Brick*                    findBrick(std::int32_t bx, std::int32_t by, std::int32_t bz) const;
+    // Inserted empty when absent; references stay valid until the next
+    // insertion
+    Brick&                          brick(std::int32_t bx, std::int32_t by, std::int32_t bz);
+
+    // Bricks in insertion order; some may be empty
+    const Brick&                    brickAt(NS::UInteger index) const;
+    Brick&                          brickAt(NS::UInteger index);
+    void                            brickCoordinate(NS::UInteger index, std::int32_t* coordinate) const;
+    // Shell of bit x + 8 * y + 64 * z of a brick
+    std::int32_t                    brickShell(NS::UInteger index, int bit) const;
+
+    // Sets every voxel of `other` with its shell; voxels already set keep
+    // theirs
+    void                            merge(const VoxelBrickMap& other);
+
+    // Combines `other` into this map brick by brick, in parallel, settling
+    // bricks that are empty or full on either side without touching their
+    // words. Shells are cleared, as ModelIO does.
+    void                            combine(const VoxelBrickMap& other, VoxelBoolean operation);
+
+    void                            reserve(NS::UInteger brickCount);
+    void                            clear();
+
+    // fn(x, y, z) for every voxel set, brick by brick
+    template <typename _Fn>
+    void                            forEachVoxel(_Fn&& fn) const;
+
+    // fn(x, y, z, shell) for every voxel set within the inclusive bounds,
+    // until it returns false; false when stopped that way
+    template <typename _Fn>
+    bool                            forEachVoxelWithin(const std::int32_t* minimum, const std::int32_t* maximum, _Fn&& fn) const;
+
+    // First voxel set along origin + t * direction for t within [tMin, tMax],
+    // in voxel units: voxel (x, y, z) spans x to x + 1 and so on. The DDA
+    // crosses untouched root regions, lower nodes and empty bricks in one
+    // step each. `t` is where the ray enters the voxel.
+    bool                            march(const float* origin, const float* direction, float tMin, float tMax,
+                                          std::int32_t* voxel, float& t) const;
+
+    static bool                     empty(const Brick& brick);
+    static bool                     full(const Brick& brick);
+    // 21 bits per axis, so brick coordinates within +-2^20
+    static std::uint64_t            brickKey(std::int32_t bx, std::int32_t by, std::int32_t bz);
+    static void                     brickKeyCoordinate(std::uint64_t key, std::int32_t* coordinate);
+    // fn(x, y, z) for every bit of `brick`, whose brick coordinate is given
+    template <typename _Fn>
+    static void                     forEachVoxel(const Brick& brick, const std::int32_t* coordinate, _Fn&& fn);
+
+private:
+    static constexpr std::uint64_t  EmptyKey = ~std::uint64_t(0);
+    static constexpr std::uint32_t  NoShells = ~std::uint32_t(0);
+    static constexpr std::uint32_t  NoBrick = ~std::uint32_t(0);
+    static constexpr std::int32_t   KeyBias = 1 << 20;
+    static constexpr std::uint64_t  KeyMask = (std::uint64_t(1) << 21) - 1;
+    static constexpr int            LowerCount = 1 << (3 * LowerShift);
+    static constexpr int            UpperCount = 1 << (3 * UpperShift);
+
+    // 8^3 bricks
+    struct Lower
+    {
+        std::uint64_t               mask[LowerCount / 64];
+        std::uint32_t               children[LowerCount];
+    };
+
+    // 16^3 lower nodes
+    struct Upper
+    {
+        std::uint64_t               mask[UpperCount / 64];
+        std::uint32_t               children[UpperCount];
+    };
+
+    // Brick index, or NoBrick
+    std::uint32_t                   locate(std::int32_t bx, std::int32_t by, std::int32_t bz) const;
+    // log2 of the side of the empty node around a voxel: 10, 6 or 3 when its
+    // root region, lower node or brick is missing (or the brick is empty),
+    // else 0 with the brick
+    int                             emptyShift(std::int32_t x, std::int32_t y, std::int32_t z, std::uint32_t& brick) const;
+    // Root slot holding `key`, or the empty slot where it would go
+    NS::UInteger                    slot(std::uint64_t key) const;
+    void                            rehash(NS::UInteger capacity);
+    std::int16_t*                   shells(NS::UInteger brick);
+
+    static bool                     child(const std::uint64_t* mask, int index);
+    static std::uint64_t            brickMask(int lowX, int highX, int lowY, int highY);
+    // One 512-bit operation on aligned bricks
+    static void                     combineBricks(Brick& target, const Brick& source, VoxelBoolean operation);
+
+    std::vector<std::uint64_t>      _table;
+    std::vector<std::uint32_t>      _tableUppers;
+    unsigned                        _tableShift = 64;
+    std::vector<std::uint64_t>      _upperKeys;
+    std::vector<Upper>              _uppers;
+    std::vector<Lower>              _lowers;
+    Private::AlignedVector<Brick>   _bricks;
+    std::vector<std::uint64_t>      _keys;
+    // Per brick, the first of its 512 shells in _shells, or NoShells
+    std::vector<std::uint32_t>      _brickShells;
+    std::vector<std::int16_t>       _shells;
+};
+
+namespace Private
+{
+    // Conservative voxelization: a voxel is set when its box, grown by the
+    // patch radius on every side, overlaps a triangle. The overlap is the
+    // separating axis test in the form of Schwarz and Seidel (a plane test
+    // plus edge tests in the three axis projections). Triangles are binned to
+    // the bricks their bounds cover, and bricks are then filled in parallel,
+    // each by a single thread, with the rows of a brick evaluated eight
+    // voxels at a time.
+    struct Voxelizer
+    {
+        // Three indices per triangle into float3 positions `stride` bytes apart
+        struct Triangles
+        {
+            const float*            positions;
+            NS::UInteger            stride;
+            const std::uint32_t*    indices;
+            NS::UInteger            count;
+        };
+
+        static void                 surface(const Triangles& triangles, const VoxelGrid& grid, float patchRadius, VoxelBrickMap& out);
+
+        // Shells around `surface` out to `interior` voxels inside the mesh and
+        // `exterior` outside: layers[interior + s] holds shell s, negative
+        // inside, the surface itself being shell 0. Sides come from the parity
+        // of crossings along +x from each voxel center, so they are only
+        // meaningful for closed meshes.
+        static void                 shells(const Triangles& triangles, const VoxelGrid& grid, const VoxelBrickMap& surface,
+                                           int interior, int exterior, std::vector<VoxelBrickMap>& layers);
+
+        // Grows the set by one voxel towards all 26 neighbors
+        static void                 dilate(const VoxelBrickMap& in, VoxelBrickMap& out);
+
+        // Sorted crossings of +x rays through voxel centers, by (y, z) row
+        struct Crossings
+        {
+            std::vector<std::uint64_t>  rows;
+            std::vector<std::uint32_t>  starts;
+            std::vector<float>          hits;
+
+            bool                        inside(std::int32_t x, std::int32_t y, std::int32_t z, const VoxelGrid& grid) const;
+        };
+
+        // Crossings of every voxel row the triangles span
+        static void                 crossings(const Triangles& triangles, const VoxelGrid& grid, Crossings& out);
+
+    private:
+        struct Setup
+        {
+            float                   normal[3];
+            float                   planeNear, planeFar;
+            // Edge functions per projection: two coefficients and an offset
+            float                   xy[3][3];
+            float                   yz[3][3];
+            float                   zx[3][3];
+            float                   min[3], max[3];
+        };
+
+        static bool                 setup(const Triangles& triangles, NS::UInteger triangle, float boxSize, Setup& out);
+        static void                 fillBrick(const Triangles& triangles, const std::uint32_t* list, NS::UInteger count,
+                                              const std::int32_t* coordinate, const VoxelGrid& grid, float patchRadius,
+                                              VoxelBrickMap::Brick& out);
+        static void                 dilateAxis(const VoxelBrickMap& in, int axis, VoxelBrickMap& out);
+        static std::uint64_t        rowKey(std::int32_t y, std::int32_t z);
+    };
+
+    // Grid conversions in batches, a voxel per vector: locations and indices
+    // are padded to four lanes as simd vectors of three are, and boxes hold
+    // their maximum corner before their minimum one. The fourth lane of what
+    // is written is zero.
+    void                            voxelIndices(const VoxelGrid& grid, const float* locations, NS::UInteger count, std::int32_t* indices);
+    void                            voxelCenters(const VoxelGrid& grid, const std::int32_t* indices, NS::UInteger count, float* locations);
+    void                            voxelBounds(const VoxelGrid& grid, const std::int32_t* indices, NS::UInteger count, float* boxes);
+
+    // Native occupancy of a VoxelArray, by array
+    struct VoxelArrayState
+    {
+        VoxelGrid                                   grid;
+        std::shared_ptr<VoxelBrickMap>              bricks;
+        // The bricks changed since ModelIO last had them
+        bool                                        modified = false;
+        // A conversion to a signed shell field of the given thickness, not
+        // yet made in ModelIO
+        bool                                        shellField = false;
+        float                                       interiorThickness = 0.0f;
+        float                                       exteriorThickness = 0.0f;
+        // Float3 positions and triangles of the meshes voxelized natively,
+        // for exact distances and sides; kept only while the voxels all came
+        // from them, so dropped by combinations
+        std::vector<float>                          sourcePositions;
+        std::vector<std::uint32_t>                  sourceTriangles;
+        // Present while the array is a valid signed shell field
+        std::shared_ptr<const VoxelDistanceField>   field;
+
+        // The bricks, copied first when a snapshot still shares them
+        VoxelBrickMap&                              writableBricks();
+    };
+
+    // Native states by array; an array's state goes away with the array
+    class VoxelArrayStore
+    {
+    public:
+        static VoxelArrayStore&                     shared();
+
+        std::shared_ptr<VoxelArrayState>            find(const void* array);
+        void                                        insert(const void* array, std::shared_ptr<VoxelArrayState> state);
+        void                                        remove(const void* array);
+        void                                        clear();
+
+    private:
+        std::mutex                                  _mutex;
+        std::unordered_map<const void*, std::shared_ptr<VoxelArrayState>> _states;
+
+        static void                                 evict(const void* array);
+    };
+
+} // Private
+} // MDL
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// MARK: - Private Sector
+
+_MDL_INLINE NS::UInteger MDL::VoxelBrickMap::brickCount() const
+{
+    return _bricks.size();
+}
+
+_MDL_INLINE NS::UInteger MDL::VoxelBrickMap::count() const
+{
+    NS::UInteger total = 0;
+    for (const Brick& brick : _bricks)
+    {
+        for (std::uint64_t word : brick.words)
+        {
+            total += __builtin_popcountll(word);
+        }
+    }
+    return total;
+}
+
+_MDL_INLINE bool MDL::VoxelBrickMap::test(std::int32_t x, std::int32_t y, std::int32_t z) const
+{
+    const std::uint32_t b = locate(x >> BrickShift, y >> BrickShift, z >> BrickShift);
+    return b != NoBrick && (_bricks[b].words[z & (BrickSize - 1)] >> ((x & (BrickSize - 1)) | ((y & (BrickSize - 1)) << 3)) & 1);
+}
+
+_MDL_INLINE void MDL::VoxelBrickMap::set(std::int32_t x, std::int32_t y, std::int32_t z)
+{
+    Brick& target = brick(x >> BrickShift, y >> BrickShift, z >> BrickShift);
+    target.words[z & (BrickSize - 1)] |= std::uint64_t(1) << ((x & (BrickSize - 1)) | ((y & (BrickSize - 1)) << 3));
+}
+
+_MDL_INLINE void MDL::VoxelBrickMap::set(std::int32_t x, std::int32_t y, std::int32_t z, std::int32_t shell)
+{
+    set(x, y, z);
+    const std::uint32_t b = locate(x >> BrickShift, y >> BrickShift, z >> BrickShift);
+    if (shell != 0 || _brickShells[b] != NoShells)
+    {
+        shells(b)[(x & 7) | ((y & 7) << 3) | ((z & 7) << 6)] = std::int16_t(shell);
+    }
+}
+
+_MDL_INLINE std::int32_t MDL::VoxelBrickMap::shell(std::int32_t x, std::int32_t y, std::int32_t z) const
+{
+    const std::uint32_t b = locate(x >> BrickShift, y >> BrickShift, z >> BrickShift);
+    return b == NoBrick ? 0 : brickShell(b, (x & 7) | ((y & 7) << 3) | ((z & 7) << 6));
+}
+
+_MDL_INLINE void MDL::VoxelBrickMap::fillShells(std::int32_t shell)
+{
+    if (shell == 0)
+    {
+        _brickShells.assign(_bricks.size(), NoShells);
+        _shells.clear();
+        return;
+    }
+    _shells.assign(_bricks.size() * 512, std::int16_t(shell));
+    for (NS::UInteger b = 0; b < _bricks.size(); ++b)
+    {
+        _brickShells[b] = std::uint32_t(b * 512);
+    }
+}
+
+_MDL_INLINE bool MDL::VoxelBrickMap::extent(std::int32_t* minimum, std::int32_t* maximum) const
+{
+    bool found = false;
+    for (NS::UInteger b = 0; b < _bricks.size(); ++b)
+    {
+        const Brick&  brick = _bricks[b];
+        std::uint64_t any = 0;
+        int           lowZ = BrickSize, highZ = -1;
+        for (int z = 0; z < BrickSize; ++z)
+        {
+            if (brick.words[z])
+            {
+                any |= brick.words[z];
+                lowZ = std::min(lowZ, z);
+                highZ = z;
+            }
+        }
+        if (!any)
+        {
+            continue;
+        }
+
+        // Rows of the union give y; their union gives x
+        unsigned columns = 0;
+        int      lowY = BrickSize, highY = -1;
+        for (int y = 0; y < BrickSize; ++y)
+        {
+            if (const unsigned row = unsigned(any >> (y * 8)) & 0xFFu)
+            {
+                columns |= row;
+                lowY = std::min(lowY, y);
+                highY = y;
+            }
+        }
+
+        std::int32_t coordinate[3];
+        brickCoordinate(b, coordinate);
+        const std::int32_t low[3] = { (coordinate[0] << BrickShift) + __builtin_ctz(columns), (coordinate[1] << BrickShift) + lowY,
+                                      (coordinate[2] << BrickShift) + lowZ };
+        const std::int32_t high[3] = { (coordinate[0] << BrickShift) + 31 - __builtin_clz(columns), (coordinate[1] << BrickShift) + highY,
+                                       (coordinate[2] << BrickShift) + highZ };
+
+        std::int32_t lowShell = 0, highShell = 0;
+        if (_brickShells[b] != NoShells)
+        {
+            lowShell = std::numeric_limits<std::int32_t>::max();
+            highShell = std::numeric_limits<std::int32_t>::min();
+            for (int z = 0; z < BrickSize; ++z)
+            {
+                for (std::uint64_t word = brick.words[z]; word; word &= word - 1)
+                {
+                    const std::int32_t s = _shells[_brickShells[b] + (z << 6) + __builtin_ctzll(word)];
+                    lowShell = std::min(lowShell, s);
+                    highShell = std::max(highShell, s);
+                }
+            }
+        }
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            minimum[axis] = found ? std::min(minimum[axis], low[axis]) : low[axis];
+            maximum[axis] = found ? std::max(maximum[axis], high[axis]) : high[axis];
+        }
+        minimum[3] = found ? std::min(minimum[3], lowShell) : lowShell;
+        maximum[3] = found ? std::max(maximum[3], highShell) : highShell;
+        found = true;
+    }
+    return found;
+}
+
+_MDL_INLINE NS::Integer MDL::VoxelBrickMap::brickIndex(std::int32_t bx, std::int32_t by, std::int32_t bz) const
+{
+    const std::uint32_t b = locate(bx, by, bz);
+    return b == NoBrick ? -1 : NS::Integer(b);
+}
+
+_MDL_INLINE const MDL::VoxelBrickMap::Brick* MDL::VoxelBrickMap::findBrick(std::int32_t bx, std::int32_t by, std::int32_t bz) const
+{
+    const std::uint32_t b = locate(bx, by, bz);
+    return b == NoBrick ? nullptr : &_bricks[b];
+}
+
+_MDL_INLINE MDL::VoxelBrickMap::Brick& MDL::VoxelBrickMap::brick(std::int32_t bx, std::int32_t by, std::int32_t bz)
+{
+    // Root at most half full
+    if ((_uppers.size() + 1) * 2 > _table.size())
+    {
+        rehash(std::max<NS::UInteger>(_table.size() * 2, 16));
+    }
+
+    constexpr int       upperShift = LowerShift + UpperShift;
+    const std::uint64_t key = brickKey(bx >> upperShift, by >> upperShift, bz >> upperShift);
+    const NS::UInteger  s = slot(key);
+    if (_table[s] == EmptyKey)
+    {
+        _table[s] = key;
+        _tableUppers[s] = std::uint32_t(_uppers.size());
+        _uppers.emplace_back();
+        _upperKeys.push_back(key);
+    }
+
+    const int u = ((bx >> LowerShift) & 15) | (((by >> LowerShift) & 15) << 4) | (((bz >> LowerShift) & 15) << 8);
+    if (!child(_uppers[_tableUppers[s]].mask, u))
+    {
+        Upper& upper = _uppers[_tableUppers[s]];
+        upper.mask[u >> 6] |= std::uint64_t(1) << (u & 63);
+        upper.children[u] = std::uint32_t(_lowers.size());
+        _lowers.emplace_back();
+    }
+
+    Lower&    lower = _lowers[_uppers[_tableUppers[s]].children[u]];
+    const int l = (bx & 7) | ((by & 7) << 3) | ((bz & 7) << 6);
+    if (!child(lower.mask, l))
+    {
+        lower.mask[l >> 6] |= std::uint64_t(1) << (l & 63);
+        lower.children[l] = std::uint32_t(_bricks.size());
+        _bricks.push_back(Brick {});
+        _keys.push_back(brickKey(bx, by, bz));
+        _brickShells.push_back(NoShells);
+    }
+    return _bricks[lower.children[l]];
+}
+
+_MDL_INLINE const MDL::VoxelBrickMap::Brick& MDL::VoxelBrickMap::brickAt(NS::UInteger index) const
+{
+    return _bricks[index];
+}
+
+_MDL_INLINE MDL::VoxelBrickMap::Brick& MDL::VoxelBrickMap::brickAt(NS::UInteger index)
+{
+    return _bricks[index];
+}
+
+_MDL_INLINE void MDL::VoxelBrickMap::brickCoordinate(NS::UInteger index, std::int32_t* coordinate) const
+{
+    brickKeyCoordinate(_keys[index], coordinate);
+}
+
+_MDL_INLINE std::int32_t MDL::VoxelBrickMap::brickShell(NS::UInteger index, int bit) const
+{
+    return _brickShells[index] == NoShells ? 0 : _shells[_brickShells[index] + bit];
+}
+
+_MDL_INLINE void MDL::VoxelBrickMap::merge(const VoxelBrickMap& other)
+{
+    reserve(_bricks.size() + other._bricks.size());
+    for (NS::UInteger b = 0; b < other._bricks.size(); ++b)
+    {
+        const Brick& source = other._bricks[b];
+        if (empty(source))
+        {
+            continue;
+        }
+
+        std::int32_t coordinate[3];
+        other.brickCoordinate(b, coordinate);
+        Brick& target = brick(coordinate[0], coordinate[1], coordinate[2]);
+
+        Brick fresh;
+        for (int w = 0; w < BrickSize; ++w)
+        {
+            fresh.words[w] = source.words[w] & ~target.words[w];
+            target.words[w] |= source.words[w];
+        }
+
+        if (other._brickShells[b] != NoShells && !empty(fresh))
+        {
+            std::int16_t* targetShells = shells(locate(coordinate[0], coordinate[1], coordinate[2]));
+            for (int w = 0; w < BrickSize; ++w)
+            {
+                for (std::uint64_t word = fresh.words[w]; word; word &= word - 1)
+                {
+                    const int bit = (w << 6) + __builtin_ctzll(word);
+                    targetShells[bit] = other._shells[other._brickShells[b] + bit];
+                }
+            }
+        }
+    }
+}
+
+_MDL_INLINE void MDL::VoxelBrickMap::combine(const VoxelBrickMap& other, VoxelBoolean operation)
+{
+    fillShells(0);
+    if (&other == this)
+    {
+        if (operation == VoxelBooleanDifference)
+        {
+            std::memset(static_cast<void*>(_bricks.data()), 0, _bricks.size() * sizeof(Brick));
+        }
+        return;
+    }
+
+    if (operation == VoxelBooleanUnion)
+    {
+        // Bricks only `other` has are inserted first, which the tree needs
+        // to do serially
+        std::vector<std::uint32_t> pairs;
+        pairs.reserve(other._bricks.size() * 2);
+        reserve(_bricks.size() + other._bricks.size());
+        for (NS::UInteger b = 0; b < other._bricks.size(); ++b)
+        {
+            if (empty(other._bricks[b]))
+            {
+                continue;
+            }
+            std::int32_t coordinate[3];
+            other.brickCoordinate(b, coordinate);
+            brick(coordinate[0], coordinate[1], coordinate[2]);
+            pairs.push_back(locate(coordinate[0], coordinate[1], coordinate[2]));
+            pairs.push_back(std::uint32_t(b));
+        }
+
+        Private::parallelFor(pairs.size() / 2, 256, [&](NS::UInteger begin, NS::UInteger end)
+        {
+            for (NS::UInteger p = begin; p < end; ++p)
+            {
+                Brick&       target = _bricks[pairs[p * 2]];
+                const Brick& source = other._bricks[pairs[p * 2 + 1]];
+                if (full(source))
+                {
+                    std::memset(target.words, 0xFF, sizeof(target.words));
+                }
+                else if (!full(target))
+                {
+                    combineBricks(target, source, operation);
+                }
+            }
+        });
+        return;
+    }
+
+    // Intersection and difference only ever clear bits of bricks already here
+    Private::parallelFor(_bricks.size(), 256, [&](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger b = begin; b < end; ++b)
+        {
+            Brick& target = _bricks[b];
+            if (empty(target))
+            {
+                continue;
+            }
+
+            std::int32_t coordinate[3];
+            brickCoordinate(b, coordinate);
+            const std::uint32_t s = other.locate(coordinate[0], coordinate[1], coordinate[2]);
+            const bool          missing = s == NoBrick || empty(other._bricks[s]);
+            if (missing || full(other._bricks[s]))
+            {
+                if ((operation == VoxelBooleanIntersection) == missing)
+                {
+                    std::memset(target.words, 0, sizeof(target.words));
+                }
+                continue;
+            }
+            combineBricks(target, other._bricks[s], operation);
+        }
+    });
+}
+
+_MDL_INLINE void MDL::VoxelBrickMap::reserve(NS::UInteger brickCount)
+{
+    _bricks.reserve(brickCount);
+    _keys.reserve(brickCount);
+    _brickShells.reserve(brickCount);
+}
+
+_MDL_INLINE void MDL::VoxelBrickMap::clear()
+{
+    _table.clear();
+    _tableUppers.clear();
+    _tableShift = 64;
+    _upperKeys.clear();
+    _uppers.clear();
+    _lowers.clear();
+    _bricks.clear();
+    _keys.clear();
+    _brickShells.clear();
+    _shells.clear();
+}
+
+template <typename _Fn>
+_MDL_INLINE void MDL::VoxelBrickMap::forEachVoxel(_Fn&& fn) const
+{
+    for (NS::UInteger b = 0; b < _bricks.size(); ++b)
+    {
+        std::int32_t coordinate[3];
+        brickCoordinate(b, coordinate);
+        forEachVoxel(_bricks[b], coordinate, fn);
+    }
+}
+
+template <typename _Fn>
+_MDL_INLINE bool MDL::VoxelBrickMap::forEachVoxelWithin(const std::int32_t* minimum, const std::int32_t* maximum, _Fn&& fn) const
+{
+    constexpr int upperShift = BrickShift + LowerShift + UpperShift;
+    constexpr int lowerShift = BrickShift + LowerShift;
+
+    // Whether the span of `size` voxels from `origin` overlaps the bounds
+    auto overlaps = [&](const std::int32_t* origin, std::int32_t size)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (std::int64_t(origin[axis]) + size <= minimum[axis] || origin[axis] > maximum[axis])
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    for (NS::UInteger u = 0; u < _uppers.size(); ++u)
+    {
+        std::int32_t upperOrigin[3];
+        brickKeyCoordinate(_upperKeys[u], upperOrigin);
+        for (std::int32_t& c : upperOrigin)
+        {
+            c *= 1 << upperShift;
+        }
+        if (!overlaps(upperOrigin, 1 << upperShift))
+        {
+            continue;
+        }
+
+        const Upper& upper = _uppers[u];
+        for (int word = 0; word < UpperCount / 64; ++word)
+        {
+            for (std::uint64_t bits = upper.mask[word]; bits; bits &= bits - 1)
+            {
+                const int          index = (word << 6) + __builtin_ctzll(bits);
+                const std::int32_t lowerOrigin[3] = { upperOrigin[0] + ((index & 15) << lowerShift),
+                                                      upperOrigin[1] + (((index >> 4) & 15) << lowerShift),
+                                                      upperOrigin[2] + ((index >> 8) << lowerShift) };
+                if (!overlaps(lowerOrigin, 1 << lowerShift))
+                {
+                    continue;
+                }
+
+                const Lower& lower = _lowers[upper.children[index]];
+                for (int lowerWord = 0; lowerWord < LowerCount / 64; ++lowerWord)
+                {
+                    for (std::uint64_t brickBits = lower.mask[lowerWord]; brickBits; brickBits &= brickBits - 1)
+                    {
+                        const int          l = (lowerWord << 6) + __builtin_ctzll(brickBits);
+                        const std::int32_t origin[3] = { lowerOrigin[0] + ((l & 7) << BrickShift),
+                                                         lowerOrigin[1] + (((l >> 3) & 7) << BrickShift),
+                                                         lowerOrigin[2] + ((l >> 6) << BrickShift) };
+                        if (!overlaps(origin, BrickSize))
+                        {
+                            continue;
+                        }
+
+                        // Clip the brick to the bounds: x and y by mask, z by word
+                        int low[3], high[3];
+                        for (int axis = 0; axis < 3; ++axis)
+                        {
+                            low[axis] = int(std::max<std::int64_t>(0, std::int64_t(minimum[axis]) - origin[axis]));
+                            high[axis] = int(std::min<std::int64_t>(BrickSize - 1, std::int64_t(maximum[axis]) - origin[axis]));
+                        }
+                        const std::uint32_t b = lower.children[l];
+                        const std::uint64_t clip = brickMask(low[0], high[0], low[1], high[1]);
+                        for (int z = low[2]; z <= high[2]; ++z)
+                        {
+                            for (std::uint64_t voxels = _bricks[b].words[z] & clip; voxels; voxels &= voxels - 1)
+                            {
+                                const int bit = __builtin_ctzll(voxels);
+                                if (!fn(origin[0] + (bit & 7), origin[1] + (bit >> 3), origin[2] + z, brickShell(b, (z << 6) + bit)))
+                                {
+                                    return false;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+_MDL_INLINE bool MDL::VoxelBrickMap::empty(const Brick& brick)
+{
+    std::uint64_t any = 0;
+    for (std::uint64_t word : brick.words)
+    {
+        any |= word;
+    }
+    return any == 0;
+}
+
+_MDL_INLINE bool MDL::VoxelBrickMap::full(const Brick& brick)
+{
+    std::uint64_t all = ~std::uint64_t(0);
+    for (std::uint64_t word : brick.words)
+    {
+        all &= word;
+    }
+    return all == ~std::uint64_t(0);
+}
+
+template <typename _Fn>
+_MDL_INLINE void MDL::VoxelBrickMap::forEachVoxel(const Brick& brick, const std::int32_t* coordinate, _Fn&& fn)
+{
+    for (int z = 0; z < BrickSize; ++z)
+    {
+        for (std::uint64_t word = brick.words[z]; word; word &= word - 1)
+        {
+            const int bit = __builtin_ctzll(word);
+            fn((coordinate[0] << BrickShift) + (bit & 7), (coordinate[1] << BrickShift) + (bit >> 3), (coordinate[2] << BrickShift) + z);
+        }
+    }
+}
+
+_MDL_INLINE std::uint64_t MDL::VoxelBrickMap::brickKey(std::int32_t bx, std::int32_t by, std::int32_t bz)
+{
+    return (std::uint64_t(bx + KeyBias) & KeyMask) | ((std::uint64_t(by + KeyBias) & KeyMask) << 21) |
+           ((std::uint64_t(bz + KeyBias) & KeyMask) << 42);
+}
+
+_MDL_INLINE void MDL::VoxelBrickMap::brickKeyCoordinate(std::uint64_t key, std::int32_t* coordinate)
+{
+    coordinate[0] = std::int32_t(key & KeyMask) - KeyBias;
+    coordinate[1] = std::int32_t((key >> 21) & KeyMask) - KeyBias;
+    coordinate[2] = std::int32_t((key >> 42) & KeyMask) - KeyBias;
+}
+
+_MDL_INLINE std::uint32_t MDL::VoxelBrickMap::locate(std::int32_t bx, std::int32_t by, std::int32_t bz) const
+{
+    if (_table.empty())
+    {
+        return NoBrick;
+    }
+
+    constexpr int      upperShift = LowerShift + UpperShift;
+    const NS::UInteger s = slot(brickKey(bx >> upperShift, by >> upperShift, bz >> upperShift));
+    if (_table[s] == EmptyKey)
+    {
+        return NoBrick;
+    }
+
+    const Upper& upper = _uppers[_tableUppers[s]];
+    const int    u = ((bx >> LowerShift) & 15) | (((by >> LowerShift) & 15) << 4) | (((bz >> LowerShift) & 15) << 8);
+    if (!child(upper.mask, u))
+    {
+        return NoBrick;
+    }
+
+    const Lower& lower = _lowers[upper.children[u]];
+    const int    l = (bx & 7) | ((by & 7) << 3) | ((bz & 7) << 6);
+    return child(lower.mask, l) ? lower.children[l] : NoBrick;
+}
+
+_MDL_INLINE int MDL::VoxelBrickMap::emptyShift(std::int32_t x, std::int32_t y, std::int32_t z, std::uint32_t& brick) const
+{
+    const std::int32_t bx = x >> BrickShift, by = y >> BrickShift, bz = z >> BrickShift;
+    constexpr int      upperShift = LowerShift + UpperShift;
+    if (_table.empty())
+    {
+        return BrickShift + upperShift;
+    }
+
+    const NS::UInteger s = slot(brickKey(bx >> upperShift, by >> upperShift, bz >> upperShift));
+    if (_table[s] == EmptyKey)
+    {
+        return BrickShift + upperShift;
+    }
+
+    const Upper& upper = _uppers[_tableUppers[s]];
+    const int    u = ((bx >> LowerShift) & 15) | (((by >> LowerShift) & 15) << 4) | (((bz >> LowerShift) & 15) << 8);
+    if (!child(upper.mask, u))
+    {
+        return BrickShift + LowerShift;
+    }
+
+    const Lower& lower = _lowers[upper.children[u]];
+    const int    l = (bx & 7) | ((by & 7) << 3) | ((bz & 7) << 6);
+    if (!child(lower.mask, l) || empty(_bricks[lower.children[l]]))
+    {
+        return BrickShift;
+    }
+    brick = lower.children[l];
+    return 0;
+}
+
+// Amanatides and Woo, restarted at the node size of each cell the ray
+// enters: the axis it leaves through steps across, the others follow the
+// ray but stay within the cell so every step makes progress
+_MDL_INLINE bool MDL::VoxelBrickMap::march(const float* origin, const float* direction, float tMin, float tMax,
+                                           std::int32_t* voxel, float& t) const
+{
+    if (!(tMin <= tMax) || _bricks.empty())
+    {
+        return false;
+    }
+
+    // Only root regions hold voxels, so the ray starts and ends within them
+    constexpr int regionShift = BrickShift + LowerShift + UpperShift;
+    float         regionLow[3] = { INFINITY, INFINITY, INFINITY }, regionHigh[3] = { -INFINITY, -INFINITY, -INFINITY };
+    for (std::uint64_t key : _upperKeys)
+    {
+        std::int32_t region[3];
+        brickKeyCoordinate(key, region);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            regionLow[axis] = std::min(regionLow[axis], float(region[axis]) * float(1 << regionShift));
+            regionHigh[axis] = std::max(regionHigh[axis], float(region[axis] + 1) * float(1 << regionShift));
+        }
+    }
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (direction[axis] == 0.0f)
+        {
+            if (origin[axis] < regionLow[axis] || origin[axis] >= regionHigh[axis])
+            {
+                return false;
+            }
+            continue;
+        }
+        const float inverse = 1.0f / direction[axis];
+        const float entry = (regionLow[axis] - origin[axis]) * inverse, leave = (regionHigh[axis] - origin[axis]) * inverse;
+        tMin = std::max(tMin, std::min(entry, leave));
+        tMax = std::min(tMax, std::max(entry, leave));
+    }
+    if (!(tMin <= tMax))
+    {
+        return false;
+    }
+
+    std::int32_t cell[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        cell[axis] = std::int32_t(std::floor(origin[axis] + direction[axis] * tMin));
+    }
+    t = tMin;
+
+    while (true)
+    {
+        std::uint32_t brick = NoBrick;
+        const int     shift = emptyShift(cell[0], cell[1], cell[2], brick);
+        if (shift == 0 && (_bricks[brick].words[cell[2] & (BrickSize - 1)] >> ((cell[0] & (BrickSize - 1)) | ((cell[1] & (BrickSize - 1)) << 3)) & 1))
+        {
+            std::copy(cell, cell + 3, voxel);
+            return true;
+        }
+
+        const std::int32_t size = std::int32_t(1) << shift;
+        std::int32_t       low[3];
+        float              exit = std::numeric_limits<float>::infinity();
+        int                across = 0;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            low[axis] = (cell[axis] >> shift) << shift;
+            if (direction[axis] != 0.0f)
+            {
+                const float bound = float(direction[axis] > 0.0f ? low[axis] + size : low[axis]);
+                const float crossing = (bound - origin[axis]) / direction[axis];
+                if (crossing < exit)
+                {
+                    exit = crossing;
+                    across = axis;
+                }
+            }
+        }
+        if (!(exit <= tMax))
+        {
+            return false;
+        }
+
+        t = std::max(t, exit);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (axis == across)
+            {
+                cell[axis] = direction[axis] > 0.0f ? low[axis] + size : low[axis] - 1;
+            }
+            else
+            {
+                const std::int32_t along = std::int32_t(std::floor(origin[axis] + direction[axis] * t));
+                cell[axis] = std::min(std::max(along, low[axis]), low[axis] + size - 1);
+            }
+        }
+    }
+}
+
+_MDL_INLINE NS::UInteger MDL::VoxelBrickMap::slot(std::uint64_t key) const
+{
+    const NS::UInteger mask = _table.size() - 1;
+    NS::UInteger       s = NS::UInteger((key * 0x9E3779B97F4A7C15ull) >> _tableShift);
+    while (_table[s] != EmptyKey && _table[s] != key)
+    {
+        s = (s + 1) & mask;
+    }
+    return s;
+}
+
+_MDL_INLINE void MDL::VoxelBrickMap::rehash(NS::UInteger capacity)
+{
+    _table.assign(capacity, EmptyKey);
+    _tableUppers.assign(capacity, 0);
+    _tableShift = 64 - unsigned(__builtin_ctzll(capacity));
+    for (std::uint32_t u = 0; u < _upperKeys.size(); ++u)
+    {
+        const NS::UInteger s = slot(_upperKeys[u]);
+        _table[s] = _upperKeys[u];
+        _tableUppers[s] = u;
+    }
+}
+
+_MDL_INLINE std::int16_t* MDL::VoxelBrickMap::shells(NS::UInteger brick)
+{
+    if (_brickShells[brick] == NoShells)
+    {
+        _brickShells[brick] = std::uint32_t(_shells.size());
+        _shells.resize(_shells.size() + 512, 0);
+    }
+    return _shells.data() + _brickShells[brick];
+}
+
+_MDL_INLINE bool MDL::VoxelBrickMap::child(const std::uint64_t* mask, int index)
+{
+    return (mask[index >> 6] >> (index & 63)) & 1;
+}
+
+_MDL_INLINE void MDL::VoxelBrickMap::combineBricks(Brick& target, const Brick& source, VoxelBoolean operation)
+{
+#if defined(_MDL_VOXELIZATION_AVX2)
+    for (int half = 0; half < 2; ++half)
+    {
+        __m256i*      t = reinterpret_cast<__m256i*>(target.words) + half;
+        const __m256i a = _mm256_load_si256(t);
+        const __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i*>(source.words) + half);
+        _mm256_store_si256(t, operation == VoxelBooleanUnion          ? _mm256_or_si256(a, b)
+                              : operation == VoxelBooleanIntersection ? _mm256_and_si256(a, b)
+                                                                      : _mm256_andnot_si256(b, a));
+    }
+#elif defined(_MDL_VOXELIZATION_SSE)
+    for (int quarter = 0; quarter < 4; ++quarter)
+    {
+        __m128i*      t = reinterpret_cast<__m128i*>(target.words) + quarter;
+        const __m128i a = _mm_load_si128(t);
+        const __m128i b = _mm_load_si128(reinterpret_cast<const __m128i*>(source.words) + quarter);
+        _mm_store_si128(t, operation == VoxelBooleanUnion          ? _mm_or_si128(a, b)
+                           : operation == VoxelBooleanIntersection ? _mm_and_si128(a, b)
+                                                                   : _mm_andnot_si128(b, a));
+    }
+#elif defined(_MDL_VOXELIZATION_NEON)
+    for (int quarter = 0; quarter < 4; ++quarter)
+    {
+        const uint64x2_t a = vld1q_u64(target.words + quarter * 2);
+        const uint64x2_t b = vld1q_u64(source.words + quarter * 2);
+        vst1q_u64(target.words + quarter * 2, operation == VoxelBooleanUnion          ? vorrq_u64(a, b)
+                                              : operation == VoxelBooleanIntersection ? vandq_u64(a, b)
+                                                                                      : vbicq_u64(a, b));
+    }
+#else
+    for (int w = 0; w < BrickSize; ++w)
+    {
+        target.words[w] = operation == VoxelBooleanUnion          ? target.words[w] | source.words[w]
+                          : operation == VoxelBooleanIntersection ? target.words[w] & source.words[w]
+                                                                  : target.words[w] & ~source.words[w];
+    }
+#endif
+}
+
+// Bits of columns lowX...highX on rows lowY...highY of a brick word
+_MDL_INLINE std::uint64_t MDL::VoxelBrickMap::brickMask(int lowX, int highX, int lowY, int highY)
+{
+    const std::uint64_t row = ((std::uint64_t(2) << highX) - 1) & ~((std::uint64_t(1) << lowX) - 1);
+    const std::uint64_t rows = ((highY == 7 ? ~std::uint64_t(0) : (std::uint64_t(1) << ((highY + 1) * 8)) - 1)) & ~((std::uint64_t(1) << (lowY * 8)) - 1);
+    return (row * 0x0101010101010101ull) & rows;
+}
+
+_MDL_INLINE void MDL::Private::Voxelizer::surface(const Triangles& triangles, const VoxelGrid& grid, float patchRadius, VoxelBrickMap& out)
+{
+    if (!(grid.voxelSize > 0.0f) || triangles.count == 0)
+    {
+        return;
+    }
+
+    // (brick, triangle) pairs for every brick a triangle's grown bounds touch
+    constexpr NS::UInteger                  kGrain = 4096;
+    const NS::UInteger                      chunkCount = (triangles.count + kGrain - 1) / kGrain;
+    std::vector<std::vector<std::uint64_t>> chunkKeys(chunkCount);
+    std::vector<std::vector<std::uint32_t>> chunkTriangles(chunkCount);
+    const float                             brickLength = grid.voxelSize * VoxelBrickMap::BrickSize;
+
+    parallelFor(triangles.count, kGrain, [&](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger chunk = begin / kGrain; chunk * kGrain < end; ++chunk)
+        {
+            std::vector<std::uint64_t>& keys = chunkKeys[chunk];
+            std::vector<std::uint32_t>& owners = chunkTriangles[chunk];
+            for (NS::UInteger t = chunk * kGrain, last = std::min(end, (chunk + 1) * kGrain); t < last; ++t)
+            {
+                const unsigned char* base = reinterpret_cast<const unsigned char*>(triangles.positions);
+                float                low[3], high[3];
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    low[axis] = high[axis] = reinterpret_cast<const float*>(base + triangles.indices[t * 3] * triangles.stride)[axis];
+                }
+                for (int corner = 1; corner < 3; ++corner)
+                {
+                    const float* p = reinterpret_cast<const float*>(base + triangles.indices[t * 3 + corner] * triangles.stride);
+                    for (int axis = 0; axis < 3; ++axis)
+                    {
+                        low[axis] = std::min(low[axis], p[axis]);
+                        high[axis] = std::max(high[axis], p[axis]);
+                    }
+                }
+
+                std::int32_t first[3], last3[3];
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    first[axis] = std::int32_t(std::floor((low[axis] - patchRadius - grid.origin[axis]) / brickLength));
+                    last3[axis] = std::int32_t(std::floor((high[axis] + patchRadius - grid.origin[axis]) / brickLength));
+                }
+                for (std::int32_t bz = first[2]; bz <= last3[2]; ++bz)
+                {
+                    for (std::int32_t by = first[1]; by <= last3[1]; ++by)
+                    {
+                        for (std::int32_t bx = first[0]; bx <= last3[0]; ++bx)
+                        {
+                            keys.push_back(VoxelBrickMap::brickKey(bx, by, bz));
+                            owners.push_back(std::uint32_t(t));
+                        }
+                    }
+                }
+            }
+        }
+    });
+
+    std::vector<std::uint64_t> keys;
+    std::vector<std::uint32_t> owners;
+    for (NS::UInteger chunk = 0; chunk < chunkCount; ++chunk)
+    {
+        keys.insert(keys.end(), chunkKeys[chunk].begin(), chunkKeys[chunk].end());
+        owners.insert(owners.end(), chunkTriangles[chunk].begin(), chunkTriangles[chunk].end());
+        std::vector<std::uint64_t>().swap(chunkKeys[chunk]);
+        std::vector<std::uint32_t>().swap(chunkTriangles[chunk]);
+    }
+    radixSort(keys, owners);
+
+    std::vector<std::uint32_t> runs;
+    for (NS::UInteger i = 0; i < keys.size(); ++i)
+    {
+        if (i == 0 || keys[i] != keys[i - 1])
+        {
+            runs.push_back(std::uint32_t(i));
+        }
+    }
+    runs.push_back(std::uint32_t(keys.size()));
+
+    const NS::UInteger                   runCount = runs.size() - 1;
+    AlignedVector<VoxelBrickMap::Brick>  filled(runCount);
+    parallelFor(runCount, 16, [&](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger r = begin; r < end; ++r)
+        {
+            std::int32_t coordinate[3];
+            VoxelBrickMap::brickKeyCoordinate(keys[runs[r]], coordinate);
+            filled[r] = VoxelBrickMap::Brick {};
+            fillBrick(triangles, owners.data() + runs[r], runs[r + 1] - runs[r], coordinate, grid, patchRadius, filled[r]);
+        }
+    });
+
+    out.reserve(out.brickCount() + runCount);
+    for (NS::UInteger r = 0; r < runCount; ++r)
+    {
+        if (VoxelBrickMap::empty(filled[r]))
+        {
+            continue;
+        }
+        std::int32_t coordinate[3];
+        VoxelBrickMap::brickKeyCoordinate(keys[runs[r]], coordinate);
+        VoxelBrickMap::Brick& target = out.brick(coordinate[0], coordinate[1], coordinate[2]);
+        for (int w = 0; w < VoxelBrickMap::BrickSize; ++w)
+        {
+            target.words[w] |= filled[r].words[w];
+        }
+    }
+}
+
+_MDL_INLINE bool MDL::Private::Voxelizer::setup(const Triangles& triangles, NS::UInteger triangle, float boxSize, Setup& out)
+{
+    const unsigned char* base = reinterpret_cast<const unsigned char*>(triangles.positions);
+    const float*         v[3];
+    for (int corner = 0; corner < 3; ++corner)
+    {
+        v[corner] = reinterpret_cast<const float*>(base + triangles.indices[triangle * 3 + corner] * triangles.stride);
+    }
+
+    float e[3][3];
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            e[i][axis] = v[(i + 1) % 3][axis] - v[i][axis];
+        }
+    }
+
+    float* n = out.normal;
+    n[0] = e[0][1] * e[1][2] - e[0][2] * e[1][1];
+    n[1] = e[0][2] * e[1][0] - e[0][0] * e[1][2];
+    n[2] = e[0][0] * e[1][1] - e[0][1] * e[1][0];
+    if (n[0] == 0.0f && n[1] == 0.0f && n[2] == 0.0f)
+    {
+        return false;
+    }
+
+    // Plane: the box corners nearest and furthest along the normal
+    float nearCorner = 0.0f, farCorner = 0.0f, offset = 0.0f;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float critical = n[axis] > 0.0f ? boxSize : 0.0f;
+        nearCorner += n[axis] * critical;
+        farCorner += n[axis] * (boxSize - critical);
+        offset += n[axis] * v[0][axis];
+    }
+    out.planeNear = nearCorner - offset;
+    out.planeFar = farCorner - offset;
+
+    // Edge normals of the projections onto the xy, yz and zx planes, facing
+    // inwards, with the offset moved to the box corner that tests hardest
+    auto edges = [&](int a, int b, float sign, float (*functions)[3])
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            const float na = -e[i][b] * sign;
+            const float nb = e[i][a] * sign;
+            functions[i][0] = na;
+            functions[i][1] = nb;
+            functions[i][2] = -(na * v[i][a] + nb * v[i][b]) + std::max(0.0f, boxSize * na) + std::max(0.0f, boxSize * nb);
+        }
+    };
+    edges(0, 1, n[2] >= 0.0f ? 1.0f : -1.0f, out.xy);
+    edges(1, 2, n[0] >= 0.0f ? 1.0f : -1.0f, out.yz);
+    edges(2, 0, n[1] >= 0.0f ? 1.0f : -1.0f, out.zx);
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        out.min[axis] = std::min(v[0][axis], std::min(v[1][axis], v[2][axis]));
+        out.max[axis] = std::max(v[0][axis], std::max(v[1][axis], v[2][axis]));
+    }
+    return true;
+}
+
+_MDL_INLINE void MDL::Private::Voxelizer::fillBrick(const Triangles& triangles, const std::uint32_t* list, NS::UInteger count,
+                                                     const std::int32_t* coordinate, const VoxelGrid& grid, float patchRadius,
+                                                     VoxelBrickMap::Brick& out)
+{
+    constexpr int size = VoxelBrickMap::BrickSize;
+    const float   boxSize = grid.voxelSize + 2.0f * patchRadius;
+    std::int32_t  origin[3];
+    float         corner[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        origin[axis] = coordinate[axis] * size;
+        corner[axis] = grid.origin[axis] - patchRadius;
+    }
+
+    // Minimum corners of the grown boxes along x for the eight columns
+    float columns[size];
+    for (int x = 0; x < size; ++x)
+    {
+        columns[x] = corner[0] + float(origin[0] + x) * grid.voxelSize;
+    }
+
+    for (NS::UInteger t = 0; t < count; ++t)
+    {
+        Setup s;
+        if (!setup(triangles, list[t], boxSize, s))
+        {
+            continue;
+        }
+
+        int first[3], last[3];
+        bool overlaps = true;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            first[axis] = std::max(0, int(std::floor((s.min[axis] - patchRadius - grid.origin[axis]) / grid.voxelSize)) - origin[axis]);
+            last[axis] = std::min(size - 1, int(std::floor((s.max[axis] + patchRadius - grid.origin[axis]) / grid.voxelSize)) - origin[axis]);
+            overlaps = overlaps && first[axis] <= last[axis];
+        }
+        if (!overlaps)
+        {
+            continue;
+        }
+        const unsigned columnMask = ((1u << (last[0] + 1)) - 1) & ~((1u << first[0]) - 1);
+
+        for (int z = first[2]; z <= last[2]; ++z)
+        {
+            const float pz = corner[2] + float(origin[2] + z) * grid.voxelSize;
+            for (int y = first[1]; y <= last[1]; ++y)
+            {
+                const float py = corner[1] + float(origin[1] + y) * grid.voxelSize;
+                if (s.yz[0][0] * py + s.yz[0][1] * pz + s.yz[0][2] < 0.0f ||
+                    s.yz[1][0] * py + s.yz[1][1] * pz + s.yz[1][2] < 0.0f ||
+                    s.yz[2][0] * py + s.yz[2][1] * pz + s.yz[2][2] < 0.0f)
+                {
+                    continue;
+                }
+
+                // Everything left is linear in x: slope * px + offset
+                const float plane = s.normal[1] * py + s.normal[2] * pz;
+                const float xy0 = s.xy[0][1] * py + s.xy[0][2], xy1 = s.xy[1][1] * py + s.xy[1][2], xy2 = s.xy[2][1] * py + s.xy[2][2];
+                const float zx0 = s.zx[0][0] * pz + s.zx[0][2], zx1 = s.zx[1][0] * pz + s.zx[1][2], zx2 = s.zx[2][0] * pz + s.zx[2][2];
+
+                unsigned row = 0;
+#if defined(_MDL_VOXELIZATION_SSE)
+                for (int half = 0; half < 2; ++half)
+                {
+                    const __m128 px = _mm_loadu_ps(columns + half * 4);
+                    const __m128 distance = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(s.normal[0]), px), _mm_set1_ps(plane));
+                    const __m128 product = _mm_mul_ps(_mm_add_ps(distance, _mm_set1_ps(s.planeNear)), _mm_add_ps(distance, _mm_set1_ps(s.planeFar)));
+                    __m128       pass = _mm_cmple_ps(product, _mm_setzero_ps());
+                    pass = _mm_and_ps(pass, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(s.xy[0][0]), px), _mm_set1_ps(xy0)), _mm_setzero_ps()));
+                    pass = _mm_and_ps(pass, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(s.xy[1][0]), px), _mm_set1_ps(xy1)), _mm_setzero_ps()));
+                    pass = _mm_and_ps(pass, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(s.xy[2][0]), px), _mm_set1_ps(xy2)), _mm_setzero_ps()));
+                    pass = _mm_and_ps(pass, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(s.zx[0][1]), px), _mm_set1_ps(zx0)), _mm_setzero_ps()));
+                    pass = _mm_and_ps(pass, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(s.zx[1][1]), px), _mm_set1_ps(zx1)), _mm_setzero_ps()));
+                    pass = _mm_and_ps(pass, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(s.zx[2][1]), px), _mm_set1_ps(zx2)), _mm_setzero_ps()));
+                    row |= unsigned(_mm_movemask_ps(pass)) << (half * 4);
+                }
+#elif defined(_MDL_VOXELIZATION_NEON)
+                static const std::uint32_t kLaneBits[4] = { 1, 2, 4, 8 };
+                const uint32x4_t laneBits = vld1q_u32(kLaneBits);
+                for (int half = 0; half < 2; ++half)
+                {
+                    const float32x4_t px = vld1q_f32(columns + half * 4);
+                    const float32x4_t zero = vdupq_n_f32(0.0f);
+                    const float32x4_t distance = vfmaq_n_f32(vdupq_n_f32(plane), px, s.normal[0]);
+                    const float32x4_t product = vmulq_f32(vaddq_f32(distance, vdupq_n_f32(s.planeNear)), vaddq_f32(distance, vdupq_n_f32(s.planeFar)));
+                    uint32x4_t        pass = vcleq_f32(product, zero);
+                    pass = vandq_u32(pass, vcgeq_f32(vfmaq_n_f32(vdupq_n_f32(xy0), px, s.xy[0][0]), zero));
+                    pass = vandq_u32(pass, vcgeq_f32(vfmaq_n_f32(vdupq_n_f32(xy1), px, s.xy[1][0]), zero));
+                    pass = vandq_u32(pass, vcgeq_f32(vfmaq_n_f32(vdupq_n_f32(xy2), px, s.xy[2][0]), zero));
+                    pass = vandq_u32(pass, vcgeq_f32(vfmaq_n_f32(vdupq_n_f32(zx0), px, s.zx[0][1]), zero));
+                    pass = vandq_u32(pass, vcgeq_f32(vfmaq_n_f32(vdupq_n_f32(zx1), px, s.zx[1][1]), zero));
+                    pass = vandq_u32(pass, vcgeq_f32(vfmaq_n_f32(vdupq_n_f32(zx2), px, s.zx[2][1]), zero));
+                    row |= unsigned(vaddvq_u32(vandq_u32(pass, laneBits))) << (half * 4);
+                }
+#else
+                for (int x = first[0]; x <= last[0]; ++x)
+                {
+                    const float px = columns[x];
+                    const float distance = s.normal[0] * px + plane;
+                    if ((distance + s.planeNear) * (distance + s.planeFar) <= 0.0f &&
+                        s.xy[0][0] * px + xy0 >= 0.0f && s.xy[1][0] * px + xy1 >= 0.0f && s.xy[2][0] * px + xy2 >= 0.0f &&
+                        s.zx[0][1] * px + zx0 >= 0.0f && s.zx[1][1] * px + zx1 >= 0.0f && s.zx[2][1] * px + zx2 >= 0.0f)
+                    {
+                        row |= 1u << x;
+                    }
+                }
+#endif
+                out.words[z] |= std::uint64_t(row & columnMask) << (y * 8);
+            }
+        }
+    }
+}
+
+_MDL_INLINE void MDL::Private::Voxelizer::shells(const Triangles& triangles, const VoxelGrid& grid, const VoxelBrickMap& surface,
+                                                  int interior, int exterior, std::vector<VoxelBrickMap>& layers)
+{
+    interior = std::max(interior, 0);
+    exterior = std::max(exterior, 0);
+    layers.assign(NS::UInteger(interior + exterior + 1), VoxelBrickMap());
+    layers[interior] = surface;
+
+    const int rounds = std::max(interior, exterior);
+    if (rounds == 0)
+    {
+        return;
+    }
+
+    Crossings sides;
+    crossings(triangles, grid, sides);
+
+    VoxelBrickMap reached = surface, grown;
+    for (int shell = 1; shell <= rounds; ++shell)
+    {
+        dilate(reached, grown);
+
+        // Each new voxel goes inside or outside; sides that are done stop
+        // growing
+        const bool                          keepInside = shell <= interior;
+        const bool                          keepOutside = shell <= exterior;
+        AlignedVector<VoxelBrickMap::Brick> inside(grown.brickCount()), outside(grown.brickCount());
+        parallelFor(grown.brickCount(), 64, [&](NS::UInteger begin, NS::UInteger end)
+        {
+            for (NS::UInteger b = begin; b < end; ++b)
+            {
+                std::int32_t coordinate[3];
+                grown.brickCoordinate(b, coordinate);
+                const VoxelBrickMap::Brick* before = reached.findBrick(coordinate[0], coordinate[1], coordinate[2]);
+
+                VoxelBrickMap::Brick fresh = grown.brickAt(b);
+                for (int w = 0; w < VoxelBrickMap::BrickSize; ++w)
+                {
+                    fresh.words[w] &= before ? ~before->words[w] : ~std::uint64_t(0);
+                }
+                inside[b] = outside[b] = VoxelBrickMap::Brick {};
+                VoxelBrickMap::forEachVoxel(fresh, coordinate, [&](std::int32_t x, std::int32_t y, std::int32_t z)
+                {
+                    VoxelBrickMap::Brick& side = sides.inside(x, y, z, grid) ? inside[b] : outside[b];
+                    side.words[z & 7] |= std::uint64_t(1) << ((x & 7) | ((y & 7) << 3));
+                });
+            }
+        });
+
+        for (NS::UInteger b = 0; b < grown.brickCount(); ++b)
+        {
+            std::int32_t coordinate[3];
+            grown.brickCoordinate(b, coordinate);
+            for (int side = 0; side < 2; ++side)
+            {
+                const VoxelBrickMap::Brick& fresh = side == 0 ? inside[b] : outside[b];
+                if ((side == 0 ? !keepInside : !keepOutside) || VoxelBrickMap::empty(fresh))
+                {
+                    continue;
+                }
+                VoxelBrickMap::Brick& layer = layers[NS::UInteger(side == 0 ? interior - shell : interior + shell)].brick(coordinate[0], coordinate[1], coordinate[2]);
+                VoxelBrickMap::Brick& next = reached.brick(coordinate[0], coordinate[1], coordinate[2]);
+                for (int w = 0; w < VoxelBrickMap::BrickSize; ++w)
+                {
+                    layer.words[w] |= fresh.words[w];
+                    next.words[w] |= fresh.words[w];
+                }
+            }
+        }
+    }
+}
+
+_MDL_INLINE void MDL::Private::Voxelizer::dilate(const VoxelBrickMap& in, VoxelBrickMap& out)
+{
+    VoxelBrickMap alongX, alongY;
+    dilateAxis(in, 0, alongX);
+    dilateAxis(alongX, 1, alongY);
+    dilateAxis(alongY, 2, out);
+}
+
+_MDL_INLINE void MDL::Private::Voxelizer::dilateAxis(const VoxelBrickMap& in, int axis, VoxelBrickMap& out)
+{
+    constexpr std::uint64_t firstColumn = 0x0101010101010101ull;
+    constexpr std::uint64_t lastColumn = 0x8080808080808080ull;
+    constexpr std::uint64_t firstRow = 0xFFull;
+    constexpr std::uint64_t lastRow = 0xFFull << 56;
+
+    // Bricks reached: every brick, and a neighbor along the axis when the
+    // facing slab has a voxel
+    out.clear();
+    out.reserve(in.brickCount() * 2);
+    for (NS::UInteger b = 0; b < in.brickCount(); ++b)
+    {
+        const VoxelBrickMap::Brick& brick = in.brickAt(b);
+        if (VoxelBrickMap::empty(brick))
+        {
+            continue;
+        }
+
+        std::uint64_t low = 0, high = 0;
+        for (int w = 0; w < VoxelBrickMap::BrickSize; ++w)
+        {
+            low |= axis == 0 ? brick.words[w] & firstColumn : axis == 1 ? brick.words[w] & firstRow : 0;
+            high |= axis == 0 ? brick.words[w] & lastColumn : axis == 1 ? brick.words[w] & lastRow : 0;
+        }
+        if (axis == 2)
+        {
+            low = brick.words[0];
+            high = brick.words[7];
+        }
+
+        std::int32_t coordinate[3];
+        in.brickCoordinate(b, coordinate);
+        out.brick(coordinate[0], coordinate[1], coordinate[2]);
+        coordinate[axis] -= 1;
+        if (low)
+        {
+            out.brick(coordinate[0], coordinate[1], coordinate[2]);
+        }
+        coordinate[axis] += 2;
+        if (high)
+        {
+            out.brick(coordinate[0], coordinate[1], coordinate[2]);
+        }
+    }
+
+    parallelFor(out.brickCount(), 64, [&](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger b = begin; b < end; ++b)
+        {
+            std::int32_t coordinate[3];
+            out.brickCoordinate(b, coordinate);
+            const VoxelBrickMap::Brick* self = in.findBrick(coordinate[0], coordinate[1], coordinate[2]);
+            coordinate[axis] -= 1;
+            const VoxelBrickMap::Brick* below = in.findBrick(coordinate[0], coordinate[1], coordinate[2]);
+            coordinate[axis] += 2;
+            const VoxelBrickMap::Brick* above = in.findBrick(coordinate[0], coordinate[1], coordinate[2]);
+
+            VoxelBrickMap::Brick& result = out.brickAt(b);
+            for (int w = 0; w < VoxelBrickMap::BrickSize; ++w)
+            {
+                const std::uint64_t word = self ? self->words[w] : 0;
+                std::uint64_t       value = word;
+                if (axis == 0)
+                {
+                    value |= ((word << 1) & ~firstColumn) | ((word >> 1) & ~lastColumn);
+                    value |= below ? (below->words[w] >> 7) & firstColumn : 0;
+                    value |= above ? (above->words[w] & firstColumn) << 7 : 0;
+                }
+                else if (axis == 1)
+                {
+                    value |= (word << 8) | (word >> 8);
+                    value |= below ? below->words[w] >> 56 : 0;
+                    value |= above ? (above->words[w] & firstRow) << 56 : 0;
+                }
+                else if (self)
+                {
+                    value |= (w > 0 ? self->words[w - 1] : 0) | (w < 7 ? self->words[w + 1] : 0);
+                }
+                if (axis == 2)
+                {
+                    value |= (w == 0 && below) ? below->words[7] : 0;
+                    value |= (w == 7 && above) ? above->words[0] : 0;
+                }
+                result.words[w] = value;
+            }
+        }
+    });
+}
+
+_MDL_INLINE void MDL::Private::Voxelizer::crossings(const Triangles& triangles, const VoxelGrid& grid, Crossings& out)
+{
+    // Row and hit position (as bits) for every voxel center a triangle covers
+    // in the yz projection; edges shared by two triangles count once
+    constexpr NS::UInteger                  kGrain = 4096;
+    const NS::UInteger                      chunkCount = (triangles.count + kGrain - 1) / kGrain;
+    std::vector<std::vector<std::uint64_t>> chunkRows(chunkCount);
+    std::vector<std::vector<std::uint32_t>> chunkHits(chunkCount);
+    const float                             size = grid.voxelSize;
+
+    parallelFor(triangles.count, kGrain, [&](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger chunk = begin / kGrain; chunk * kGrain < end; ++chunk)
+        {
+            for (NS::UInteger t = chunk * kGrain, last = std::min(end, (chunk + 1) * kGrain); t < last; ++t)
+            {
+                const unsigned char* base = reinterpret_cast<const unsigned char*>(triangles.positions);
+                const float*         a = reinterpret_cast<const float*>(base + triangles.indices[t * 3] * triangles.stride);
+                const float*         b = reinterpret_cast<const float*>(base + triangles.indices[t * 3 + 1] * triangles.stride);
+                const float*         c = reinterpret_cast<const float*>(base + triangles.indices[t * 3 + 2] * triangles.stride);
+
+                const float area = (b[1] - a[1]) * (c[2] - a[2]) - (b[2] - a[2]) * (c[1] - a[1]);
+                if (area == 0.0f)
+                {
+                    continue;
+                }
+                if (area < 0.0f)
+                {
+                    std::swap(b, c);
+                }
+                const float* corners[3] = { a, b, c };
+
+                // Normal x component, for the plane solve
+                const float nx = (b[1] - a[1]) * (c[2] - a[2]) - (b[2] - a[2]) * (c[1] - a[1]);
+                const float ny = (b[2] - a[2]) * (c[0] - a[0]) - (b[0] - a[0]) * (c[2] - a[2]);
+                const float nz = (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+
+                const std::int32_t y0 = std::int32_t(std::ceil((std::min(a[1], std::min(b[1], c[1])) - grid.origin[1]) / size - 0.5f));
+                const std::int32_t y1 = std::int32_t(std::floor((std::max(a[1], std::max(b[1], c[1])) - grid.origin[1]) / size - 0.5f));
+                const std::int32_t z0 = std::int32_t(std::ceil((std::min(a[2], std::min(b[2], c[2])) - grid.origin[2]) / size - 0.5f));
+                const std::int32_t z1 = std::int32_t(std::floor((std::max(a[2], std::max(b[2], c[2])) - grid.origin[2]) / size - 0.5f));
+
+                for (std::int32_t z = z0; z <= z1; ++z)
+                {
+                    const float cz = grid.origin[2] + (float(z) + 0.5f) * size;
+                    for (std::int32_t y = y0; y <= y1; ++y)
+                    {
+                        const float cy = grid.origin[1] + (float(y) + 0.5f) * size;
+                        bool        covered = true;
+                        for (int i = 0; i < 3 && covered; ++i)
+                        {
+                            const float* p = corners[i];
+                            const float* q = corners[(i + 1) % 3];
+                            const float  dy = q[1] - p[1], dz = q[2] - p[2];
+                            const float  edge = dy * (cz - p[2]) - dz * (cy - p[1]);
+                            // Top-left rule: of two triangles sharing an
+                            // edge, exactly one owns the centers on it
+                            covered = edge > 0.0f || (edge == 0.0f && (dz < 0.0f || (dz == 0.0f && dy > 0.0f)));
+                        }
+                        if (!covered)
+                        {
+                            continue;
+                        }
+                        const float hit = a[0] - (ny * (cy - a[1]) + nz * (cz - a[2])) / nx;
+                        std::uint32_t bits;
+                        std::memcpy(&bits, &hit, sizeof(bits));
+                        chunkRows[chunk].push_back(rowKey(y, z));
+                        chunkHits[chunk].push_back(bits);
+                    }
+                }
+            }
+        }
+    });
+
+    std::vector<std::uint64_t> rows;
+    std::vector<std::uint32_t> hits;
+    for (NS::UInteger chunk = 0; chunk < chunkCount; ++chunk)
+    {
+        rows.insert(rows.end(), chunkRows[chunk].begin(), chunkRows[chunk].end());
+        hits.insert(hits.end(), chunkHits[chunk].begin(), chunkHits[chunk].end());
+    }
+    radixSort(rows, hits);
+
+    out.rows.clear();
+    out.starts.clear();
+    out.hits.resize(hits.size());
+    for (NS::UInteger i = 0; i < rows.size(); ++i)
+    {
+        if (i == 0 || rows[i] != rows[i - 1])
+        {
+            out.rows.push_back(rows[i]);
+            out.starts.push_back(std::uint32_t(i));
+        }
+        std::memcpy(&out.hits[i], &hits[i], sizeof(float));
+    }
+    out.starts.push_back(std::uint32_t(rows.size()));
+
+    parallelFor(out.rows.size(), 256, [&](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger r = begin; r < end; ++r)
+        {
+            std::sort(out.hits.begin() + out.starts[r], out.hits.begin() + out.starts[r + 1]);
+        }
+    });
+}
+
+_MDL_INLINE bool MDL::Private::Voxelizer::Crossings::inside(std::int32_t x, std::int32_t y, std::int32_t z, const VoxelGrid& grid) const
+{
+    auto row = std::lower_bound(rows.begin(), rows.end(), rowKey(y, z));
+    if (row == rows.end() || *row != rowKey(y, z))
+    {
+        return false;
+    }
+    const NS::UInteger r = NS::UInteger(row - rows.begin());
+    const float        center = grid.origin[0] + (float(x) + 0.5f) * grid.voxelSize;
+    const NS::UInteger before = NS::UInteger(std::lower_bound(hits.begin() + starts[r], hits.begin() + starts[r + 1], center) -
+                                             (hits.begin() + starts[r]));
+    return (before & 1) != 0;
+}
+
+_MDL_INLINE std::uint64_t MDL::Private::Voxelizer::rowKey(std::int32_t y, std::int32_t z)
+{
+    return (std::uint64_t(std::uint32_t(z) ^ 0x80000000u) << 32) | (std::uint32_t(y) ^ 0x80000000u);
+}
+
+_MDL_INLINE MDL::VoxelBrickMap& MDL::Private::VoxelArrayState::writableBricks()
+{
+    if (bricks.use_count() > 1)
+    {
+        bricks = std::make_shared<VoxelBrickMap>(*bricks);
+    }
+    return *bricks;
+}
+
+// Floor by truncation, corrected below zero
+_MDL_INLINE void MDL::Private::voxelIndices(const VoxelGrid& grid, const float* locations, NS::UInteger count, std::int32_t* indices)
+{
+    const float inverse = 1.0f / grid.voxelSize;
+    parallelFor(count, 4096, [&](NS::UInteger begin, NS::UInteger end)
+    {
+#if defined(_MDL_VOXELIZATION_SSE)
+        const __m128  origin = _mm_setr_ps(grid.origin[0], grid.origin[1], grid.origin[2], 0.0f);
+        const __m128  scale = _mm_set1_ps(inverse);
+        const __m128i lanes = _mm_setr_epi32(-1, -1, -1, 0);
+        for (NS::UInteger i = begin; i < end; ++i)
+        {
+            const __m128  u = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(locations + i * 4), origin), scale);
+            const __m128i truncated = _mm_cvttps_epi32(u);
+            const __m128i below = _mm_castps_si128(_mm_cmplt_ps(u, _mm_cvtepi32_ps(truncated)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(indices + i * 4), _mm_and_si128(_mm_add_epi32(truncated, below), lanes));
+        }
+#elif defined(_MDL_VOXELIZATION_NEON)
+        const float32x4_t origin = { grid.origin[0], grid.origin[1], grid.origin[2], 0.0f };
+        const int32x4_t   lanes = { -1, -1, -1, 0 };
+        for (NS::UInteger i = begin; i < end; ++i)
+        {
+            const float32x4_t u = vmulq_n_f32(vsubq_f32(vld1q_f32(locations + i * 4), origin), inverse);
+            vst1q_s32(indices + i * 4, vandq_s32(vcvtmq_s32_f32(u), lanes));
+        }
+#else
+        for (NS::UInteger i = begin; i < end; ++i)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                indices[i * 4 + axis] = std::int32_t(std::floor((locations[i * 4 + axis] - grid.origin[axis]) * inverse));
+            }
+            indices[i * 4 + 3] = 0;
+        }
+#endif
+    });
+}
+
+_MDL_INLINE void MDL::Private::voxelCenters(const VoxelGrid& grid, const std::int32_t* indices, NS::UInteger count, float* locations)
+{
+    parallelFor(count, 4096, [&](NS::UInteger begin, NS::UInteger end)
+    {
+#if defined(_MDL_VOXELIZATION_SSE)
+        const __m128 half = _mm_setr_ps(0.5f, 0.5f, 0.5f, 0.0f);
+        const __m128 mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+        const __m128 origin = _mm_setr_ps(grid.origin[0], grid.origin[1], grid.origin[2], 0.0f);
+        const __m128 size = _mm_set1_ps(grid.voxelSize);
+        for (NS::UInteger i = begin; i < end; ++i)
+        {
+            const __m128 index = _mm_and_ps(_mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + i * 4))), mask);
+            _mm_storeu_ps(locations + i * 4, _mm_add_ps(origin, _mm_mul_ps(_mm_add_ps(index, half), size)));
+        }
+#elif defined(_MDL_VOXELIZATION_NEON)
+        const float32x4_t half = { 0.5f, 0.5f, 0.5f, 0.0f };
+        const float32x4_t origin = { grid.origin[0], grid.origin[1], grid.origin[2], 0.0f };
+        const uint32x4_t  mask = { ~0u, ~0u, ~0u, 0u };
+        for (NS::UInteger i = begin; i < end; ++i)
+        {
+            const float32x4_t index = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(vcvtq_f32_s32(vld1q_s32(indices + i * 4))), mask));
+            vst1q_f32(locations + i * 4, vfmaq_n_f32(origin, vaddq_f32(index, half), grid.voxelSize));
+        }
+#else
+        for (NS::UInteger i = begin; i < end; ++i)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                locations[i * 4 + axis] = grid.origin[axis] + (float(indices[i * 4 + axis]) + 0.5f) * grid.voxelSize;
+            }
+            locations[i * 4 + 3] = 0.0f;
+        }
+#endif
+    });
+}
+
+_MDL_INLINE void MDL::Private::voxelBounds(const VoxelGrid& grid, const std::int32_t* indices, NS::UInteger count, float* boxes)
+{
+    parallelFor(count, 4096, [&](NS::UInteger begin, NS::UInteger end)
+    {
+#if defined(_MDL_VOXELIZATION_SSE)
+        const __m128 mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+        const __m128 origin = _mm_setr_ps(grid.origin[0], grid.origin[1], grid.origin[2], 0.0f);
+        const __m128 size = _mm_set1_ps(grid.voxelSize);
+        for (NS::UInteger i = begin; i < end; ++i)
+        {
+            const __m128 index = _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + i * 4)));
+            const __m128 minimum = _mm_and_ps(_mm_add_ps(origin, _mm_mul_ps(index, size)), mask);
+            _mm_storeu_ps(boxes + i * 8, _mm_and_ps(_mm_add_ps(minimum, size), mask));
+            _mm_storeu_ps(boxes + i * 8 + 4, minimum);
+        }
+#elif defined(_MDL_VOXELIZATION_NEON)
+        const float32x4_t origin = { grid.origin[0], grid.origin[1], grid.origin[2], 0.0f };
+        const float32x4_t size = { grid.voxelSize, grid.voxelSize, grid.voxelSize, 0.0f };
+        const uint32x4_t  mask = { ~0u, ~0u, ~0u, 0u };
+        for (NS::UInteger i = begin; i < end; ++i)
+        {
+            const float32x4_t index = vcvtq_f32_s32(vld1q_s32(indices + i * 4));
+            const float32x4_t minimum = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(vfmaq_f32(origin, index, size)), mask));
+            vst1q_f32(boxes + i * 8, vaddq_f32(minimum, size));
+            vst1q_f32(boxes + i * 8 + 4, minimum);
+        }
+#else
+        for (NS::UInteger i = begin; i < end; ++i)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const float minimum = grid.origin[axis] + float(indices[i * 4 + axis]) * grid.voxelSize;
+                boxes[i * 8 + axis] = minimum + grid.voxelSize;
+                boxes[i * 8 + 4 + axis] = minimum;
+            }
+            boxes[i * 8 + 3] = boxes[i * 8 + 7] = 0.0f;
+        }
+#endif
+    });
+}
+
+_MDL_INLINE MDL::Private::VoxelArrayStore& MDL::Private::VoxelArrayStore::shared()
+{
+    static VoxelArrayStore store;
+    return store;
+}
+
+_MDL_INLINE std::shared_ptr<MDL::Private::VoxelArrayState> MDL::Private::VoxelArrayStore::find(const void* array)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _states.find(array);
+    return it == _states.end() ? nullptr : it->second;
+}
+
+_MDL_INLINE void MDL::Private::VoxelArrayStore::insert(const void* array, std::shared_ptr<VoxelArrayState> state)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _states[array] = std::move(state);
+    }
+    ObjectLifetime::watch(array, this, &VoxelArrayStore::evict);
+}
+
+_MDL_INLINE void MDL::Private::VoxelArrayStore::remove(const void* array)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _states.erase(array);
+}
+
+_MDL_INLINE void MDL::Private::VoxelArrayStore::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _states.clear();
+}
+
+_MDL_INLINE void MDL::Private::VoxelArrayStore::evict(const void* array)
+{
+    shared().remove(array);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
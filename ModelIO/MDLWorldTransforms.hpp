@@ -0,0 +1,401 @@
+/*!
+ @header MDLWorldTransforms.hpp
+ @framework ModelIO
+ @abstract World matrices of a whole hierarchy, evaluated in one pass per time
+ @copyright Treata Norouzi on 10/19/26.
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+#include "MDLDefines.hpp"
+#include "MDLParallel.hpp"
+#include "MDLSceneGraph.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define _MDL_WORLD_TRANSFORMS_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define _MDL_WORLD_TRANSFORMS_NEON 1
+#endif
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace MDL
+{
+namespace Private
+{
+    class WorldTransformCache;
+}
+
+// World matrices of a scene graph node and everything below it at one time
+class WorldTransformTable
+{
+public:
+    using NodeId = Private::SceneGraph::NodeId;
+    using Matrix = Private::SceneGraph::Matrix;
+
+    NodeId                          root() const;
+    double                          time() const;
+
+    NS::UInteger                    count() const;
+    // Pre-order, parents before their children
+    const NodeId*                   nodes() const;
+    // One per entry of nodes()
+    const Matrix*                   matrices() const;
+
+    // World matrix of `node`, or nullptr if it is not below the root
+    const Matrix*                   find(NodeId node) const;
+
+private:
+    friend class Private::WorldTransformCache;
+
+    static constexpr std::uint32_t  NoSlot = UINT32_MAX;
+
+    NodeId                          _root = Private::SceneGraph::InvalidNode;
+    double                          _time = 0.0;
+    std::vector<NodeId>             _nodes;
+    std::vector<Matrix>             _matrices;
+    // Index into _nodes by node id
+    std::vector<std::uint32_t>      _slots;
+};
+
+namespace Private
+{
+    // Tables by root and time, valid until the hierarchy or a local transform
+    // changes. Evaluation walks the scene graph once in pre-order: nodes with
+    // a static transform use the matrix stored in the graph, animated ones are
+    // sampled (serially, since sampling calls into ModelIO), and the products
+    // are then formed parent before child, optionally with independent
+    // subtrees spread over the worker pool.
+    class WorldTransformCache
+    {
+    public:
+        using NodeId = SceneGraph::NodeId;
+        using Matrix = SceneGraph::Matrix;
+
+        // Tables kept before the oldest are dropped
+        static constexpr NS::UInteger                   MaxTables = 64;
+        // Below this many nodes the parallel variant runs serially
+        static constexpr NS::UInteger                   ParallelThreshold = 1 << 14;
+
+        static WorldTransformCache&                     shared();
+
+        // `sample(node, time, float* columns)` writes the local transform of
+        // an animated node at `time`
+        template <typename _Sampler>
+        std::shared_ptr<const WorldTransformTable>      evaluate(NodeId root, double time, bool parallel, _Sampler&& sample);
+
+        void                                            clear();
+
+        // out = a * b, column-major
+        static void                                     multiply(const Matrix& a, const Matrix& b, Matrix& out);
+
+    private:
+        struct Entry
+        {
+            std::shared_ptr<const WorldTransformTable>  table;
+            std::uint64_t                               use;
+        };
+
+        std::mutex                                      _mutex;
+        std::map<std::pair<NodeId, double>, Entry>      _tables;
+        std::uint64_t                                   _generation = UINT64_MAX;
+        std::uint64_t                                   _transformGeneration = UINT64_MAX;
+        std::uint64_t                                   _use = 0;
+    };
+
+} // Private
+} // MDL
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// MARK: - Private Sector
+
+_MDL_INLINE MDL::WorldTransformTable::NodeId MDL::WorldTransformTable::root() const
+{
+    return _root;
+}
+
+_MDL_INLINE double MDL::WorldTransformTable::time() const
+{
+    return _time;
+}
+
+_MDL_INLINE NS::UInteger MDL::WorldTransformTable::count() const
+{
+    return _nodes.size();
+}
+
+_MDL_INLINE const MDL::WorldTransformTable::NodeId* MDL::WorldTransformTable::nodes() const
+{
+    return _nodes.data();
+}
+
+_MDL_INLINE const MDL::WorldTransformTable::Matrix* MDL::WorldTransformTable::matrices() const
+{
+    return _matrices.data();
+}
+
+_MDL_INLINE const MDL::WorldTransformTable::Matrix* MDL::WorldTransformTable::find(NodeId node) const
+{
+    if (node >= _slots.size() || _slots[node] == NoSlot)
+    {
+        return nullptr;
+    }
+    return &_matrices[_slots[node]];
+}
+
+_MDL_INLINE MDL::Private::WorldTransformCache& MDL::Private::WorldTransformCache::shared()
+{
+    static WorldTransformCache cache;
+    return cache;
+}
+
+_MDL_INLINE void MDL::Private::WorldTransformCache::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _tables.clear();
+}
+
+_MDL_INLINE void MDL::Private::WorldTransformCache::multiply(const Matrix& a, const Matrix& b, Matrix& out)
+{
+#if defined(_MDL_WORLD_TRANSFORMS_SSE)
+    const __m128 a0 = _mm_load_ps(a.columns + 0);
+    const __m128 a1 = _mm_load_ps(a.columns + 4);
+    const __m128 a2 = _mm_load_ps(a.columns + 8);
+    const __m128 a3 = _mm_load_ps(a.columns + 12);
+    for (int column = 0; column < 4; ++column)
+    {
+        const float* bc = b.columns + column * 4;
+        __m128 r = _mm_mul_ps(a0, _mm_set1_ps(bc[0]));
+        r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(bc[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(bc[2])));
+        r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(bc[3])));
+        _mm_store_ps(out.columns + column * 4, r);
+    }
+#elif defined(_MDL_WORLD_TRANSFORMS_NEON)
+    const float32x4_t a0 = vld1q_f32(a.columns + 0);
+    const float32x4_t a1 = vld1q_f32(a.columns + 4);
+    const float32x4_t a2 = vld1q_f32(a.columns + 8);
+    const float32x4_t a3 = vld1q_f32(a.columns + 12);
+    for (int column = 0; column < 4; ++column)
+    {
+        const float32x4_t bc = vld1q_f32(b.columns + column * 4);
+        float32x4_t r = vmulq_lane_f32(a0, vget_low_f32(bc), 0);
+        r = vmlaq_lane_f32(r, a1, vget_low_f32(bc), 1);
+        r = vmlaq_lane_f32(r, a2, vget_high_f32(bc), 0);
+        r = vmlaq_lane_f32(r, a3, vget_high_f32(bc), 1);
+        vst1q_f32(out.columns + column * 4, r);
+    }
+#else
+    Matrix result;
+    for (int column = 0; column < 4; ++column)
+    {
+        for (int row = 0; row < 4; ++row)
+        {
+            result.columns[column * 4 + row] = a.columns[row] * b.columns[column * 4] +
+                                               a.columns[4 + row] * b.columns[column * 4 + 1] +
+                                               a.columns[8 + row] * b.columns[column * 4 + 2] +
+                                               a.columns[12 + row] * b.columns[column * 4 + 3];
+        }
+    }
+    out = result;
+#endif
+}
+
+template <typename _Sampler>
+_MDL_INLINE std::shared_ptr<const MDL::WorldTransformTable> MDL::Private::WorldTransformCache::evaluate(NodeId root, double time,
+                                                                                                         bool parallel, _Sampler&& sample)
+{
+    const SceneGraph& graph = SceneGraph::shared();
+    if (root >= graph.capacity() || !(graph.flags(root) & SceneGraph::FlagLive))
+    {
+        return nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_generation != graph.generation() || _transformGeneration != graph.transformGeneration())
+        {
+            _tables.clear();
+            _generation = graph.generation();
+            _transformGeneration = graph.transformGeneration();
+        }
+
+        auto it = _tables.find({ root, time });
+        if (it != _tables.end())
+        {
+            it->second.use = ++_use;
+            return it->second.table;
+        }
+    }
+
+    auto table = std::make_shared<WorldTransformTable>();
+    table->_root = root;
+    table->_time = time;
+
+    std::vector<NodeId>& nodes = table->_nodes;
+    graph.subtree(root, nodes);
+    const NS::UInteger count = nodes.size();
+
+    table->_slots.assign(graph.capacity(), WorldTransformTable::NoSlot);
+    for (NS::UInteger i = 0; i < count; ++i)
+    {
+        table->_slots[nodes[i]] = std::uint32_t(i);
+    }
+
+    // Animated locals, sampled up front
+    std::vector<Matrix>        sampled;
+    std::vector<std::uint32_t> sampledSlots(count, WorldTransformTable::NoSlot);
+    auto local = [&](NodeId node, std::uint32_t slot) -> const Matrix&
+    {
+        return slot == WorldTransformTable::NoSlot ? graph.localTransform(node) : sampled[slot];
+    };
+    for (NS::UInteger i = 0; i < count; ++i)
+    {
+        if (graph.flags(nodes[i]) & SceneGraph::FlagAnimated)
+        {
+            sampledSlots[i] = std::uint32_t(sampled.size());
+            sampled.emplace_back();
+            sample(nodes[i], time, sampled.back().columns);
+        }
+    }
+
+    // The root's parents still place it; walk up to the first reset
+    Matrix rootWorld = local(root, sampledSlots[0]);
+    for (NodeId node = root;
+         !(graph.flags(node) & SceneGraph::FlagResetsTransform) && graph.parent(node) != SceneGraph::InvalidNode;)
+    {
+        node = graph.parent(node);
+        if (!(graph.flags(node) & SceneGraph::FlagTransform))
+        {
+            continue;
+        }
+
+        Matrix parentLocal = graph.localTransform(node);
+        if (graph.flags(node) & SceneGraph::FlagAnimated)
+        {
+            sample(node, time, parentLocal.columns);
+        }
+        multiply(parentLocal, rootWorld, rootWorld);
+    }
+
+    std::vector<Matrix>& world = table->_matrices;
+    world.resize(count);
+    world[0] = rootWorld;
+
+    auto evaluateRange = [&](NS::UInteger begin, NS::UInteger end)
+    {
+        for (NS::UInteger i = std::max<NS::UInteger>(begin, 1); i < end; ++i)
+        {
+            const NodeId       node = nodes[i];
+            const std::uint8_t flags = graph.flags(node);
+            const Matrix&      parent = world[table->_slots[graph.parent(node)]];
+            if (flags & SceneGraph::FlagResetsTransform)
+            {
+                world[i] = local(node, sampledSlots[i]);
+            }
+            else if (flags & SceneGraph::FlagTransform)
+            {
+                multiply(parent, local(node, sampledSlots[i]), world[i]);
+            }
+            else
+            {
+                world[i] = parent;
+            }
+        }
+    };
+
+    if (!parallel || count < ParallelThreshold || ThreadPool::shared().threadCount() == 1)
+    {
+        evaluateRange(0, count);
+    }
+    else
+    {
+        // Subtree extents in the pre-order list
+        std::vector<std::uint32_t> ends(count);
+        std::vector<std::uint32_t> stack;
+        for (NS::UInteger i = 0; i < count; ++i)
+        {
+            while (!stack.empty() && nodes[stack.back()] != graph.parent(nodes[i]))
+            {
+                ends[stack.back()] = std::uint32_t(i);
+                stack.pop_back();
+            }
+            stack.push_back(std::uint32_t(i));
+        }
+        for (std::uint32_t i : stack)
+        {
+            ends[i] = std::uint32_t(count);
+        }
+
+        // Split the largest range into its head and its child subtrees until
+        // there are a few ranges per worker. Heads are split top-down, so
+        // evaluating them in order has every parent ready.
+        const NS::UInteger target = 4 * ThreadPool::shared().threadCount();
+        const NS::UInteger smallest = std::max<NS::UInteger>(count / (4 * target), 256);
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> ranges = { { 0, std::uint32_t(count) } };
+        std::vector<std::uint32_t> heads;
+        while (ranges.size() < target)
+        {
+            auto largest = std::max_element(ranges.begin(), ranges.end(), [](const auto& a, const auto& b)
+            {
+                return a.second - a.first < b.second - b.first;
+            });
+            if (largest->second - largest->first <= smallest)
+            {
+                break;
+            }
+
+            const std::uint32_t head = largest->first;
+            const std::uint32_t end = largest->second;
+            ranges.erase(largest);
+            heads.push_back(head);
+            for (std::uint32_t child = head + 1; child < end; child = ends[child])
+            {
+                ranges.push_back({ child, ends[child] });
+            }
+        }
+
+        for (std::uint32_t head : heads)
+        {
+            evaluateRange(head, head + 1);
+        }
+        parallelFor(ranges.size(), 1, [&](NS::UInteger begin, NS::UInteger end)
+        {
+            for (NS::UInteger r = begin; r < end; ++r)
+            {
+                evaluateRange(ranges[r].first, ranges[r].second);
+            }
+        });
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_tables.size() >= MaxTables)
+    {
+        auto oldest = std::min_element(_tables.begin(), _tables.end(), [](const auto& a, const auto& b)
+        {
+            return a.second.use < b.second.use;
+        });
+        _tables.erase(oldest);
+    }
+    // Keep the table only if nothing changed while it was built
+    if (_generation == graph.generation() && _transformGeneration == graph.transformGeneration())
+    {
+        _tables[{ root, time }] = { table, ++_use };
+    }
+    return table;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
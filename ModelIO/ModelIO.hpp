@@ -7,19 +7,39 @@
 
 #import "ModelIOExports.hpp"
 
+#import "MDLAlignedAllocator.hpp"
 #import "MDLAsset.hpp"
 #import "MDLAssetResolver.hpp"
+#import "MDLBoundingVolumeHierarchy.hpp"
+#import "MDLBoundsCache.hpp"
 #import "MDLCamera.hpp"
+#import "MDLCurveCompression.hpp"
+#import "MDLInstancing.hpp"
+#import "MDLJointHierarchy.hpp"
+#import "MDLKeyframeSampling.hpp"
 #import "MDLLight.hpp"
 #import "MDLMaterial.hpp"
+#import "MDLMatrixBuffer.hpp"
 #import "MDLMesh.hpp"
+#import "MDLMeshAdjacency.hpp"
 #import "MDLMeshBuffer.hpp"
+#import "MDLMeshSimplifier.hpp"
 #import "MDLObject.hpp"
+#import "MDLPoseBlending.hpp"
+#import "MDLRetargeting.hpp"
+#import "MDLSceneGraph.hpp"
+#import "MDLSkinning.hpp"
 #import "MDLSubmesh.hpp"
 #import "MDLTexture.hpp"
 #import "MDLTransform.hpp"
+#import "MDLTransformProgram.hpp"
 #import "MDLTransformStack.hpp"
 #import "MDLTypes.hpp"
+#import "MDLVertexBounds.hpp"
 #import "MDLVertexDescriptor.hpp"
 #import "MDLVoxelArray.hpp"
+#import "MDLVoxelDistanceField.hpp"
+#import "MDLVoxelSurface.hpp"
+#import "MDLVoxelization.hpp"
+#import "MDLWorldTransforms.hpp"
 #import "MDLAnimation.hpp"